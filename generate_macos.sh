@@ -13,7 +13,7 @@ if [ -f "$SIGHMAKE" ] && file "$SIGHMAKE" | grep -q "Mach-O"; then
 else
     echo "No macOS binary found, compiling from source..."
     SOURCES=$(find src -name '*.cpp' | tr '\n' ' ')
-    clang++ -std=c++17 -O2 -Wall -Isrc/ -include src/pch.h -o sighmake_macos $SOURCES
+    clang++ -std=c++17 -O2 -Wall -pthread -Isrc/ -include src/pch.h -o sighmake_macos $SOURCES
     if [ $? -ne 0 ]; then
         echo
         echo "Compilation failed."
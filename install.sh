@@ -64,7 +64,7 @@ find src -name '*.cpp' -print0 | \
     }
 
 # Link, then strip symbols for a smaller release binary
-$CXX $CXXFLAGS -o sighmake "$BUILD_DIR"/*.o
+$CXX $CXXFLAGS -pthread -o sighmake "$BUILD_DIR"/*.o
 strip sighmake 2>/dev/null || true
 echo "      OK"
 echo
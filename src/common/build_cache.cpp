@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "build_cache.hpp"
+#include "output_file.hpp"
+#include "package_cache.hpp"
 
 namespace fs = std::filesystem;
 
@@ -33,15 +35,81 @@ static std::vector<std::string> split(const std::string& str, char delim) {
     return result;
 }
 
-bool BuildCache::write(const std::string& output_dir) const {
-    fs::path cache_path = fs::path(output_dir) / CACHE_FILENAME;
+uint64_t hash_input_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return 0;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return fnv1a64(buffer.str());
+}
 
-    std::ofstream out(cache_path);
-    if (!out) {
-        std::cerr << "Warning: Failed to write build cache: " << cache_path << "\n";
+uint64_t hash_input_directory(const std::string& path) {
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        return 0;
+    }
+
+    std::vector<std::string> names;
+    for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (it->is_directory(ec)) {
+            name += '/';
+        }
+        names.push_back(std::move(name));
+    }
+    return hash_directory_entries(std::move(names));
+}
+
+uint64_t hash_directory_entries(std::vector<std::string> names) {
+    std::sort(names.begin(), names.end());
+    return fnv1a64(join(names, "\n"));
+}
+
+void BuildCache::record_inputs(const Solution& solution) {
+    options = solution.generation_options;
+    inputs = solution.inputs;
+}
+
+bool BuildCache::is_up_to_date(const std::string& generation_options, const std::string& dir) const {
+    if (inputs.empty() || options != generation_options) {
         return false;
     }
 
+    // Generated files must still be there
+    std::error_code ec;
+    if (!build_dir.empty() && !fs::exists(fs::path(dir) / build_dir, ec)) {
+        return false;
+    }
+    if (!solution_file.empty() && !fs::exists(fs::path(dir) / solution_file, ec)) {
+        return false;
+    }
+    for (const auto& project : projects) {
+        if (!fs::exists(fs::path(dir) / project.file, ec)) {
+            return false;
+        }
+    }
+
+    for (const auto& input : inputs) {
+        uint64_t current = input.is_directory ? hash_input_directory(input.path) : hash_input_file(input.path);
+        if (current != input.hash) {
+            return false;
+        }
+    }
+
+    // find_package() results depend on environment variables and SDK paths
+    // that are not generation inputs; their probes are stored next to us
+    PackageCache packages;
+    packages.load(dir);
+    return packages.unchanged();
+}
+
+bool BuildCache::write(const std::string& output_dir) const {
+    fs::path cache_path = fs::path(output_dir) / CACHE_FILENAME;
+
+    OutputFile out(cache_path);
+
     out << "# sighmake build cache - auto-generated, do not edit\n";
     out << "generator=" << generator << "\n";
     out << "solution_name=" << solution_name << "\n";
@@ -66,9 +134,15 @@ bool BuildCache::write(const std::string& output_dir) const {
     for (const auto& project : projects) {
         out << "project=" << project.name << "|" << project.file << "\n";
     }
+    if (!options.empty()) {
+        out << "options=" << options << "\n";
+    }
+    for (const auto& input : inputs) {
+        out << "input=" << (input.is_directory ? 'd' : 'f') << "|" << std::hex << input.hash << std::dec
+            << "|" << input.path << "\n";
+    }
 
-    out.flush();
-    if (!out) {
+    if (!out.commit()) {
         std::cerr << "Warning: Failed to write build cache: " << cache_path << "\n";
         return false;
     }
@@ -123,6 +197,23 @@ std::optional<BuildCache> BuildCache::read(const std::string& dir) {
                 cache.projects.push_back(
                     { value.substr(0, sep), value.substr(sep + 1) });
             }
+        } else if (key == "options") {
+            cache.options = value;
+        } else if (key == "input") {
+            // input=<f|d>|<hex hash>|<path>
+            size_t kind_sep = value.find('|');
+            size_t hash_sep = kind_sep == std::string::npos ? kind_sep : value.find('|', kind_sep + 1);
+            if (hash_sep != std::string::npos) {
+                GenerationInput input;
+                input.is_directory = value.substr(0, kind_sep) == "d";
+                try {
+                    input.hash = std::stoull(value.substr(kind_sep + 1, hash_sep - kind_sep - 1), nullptr, 16);
+                } catch (...) {
+                    input.hash = 0;
+                }
+                input.path = value.substr(hash_sep + 1);
+                cache.inputs.push_back(std::move(input));
+            }
         }
     }
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "project_types.hpp"
+
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
@@ -12,7 +15,7 @@ struct BuildProjectEntry {
 };
 
 struct BuildCache {
-    std::string generator;              // "vcxproj" or "makefile"
+    std::string generator;              // "vcxproj", "makefile", "ninja" or "cmake"
     std::string solution_file;          // Relative path to .sln/.slnx (vcxproj only)
     std::string solution_name;
     std::string vs_installation_path;   // (vcxproj only)
@@ -22,6 +25,16 @@ struct BuildCache {
     std::vector<std::string> platforms;
     std::string build_dir;              // Relative path to makefile build dir (makefile only)
     std::vector<BuildProjectEntry> projects;
+    std::string options;                // Generation options fingerprint (see Solution::generation_options)
+    std::vector<GenerationInput> inputs;
+
+    // Copy the solution's generation inputs and options into the cache
+    void record_inputs(const Solution& solution);
+
+    // True if inputs were recorded with the same options, none of them changed
+    // on disk, the generated files listed in the cache still exist and no
+    // find_package() probe input stored in dir changed
+    bool is_up_to_date(const std::string& generation_options, const std::string& dir) const;
 
     // Write cache to output_dir/.sighmake_cache
     bool write(const std::string& output_dir) const;
@@ -32,4 +45,14 @@ struct BuildCache {
     static constexpr const char* CACHE_FILENAME = ".sighmake_cache";
 };
 
+// Content hash of a generation input file (0 if it cannot be read)
+uint64_t hash_input_file(const std::string& path);
+
+// Hash of a directory's sorted entry names (0 if it does not exist)
+uint64_t hash_input_directory(const std::string& path);
+
+// hash_input_directory for a listing already in hand: entry names with a
+// trailing '/' on directories, in any order
+uint64_t hash_directory_entries(std::vector<std::string> names);
+
 } // namespace vcxproj
@@ -2,11 +2,47 @@
 #include "build_runner.hpp"
 #include "project_types.hpp"
 #include "defaults.hpp"
+#include "build_trace.hpp"
+#include "native_build.hpp"
+#include "object_cache.hpp"
 
 namespace fs = std::filesystem;
 
 namespace vcxproj {
 
+// Overrides the buildscript's compiler_launcher for makefile and CMake builds
+static constexpr const char* COMPILER_LAUNCHER_ENV = "SIGHMAKE_COMPILER_LAUNCHER";
+
+static std::string compiler_launcher_from_env() {
+    const char* launcher = std::getenv(COMPILER_LAUNCHER_ENV);
+    return launcher ? launcher : "";
+}
+
+// A command line as a CMake list: its words joined with ';'
+static std::string cmake_list(const std::string& command) {
+    std::istringstream words(command);
+    std::string word;
+    std::string list;
+    while (words >> word) {
+        list += (list.empty() ? "" : ";") + word;
+    }
+    return list;
+}
+
+// Value of a CMakeCache.txt entry (NAME:TYPE=value), or "" if it is not cached
+static std::string cmake_cache_value(const fs::path& build_dir, const std::string& name) {
+    std::ifstream in(build_dir / "CMakeCache.txt");
+    const std::string prefix = name + ":";
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            size_t eq = line.find('=');
+            return eq == std::string::npos ? "" : line.substr(eq + 1);
+        }
+    }
+    return "";
+}
+
 static bool contains_path_separator(const std::string& value) {
     return value.find('/') != std::string::npos ||
            value.find('\\') != std::string::npos;
@@ -64,6 +100,53 @@ static std::optional<fs::path> resolve_msbuild_project(
     return std::nullopt;
 }
 
+// Runs a make command with every recipe line going through the
+// --trace-command hook, which times it for --trace and routes compiles
+// through the object cache for --cache
+static int run_hooked_make(const std::string& cmd, const BuildOptions& options,
+                           const fs::path& build_dir) {
+#ifdef _WIN32
+    std::cerr << "Warning: --trace and --cache are not supported on Windows, building without them.\n";
+    (void)options;
+    (void)build_dir;
+    return std::system(cmd.c_str());
+#else
+    const bool tracing = !options.trace_file.empty();
+    const fs::path log_path = build_dir / ".sighmake_trace.log";
+    if (tracing) {
+        std::ofstream truncate(log_path, std::ios::trunc);
+        ::setenv(TRACE_LOG_ENV, log_path.string().c_str(), 1);
+    }
+    if (!options.cache_dir.empty()) {
+        ::setenv(CACHE_DIR_ENV, options.cache_dir.c_str(), 1);
+        ::setenv(CACHE_SIZE_ENV, std::to_string(options.cache_size).c_str(), 1);
+    }
+
+    // Command-line variables reach sub-makes through MAKEFLAGS
+    const std::string hooked_cmd = cmd + " \"SHELL=" + options.executable + "\" \".SHELLFLAGS=" +
+                                   TRACE_COMMAND_FLAG + " -c\"";
+    const int result = std::system(hooked_cmd.c_str());
+    ::unsetenv(TRACE_LOG_ENV);
+    ::unsetenv(CACHE_DIR_ENV);
+    ::unsetenv(CACHE_SIZE_ENV);
+    if (!tracing) {
+        return result;
+    }
+
+    const std::vector<TraceEvent> events = read_trace_log(log_path.string());
+    std::error_code ec;
+    fs::remove(log_path, ec);
+
+    if (!write_build_trace(events, options.trace_file)) {
+        std::cerr << "Warning: Could not write build trace to " << options.trace_file << "\n";
+    } else {
+        std::cout << "Build trace written to " << options.trace_file << "\n";
+    }
+    write_build_trace_summary(events, std::cout);
+    return result;
+#endif
+}
+
 std::string BuildRunner::find_msbuild(const std::string& vs_installation_path) {
     // Standard MSBuild location for VS 2017+
     fs::path msbuild = fs::path(vs_installation_path) / "MSBuild" / "Current" / "Bin" / "MSBuild.exe";
@@ -273,6 +356,120 @@ int BuildRunner::run_make(const BuildCache& cache, const BuildOptions& options,
         cmd += " -j " + std::to_string(options.parallel);
     }
 
+    // Command-line variables reach sub-makes through MAKEFLAGS
+    const std::string launcher = compiler_launcher_from_env();
+    if (!launcher.empty()) {
+        cmd += " \"SIGHMAKE_COMPILER_LAUNCHER=" + launcher + "\"";
+    }
+
+    std::cout << "Building: " << cache.solution_name << " [" << config << "]" << std::endl;
+
+    if (!options.trace_file.empty() || !options.cache_dir.empty()) {
+        return run_hooked_make(cmd, options, build_dir);
+    }
+    return std::system(cmd.c_str());
+}
+
+int BuildRunner::run_ninja(const BuildCache& cache, const BuildOptions& options,
+                            const std::string& cache_dir) {
+    // Verify build.ninja exists
+    fs::path build_dir = fs::path(cache_dir) / cache.build_dir;
+    fs::path ninja_path = build_dir / "build.ninja";
+    if (!fs::exists(ninja_path)) {
+        std::cerr << "Error: build.ninja not found at " << ninja_path << "\n";
+        std::cerr << "  Run sighmake to regenerate project files.\n";
+        return 1;
+    }
+
+    // Determine configuration
+    std::string config = options.config;
+    if (config.empty()) {
+        if (!cache.configurations.empty()) {
+            bool has_debug = false;
+            for (const auto& c : cache.configurations) {
+                if (c == "Debug") { has_debug = true; break; }
+            }
+            config = has_debug ? "Debug" : cache.configurations[0];
+        } else {
+            config = "Debug";
+        }
+    } else {
+        // Validate
+        bool found = false;
+        for (const auto& c : cache.configurations) {
+            if (c == config) { found = true; break; }
+        }
+        if (!found && !cache.configurations.empty()) {
+            std::cerr << "Error: Configuration '" << config << "' not available.\n";
+            std::cerr << "  Available: ";
+            for (size_t i = 0; i < cache.configurations.size(); i++) {
+                if (i > 0) std::cerr << ", ";
+                std::cerr << cache.configurations[i];
+            }
+            std::cerr << "\n";
+            return 1;
+        }
+    }
+
+    if (options.executor == "native") {
+        NativeBuildOptions native;
+        native.jobs = options.parallel;
+        native.clean_only = options.clean_only;
+        native.clean_first = options.clean_first;
+        native.trace_file = options.trace_file;
+        native.cache_dir = options.cache_dir;
+        native.cache_size = options.cache_size;
+
+        // Projects map to their per-config phony target
+        std::vector<std::string> targets;
+        if (!options.project.empty()) {
+            targets.push_back(options.project + "." + config);
+        } else if (!options.target.empty()) {
+            targets.push_back(options.target);
+        } else {
+            targets.push_back(config);
+        }
+
+        std::cout << (options.clean_only ? "Cleaning: " : "Building: ") << cache.solution_name
+                  << " [" << config << "] with the native executor" << std::endl;
+        return run_native_build(build_dir.string(), targets, native);
+    }
+
+    // Build ninja command
+    std::string cmd = "ninja -C \"" + build_dir.string() + "\"";
+
+    // Clean only if requested
+    if (options.clean_only) {
+        std::string clean_cmd = cmd + " -t clean";
+        std::cout << "Cleaning: " << cache.solution_name << " [" << config << "]" << std::endl;
+        return std::system(clean_cmd.c_str());
+    }
+
+    // Clean first if requested
+    if (options.clean_first) {
+        std::string clean_cmd = cmd + " -t clean";
+        std::cout << "Cleaning...\n";
+        int clean_result = std::system(clean_cmd.c_str());
+        if (clean_result != 0) {
+            std::cerr << "Warning: clean step returned non-zero exit code ("
+                      << clean_result << "), continuing with build.\n";
+        }
+    }
+
+    // Parallel build
+    if (options.parallel > 0) {
+        cmd += " -j " + std::to_string(options.parallel);
+    }
+
+    // Add target or config. Projects map to their per-config phony target.
+    if (!options.project.empty()) {
+        cmd += " " + options.project + "." + config;
+    } else if (!options.target.empty()) {
+        cmd += " " + options.target;
+    } else {
+        cmd += " " + config;
+    }
+
     std::cout << "Building: " << cache.solution_name << " [" << config << "]" << std::endl;
 
     return std::system(cmd.c_str());
@@ -280,9 +477,29 @@ int BuildRunner::run_make(const BuildCache& cache, const BuildOptions& options,
 
 int BuildRunner::run_cmake(const BuildCache& cache, const BuildOptions& options,
                             const std::string& cache_dir) {
-    // Verify build directory exists
     fs::path build_dir = fs::path(cache_dir) / cache.build_dir;
-    if (!fs::exists(build_dir)) {
+    const bool configured = fs::exists(build_dir);
+
+    // A launcher from the environment is passed to configure, where it wins
+    // over the generated default. CMake keeps it in CMakeCache.txt, so
+    // reconfigure only when it differs from the cached one, and drop the
+    // cached one once the variable is unset so compiler_launcher applies
+    // again. Targets with a compiler_launcher of their own keep it.
+    const std::string launcher = cmake_list(compiler_launcher_from_env());
+    const std::string cached_launcher =
+        configured ? cmake_cache_value(build_dir, "CMAKE_CXX_COMPILER_LAUNCHER") : "";
+    std::string launcher_args;
+    if (launcher != cached_launcher) {
+        for (const char* lang : {"C", "CXX"}) {
+            if (!launcher.empty()) {
+                launcher_args += std::string(" \"-DCMAKE_") + lang + "_COMPILER_LAUNCHER=" + launcher + "\"";
+            } else {
+                launcher_args += std::string(" -UCMAKE_") + lang + "_COMPILER_LAUNCHER";
+            }
+        }
+    }
+
+    if (!configured || !launcher_args.empty()) {
         // Create build directory and run cmake configure first
         try {
             fs::create_directories(build_dir);
@@ -293,6 +510,7 @@ int BuildRunner::run_cmake(const BuildCache& cache, const BuildOptions& options,
 
         // Configure
         std::string configure_cmd = "cmake -S \"" + cache_dir + "\" -B \"" + build_dir.string() + "\"";
+        configure_cmd += launcher_args;
         std::cout << "Configuring CMake project...\n";
         int ret = std::system(configure_cmd.c_str());
         if (ret != 0) {
@@ -381,16 +599,50 @@ int BuildRunner::run(const BuildOptions& options) {
 
     std::string cache_dir = fs::canonical(options.directory).string();
 
+    if (options.executor == "native" && cache->generator != "ninja") {
+        std::cerr << "Error: --executor native runs the build.ninja of the ninja generator.\n";
+        std::cerr << "  Regenerate with -g ninja to build without make or ninja.\n";
+        return 1;
+    }
+    if (!compiler_launcher_from_env().empty() && cache->generator != "makefile" && cache->generator != "cmake") {
+        std::cerr << "Warning: " << COMPILER_LAUNCHER_ENV << " only applies to makefile and CMake builds; "
+                  << "set compiler_launcher in the buildscript instead.\n";
+    }
+    if (!options.trace_file.empty() && cache->generator != "makefile" && options.executor != "native") {
+        std::cerr << "Warning: --trace is only supported for makefile builds and the native executor, ignoring it.\n";
+    }
+
+    BuildOptions build_options = options;
+    if (!options.cache_dir.empty()) {
+        if (cache->generator != "makefile" && options.executor != "native") {
+            std::cerr << "Warning: --cache is only supported for makefile builds and the native executor, ignoring it.\n";
+            build_options.cache_dir.clear();
+        } else if (build_options.cache_size == 0) {
+            build_options.cache_size = DEFAULT_CACHE_SIZE;
+        }
+    }
+
+    int result = 0;
+    const ObjectCache object_cache(build_options.cache_dir, build_options.cache_size);
+    const bool report_cache = !build_options.cache_dir.empty() && !options.clean_only;
+    const ObjectCacheStats cache_before = report_cache ? object_cache.stats() : ObjectCacheStats();
     if (cache->generator == "vcxproj") {
-        return run_msbuild(*cache, options, cache_dir);
+        result = run_msbuild(*cache, build_options, cache_dir);
     } else if (cache->generator == "makefile") {
-        return run_make(*cache, options, cache_dir);
+        result = run_make(*cache, build_options, cache_dir);
+    } else if (cache->generator == "ninja") {
+        result = run_ninja(*cache, build_options, cache_dir);
     } else if (cache->generator == "cmake") {
-        return run_cmake(*cache, options, cache_dir);
+        result = run_cmake(*cache, build_options, cache_dir);
     } else {
         std::cerr << "Error: Unknown generator '" << cache->generator << "' in cache file.\n";
         return 1;
     }
+
+    if (report_cache) {
+        write_object_cache_summary(cache_before, object_cache.stats(), build_options.cache_size, std::cout);
+    }
+    return result;
 }
 
 } // namespace vcxproj
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "build_cache.hpp"
+#include <cstdint>
 #include <string>
 
 namespace vcxproj {
@@ -14,6 +15,11 @@ struct BuildOptions {
     bool clean_only = false;        // --clean (optional, clean without building)
     bool build_project_references = true; // false with --no-project-references
     int parallel = 0;               // --parallel <N> (optional, 0 = default)
+    std::string trace_file;         // --trace <file> (optional, makefile builds and native executor)
+    std::string executor;           // --executor native (optional, ninja generator)
+    std::string cache_dir;          // --cache / --cache-dir <dir> (optional, makefile builds and native executor)
+    uint64_t cache_size = 0;        // --cache-size <size> (0 = DEFAULT_CACHE_SIZE)
+    std::string executable;         // Path of sighmake itself, the recipe shell hook for --trace and --cache
 };
 
 class BuildRunner {
@@ -31,6 +37,10 @@ private:
     static int run_make(const BuildCache& cache, const BuildOptions& options,
                         const std::string& cache_dir);
 
+    // Invoke ninja on build/build.ninja
+    static int run_ninja(const BuildCache& cache, const BuildOptions& options,
+                         const std::string& cache_dir);
+
     // Invoke cmake --build on a CMake build directory
     static int run_cmake(const BuildCache& cache, const BuildOptions& options,
                          const std::string& cache_dir);
@@ -0,0 +1,306 @@
+#include "pch.h"
+#include "build_trace.hpp"
+#include "object_cache.hpp"
+#include "output_file.hpp"
+#include "string_utils.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Log records are one line each: start, end, exit code and the command with
+// backslashes, tabs and newlines escaped
+std::string escape_field(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\') result += "\\\\";
+        else if (c == '\t') result += "\\t";
+        else if (c == '\n') result += "\\n";
+        else if (c == '\r') result += "\\r";
+        else result += c;
+    }
+    return result;
+}
+
+std::string unescape_field(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            result += value[i];
+            continue;
+        }
+        char c = value[++i];
+        result += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+    }
+    return result;
+}
+
+// Appends one line with a single write() so records from parallel recipe
+// lines never interleave
+void append_record(const std::string& log_path, const std::string& line) {
+#ifdef _WIN32
+    std::ofstream out(log_path, std::ios::app | std::ios::binary);
+    out << line;
+#else
+    int fd = ::open(log_path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return;
+    const char* data = line.data();
+    size_t left = line.size();
+    while (left > 0) {
+        ssize_t written = ::write(fd, data, left);
+        if (written <= 0) break;
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+    ::close(fd);
+#endif
+}
+
+std::vector<std::string> split_words(const std::string& command) {
+    std::vector<std::string> words;
+    std::istringstream in(command);
+    std::string word;
+    while (in >> word) {
+        if (word.size() >= 2 && (word.front() == '"' || word.front() == '\'') && word.back() == word.front()) {
+            word = word.substr(1, word.size() - 2);
+        }
+        words.push_back(word);
+    }
+    return words;
+}
+
+bool ends_with(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() &&
+           value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool is_compiler(const std::string& program) {
+    return program.find("gcc") != std::string::npos || program.find("g++") != std::string::npos ||
+           program.find("clang") != std::string::npos || program == "cc" || program == "c++" ||
+           ends_with(program, "-cc") || ends_with(program, "-c++") || program.find("nasm") != std::string::npos;
+}
+
+// Classifies one simple command (no && or ;)
+TraceCommandInfo classify_words(std::vector<std::string> words) {
+    TraceCommandInfo info{"other", ""};
+    if (words.empty()) return info;
+
+    // A compiler launcher (ccache, sccache, ...) in front of the compiler
+    if (words.size() > 1 && !is_compiler(fs::path(words[0]).filename().string()) &&
+        is_compiler(fs::path(words[1]).filename().string())) {
+        words.erase(words.begin());
+    }
+
+    const std::string program = fs::path(words[0]).filename().string();
+    info.label = program;
+
+    if (ends_with(program, "make")) {
+        info.kind = "make";
+        for (size_t i = 1; i + 1 < words.size(); ++i) {
+            if (words[i] == "-C" || words[i] == "-f") info.label = words[i + 1];
+        }
+        return info;
+    }
+
+    std::string output;
+    for (size_t i = 1; i + 1 < words.size(); ++i) {
+        if (words[i] == "-o") output = words[i + 1];
+    }
+
+    if (program == "ar" || ends_with(program, "-ar")) {
+        info.kind = "archive";
+        for (size_t i = 1; i < words.size(); ++i) {
+            if (ends_with(words[i], ".a") || ends_with(words[i], ".lib")) {
+                info.label = words[i];
+                break;
+            }
+        }
+        return info;
+    }
+
+    if (!is_compiler(program)) return info;
+
+    bool compiles = false;
+    for (size_t i = 1; i < words.size(); ++i) {
+        if (words[i] == "-c" || (words[i] == "-x" && i + 1 < words.size() && ends_with(words[i + 1], "-header"))) {
+            compiles = true;
+        }
+    }
+
+    if (compiles) {
+        // The translation unit is the last operand that isn't the -o value
+        info.kind = "compile";
+        for (size_t i = words.size(); i-- > 1;) {
+            const std::string& word = words[i];
+            if (word.empty() || word[0] == '-' || word == output) continue;
+            if (i > 0 && (words[i - 1] == "-o" || words[i - 1] == "-MF" || words[i - 1] == "-MT" ||
+                          words[i - 1] == "-include" || words[i - 1] == "-x")) {
+                continue;
+            }
+            info.label = word;
+            break;
+        }
+    } else if (!output.empty()) {
+        info.kind = "link";
+        info.label = output;
+    }
+    return info;
+}
+
+} // namespace
+
+int run_traced_command(const std::string& command) {
+    const int64_t start = now_us();
+    const int exit_code = run_recipe_command(command);
+    const int64_t end = now_us();
+
+    const char* log_path = std::getenv(TRACE_LOG_ENV);
+    if (log_path && *log_path) {
+        append_record(log_path, std::to_string(start) + "\t" + std::to_string(end) + "\t" +
+                                    std::to_string(exit_code) + "\t" + escape_field(command) + "\n");
+    }
+    return exit_code;
+}
+
+std::vector<TraceEvent> read_trace_log(const std::string& path) {
+    std::vector<TraceEvent> events;
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t first = line.find('\t');
+        size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+        size_t third = second == std::string::npos ? second : line.find('\t', second + 1);
+        if (third == std::string::npos) continue;
+
+        TraceEvent event;
+        try {
+            event.start_us = std::stoll(line.substr(0, first));
+            event.end_us = std::stoll(line.substr(first + 1, second - first - 1));
+            event.exit_code = std::stoi(line.substr(second + 1, third - second - 1));
+        } catch (const std::exception&) {
+            continue;
+        }
+        event.command = unescape_field(line.substr(third + 1));
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+TraceCommandInfo classify_trace_command(const std::string& command) {
+    // Event commands are chained onto recipes with && or ;, so classify each
+    // part and keep the first one that does real work
+    std::vector<std::string> words = split_words(command);
+    std::vector<std::string> part;
+    TraceCommandInfo first_info;
+    bool have_first = false;
+    for (size_t i = 0; i <= words.size(); ++i) {
+        if (i < words.size() && words[i] != "&&" && words[i] != ";" && words[i] != "||") {
+            part.push_back(words[i]);
+            continue;
+        }
+        if (part.empty()) continue;
+        TraceCommandInfo info = classify_words(part);
+        if (info.kind != "other") return info;
+        if (!have_first) {
+            first_info = info;
+            have_first = true;
+        }
+        part.clear();
+    }
+    return have_first ? first_info : TraceCommandInfo{"other", ""};
+}
+
+bool write_build_trace(const std::vector<TraceEvent>& events, const std::string& path) {
+    std::vector<const TraceEvent*> sorted;
+    for (const auto& event : events) sorted.push_back(&event);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const TraceEvent* a, const TraceEvent* b) {
+        return a->start_us < b->start_us;
+    });
+    const int64_t origin = sorted.empty() ? 0 : sorted.front()->start_us;
+
+    // Greedy row packing: each command goes to the first row that is free
+    std::vector<int64_t> row_end;
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"build\"}}";
+    for (const TraceEvent* event : sorted) {
+        size_t row = 0;
+        while (row < row_end.size() && row_end[row] > event->start_us) ++row;
+        if (row == row_end.size()) row_end.push_back(0);
+        row_end[row] = event->end_us;
+
+        const TraceCommandInfo info = classify_trace_command(event->command);
+        out << ",\n  {\"name\": \"" << escape_json(info.label.empty() ? info.kind : info.label)
+            << "\", \"cat\": \"" << info.kind << "\", \"ph\": \"X\", \"ts\": " << (event->start_us - origin)
+            << ", \"dur\": " << (event->end_us - event->start_us) << ", \"pid\": 1, \"tid\": " << (row + 1)
+            << ", \"args\": {\"exit_code\": " << event->exit_code
+            << ", \"command\": \"" << escape_json(event->command) << "\"}}";
+    }
+    out << "\n]}\n";
+
+    return write_file_if_changed(path, out.str()) != WriteResult::Failed;
+}
+
+void write_build_trace_summary(const std::vector<TraceEvent>& events, std::ostream& out, size_t count) {
+    if (events.empty()) {
+        out << "\nBuild trace: no commands were run\n";
+        return;
+    }
+
+    int64_t first_start = events.front().start_us;
+    int64_t last_end = events.front().end_us;
+    std::map<std::string, std::pair<size_t, int64_t>> per_kind;  // kind -> (commands, busy us)
+    std::vector<std::pair<int64_t, std::string>> compiles;       // (duration, source)
+    for (const auto& event : events) {
+        first_start = std::min(first_start, event.start_us);
+        last_end = std::max(last_end, event.end_us);
+        const TraceCommandInfo info = classify_trace_command(event.command);
+        const int64_t duration = event.end_us - event.start_us;
+        auto& totals = per_kind[info.kind];
+        totals.first++;
+        totals.second += duration;
+        if (info.kind == "compile") {
+            compiles.push_back({duration, info.label});
+        }
+    }
+
+    const auto seconds = [](int64_t us) { return static_cast<double>(us) / 1e6; };
+    out << std::fixed << std::setprecision(2);
+    out << "\nBuild trace: " << events.size() << " commands in " << seconds(last_end - first_start)
+        << " s wall time\n";
+    for (const auto& [kind, totals] : per_kind) {
+        out << "  " << std::left << std::setw(8) << kind << std::right << std::setw(7) << totals.first
+            << " commands " << std::setw(10) << seconds(totals.second) << " s\n";
+    }
+
+    // Sub-make and bookkeeping lines are not translation units
+    std::stable_sort(compiles.begin(), compiles.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    if (!compiles.empty()) {
+        out << "Slowest translation units:\n";
+        for (size_t i = 0; i < compiles.size() && i < count; ++i) {
+            out << "  " << std::setw(8) << seconds(compiles[i].first) << " s  " << compiles[i].second << "\n";
+        }
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+} // namespace vcxproj
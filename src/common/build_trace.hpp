@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vcxproj {
+
+// Command tracing for `--build --trace <file>`. make runs every recipe line
+// through `sighmake --trace-command -c <line>` (SHELL/.SHELLFLAGS set on the
+// make command line), which runs the line with /bin/sh and appends one record
+// to the log named by SIGHMAKE_TRACE_LOG. After the build the log becomes a
+// Chrome trace and a slowest-translation-units summary. `--build --cache`
+// installs the same hook to route compiles through the object cache.
+
+// Environment variable holding the log path for traced recipe lines
+constexpr const char* TRACE_LOG_ENV = "SIGHMAKE_TRACE_LOG";
+
+// Internal argv[1] of the recipe shell hook
+constexpr const char* TRACE_COMMAND_FLAG = "--trace-command";
+
+// One recipe line run by the build tool
+struct TraceEvent {
+    std::string command;
+    int64_t start_us = 0;   // microseconds since the epoch
+    int64_t end_us = 0;
+    int exit_code = 0;
+};
+
+// What a recipe line does, derived from its command line
+struct TraceCommandInfo {
+    std::string kind;   // "compile", "link", "archive", "make" or "other"
+    std::string label;  // Source file, output file or program name
+};
+
+// Runs command through run_recipe_command() and, if SIGHMAKE_TRACE_LOG is
+// set, appends its timing to that log. Returns the command's exit code (128 + signal if it
+// was killed), so make sees the same result it would without the hook.
+int run_traced_command(const std::string& command);
+
+// Reads the records appended by run_traced_command, skipping damaged lines
+std::vector<TraceEvent> read_trace_log(const std::string& path);
+
+TraceCommandInfo classify_trace_command(const std::string& command);
+
+// Chrome trace_event JSON: one complete event per command, packed into as
+// few rows as the build's parallelism needs
+bool write_build_trace(const std::vector<TraceEvent>& events, const std::string& path);
+
+// Wall time, busy time per kind of command and the `count` slowest
+// translation units
+void write_build_trace_summary(const std::vector<TraceEvent>& events, std::ostream& out,
+                               size_t count = 10);
+
+} // namespace vcxproj
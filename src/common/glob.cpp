@@ -0,0 +1,510 @@
+#include "pch.h"
+#include "glob.hpp"
+#include "parallel.hpp"
+#include "timings.hpp"
+
+#include <cctype>
+#include <condition_variable>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+inline char fold(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+inline bool is_separator(char c) {
+    return c == '/' || c == '\\';
+}
+
+// Matches ch against the class starting at pattern[pos] == '['. Sets end to
+// the index after the closing ']', or npos if the class is unterminated (the
+// '[' is then an ordinary character).
+bool match_class(const std::string& pattern, size_t pos, char ch, bool case_sensitive, size_t& end) {
+    size_t i = pos + 1;
+    bool negate = false;
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+        negate = true;
+        ++i;
+    }
+
+    const char lower = fold(ch);
+    const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    bool matched = false;
+    bool first = true;
+    for (; i < pattern.size(); ++i) {
+        char lo = pattern[i];
+        // A ']' right after the opening bracket is a member, not the terminator
+        if (lo == ']' && !first) {
+            end = i + 1;
+            return matched != negate;
+        }
+        first = false;
+
+        char hi = lo;
+        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+            hi = pattern[i + 2];
+            i += 2;
+        }
+        if (case_sensitive) {
+            matched = matched || (ch >= lo && ch <= hi);
+        } else {
+            matched = matched || (lower >= lo && lower <= hi) || (upper >= lo && upper <= hi);
+        }
+    }
+    end = std::string::npos;
+    return false;
+}
+
+// Single-star backtracking matcher: on a mismatch, retry from the most recent
+// '*' with it consuming one more character. Linear for the usual "*.cpp"
+// shapes and never worse than O(pattern * name).
+bool match_wildcards(const std::string& pattern, const std::string& name, bool case_sensitive) {
+    size_t p = 0;
+    size_t n = 0;
+    size_t star_p = std::string::npos;
+    size_t star_n = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size()) {
+            const char c = pattern[p];
+            if (c == '*') {
+                while (p < pattern.size() && pattern[p] == '*') ++p;
+                star_p = p;
+                star_n = n;
+                continue;
+            }
+            if (c == '?') {
+                ++p;
+                ++n;
+                continue;
+            }
+            if (c == '[') {
+                size_t end = 0;
+                bool in_class = match_class(pattern, p, name[n], case_sensitive, end);
+                if (end != std::string::npos) {
+                    if (in_class) {
+                        p = end;
+                        ++n;
+                        continue;
+                    }
+                } else if (name[n] == '[') {
+                    ++p;
+                    ++n;
+                    continue;
+                }
+            } else if (case_sensitive ? c == name[n] : fold(c) == fold(name[n])) {
+                ++p;
+                ++n;
+                continue;
+            }
+        }
+        if (star_p == std::string::npos) {
+            return false;
+        }
+        p = star_p;
+        n = ++star_n;
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// Index of the '}' closing the brace at pattern[open], or npos
+size_t find_closing_brace(const std::string& pattern, size_t open) {
+    int depth = 0;
+    for (size_t i = open; i < pattern.size(); ++i) {
+        if (pattern[i] == '{') {
+            ++depth;
+        } else if (pattern[i] == '}' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Splits a pattern into path components, skipping empty ones. Separators
+// inside a brace set do not split; has_nested_separator reports them so the
+// caller can brace-expand the whole pattern first.
+std::vector<std::string> split_components(const std::string& pattern, bool& has_nested_separator) {
+    std::vector<std::string> components;
+    std::string current;
+    int depth = 0;
+    has_nested_separator = false;
+    for (char c : pattern) {
+        if (c == '{') {
+            ++depth;
+        } else if (c == '}' && depth > 0) {
+            --depth;
+        }
+        if (is_separator(c)) {
+            if (depth > 0) {
+                has_nested_separator = true;
+            } else {
+                if (!current.empty()) components.push_back(current);
+                current.clear();
+                continue;
+            }
+        }
+        current += c;
+    }
+    if (!current.empty()) components.push_back(current);
+    return components;
+}
+
+struct Component {
+    bool recursive;  // "**"
+    GlobPattern pattern;
+};
+
+// The compiled components of one pattern and the state machine over them.
+// A state is the index of the next component to match; a directory is
+// visited with the set of states that are live inside it.
+class GlobMachine {
+public:
+    explicit GlobMachine(std::vector<Component> components) : components_(std::move(components)) {}
+
+    size_t size() const { return components_.size(); }
+    const Component& operator[](size_t k) const { return components_[k]; }
+
+    // A "**" at state k may also match zero directories, so k + 1 is live too
+    void close_over_recursion(std::vector<size_t>& states) const {
+        std::vector<size_t> closed;
+        for (size_t k : states) {
+            closed.push_back(k);
+            if (components_[k].recursive && k + 1 < components_.size()) {
+                closed.push_back(k + 1);
+            }
+        }
+        std::sort(closed.begin(), closed.end());
+        closed.erase(std::unique(closed.begin(), closed.end()), closed.end());
+        states.swap(closed);
+    }
+
+    // True if every live state is a plain name, so the directory need not be listed
+    bool all_literal(const std::vector<size_t>& states) const {
+        for (size_t k : states) {
+            if (components_[k].recursive || !components_[k].pattern.is_literal()) return false;
+        }
+        return true;
+    }
+
+    // Advances states over one directory entry. Returns true if the entry is a
+    // file matched by the whole pattern; next receives the states to enter a
+    // subdirectory with (empty if it cannot match).
+    bool step(const std::vector<size_t>& states, const DirectoryListing::Entry& entry,
+              std::vector<size_t>& next) const {
+        bool matched = false;
+        next.clear();
+        for (size_t k : states) {
+            const Component& component = components_[k];
+            const bool last = k + 1 == components_.size();
+            if (component.recursive) {
+                if (entry.is_directory && !entry.is_symlink) next.push_back(k);
+                if (last && entry.is_file) matched = true;
+            } else if (component.pattern.matches(entry.name)) {
+                if (last) {
+                    matched = matched || entry.is_file;
+                } else if (entry.is_directory) {
+                    next.push_back(k + 1);
+                }
+            }
+        }
+        return matched;
+    }
+
+private:
+    std::vector<Component> components_;
+};
+
+// Reads every directory the pattern will need into the cache on up to `jobs`
+// threads. Idle workers take the most recently discovered subdirectory from a
+// shared queue, so the tree is fanned out depth-first across workers. The
+// ordered walk that follows then only reads listings from memory.
+void prefetch_listings(const GlobMachine& machine, const fs::path& root, DirectoryCache& cache, int jobs) {
+    struct Task {
+        fs::path dir;
+        std::vector<size_t> states;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Task> queue;
+    size_t active = 0;
+    queue.push_back({root, {0}});
+
+    auto worker = [&]() {
+        std::vector<size_t> next;
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return !queue.empty() || active == 0; });
+                if (queue.empty()) return;
+                task = std::move(queue.back());
+                queue.pop_back();
+                ++active;
+            }
+
+            std::vector<Task> children;
+            machine.close_over_recursion(task.states);
+            if (machine.all_literal(task.states)) {
+                for (size_t k : task.states) {
+                    if (k + 1 < machine.size()) {
+                        children.push_back({task.dir / machine[k].pattern.pattern(), {k + 1}});
+                    }
+                }
+            } else {
+                auto listing = cache.list(task.dir);
+                for (const auto& entry : listing->entries) {
+                    machine.step(task.states, entry, next);
+                    if (!next.empty()) children.push_back({task.dir / entry.name, next});
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& child : children) queue.push_back(std::move(child));
+                --active;
+            }
+            wake.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < jobs; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+class GlobWalker {
+public:
+    GlobWalker(const GlobMachine& machine, const GlobOptions& options, DirectoryCache& cache,
+               std::vector<std::string>& results, std::set<std::string>& seen)
+        : machine_(machine), options_(options), cache_(cache), results_(results), seen_(seen) {}
+
+    void walk(const fs::path& dir, const fs::path& rel, std::vector<size_t> states) {
+        machine_.close_over_recursion(states);
+        if (states.empty()) return;
+
+        // Only literal components remain: look the names up directly instead
+        // of listing the directory
+        if (machine_.all_literal(states)) {
+            for (size_t k : states) {
+                const std::string& name = machine_[k].pattern.pattern();
+                visit(dir / name, rel / name, k);
+            }
+            return;
+        }
+
+        if (options_.on_directory) {
+            options_.on_directory(dir);
+        }
+
+        auto listing = cache_.list(dir);
+        std::vector<size_t> next;
+        for (const auto& entry : listing->entries) {
+            if (machine_.step(states, entry, next)) add(rel / entry.name);
+            if (!next.empty()) walk(dir / entry.name, rel / entry.name, next);
+        }
+    }
+
+private:
+    void visit(const fs::path& path, const fs::path& rel, size_t k) {
+        std::error_code ec;
+        if (k + 1 == machine_.size()) {
+            if (fs::is_regular_file(path, ec)) add(rel);
+        } else if (fs::is_directory(path, ec)) {
+            walk(path, rel, {k + 1});
+        }
+    }
+
+    void add(const fs::path& rel) {
+        std::string path = rel.string();
+        if (seen_.insert(path).second) {
+            results_.push_back(std::move(path));
+        }
+    }
+
+    const GlobMachine& machine_;
+    const GlobOptions& options_;
+    DirectoryCache& cache_;
+    std::vector<std::string>& results_;
+    std::set<std::string>& seen_;
+};
+
+void glob_into(const std::string& pattern, const std::string& base_dir, const GlobOptions& options,
+               DirectoryCache& cache, std::vector<std::string>& results, std::set<std::string>& seen) {
+    bool has_nested_separator = false;
+    std::vector<std::string> parts = split_components(pattern, has_nested_separator);
+    if (has_nested_separator) {
+        for (const auto& alternative : expand_braces(pattern)) {
+            glob_into(alternative, base_dir, options, cache, results, seen);
+        }
+        return;
+    }
+
+    // Absolute patterns are walked from their root; relative ones from base_dir
+    const fs::path pattern_path(pattern);
+    fs::path dir = base_dir.empty() ? fs::path(".") : fs::path(base_dir);
+    fs::path rel;
+    if (pattern_path.has_root_path()) {
+        rel = pattern_path.root_path();
+        dir = rel;
+        // The root name ("C:") is not a component to match
+        if (pattern_path.has_root_name() && !parts.empty() &&
+            parts.front() == pattern_path.root_name().string()) {
+            parts.erase(parts.begin());
+        }
+    }
+
+    std::vector<Component> components;
+    bool recursive = false;
+    for (const auto& part : parts) {
+        const bool is_recursive = part == "**";
+        if (is_recursive && !components.empty() && components.back().recursive) continue;
+        components.push_back({is_recursive, GlobPattern(part, options.case_sensitive)});
+        recursive = recursive || is_recursive;
+    }
+    if (components.empty()) return;
+
+    // Leading literal directories are joined without touching the filesystem
+    size_t first = 0;
+    while (first + 1 < components.size() && !components[first].recursive &&
+           components[first].pattern.is_literal()) {
+        const std::string& name = components[first].pattern.pattern();
+        dir /= name;
+        rel /= name;
+        ++first;
+    }
+    rel = rel.lexically_normal();
+    if (rel == ".") rel.clear();
+
+    GlobMachine machine(std::vector<Component>(std::make_move_iterator(components.begin() + first),
+                                               std::make_move_iterator(components.end())));
+
+    // Only "**" walks fan out far enough to be worth threads
+    const int jobs = options.jobs <= 0 ? default_job_count() : options.jobs;
+    if (recursive && jobs > 1) {
+        prefetch_listings(machine, dir, cache, jobs);
+    }
+
+    GlobWalker walker(machine, options, cache, results, seen);
+    walker.walk(dir, rel, {0});
+}
+
+} // namespace
+
+std::shared_ptr<const DirectoryListing> DirectoryCache::list(const fs::path& dir) {
+    const std::string key = dir.lexically_normal().generic_string();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = listings_.find(key);
+        if (it != listings_.end()) return it->second;
+    }
+
+    // Read outside the lock so workers list different directories concurrently
+    add_timing_counter("directories read");
+    auto listing = std::make_shared<DirectoryListing>();
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    listing->exists = !ec;
+    for (fs::directory_iterator end; !ec && it != end; it.increment(ec)) {
+        std::error_code type_ec;
+        DirectoryListing::Entry entry;
+        entry.name = it->path().filename().string();
+        entry.is_directory = it->is_directory(type_ec);
+        entry.is_file = !entry.is_directory && it->is_regular_file(type_ec);
+        entry.is_symlink = it->is_symlink(type_ec);
+        listing->entries.push_back(std::move(entry));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return listings_.emplace(key, std::move(listing)).first->second;
+}
+
+void DirectoryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listings_.clear();
+}
+
+GlobPattern::GlobPattern(const std::string& pattern, bool case_sensitive)
+    : pattern_(pattern), alternatives_(expand_braces(pattern)), case_sensitive_(case_sensitive) {
+    literal_ = alternatives_.size() == 1 && alternatives_[0].find_first_of("*?[") == std::string::npos;
+}
+
+bool GlobPattern::matches(const std::string& name) const {
+    if (literal_) {
+        const std::string& literal = alternatives_[0];
+        if (literal.size() != name.size()) return false;
+        if (case_sensitive_) return literal == name;
+        for (size_t i = 0; i < name.size(); ++i) {
+            if (fold(literal[i]) != fold(name[i])) return false;
+        }
+        return true;
+    }
+    for (const auto& alternative : alternatives_) {
+        if (match_wildcards(alternative, name, case_sensitive_)) return true;
+    }
+    return false;
+}
+
+bool has_glob_chars(const std::string& path) {
+    return path.find_first_of("*?[{") != std::string::npos;
+}
+
+std::vector<std::string> expand_braces(const std::string& pattern) {
+    for (size_t open = pattern.find('{'); open != std::string::npos; open = pattern.find('{', open + 1)) {
+        const size_t close = find_closing_brace(pattern, open);
+        if (close == std::string::npos) break;
+
+        // Split the set on top-level commas; "{x}" without a comma is literal
+        std::vector<std::string> options;
+        std::string current;
+        int depth = 0;
+        for (size_t i = open + 1; i < close; ++i) {
+            const char c = pattern[i];
+            if (c == '{') ++depth;
+            if (c == '}') --depth;
+            if (c == ',' && depth == 0) {
+                options.push_back(current);
+                current.clear();
+            } else {
+                current += c;
+            }
+        }
+        if (options.empty()) continue;
+        options.push_back(current);
+
+        const std::string prefix = pattern.substr(0, open);
+        const std::string suffix = pattern.substr(close + 1);
+        std::vector<std::string> result;
+        for (const auto& option : options) {
+            for (auto& expanded : expand_braces(prefix + option + suffix)) {
+                result.push_back(std::move(expanded));
+            }
+        }
+        return result;
+    }
+    return {pattern};
+}
+
+std::vector<std::string> glob_files(const std::string& pattern, const std::string& base_dir,
+                                    const GlobOptions& options) {
+    std::vector<std::string> results;
+    std::set<std::string> seen;
+    DirectoryCache local_cache;
+    glob_into(pattern, base_dir, options, options.cache ? *options.cache : local_cache, results, seen);
+    return results;
+}
+
+} // namespace vcxproj
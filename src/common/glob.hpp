@@ -0,0 +1,97 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vcxproj {
+
+// A compiled glob for a single path component. Supports '*' (any run of
+// characters), '?' (one character), character classes ([abc], [a-z], [!a] or
+// [^a]) and brace sets ({cpp,cc,cxx}, nestable). Matching is a linear scan
+// with single-star backtracking; no std::regex is involved. Matches are
+// case-insensitive unless requested otherwise, as source globs have always been.
+class GlobPattern {
+public:
+    explicit GlobPattern(const std::string& pattern, bool case_sensitive = false);
+
+    bool matches(const std::string& name) const;
+
+    // True if the pattern has no wildcard syntax and only matches itself
+    bool is_literal() const { return literal_; }
+
+    const std::string& pattern() const { return pattern_; }
+
+private:
+    std::string pattern_;
+    std::vector<std::string> alternatives_;  // pattern after brace expansion
+    bool case_sensitive_;
+    bool literal_;
+};
+
+// True if the path contains glob syntax (*, ?, [ or {)
+bool has_glob_chars(const std::string& path);
+
+// Expands brace sets: "a.{h,cpp}" -> {"a.h", "a.cpp"}. Unbalanced braces are
+// kept literally.
+std::vector<std::string> expand_braces(const std::string& pattern);
+
+// One directory's entries, in directory_iterator order. A directory that
+// could not be opened has exists == false and no entries.
+struct DirectoryListing {
+    struct Entry {
+        std::string name;
+        bool is_directory = false;  // follows symlinks
+        bool is_file = false;       // regular file, follows symlinks
+        bool is_symlink = false;
+    };
+
+    bool exists = false;
+    std::vector<Entry> entries;
+};
+
+// Directory listings shared by every glob of one parse, so patterns over
+// overlapping trees (src/**/*.cpp and src/**/*.h) read each directory once.
+// Listings are never refreshed; clear the cache between runs. Thread-safe.
+class DirectoryCache {
+public:
+    std::shared_ptr<const DirectoryListing> list(const std::filesystem::path& dir);
+    void clear();
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const DirectoryListing>> listings_;
+};
+
+struct GlobOptions {
+    bool case_sensitive = false;
+    // Listings to reuse across calls; null uses a cache local to the call
+    DirectoryCache* cache = nullptr;
+    // Threads used to read the directories of a "**" pattern before the
+    // ordered walk (<= 0 uses one per core, 1 reads them on the calling thread)
+    int jobs = 1;
+    // Called for every directory the expansion lists, including one that
+    // turns out not to exist (so callers can watch for it being created)
+    std::function<void(const std::filesystem::path&)> on_directory;
+};
+
+// Expands a path pattern against the filesystem and returns the matching
+// regular files. Components are separated by '/' or '\'; a "**" component
+// matches zero or more directories. Leading literal components are resolved
+// without listing anything, each directory is listed at most once, and a
+// subdirectory is only entered when the remaining components can still match
+// inside it. Symlinked directories are not followed by "**". With jobs > 1
+// the directories are read in parallel first; the results are the same.
+//
+// Relative patterns are resolved against base_dir and returned relative to it;
+// absolute patterns return absolute paths. Results keep directory order, with
+// subdirectories expanded where they are encountered (the same order
+// recursive_directory_iterator produces).
+std::vector<std::string> glob_files(const std::string& pattern, const std::string& base_dir,
+                                    const GlobOptions& options = {});
+
+} // namespace vcxproj
@@ -0,0 +1,728 @@
+#include "pch.h"
+#include "native_build.hpp"
+#include "build_trace.hpp"
+#include "output_file.hpp"
+#include "project_types.hpp"
+#include "string_utils.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+// Command hashes and restat times of the outputs built so far, in the build
+// directory next to build.ninja
+constexpr const char* BUILD_LOG_FILENAME = ".sighmake_native_log";
+constexpr const char* BUILD_LOG_HEADER = "# sighmake native build log v1";
+
+constexpr int64_t MISSING = std::numeric_limits<int64_t>::min();
+
+bool is_variable_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+}
+
+std::string trim_left(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    return start == std::string::npos ? "" : value.substr(start);
+}
+
+// Splits a build or default line into words, keeping $ escapes for
+// expansion. An unescaped ':' is a word of its own.
+std::vector<std::string> split_ninja_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    auto flush = [&]() {
+        if (!word.empty()) words.push_back(std::move(word));
+        word.clear();
+    };
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '$' && i + 1 < text.size()) {
+            word += c;
+            word += text[++i];
+        } else if (c == ' ' || c == '\t') {
+            flush();
+        } else if (c == ':') {
+            flush();
+            words.push_back(":");
+        } else {
+            word += c;
+        }
+    }
+    flush();
+    return words;
+}
+
+int64_t stat_time(const fs::path& path) {
+    std::error_code ec;
+    const auto time = fs::last_write_time(path, ec);
+    return ec ? MISSING : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Modification times shared by all workers; a header included by hundreds
+// of translation units is stat()ed once per build
+class StatCache {
+public:
+    explicit StatCache(fs::path dir) : dir_(std::move(dir)) {}
+
+    int64_t mtime(const std::string& path) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = times_.find(path);
+            if (it != times_.end()) return it->second;
+        }
+        const int64_t time = stat_time(dir_ / path);
+        std::lock_guard<std::mutex> lock(mutex_);
+        times_[path] = time;
+        return time;
+    }
+
+    void forget(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        times_.erase(path);
+    }
+
+private:
+    fs::path dir_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, int64_t> times_;
+};
+
+struct LogEntry {
+    uint64_t command_hash = 0;
+    int64_t restat_time = MISSING;  // Newest input when the output was last built
+};
+
+std::unordered_map<std::string, LogEntry> load_build_log(const fs::path& path) {
+    std::unordered_map<std::string, LogEntry> log;
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line) || line != BUILD_LOG_HEADER) {
+        return log;  // Missing or from another version: everything rebuilds once
+    }
+    while (std::getline(in, line)) {
+        size_t first = line.find('\t');
+        size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+        if (second == std::string::npos) continue;
+        try {
+            LogEntry entry;
+            entry.command_hash = std::stoull(line.substr(0, first), nullptr, 16);
+            entry.restat_time = std::stoll(line.substr(first + 1, second - first - 1));
+            log[line.substr(second + 1)] = entry;
+        } catch (const std::exception&) {
+        }
+    }
+    return log;
+}
+
+bool save_build_log(const fs::path& path, const std::unordered_map<std::string, LogEntry>& log) {
+    std::map<std::string, LogEntry> sorted(log.begin(), log.end());
+    OutputFile out(path);
+    out << BUILD_LOG_HEADER << "\n";
+    for (const auto& [output, entry] : sorted) {
+        out << std::hex << entry.command_hash << std::dec << "\t" << entry.restat_time << "\t" << output << "\n";
+    }
+    return out.commit();
+}
+
+#ifndef _WIN32
+// Runs command in dir with stdout and stderr captured together
+int run_captured(const fs::path& dir, const std::string& command, std::string& output) {
+    const std::string wrapped = "cd " + shell_quote(dir.string()) + " && (" + command + ") 2>&1";
+    FILE* pipe = ::popen(wrapped.c_str(), "r");
+    if (!pipe) {
+        output = "failed to start /bin/sh\n";
+        return 127;
+    }
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, read);
+    }
+    const int status = ::pclose(pipe);
+    if (status == -1) return 127;
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return status;
+}
+#endif
+
+} // namespace
+
+NinjaManifest NinjaManifest::parse(const std::string& text, const std::string& filename) {
+    NinjaManifest manifest;
+
+    // Logical lines: "$\n" continues a line and drops the next line's indent
+    std::vector<std::pair<size_t, std::string>> lines;
+    {
+        std::string current;
+        size_t line_number = 1;
+        size_t start = 1;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            if (c == '$' && i + 1 < text.size()) {
+                size_t next = i + 1;
+                if (text[next] == '\r' && next + 1 < text.size() && text[next + 1] == '\n') ++next;
+                if (text[next] == '\n') {
+                    ++line_number;
+                    i = next;
+                    while (i + 1 < text.size() && text[i + 1] == ' ') ++i;
+                    continue;
+                }
+                current += c;
+                current += text[++i];
+                continue;
+            }
+            if (c == '\n') {
+                if (!current.empty() && current.back() == '\r') current.pop_back();
+                lines.push_back({start, std::move(current)});
+                current.clear();
+                start = ++line_number;
+                continue;
+            }
+            current += c;
+        }
+        if (!current.empty()) lines.push_back({start, std::move(current)});
+    }
+
+    auto fail = [&](size_t line, const std::string& message) {
+        throw std::runtime_error(filename + ":" + std::to_string(line) + ": " + message);
+    };
+
+    enum class Block { None, Rule, Build };
+    Block block = Block::None;
+    NinjaRule* rule = nullptr;
+
+    for (const auto& [line_number, line] : lines) {
+        const std::string content = trim_left(line);
+        if (content.empty() || content[0] == '#') continue;
+
+        const size_t equals = content.find('=');
+        if (line[0] == ' ' || line[0] == '\t') {
+            if (block == Block::None || equals == std::string::npos) {
+                fail(line_number, "unexpected indented line");
+            }
+            std::string key = trim(content.substr(0, equals));
+            std::string value = trim_left(content.substr(equals + 1));
+            if (block == Block::Rule) {
+                rule->bindings[key] = value;
+            } else {
+                manifest.edges_.back().bindings[key] = value;
+            }
+            continue;
+        }
+
+        block = Block::None;
+        const std::string keyword = content.substr(0, content.find_first_of(" \t"));
+        const std::string rest = trim_left(content.substr(keyword.size()));
+
+        if (keyword == "rule") {
+            rule = &manifest.rules_[trim(rest)];
+            block = Block::Rule;
+        } else if (keyword == "build") {
+            std::vector<std::string> words = split_ninja_words(rest);
+            auto colon = std::find(words.begin(), words.end(), ":");
+            if (colon == words.end() || colon + 1 == words.end()) {
+                fail(line_number, "expected 'build <outputs>: <rule> <inputs>'");
+            }
+
+            NinjaEdge edge;
+            for (auto it = words.begin(); it != colon; ++it) {
+                if (*it != "|") edge.outputs.push_back(manifest.expand(*it, nullptr, 0));
+            }
+            edge.rule = *(colon + 1);
+            if (edge.rule != "phony" && !manifest.rules_.count(edge.rule)) {
+                fail(line_number, "unknown rule '" + edge.rule + "'");
+            }
+
+            enum { Explicit, Implicit, OrderOnly } section = Explicit;
+            for (auto it = colon + 2; it != words.end(); ++it) {
+                if (*it == "|" && section == Explicit) {
+                    section = Implicit;
+                    edge.implicit_begin = edge.inputs.size();
+                } else if (*it == "||") {
+                    if (section == Explicit) edge.implicit_begin = edge.inputs.size();
+                    section = OrderOnly;
+                    edge.order_only_begin = edge.inputs.size();
+                } else {
+                    edge.inputs.push_back(manifest.expand(*it, nullptr, 0));
+                }
+            }
+            if (section == Explicit) edge.implicit_begin = edge.inputs.size();
+            if (section != OrderOnly) edge.order_only_begin = edge.inputs.size();
+
+            for (const auto& output : edge.outputs) {
+                if (!manifest.producers_.emplace(output, manifest.edges_.size()).second) {
+                    fail(line_number, "multiple rules generate " + output);
+                }
+            }
+            manifest.edges_.push_back(std::move(edge));
+            block = Block::Build;
+        } else if (keyword == "default") {
+            for (const auto& word : split_ninja_words(rest)) {
+                manifest.defaults_.push_back(manifest.expand(word, nullptr, 0));
+            }
+        } else if (keyword == "include" || keyword == "subninja" || keyword == "pool") {
+            fail(line_number, "'" + keyword + "' is not supported by the native executor");
+        } else if (equals != std::string::npos) {
+            manifest.variables_[trim(content.substr(0, equals))] =
+                manifest.expand(trim_left(content.substr(equals + 1)), nullptr, 0);
+        } else {
+            fail(line_number, "unexpected '" + keyword + "'");
+        }
+    }
+
+    return manifest;
+}
+
+NinjaManifest NinjaManifest::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return parse(buffer.str(), path);
+}
+
+size_t NinjaManifest::producer(const std::string& path) const {
+    auto it = producers_.find(path);
+    return it == producers_.end() ? npos : it->second;
+}
+
+std::string NinjaManifest::evaluate(const NinjaEdge& edge, const std::string& name) const {
+    return lookup(name, &edge, 0);
+}
+
+std::string NinjaManifest::lookup(const std::string& name, const NinjaEdge* edge, int depth) const {
+    if (depth > 32) {
+        throw std::runtime_error("variable '" + name + "' refers to itself");
+    }
+    if (edge) {
+        if (name == "in" || name == "out") {
+            const bool in = name == "in";
+            const size_t count = in ? edge->implicit_begin : edge->outputs.size();
+            std::string result;
+            for (size_t i = 0; i < count; ++i) {
+                if (i > 0) result += ' ';
+                result += shell_quote(in ? edge->inputs[i] : edge->outputs[i]);
+            }
+            return result;
+        }
+        auto binding = edge->bindings.find(name);
+        if (binding != edge->bindings.end()) {
+            return expand(binding->second, edge, depth + 1);
+        }
+        auto rule = rules_.find(edge->rule);
+        if (rule != rules_.end()) {
+            auto rule_binding = rule->second.bindings.find(name);
+            if (rule_binding != rule->second.bindings.end()) {
+                return expand(rule_binding->second, edge, depth + 1);
+            }
+        }
+    }
+    auto variable = variables_.find(name);
+    return variable == variables_.end() ? "" : variable->second;
+}
+
+std::string NinjaManifest::expand(const std::string& raw, const NinjaEdge* edge, int depth) const {
+    std::string result;
+    result.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '$' || i + 1 == raw.size()) {
+            result += raw[i];
+            continue;
+        }
+        const char next = raw[++i];
+        if (next == '{') {
+            const size_t close = raw.find('}', i);
+            if (close == std::string::npos) {
+                result += raw.substr(i - 1);
+                break;
+            }
+            result += lookup(raw.substr(i + 1, close - i - 1), edge, depth);
+            i = close;
+        } else if (is_variable_char(next)) {
+            size_t end = i;
+            while (end < raw.size() && is_variable_char(raw[end])) ++end;
+            result += lookup(raw.substr(i, end - i), edge, depth);
+            i = end - 1;
+        } else {
+            result += next;  // $$, "$ " and "$:"
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> read_depfile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return {};
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+
+    // The first rule runs to the first newline that is not escaped
+    std::vector<std::string> words;
+    std::string word;
+    bool seen_colon = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            const char next = text[i + 1];
+            if (next == '\n' || (next == '\r' && i + 2 < text.size() && text[i + 2] == '\n')) {
+                i += next == '\r' ? 2 : 1;
+                if (!word.empty()) words.push_back(std::move(word));
+                word.clear();
+                continue;
+            }
+            if (next == ' ' || next == '#' || next == '\\') {
+                word += next;
+                ++i;
+                continue;
+            }
+        }
+        if (c == '$' && i + 1 < text.size() && text[i + 1] == '$') {
+            word += '$';
+            ++i;
+            continue;
+        }
+        if (c == '\n' || c == '\r') {
+            if (seen_colon) break;
+            continue;
+        }
+        // The target ends at a colon followed by whitespace or the end of the
+        // line, which leaves drive letters (C:\...) alone
+        if (!seen_colon && c == ':' &&
+            (i + 1 == text.size() || text[i + 1] == ' ' || text[i + 1] == '\t' ||
+             text[i + 1] == '\n' || text[i + 1] == '\r')) {
+            seen_colon = true;
+            word.clear();
+            words.clear();
+            continue;
+        }
+        if (c == ' ' || c == '\t') {
+            if (!word.empty()) words.push_back(std::move(word));
+            word.clear();
+            continue;
+        }
+        word += c;
+    }
+    if (!word.empty()) words.push_back(std::move(word));
+    return seen_colon ? words : std::vector<std::string>{};
+}
+
+int run_native_build(const std::string& build_dir, const std::vector<std::string>& targets,
+                     const NativeBuildOptions& options) {
+    std::ostream& out = *options.out;
+    std::ostream& err = *options.err;
+#ifdef _WIN32
+    (void)build_dir;
+    (void)targets;
+    err << "Error: The native executor is not supported on Windows.\n";
+    return 1;
+#else
+    const fs::path dir(build_dir);
+    NinjaManifest manifest;
+    try {
+        manifest = NinjaManifest::load((dir / "build.ninja").string());
+    } catch (const std::exception& e) {
+        err << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    const auto& edges = manifest.edges();
+    const fs::path log_path = dir / BUILD_LOG_FILENAME;
+
+    if (options.clean_only || options.clean_first) {
+        size_t removed = 0;
+        std::error_code ec;
+        for (const auto& edge : edges) {
+            if (edge.rule == "phony") continue;
+            std::vector<std::string> files = edge.outputs;
+            const std::string depfile = manifest.evaluate(edge, "depfile");
+            if (!depfile.empty()) files.push_back(depfile);
+            for (const auto& file : files) {
+                if (fs::remove(dir / file, ec)) ++removed;
+            }
+        }
+        fs::remove(log_path, ec);
+        out << "Cleaning... " << removed << " files.\n";
+        if (options.clean_only) return 0;
+    }
+
+    // Edges the targets need, dependencies first; a cycle is an error
+    std::vector<std::string> roots = targets.empty() ? manifest.defaults() : targets;
+    if (roots.empty()) {
+        for (const auto& edge : edges) {
+            roots.insert(roots.end(), edge.outputs.begin(), edge.outputs.end());
+        }
+    }
+    std::vector<char> state(edges.size(), 0);  // 0 = unseen, 1 = on the stack, 2 = done
+    std::vector<size_t> needed;
+    for (const auto& root : roots) {
+        const size_t root_edge = manifest.producer(root);
+        if (root_edge == NinjaManifest::npos) {
+            if (stat_time(dir / root) == MISSING) {
+                err << "Error: Unknown target '" << root << "'\n";
+                return 1;
+            }
+            continue;
+        }
+        std::vector<std::pair<size_t, size_t>> stack{{root_edge, 0}};  // (edge, next input)
+        while (!stack.empty()) {
+            auto& [edge_index, next] = stack.back();
+            if (next == 0) {
+                if (state[edge_index] == 2) {
+                    stack.pop_back();
+                    continue;
+                }
+                state[edge_index] = 1;
+            }
+            const auto& inputs = edges[edge_index].inputs;
+            if (next < inputs.size()) {
+                const size_t child = manifest.producer(inputs[next++]);
+                if (child == NinjaManifest::npos || state[child] == 2) continue;
+                if (state[child] == 1) {
+                    err << "Error: Dependency cycle through '" << edges[child].outputs.front() << "'\n";
+                    return 1;
+                }
+                stack.push_back({child, 0});
+                continue;
+            }
+            state[edge_index] = 2;
+            needed.push_back(edge_index);
+            stack.pop_back();
+        }
+    }
+
+    // Each edge waits for the distinct edges producing its inputs
+    std::vector<std::atomic<size_t>> pending(edges.size());
+    std::vector<std::vector<size_t>> dependents(edges.size());
+    size_t total = 0;
+    for (size_t e : needed) {
+        std::set<size_t> producers;
+        for (const auto& input : edges[e].inputs) {
+            const size_t producer = manifest.producer(input);
+            if (producer != NinjaManifest::npos) producers.insert(producer);
+        }
+        pending[e].store(producers.size());
+        for (size_t producer : producers) dependents[producer].push_back(e);
+        if (edges[e].rule != "phony") ++total;
+    }
+
+    StatCache stats(dir);
+    std::unordered_map<std::string, LogEntry> log = load_build_log(log_path);
+    std::mutex log_mutex;
+    std::mutex print_mutex;
+    std::vector<TraceEvent> trace;
+    std::vector<int64_t> phony_time(edges.size(), MISSING);
+    std::atomic<bool> failed{false};
+    std::atomic<size_t> finished{0};
+    std::atomic<size_t> commands{0};
+
+    // Time an input counts with, or false with an error for a missing source
+    auto input_time = [&](const std::string& input, int64_t& time, bool& dirty, std::string& error) {
+        const size_t producer = manifest.producer(input);
+        if (producer != NinjaManifest::npos && edges[producer].rule == "phony") {
+            time = phony_time[producer];
+            if (time == MISSING) time = stats.mtime(input);
+            if (time == MISSING) dirty = true;
+            return;
+        }
+        time = stats.mtime(input);
+        if (time != MISSING) return;
+        if (producer != NinjaManifest::npos) {
+            dirty = true;  // Built this run without leaving a file (build events)
+        } else {
+            error = "'" + input + "' is missing and no rule builds it";
+        }
+    };
+
+    std::optional<ObjectCache> object_cache;
+    if (!options.cache_dir.empty()) {
+        object_cache.emplace(options.cache_dir, options.cache_size);
+    }
+
+    WorkStealingPool pool(options.jobs);
+    std::function<void(size_t)> process = [&](size_t e) {
+        if (failed.load()) return;
+        const NinjaEdge& edge = edges[e];
+
+        if (edge.rule == "phony") {
+            int64_t newest = MISSING;
+            for (size_t i = 0; i < edge.order_only_begin; ++i) {
+                int64_t time = MISSING;
+                bool dirty = false;
+                std::string error;
+                input_time(edge.inputs[i], time, dirty, error);
+                newest = std::max(newest, time);
+            }
+            phony_time[e] = newest;
+        } else {
+            const std::string command = manifest.evaluate(edge, "command");
+            const uint64_t command_hash = fnv1a64(command);
+
+            // Up to date unless an output is missing or older than an input
+            // (including depfile headers) or the command changed
+            bool dirty = false;
+            std::string error;
+            int64_t oldest_output = std::numeric_limits<int64_t>::max();
+            for (const auto& output : edge.outputs) {
+                oldest_output = std::min(oldest_output, stats.mtime(output));
+            }
+            if (oldest_output == MISSING) dirty = true;
+
+            LogEntry logged;
+            bool have_log = false;
+            {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                auto it = log.find(edge.outputs.front());
+                if (it != log.end()) {
+                    logged = it->second;
+                    have_log = true;
+                }
+            }
+            if (!have_log || logged.command_hash != command_hash) dirty = true;
+
+            // restat edges (archives) may leave an unchanged output untouched;
+            // the log remembers which inputs that build already covered
+            int64_t output_time = oldest_output;
+            if (!manifest.evaluate(edge, "restat").empty() && have_log) {
+                output_time = std::max(output_time, logged.restat_time);
+            }
+
+            int64_t newest_input = MISSING;
+            for (size_t i = 0; i < edge.order_only_begin && error.empty(); ++i) {
+                int64_t time = MISSING;
+                input_time(edge.inputs[i], time, dirty, error);
+                newest_input = std::max(newest_input, time);
+            }
+            if (!error.empty()) {
+                std::lock_guard<std::mutex> lock(print_mutex);
+                err << "Error: " << error << ", needed by '" << edge.outputs.front() << "'\n";
+                failed.store(true);
+                return;
+            }
+
+            const std::string depfile = manifest.evaluate(edge, "depfile");
+            if (!depfile.empty()) {
+                if (stats.mtime(depfile) == MISSING) {
+                    dirty = true;
+                } else {
+                    for (const auto& dependency : read_depfile((dir / depfile).string())) {
+                        const int64_t time = stats.mtime(dependency);
+                        if (time == MISSING) dirty = true;
+                        newest_input = std::max(newest_input, time);
+                    }
+                }
+            }
+            if (newest_input > output_time) dirty = true;
+
+            if (dirty) {
+                std::error_code ec;
+                for (const auto& output : edge.outputs) {
+                    fs::create_directories((dir / output).parent_path(), ec);
+                }
+
+                std::string captured;
+                const int64_t start = now_us();
+                int exit_code = 0;
+                std::optional<CacheableCompile> cacheable;
+                if (object_cache) cacheable = parse_cacheable_compile(command);
+                if (cacheable) {
+                    exit_code = object_cache->compile(*cacheable, dir.string(), captured);
+                } else {
+                    if (object_cache && classify_trace_command(command).kind == "compile") {
+                        object_cache->record_uncacheable();
+                    }
+                    exit_code = run_captured(dir, command, captured);
+                }
+                const int64_t end = now_us();
+                for (const auto& output : edge.outputs) stats.forget(output);
+                if (!depfile.empty()) stats.forget(depfile);
+                commands.fetch_add(1);
+
+                std::string description = manifest.evaluate(edge, "description");
+                if (description.empty()) description = command;
+
+                {
+                    std::lock_guard<std::mutex> lock(print_mutex);
+                    out << "[" << ++finished << "/" << total << "] " << description << "\n";
+                    if (exit_code != 0) {
+                        out << "FAILED:";
+                        for (const auto& output : edge.outputs) out << " " << output;
+                        out << "\n" << command << "\n";
+                    }
+                    out << captured;
+                    if (!captured.empty() && captured.back() != '\n') out << "\n";
+                    out.flush();
+                    if (!options.trace_file.empty()) {
+                        trace.push_back({command, start, end, exit_code});
+                    }
+                }
+
+                if (exit_code != 0) {
+                    failed.store(true);
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(log_mutex);
+                for (const auto& output : edge.outputs) {
+                    log[output] = {command_hash, newest_input};
+                }
+            } else {
+                finished.fetch_add(1);
+            }
+        }
+
+        for (size_t dependent : dependents[e]) {
+            if (pending[dependent].fetch_sub(1) == 1) {
+                pool.submit([&process, dependent] { process(dependent); });
+            }
+        }
+    };
+
+    for (size_t e : needed) {
+        if (pending[e].load() == 0) {
+            pool.submit([&process, e] { process(e); });
+        }
+    }
+    pool.wait();
+
+    if (!save_build_log(log_path, log)) {
+        err << "Warning: Could not write " << log_path.string() << "\n";
+    }
+    if (!options.trace_file.empty()) {
+        if (write_build_trace(trace, options.trace_file)) {
+            out << "Build trace written to " << options.trace_file << "\n";
+        }
+        write_build_trace_summary(trace, out);
+    }
+
+    if (failed.load()) {
+        err << "Build failed.\n";
+        return 1;
+    }
+    if (commands.load() == 0) {
+        out << "native: no work to do.\n";
+    }
+    return 0;
+#endif
+}
+
+} // namespace vcxproj
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "object_cache.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vcxproj {
+
+// In-process executor for `--build --executor native`. It reads the
+// build.ninja written by the ninja generator and runs its commands itself, so
+// building needs neither make nor ninja.
+//
+// Supported manifest syntax is what NinjaGenerator emits: top-level
+// variables, rules, build statements with implicit (|) and order-only (||)
+// inputs, phony, default, line continuations and $ escapes. include,
+// subninja and pool are rejected.
+
+struct NinjaEdge {
+    std::string rule;                       // "phony" for phony edges
+    std::vector<std::string> outputs;
+    std::vector<std::string> inputs;        // explicit, then implicit, then order-only
+    size_t implicit_begin = 0;              // First implicit input
+    size_t order_only_begin = 0;            // First order-only input
+    std::map<std::string, std::string> bindings;  // Unevaluated edge variables
+};
+
+struct NinjaRule {
+    std::map<std::string, std::string> bindings;  // Unevaluated rule variables
+};
+
+class NinjaManifest {
+public:
+    // Throws std::runtime_error with file:line on syntax it does not support
+    static NinjaManifest parse(const std::string& text, const std::string& filename = "build.ninja");
+    static NinjaManifest load(const std::string& path);
+
+    const std::vector<NinjaEdge>& edges() const { return edges_; }
+    const std::vector<std::string>& defaults() const { return defaults_; }
+
+    // Index of the edge producing path, or npos
+    size_t producer(const std::string& path) const;
+
+    // Value of a rule variable (command, depfile, description, restat, ...)
+    // for one edge: $in, $out and the edge's own variables shadow the rule's,
+    // which shadow the top-level ones
+    std::string evaluate(const NinjaEdge& edge, const std::string& name) const;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    std::string expand(const std::string& raw, const NinjaEdge* edge, int depth) const;
+    std::string lookup(const std::string& name, const NinjaEdge* edge, int depth) const;
+
+    std::map<std::string, std::string> variables_;  // Top-level, already evaluated
+    std::map<std::string, NinjaRule> rules_;
+    std::vector<NinjaEdge> edges_;
+    std::map<std::string, size_t> producers_;
+    std::vector<std::string> defaults_;
+};
+
+// Inputs listed for the first target of a gcc -MMD depfile (with or without
+// -MP), or nothing if the file cannot be read
+std::vector<std::string> read_depfile(const std::string& path);
+
+struct NativeBuildOptions {
+    int jobs = 0;                 // -j (0 = one per core)
+    bool clean_only = false;      // Remove every output instead of building
+    bool clean_first = false;     // Remove every output, then build
+    std::string trace_file;       // Chrome trace of the commands that ran (optional)
+    std::string cache_dir;        // Object cache for compile commands (optional)
+    uint64_t cache_size = DEFAULT_CACHE_SIZE;
+    std::ostream* out = &std::cout;
+    std::ostream* err = &std::cerr;
+};
+
+// Builds targets (the manifest's defaults if empty) from build_dir/build.ninja.
+// Commands run with build_dir as the working directory; each one's output is
+// captured and printed in one piece after it finishes. Stops starting new
+// commands after the first failure. Returns 0 on success.
+int run_native_build(const std::string& build_dir, const std::vector<std::string>& targets,
+                     const NativeBuildOptions& options);
+
+} // namespace vcxproj
@@ -0,0 +1,578 @@
+#include "pch.h"
+#include "object_cache.hpp"
+#include "build_trace.hpp"
+#include "sha256.hpp"
+#include "string_utils.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+constexpr const char* KEY_VERSION = "sighmake object cache v1";
+constexpr const char* STATS_FILENAME = "stats";
+constexpr const char* LOCK_FILENAME = "lock";
+
+// Options whose value is the next word
+const std::set<std::string> OPTIONS_WITH_VALUE = {
+    "-o", "-MF", "-MT", "-MQ", "-I", "-D", "-U", "-include", "-imacros", "-isystem", "-iquote",
+    "-idirafter", "-isysroot", "-x", "-Xclang", "-Xpreprocessor", "-Xassembler", "-arch", "-target",
+    "-aux-info",
+};
+
+// Options that write something besides the object or change what -E sees
+bool is_uncacheable_option(const std::string& word) {
+    static const std::set<std::string> exact = {
+        "-E", "-S", "-M", "-MM", "-", "--coverage", "-ftest-coverage", "-fprofile-arcs",
+        "-gsplit-dwarf", "-MJ",
+    };
+    return exact.count(word) > 0 || word.rfind("-save-temps", 0) == 0 ||
+           word.rfind("-ftime-trace", 0) == 0 || word.rfind("-fdump-", 0) == 0;
+}
+
+// Splits a /bin/sh command into words, undoing quotes and backslashes, or
+// nullopt if it uses any other shell syntax
+std::optional<std::vector<std::string>> split_shell_words(const std::string& command) {
+    static const std::string special = ";&|<>()$`*?[#~!\n";
+    std::vector<std::string> words;
+    std::string word;
+    bool in_word = false;
+    for (size_t i = 0; i < command.size(); ++i) {
+        const char c = command[i];
+        if (c == ' ' || c == '\t') {
+            if (in_word) words.push_back(word);
+            word.clear();
+            in_word = false;
+        } else if (c == '\'') {
+            const size_t end = command.find('\'', i + 1);
+            if (end == std::string::npos) return std::nullopt;
+            word += command.substr(i + 1, end - i - 1);
+            in_word = true;
+            i = end;
+        } else if (c == '"') {
+            in_word = true;
+            for (++i; i < command.size() && command[i] != '"'; ++i) {
+                if (command[i] == '$' || command[i] == '`') return std::nullopt;
+                if (command[i] == '\\' && i + 1 < command.size() &&
+                    std::string("\"\\$`").find(command[i + 1]) != std::string::npos) {
+                    ++i;
+                }
+                word += command[i];
+            }
+            if (i == command.size()) return std::nullopt;
+        } else if (c == '\\') {
+            if (i + 1 == command.size() || command[i + 1] == '\n') return std::nullopt;
+            word += command[++i];
+            in_word = true;
+        } else if (special.find(c) != std::string::npos) {
+            return std::nullopt;
+        } else {
+            word += c;
+            in_word = true;
+        }
+    }
+    if (in_word) words.push_back(word);
+    return words;
+}
+
+std::string join_shell_words(const std::vector<std::string>& words) {
+    std::string command;
+    for (const auto& word : words) {
+        if (!command.empty()) command += ' ';
+        command += shell_quote(word);
+    }
+    return command;
+}
+
+std::string read_file(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Size and mtime stand in for the contents of large inputs such as the
+// compiler binary or a precompiled header
+std::string file_stamp(const fs::path& path) {
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return "missing";
+    const auto time = fs::last_write_time(path, ec);
+    return std::to_string(size) + ":" + std::to_string(time.time_since_epoch().count());
+}
+
+fs::path find_program(const std::string& program, const fs::path& working_dir) {
+    if (program.find('/') != std::string::npos) {
+        return working_dir / program;
+    }
+    const char* path = std::getenv("PATH");
+    std::istringstream dirs(path ? path : "");
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        std::error_code ec;
+        const fs::path candidate = fs::path(dir.empty() ? "." : dir) / program;
+        if (fs::is_regular_file(candidate, ec)) return candidate;
+    }
+    return program;
+}
+
+// Depfile target as gcc writes it
+std::string escape_depfile_target(const std::string& path) {
+    std::string result;
+    for (char c : path) {
+        if (c == ' ' || c == '#') result += '\\';
+        if (c == '$') result += '$';
+        result += c;
+    }
+    return result;
+}
+
+// The depfile minus its first target, so a hit can name its own object
+std::optional<std::string> depfile_body(const std::string& text) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\\') {
+            ++i;
+        } else if (text[i] == ':' && (i + 1 == text.size() || std::isspace(static_cast<unsigned char>(text[i + 1])))) {
+            return text.substr(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::string format_bytes(uint64_t bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024.0 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+        value /= 1024.0;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << value << " " << units[unit];
+    return out.str();
+}
+
+ObjectCacheStats read_stats(const fs::path& path) {
+    ObjectCacheStats stats;
+    std::ifstream in(path);
+    std::string name;
+    uint64_t value = 0;
+    while (in >> name >> value) {
+        if (name == "hits") stats.hits = value;
+        else if (name == "misses") stats.misses = value;
+        else if (name == "uncacheable") stats.uncacheable = value;
+        else if (name == "evictions") stats.evictions = value;
+        else if (name == "bytes") stats.bytes = value;
+    }
+    return stats;
+}
+
+void write_stats(const fs::path& path, const ObjectCacheStats& stats) {
+    const fs::path temp = path.string() + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << "hits " << stats.hits << "\n"
+            << "misses " << stats.misses << "\n"
+            << "uncacheable " << stats.uncacheable << "\n"
+            << "evictions " << stats.evictions << "\n"
+            << "bytes " << stats.bytes << "\n";
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+}
+
+// Name for a temporary file no other thread or process picks
+std::string unique_suffix() {
+    std::ostringstream out;
+#ifndef _WIN32
+    out << ".tmp." << ::getpid() << "." << std::this_thread::get_id();
+#else
+    out << ".tmp." << std::this_thread::get_id();
+#endif
+    return out.str();
+}
+
+// Copies from to to through a temporary, so readers never see half a file,
+// and stamps it with the current time
+bool copy_atomically(const fs::path& from, const fs::path& to) {
+    std::error_code ec;
+    const fs::path temp = to.string() + unique_suffix();
+    fs::copy_file(from, temp, fs::copy_options::overwrite_existing, ec);
+    if (!ec) fs::last_write_time(temp, fs::file_time_type::clock::now(), ec);
+    if (!ec) fs::rename(temp, to, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+int decode_status(int status) {
+    if (status == -1) return 127;
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return status;
+}
+
+// Runs command in dir, appending its stdout (and stderr if merge_stderr,
+// otherwise stderr is discarded) to output
+int run_captured(const std::string& dir, const std::string& command, bool merge_stderr, std::string& output) {
+    const std::string wrapped = "cd " + shell_quote(dir.empty() ? "." : dir) + " && (" + command + ") " +
+                                (merge_stderr ? "2>&1" : "2>/dev/null");
+    FILE* pipe = ::popen(wrapped.c_str(), "r");
+    if (!pipe) {
+        output += "failed to start /bin/sh\n";
+        return 127;
+    }
+    char buffer[65536];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, read);
+    }
+    return decode_status(::pclose(pipe));
+}
+
+// Exclusive lock on the cache's lock file, shared by threads and processes
+class CacheLock {
+public:
+    explicit CacheLock(const fs::path& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ >= 0) ::flock(fd_, LOCK_EX);
+    }
+    ~CacheLock() {
+        if (fd_ >= 0) {
+            ::flock(fd_, LOCK_UN);
+            ::close(fd_);
+        }
+    }
+    CacheLock(const CacheLock&) = delete;
+    CacheLock& operator=(const CacheLock&) = delete;
+
+private:
+    int fd_ = -1;
+};
+#endif
+
+} // namespace
+
+std::optional<CacheableCompile> parse_cacheable_compile(const std::string& command) {
+    auto words = split_shell_words(command);
+    if (!words || words->empty()) return std::nullopt;
+    if (classify_trace_command(command).kind != "compile") return std::nullopt;
+    if (fs::path((*words)[0]).filename().string().find("nasm") != std::string::npos) return std::nullopt;
+
+    CacheableCompile compile;
+    bool compiles = false;
+    bool wants_depfile = false;
+    std::vector<std::string> sources;
+    for (size_t i = 1; i < words->size(); ++i) {
+        const std::string& word = (*words)[i];
+        if (is_uncacheable_option(word)) return std::nullopt;
+        if (word == "-c") {
+            compiles = true;
+        } else if (word == "-MD" || word == "-MMD") {
+            wants_depfile = true;
+        } else if (OPTIONS_WITH_VALUE.count(word)) {
+            if (i + 1 == words->size()) return std::nullopt;
+            const std::string& value = (*words)[++i];
+            if (word == "-o") compile.output = value;
+            else if (word == "-MF") compile.depfile = value;
+            else if (word == "-x" && value.size() > 7 && value.compare(value.size() - 7, 7, "-header") == 0) {
+                return std::nullopt;  // Precompiled header
+            }
+        } else if (word[0] != '-') {
+            sources.push_back(word);
+        }
+    }
+    if (!compiles || compile.output.empty() || sources.size() != 1) return std::nullopt;
+
+    compile.source = sources.front();
+    if (!wants_depfile) {
+        compile.depfile.clear();
+    } else if (compile.depfile.empty()) {
+        compile.depfile = fs::path(compile.output).replace_extension(".d").string();
+    }
+    compile.words = std::move(*words);
+    return compile;
+}
+
+ObjectCache::ObjectCache(std::string directory, uint64_t max_bytes)
+    : directory_(std::move(directory)), max_bytes_(max_bytes) {}
+
+int ObjectCache::compile(const CacheableCompile& compile, const std::string& working_dir, std::string& output) {
+#ifdef _WIN32
+    record_uncacheable();
+    const int status = std::system(join_shell_words(compile.words).c_str());
+    (void)working_dir;
+    (void)output;
+    return status;
+#else
+    const fs::path work = working_dir.empty() ? fs::path(".") : fs::path(working_dir);
+    const std::string command = join_shell_words(compile.words);
+
+    // The preprocessor sees the same flags minus the outputs
+    std::vector<std::string> preprocess;
+    std::string key_text = KEY_VERSION;
+    key_text += "\n" + find_program(compile.words[0], work).string() + " " +
+                file_stamp(find_program(compile.words[0], work)) + "\n";
+    bool debug_info = false;
+    for (size_t i = 0; i < compile.words.size(); ++i) {
+        const std::string& word = compile.words[i];
+        if (word == "-o" || word == "-MF" || word == "-MT" || word == "-MQ") {
+            key_text += word + " <path>\n";
+            ++i;
+            continue;
+        }
+        key_text += word + "\n";
+        if (word.rfind("-g", 0) == 0 && word != "-g0") debug_info = true;
+        if (word != "-c" && word != "-MD" && word != "-MMD" && word != "-MP") preprocess.push_back(word);
+    }
+    preprocess.push_back("-E");
+    if (debug_info) {
+        // Debug info records the compilation directory
+        std::error_code ec;
+        key_text += "cwd " + fs::absolute(work, ec).lexically_normal().string() + "\n";
+    }
+
+    std::string preprocessed;
+    if (run_captured(work.string(), join_shell_words(preprocess), false, preprocessed) != 0) {
+        // Let the real compile report the error
+        record_uncacheable();
+        return run_captured(work.string(), command, true, output);
+    }
+
+    // gcc leaves a used precompiled header as a pragma instead of its text
+    const std::string pch_pragma = "#pragma GCC pch_preprocess \"";
+    for (size_t pos = preprocessed.find(pch_pragma); pos != std::string::npos;
+         pos = preprocessed.find(pch_pragma, pos + 1)) {
+        const size_t begin = pos + pch_pragma.size();
+        const size_t end = preprocessed.find('"', begin);
+        if (end == std::string::npos) break;
+        key_text += "pch " + file_stamp(work / preprocessed.substr(begin, end - begin)) + "\n";
+    }
+    key_text += preprocessed;
+    const std::string key = sha256_hex(key_text);
+
+    const fs::path entry_dir = fs::path(directory_) / key.substr(0, 2);
+    const fs::path object_entry = entry_dir / (key + ".o");
+    const fs::path depfile_entry = entry_dir / (key + ".d");
+    const fs::path output_entry = entry_dir / (key + ".txt");
+    const fs::path object_path = work / compile.output;
+    std::error_code ec;
+
+    // Hit: copy the object, give the depfile this object's name and replay
+    // the compiler's output
+    if (fs::exists(object_entry, ec) && (compile.depfile.empty() || fs::exists(depfile_entry, ec))) {
+        fs::create_directories(object_path.parent_path(), ec);
+        bool restored = copy_atomically(object_entry, object_path);
+        if (restored && !compile.depfile.empty()) {
+            const std::string body = read_file(depfile_entry);
+            std::ofstream depfile(work / compile.depfile, std::ios::binary | std::ios::trunc);
+            depfile << escape_depfile_target(compile.output) << body;
+            restored = !body.empty() && static_cast<bool>(depfile);
+        }
+        if (restored) {
+            output += read_file(output_entry);
+            fs::last_write_time(object_entry, fs::file_time_type::clock::now(), ec);  // Most recently used
+            ObjectCacheStats delta;
+            delta.hits = 1;
+            update_stats(delta, false);
+            return 0;
+        }
+    }
+
+    std::string compiler_output;
+    const int exit_code = run_captured(work.string(), command, true, compiler_output);
+    output += compiler_output;
+
+    ObjectCacheStats delta;
+    delta.misses = 1;
+    if (exit_code == 0 && fs::exists(object_path, ec)) {
+        std::optional<std::string> body = std::string();
+        if (!compile.depfile.empty()) body = depfile_body(read_file(work / compile.depfile));
+        fs::create_directories(entry_dir, ec);
+        if (body && !ec) {
+            // The object goes in last: its presence marks a complete entry
+            const std::string suffix = unique_suffix();
+            bool stored = true;
+            for (const auto& [path, text] : {std::make_pair(output_entry, compiler_output),
+                                             std::make_pair(depfile_entry, *body)}) {
+                if (path == depfile_entry && compile.depfile.empty()) continue;
+                const fs::path temp = path.string() + suffix;
+                {
+                    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+                    file << text;
+                    stored = stored && static_cast<bool>(file);
+                }
+                fs::rename(temp, path, ec);
+                stored = stored && !ec;
+            }
+            if (stored && copy_atomically(object_path, object_entry)) {
+                delta.bytes = fs::file_size(object_entry, ec) + compiler_output.size() +
+                              (compile.depfile.empty() ? 0 : body->size());
+            }
+        }
+    }
+    update_stats(delta, true);
+    return exit_code;
+#endif
+}
+
+void ObjectCache::record_uncacheable() {
+    ObjectCacheStats delta;
+    delta.uncacheable = 1;
+    update_stats(delta, false);
+}
+
+ObjectCacheStats ObjectCache::stats() const {
+    return read_stats(fs::path(directory_) / STATS_FILENAME);
+}
+
+void ObjectCache::update_stats(const ObjectCacheStats& delta, bool evict_if_full) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+#ifndef _WIN32
+    CacheLock lock(fs::path(directory_) / LOCK_FILENAME);
+#endif
+    const fs::path path = fs::path(directory_) / STATS_FILENAME;
+    ObjectCacheStats stats = read_stats(path);
+    stats.hits += delta.hits;
+    stats.misses += delta.misses;
+    stats.uncacheable += delta.uncacheable;
+    stats.evictions += delta.evictions;
+    stats.bytes += delta.bytes;
+    if (evict_if_full && stats.bytes > max_bytes_) {
+        evict_locked(stats);
+    }
+    write_stats(path, stats);
+}
+
+void ObjectCache::evict() {
+    std::error_code ec;
+    if (!fs::is_directory(directory_, ec)) return;
+#ifndef _WIN32
+    CacheLock lock(fs::path(directory_) / LOCK_FILENAME);
+#endif
+    const fs::path path = fs::path(directory_) / STATS_FILENAME;
+    ObjectCacheStats stats = read_stats(path);
+    evict_locked(stats);
+    write_stats(path, stats);
+}
+
+void ObjectCache::evict_locked(ObjectCacheStats& stats) {
+    struct Entry {
+        fs::path base;  // Without extension
+        fs::file_time_type used;
+        uint64_t bytes;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(directory_, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().extension() != ".o") continue;
+        Entry entry{it->path(), it->last_write_time(ec), 0};
+        entry.base.replace_extension();
+        for (const char* extension : {".o", ".d", ".txt"}) {
+            std::error_code size_ec;
+            const auto size = fs::file_size(entry.base.string() + extension, size_ec);
+            if (!size_ec) entry.bytes += size;
+        }
+        total += entry.bytes;
+        entries.push_back(std::move(entry));
+    }
+
+    // Down to 90% so the next few stores do not evict again
+    if (total > max_bytes_) {
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        const uint64_t target = max_bytes_ / 10 * 9;
+        for (const auto& entry : entries) {
+            if (total <= target) break;
+            for (const char* extension : {".o", ".d", ".txt"}) {
+                fs::remove(entry.base.string() + extension, ec);
+            }
+            total -= entry.bytes;
+            stats.evictions++;
+        }
+    }
+    stats.bytes = total;
+}
+
+std::string ObjectCache::default_directory() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return (fs::path(xdg) / "sighmake" / "objects").string();
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return (fs::path(home) / ".cache" / "sighmake" / "objects").string();
+    }
+    return (fs::temp_directory_path() / "sighmake-objects").string();
+}
+
+std::optional<uint64_t> ObjectCache::parse_size(const std::string& text) {
+    size_t digits = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) ++digits;
+    if (digits == 0 || digits > 15) return std::nullopt;
+    uint64_t value = std::stoull(text.substr(0, digits));
+
+    std::string unit = text.substr(digits);
+    if (unit.size() > 1 && (unit.back() == 'B' || unit.back() == 'b')) unit.pop_back();
+    if (unit.empty()) return value;
+    if (unit.size() != 1) return std::nullopt;
+    switch (std::toupper(static_cast<unsigned char>(unit[0]))) {
+        case 'K': return value << 10;
+        case 'M': return value << 20;
+        case 'G': return value << 30;
+        case 'T': return value << 40;
+        default: return std::nullopt;
+    }
+}
+
+int run_recipe_command(const std::string& command) {
+#ifndef _WIN32
+    const char* directory = std::getenv(CACHE_DIR_ENV);
+    if (directory && *directory) {
+        uint64_t max_bytes = DEFAULT_CACHE_SIZE;
+        if (const char* size = std::getenv(CACHE_SIZE_ENV)) {
+            max_bytes = ObjectCache::parse_size(size).value_or(DEFAULT_CACHE_SIZE);
+        }
+        ObjectCache cache(directory, max_bytes);
+        if (auto compile = parse_cacheable_compile(command)) {
+            std::string output;
+            const int exit_code = cache.compile(*compile, ".", output);
+            std::fwrite(output.data(), 1, output.size(), stderr);
+            return exit_code;
+        }
+        if (classify_trace_command(command).kind == "compile") {
+            cache.record_uncacheable();
+        }
+    }
+    return decode_status(std::system(command.c_str()));
+#else
+    return std::system(command.c_str());
+#endif
+}
+
+void write_object_cache_summary(const ObjectCacheStats& before, const ObjectCacheStats& after,
+                                uint64_t max_bytes, std::ostream& out) {
+    const uint64_t hits = after.hits - before.hits;
+    const uint64_t misses = after.misses - before.misses;
+    const uint64_t uncacheable = after.uncacheable - before.uncacheable;
+    out << "Object cache: " << hits << " hits, " << misses << " misses, " << uncacheable << " uncacheable";
+    if (hits + misses > 0) {
+        out << " (" << (hits * 100 / (hits + misses)) << "% hit rate)";
+    }
+    out << "; " << format_bytes(after.bytes) << " of " << format_bytes(max_bytes) << " used\n";
+}
+
+} // namespace vcxproj
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vcxproj {
+
+// Local content-addressed object cache for `--build --cache`. A compile
+// command is keyed on the compiler, its flags (everything but output paths)
+// and the hash of its preprocessed source, so switching back to a branch
+// copies the objects built there instead of compiling them again. Entries
+// live in a local directory bounded by size; the least recently used ones are
+// evicted first.
+//
+// make builds reach the cache through the recipe shell hook (see
+// build_trace.hpp) with the directory in SIGHMAKE_CACHE_DIR; the native
+// executor calls it directly.
+
+// Environment variables handing the cache to recipe lines run by make
+constexpr const char* CACHE_DIR_ENV = "SIGHMAKE_CACHE_DIR";
+constexpr const char* CACHE_SIZE_ENV = "SIGHMAKE_CACHE_SIZE";
+
+constexpr uint64_t DEFAULT_CACHE_SIZE = 5ull << 30;  // 5 GiB
+
+// A gcc/clang `-c` command the cache can serve: one source, one object and
+// no flags that write other outputs (PCH, coverage, split DWARF, ...)
+struct CacheableCompile {
+    std::vector<std::string> words;  // Compiler, then arguments (unquoted)
+    std::string source;
+    std::string output;              // -o value
+    std::string depfile;             // -MF value or derived from -o; empty without -MD/-MMD
+};
+
+// Parses command, or nullopt if it is not a compile the cache understands.
+// Commands with shell syntax beyond quoting (&&, pipes, redirections,
+// substitutions) are never cacheable.
+std::optional<CacheableCompile> parse_cacheable_compile(const std::string& command);
+
+// Lifetime counters, kept in the cache directory
+struct ObjectCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t uncacheable = 0;  // Compiles the cache could not key (parse or preprocessor failure)
+    uint64_t evictions = 0;
+    uint64_t bytes = 0;        // Size of the stored entries
+};
+
+class ObjectCache {
+public:
+    ObjectCache(std::string directory, uint64_t max_bytes = DEFAULT_CACHE_SIZE);
+
+    const std::string& directory() const { return directory_; }
+    uint64_t max_bytes() const { return max_bytes_; }
+
+    // Runs compile in working_dir, copying the object (and depfile) from the
+    // cache on a hit and storing them after a successful miss. Compiler
+    // output is appended to output, replayed on hits. Returns the exit code.
+    // Safe to call from several threads and processes at once.
+    int compile(const CacheableCompile& compile, const std::string& working_dir, std::string& output);
+
+    // Counts a compile that ran without the cache
+    void record_uncacheable();
+
+    ObjectCacheStats stats() const;
+
+    // Removes least recently used entries until the cache fits in max_bytes
+    void evict();
+
+    // $XDG_CACHE_HOME/sighmake/objects, else ~/.cache/sighmake/objects
+    static std::string default_directory();
+
+    // "500M", "5G", "64K" or a byte count; nullopt if malformed
+    static std::optional<uint64_t> parse_size(const std::string& text);
+
+private:
+    void update_stats(const ObjectCacheStats& delta, bool evict_if_full);
+    void evict_locked(ObjectCacheStats& stats);
+
+    std::string directory_;
+    uint64_t max_bytes_;
+};
+
+// Recipe line run by the make shell hook: compiles go through the cache named
+// by SIGHMAKE_CACHE_DIR when it is set, everything else runs with /bin/sh.
+// Returns the exit code (128 + signal if the command was killed).
+int run_recipe_command(const std::string& command);
+
+// "Object cache: 12 hits, 3 misses, ..." for the difference between two
+// snapshots, plus the current size
+void write_object_cache_summary(const ObjectCacheStats& before, const ObjectCacheStats& after,
+                                uint64_t max_bytes, std::ostream& out);
+
+} // namespace vcxproj
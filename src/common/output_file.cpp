@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "output_file.hpp"
+#include "timings.hpp"
+
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+std::atomic<size_t> g_written{0};
+std::atomic<size_t> g_unchanged{0};
+
+// True if the file at path holds exactly content (read in the same mode it
+// would be written, so newline translation cancels out)
+bool file_matches(const fs::path& path, const std::string& content, bool binary) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return false;
+    }
+    // Without newline translation the size alone rules out most changes
+    if (binary && fs::file_size(path, ec) != content.size()) {
+        return false;
+    }
+
+    std::ifstream in(path, binary ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!in) {
+        return false;
+    }
+
+    std::string existing;
+    existing.reserve(content.size());
+    char buffer[64 * 1024];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+        existing.append(buffer, static_cast<size_t>(in.gcount()));
+        if (existing.size() > content.size()) {
+            return false;
+        }
+    }
+    return existing == content;
+}
+
+} // anonymous namespace
+
+WriteResult write_file_if_changed(const fs::path& path, const std::string& content, bool binary) {
+    TimingScope timing("write_file_if_changed");
+    if (file_matches(path, content, binary)) {
+        ++g_unchanged;
+        return WriteResult::Unchanged;
+    }
+
+    std::ofstream out(path, binary ? std::ios::out | std::ios::binary : std::ios::out);
+    if (!out) {
+        return WriteResult::Failed;
+    }
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    out.close();
+    if (!out) {
+        return WriteResult::Failed;
+    }
+
+    ++g_written;
+    add_timing_counter("bytes written", content.size());
+    return WriteResult::Written;
+}
+
+OutputStats output_stats() {
+    OutputStats stats;
+    stats.written = g_written.load();
+    stats.unchanged = g_unchanged.load();
+    return stats;
+}
+
+void reset_output_stats() {
+    g_written.store(0);
+    g_unchanged.store(0);
+}
+
+bool OutputFile::commit() {
+    if (fail()) {
+        result_ = WriteResult::Failed;
+        return false;
+    }
+    result_ = write_file_if_changed(path_, str(), binary_);
+    return result_ != WriteResult::Failed;
+}
+
+} // namespace vcxproj
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+namespace vcxproj {
+
+enum class WriteResult {
+    Written,    // File was created or its content changed
+    Unchanged,  // File already held identical bytes and was left untouched
+    Failed      // File could not be written
+};
+
+// Writes content to path unless the file already holds exactly those bytes, so
+// regenerating an unchanged project keeps its mtime and make, ninja and MSBuild
+// have nothing to re-evaluate. Binary mode skips newline translation (pugixml
+// writes XML in binary mode). Safe to call from generator worker threads.
+WriteResult write_file_if_changed(const std::filesystem::path& path, const std::string& content,
+                                  bool binary = false);
+
+// Counts of write_file_if_changed results since the last reset
+struct OutputStats {
+    size_t written = 0;
+    size_t unchanged = 0;
+};
+
+OutputStats output_stats();
+void reset_output_stats();
+
+// In-memory stream for a generated file. Nothing touches the disk until
+// commit(), which goes through write_file_if_changed.
+class OutputFile : public std::ostringstream {
+public:
+    explicit OutputFile(std::filesystem::path path, bool binary = false)
+        : path_(std::move(path)), binary_(binary) {}
+
+    // Returns false if the stream failed or the file could not be written
+    bool commit();
+
+    WriteResult result() const { return result_; }
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+    bool binary_;
+    WriteResult result_ = WriteResult::Failed;
+};
+
+} // namespace vcxproj
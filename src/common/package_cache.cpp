@@ -0,0 +1,244 @@
+#include "pch.h"
+#include "package_cache.hpp"
+#include "output_file.hpp"
+#include "timings.hpp"
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+static std::string env_state(const char* value) {
+    return value ? std::string("=") + value : std::string();
+}
+
+static std::string path_state(const fs::path& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    if (ec) {
+        return "-";
+    }
+    return std::to_string(static_cast<long long>(time.time_since_epoch().count()));
+}
+
+// Values are stored one per line
+static std::string single_line(std::string value) {
+    std::replace(value.begin(), value.end(), '\n', ' ');
+    std::replace(value.begin(), value.end(), '\r', ' ');
+    return value;
+}
+
+void PackageProbe::record(bool is_env, std::string name, std::string state) {
+    for (const auto& input : inputs) {
+        if (input.is_env == is_env && input.name == name) {
+            return;
+        }
+    }
+    inputs.push_back({is_env, std::move(name), std::move(state)});
+}
+
+const char* PackageProbe::env(const char* name) {
+    const char* value = std::getenv(name);
+    record(true, name, env_state(value));
+    return value;
+}
+
+bool PackageProbe::exists(const fs::path& path) {
+    std::string state = path_state(path);
+    const bool found = state != "-";
+    record(false, path.string(), std::move(state));
+    return found;
+}
+
+void PackageProbe::watch(const fs::path& path) {
+    record(false, path.string(), path_state(path));
+}
+
+bool PackageProbe::unchanged() const {
+    for (const auto& input : inputs) {
+        const std::string current = input.is_env ? env_state(std::getenv(input.name.c_str()))
+                                                 : path_state(input.name);
+        if (current != input.state) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PackageCache::load(const std::string& dir) {
+    std::ifstream in(fs::path(dir) / CACHE_FILENAME);
+    if (!in) {
+        return;
+    }
+
+    std::map<std::string, std::shared_ptr<Entry>> entries;
+    Entry* entry = nullptr;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+
+        if (key == "package") {
+            auto& slot = entries[value];
+            slot = std::make_shared<Entry>();
+            slot->stored = true;
+            entry = slot.get();
+            continue;
+        }
+        if (!entry) {
+            return;  // Settings before the first package: not a file we wrote
+        }
+
+        PackageFindResult& result = entry->result;
+        if (key == "found") {
+            result.found = value == "1";
+        } else if (key == "include_dirs") {
+            result.include_dirs = value;
+        } else if (key == "libraries") {
+            result.libraries = value;
+        } else if (key == "library_dirs") {
+            result.library_dirs = value;
+        } else if (key == "library_dirs_x64") {
+            result.library_dirs_x64 = value;
+        } else if (key == "version") {
+            result.version = value;
+        } else if (key == "error") {
+            result.error_message = value;
+        } else if (key == "env" || key == "path") {
+            // env=<name>|<state>, path=<state>|<path>
+            size_t sep = value.find('|');
+            if (sep == std::string::npos) {
+                return;
+            }
+            PackageProbe::Input input;
+            input.is_env = key == "env";
+            if (input.is_env) {
+                input.name = value.substr(0, sep);
+                input.state = value.substr(sep + 1);
+            } else {
+                input.state = value.substr(0, sep);
+                input.name = value.substr(sep + 1);
+            }
+            entry->probe.inputs.push_back(std::move(input));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(entries);
+    dirty_ = false;
+}
+
+bool PackageCache::save(const std::string& dir) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Results this run did not ask for are dropped, so a package the
+    // buildscripts no longer use cannot keep the build cache stale
+    bool unused = false;
+    for (const auto& [package, entry] : entries_) {
+        std::lock_guard<std::mutex> entry_lock(entry->mutex);
+        unused = unused || (entry->stored && !entry->checked);
+    }
+    if (!dirty_ && !unused) {
+        return true;
+    }
+
+    fs::path cache_path = fs::path(dir) / CACHE_FILENAME;
+    OutputFile out(cache_path);
+    out << "# sighmake find_package() cache - auto-generated, do not edit\n";
+    for (const auto& [package, entry] : entries_) {
+        std::lock_guard<std::mutex> entry_lock(entry->mutex);
+        if (!entry->stored || !entry->checked) {
+            continue;
+        }
+        const PackageFindResult& result = entry->result;
+        out << "package=" << package << "\n";
+        out << "found=" << (result.found ? "1" : "0") << "\n";
+        out << "include_dirs=" << single_line(result.include_dirs) << "\n";
+        out << "libraries=" << single_line(result.libraries) << "\n";
+        out << "library_dirs=" << single_line(result.library_dirs) << "\n";
+        out << "library_dirs_x64=" << single_line(result.library_dirs_x64) << "\n";
+        out << "version=" << single_line(result.version) << "\n";
+        out << "error=" << single_line(result.error_message) << "\n";
+        for (const auto& input : entry->probe.inputs) {
+            if (input.is_env) {
+                out << "env=" << input.name << "|" << single_line(input.state) << "\n";
+            } else {
+                out << "path=" << input.state << "|" << input.name << "\n";
+            }
+        }
+    }
+
+    if (!out.commit()) {
+        std::cerr << "Warning: Failed to write package cache: " << cache_path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool PackageCache::unchanged() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [package, entry] : entries_) {
+        std::lock_guard<std::mutex> entry_lock(entry->mutex);
+        if (entry->stored && !entry->probe.unchanged()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PackageCache::begin_run() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [package, entry] : entries_) {
+            std::lock_guard<std::mutex> entry_lock(entry->mutex);
+            entry->checked = false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(run_values_mutex_);
+    run_values_.clear();
+}
+
+std::string PackageCache::run_value(const std::string& key, const std::function<std::string()>& compute) {
+    std::lock_guard<std::mutex> lock(run_values_mutex_);
+    auto it = run_values_.find(key);
+    if (it == run_values_.end()) {
+        it = run_values_.emplace(key, compute()).first;
+    }
+    return it->second;
+}
+
+PackageFindResult PackageCache::find(const std::string& package, const Finder& find) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = entries_[package];
+        if (!slot) {
+            slot = std::make_shared<Entry>();
+        }
+        entry = slot;
+    }
+
+    // A second lookup of the same package waits for the first instead of
+    // spawning the same pkg-config processes; other packages probe meanwhile
+    std::lock_guard<std::mutex> entry_lock(entry->mutex);
+    if (entry->checked || (entry->stored && entry->probe.unchanged())) {
+        entry->checked = true;
+        add_timing_counter("find_package cache hits");
+        return entry->result;
+    }
+
+    TimingScope timing("find_package probe");
+    PackageProbe probe;
+    entry->result = find(probe);
+    entry->probe = std::move(probe);
+    entry->stored = true;
+    entry->checked = true;
+    dirty_ = true;
+    return entry->result;
+}
+
+} // namespace vcxproj
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "project_types.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vcxproj {
+
+// What a find_package() probe looked at, with the state it saw: environment
+// variables and paths. A probe's result holds as long as none of them change.
+class PackageProbe {
+public:
+    struct Input {
+        bool is_env = false;
+        std::string name;   // Variable name or path
+        std::string state;  // "=value" or "" (unset); modification time or "-" (missing)
+    };
+
+    // std::getenv that records the variable
+    const char* env(const char* name);
+
+    // fs::exists that records the path's modification time, or its absence
+    bool exists(const std::filesystem::path& path);
+
+    // Records a path whose modification time matters without testing it, such
+    // as a search directory where a new file would change the result
+    void watch(const std::filesystem::path& path);
+
+    // Whether every recorded input still has the state the probe saw
+    bool unchanged() const;
+
+    std::vector<Input> inputs;
+
+private:
+    void record(bool is_env, std::string name, std::string state);
+};
+
+// find_package() results, kept across runs in .sighmake_packages next to
+// .sighmake_cache. A package is probed or checked at most once per run; a
+// result from an earlier run is reused while its probe inputs are unchanged,
+// so a warm regeneration runs no pkg-config at all. Safe to share between
+// threads.
+class PackageCache {
+public:
+    using Finder = std::function<PackageFindResult(PackageProbe&)>;
+
+    // Loads dir/.sighmake_packages; a missing or malformed file loads nothing
+    void load(const std::string& dir);
+
+    // Writes this run's results to dir/.sighmake_packages if a package was
+    // probed since load() or a stored one went unused
+    bool save(const std::string& dir) const;
+
+    // Whether every stored result's probe inputs are unchanged, so that
+    // probing again would give the same answers
+    bool unchanged() const;
+
+    // Starts a new run: stored results are checked again before reuse and
+    // run values are computed again
+    void begin_run();
+
+    // The result for package (a finder key such as "vulkan"): this run's,
+    // else a stored one whose inputs are unchanged, else find(probe)
+    PackageFindResult find(const std::string& package, const Finder& find);
+
+    // compute(), run once per run and shared by every probe that asks for
+    // key, such as a tool's default search path
+    std::string run_value(const std::string& key, const std::function<std::string()>& compute);
+
+    static constexpr const char* CACHE_FILENAME = ".sighmake_packages";
+
+private:
+    // Locked on its own while probing, so only lookups of the same package
+    // wait for a probe
+    struct Entry {
+        std::mutex mutex;
+        PackageFindResult result;
+        PackageProbe probe;
+        bool stored = false;   // result holds a probe's answer
+        bool checked = false;  // Probed or verified during this run
+    };
+
+    mutable std::mutex mutex_;  // Guards entries_, never held while probing
+    std::map<std::string, std::shared_ptr<Entry>> entries_;
+    std::atomic<bool> dirty_{false};
+
+    std::mutex run_values_mutex_;  // Held while computing a run value
+    std::map<std::string, std::string> run_values_;
+};
+
+} // namespace vcxproj
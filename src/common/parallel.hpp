@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vcxproj {
+
+// Worker count used when the caller did not ask for a specific number of jobs
+inline int default_job_count() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+// Run fn(i) for every i in [0, count) on up to `jobs` threads (jobs <= 0 uses
+// default_job_count()). Indices are handed out in increasing order; callers
+// keep results deterministic by writing into slot i of a pre-sized container.
+// The first exception thrown by fn stops further work and is rethrown on the
+// calling thread once every worker has finished.
+template <typename Fn>
+void parallel_for(size_t count, int jobs, Fn&& fn) {
+    if (jobs <= 0) {
+        jobs = default_job_count();
+    }
+    const size_t workers = std::min(static_cast<size_t>(jobs), count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for (;;) {
+            const size_t i = next.fetch_add(1);
+            if (i >= count) {
+                return;
+            }
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(count);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace vcxproj
@@ -0,0 +1,66 @@
+#include "pch.h"
+#include "project_graph.hpp"
+
+namespace vcxproj {
+
+ProjectGraph::ProjectGraph(const Solution& solution) {
+    const size_t count = solution.projects.size();
+    index_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        index_.try_emplace(solution.projects[i].name, i);  // first project wins
+    }
+
+    dependencies_.resize(count);
+    dependents_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& references = solution.projects[i].project_references;
+        for (size_t r = 0; r < references.size(); ++r) {
+            size_t dep = find(references[r].name);
+            if (dep == npos) continue;
+            dependencies_[i].push_back({dep, r});
+            // i only grows, so a repeated reference is always the last entry
+            auto& users = dependents_[dep];
+            if (users.empty() || users.back() != i) {
+                users.push_back(i);
+            }
+        }
+    }
+
+    // Iterative post-order, so deep dependency chains can't overflow the stack
+    order_.reserve(count);
+    std::vector<char> visited(count, 0);
+    std::vector<std::pair<size_t, size_t>> stack;  // (project, next edge)
+    for (size_t root = 0; root < count; ++root) {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        stack.push_back({root, 0});
+        while (!stack.empty()) {
+            auto& [project, next] = stack.back();
+            const auto& edges = dependencies_[project];
+            if (next < edges.size()) {
+                size_t dep = edges[next++].project;
+                if (!visited[dep]) {
+                    visited[dep] = 1;
+                    stack.push_back({dep, 0});
+                }
+                continue;
+            }
+            order_.push_back(project);
+            stack.pop_back();
+        }
+    }
+}
+
+size_t ProjectGraph::find(const std::string& name) const {
+    auto it = index_.find(name);
+    return it == index_.end() ? npos : it->second;
+}
+
+const ProjectGraph& Solution::graph() const {
+    if (!graph_ || graph_->size() != projects.size()) {
+        graph_ = std::make_shared<const ProjectGraph>(*this);
+    }
+    return *graph_;
+}
+
+} // namespace vcxproj
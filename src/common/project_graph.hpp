@@ -0,0 +1,54 @@
+#pragma once
+
+#include "project_types.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vcxproj {
+
+// Name index and dependency edges of a solution's projects, built once so
+// that propagation and the generators resolve project_references in O(1)
+// instead of scanning solution.projects. Projects are referred to by their
+// position in solution.projects; the graph stores no pointers, so it stays
+// valid for copies of the solution it was built from.
+class ProjectGraph {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // One project_references entry that names a project of the solution
+    struct Edge {
+        size_t project;    // index of the referenced project
+        size_t reference;  // index into the referencing project's project_references
+    };
+
+    ProjectGraph() = default;
+    explicit ProjectGraph(const Solution& solution);
+
+    size_t size() const { return dependencies_.size(); }
+
+    // Index of the first project with this name, or npos
+    size_t find(const std::string& name) const;
+
+    // Resolved references of a project, in project_references order.
+    // References to names that are not projects have no edge.
+    const std::vector<Edge>& dependencies(size_t project) const { return dependencies_[project]; }
+
+    // Projects that reference this one, each listed once, in solution order
+    const std::vector<size_t>& dependents(size_t project) const { return dependents_[project]; }
+
+    // Every project with its dependencies before it: a depth-first post-order
+    // from each project in solution order, following references in
+    // declaration order. A cycle is broken where it closes.
+    const std::vector<size_t>& topological_order() const { return order_; }
+
+private:
+    std::unordered_map<std::string, size_t> index_;
+    std::vector<std::vector<Edge>> dependencies_;
+    std::vector<std::vector<size_t>> dependents_;
+    std::vector<size_t> order_;
+};
+
+} // namespace vcxproj
@@ -3,8 +3,12 @@
 #include "string_utils.hpp"
 #include "file_types.hpp"
 
+#include <memory>
+
 namespace vcxproj {
 
+class ProjectGraph;
+
 // Result from package finding operations
 struct PackageFindResult {
     bool found = false;
@@ -304,6 +308,9 @@ struct Project {
     // Language settings
     std::string language;                               // "C", "C++", or "" (auto-detect)
     std::string c_standard;                             // "89", "99", "11", "17", "23" (for C projects)
+    std::string compiler_launcher;                      // Prefix for compile commands, e.g. "ccache" (empty = none)
+    bool unity_build = false;                           // Batch ClCompile sources into generated unity TUs
+    int unity_batch_size = 8;                           // Sources per unity TU (0 = one TU per language)
 
     bool ignore_warn_compile_duplicated_filename = false;
     std::string vcxproj_path;                           // Original .vcxproj file path (for reverse conversion)
@@ -355,6 +362,15 @@ struct SolutionFolder {
     std::string uuid;
 };
 
+// A file or directory a solution was generated from. Files are hashed by
+// content, directories by their entry names (so wildcard matches that appear
+// or disappear are noticed). A hash of 0 means the path did not exist.
+struct GenerationInput {
+    std::string path;
+    bool is_directory = false;
+    uint64_t hash = 0;
+};
+
 // Solution
 struct Solution {
     std::string name;
@@ -369,6 +385,9 @@ struct Solution {
     // Per-config solution-level defines (for bracket notation like defines[Win32])
     std::map<std::string, std::vector<std::string>> solution_level_preprocessor_definitions_per_config;
 
+    // Default compiler_launcher for projects that don't set their own
+    std::string compiler_launcher;
+
     // Solution-wide found packages (from find_package())
     // Used to create synthetic projects for automatic dependency propagation
     std::map<std::string, PackageFindResult> found_packages;
@@ -377,6 +396,12 @@ struct Solution {
     // Populated from buildscript toolset or parsed from .sln VisualStudioVersion header
     std::string target_toolset;
 
+    // Buildscripts and wildcard directories read by the parser, plus the
+    // command-line options that shaped generation. Recorded in .sighmake_cache
+    // so an unchanged regeneration can be skipped.
+    std::vector<GenerationInput> inputs;
+    std::string generation_options;
+
     // Get all configuration keys (e.g., "Debug|Win32", "Release|x64")
     std::vector<std::string> get_config_keys() const {
         std::vector<std::string> keys;
@@ -387,29 +412,43 @@ struct Solution {
         }
         return keys;
     }
+
+    // Name index and dependency edges of the projects (see project_graph.hpp),
+    // built on first use and rebuilt when projects are added or removed. Call
+    // invalidate_graph() after renaming projects or changing their references.
+    // Not thread-safe until built; generators fetch it before starting workers.
+    const ProjectGraph& graph() const;
+    void invalidate_graph() const { graph_.reset(); }
+
+    mutable std::shared_ptr<const ProjectGraph> graph_;
 };
 
-// Helper function to generate UUIDs
-inline std::string generate_uuid() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    std::uniform_int_distribution<> dis2(8, 11);
+// 64-bit FNV-1a hash
+inline uint64_t fnv1a64(const std::string& value) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Name-based UUID: the same seed always gives the same UUID, so regenerating a
+// solution keeps its .sln/.vcxproj GUIDs and MSBuild/IDE state stays valid.
+// Formatted like a random version 4 GUID, with version 8 (custom) instead.
+inline std::string make_stable_uuid(const std::string& seed) {
+    uint64_t high = fnv1a64(seed);
+    uint64_t low = fnv1a64(seed + "#uuid");
+    high = (high & ~0xF000ull) | 0x8000ull;                        // Version 8
+    low = (low & 0x3FFFFFFFFFFFFFFFull) | 0x8000000000000000ull;   // RFC 4122 variant
 
     std::stringstream ss;
-    ss << std::uppercase << std::hex;
-
-    for (int i = 0; i < 8; i++) ss << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 4; i++) ss << dis(gen);
-    ss << "-4"; // Version 4
-    for (int i = 0; i < 3; i++) ss << dis(gen);
-    ss << "-";
-    ss << dis2(gen); // Variant
-    for (int i = 0; i < 3; i++) ss << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 12; i++) ss << dis(gen);
-
+    ss << std::uppercase << std::hex << std::setfill('0');
+    ss << std::setw(8) << static_cast<uint32_t>(high >> 32) << "-";
+    ss << std::setw(4) << static_cast<uint16_t>(high >> 16) << "-";
+    ss << std::setw(4) << static_cast<uint16_t>(high) << "-";
+    ss << std::setw(4) << static_cast<uint16_t>(low >> 48) << "-";
+    ss << std::setw(12) << (low & 0x0000FFFFFFFFFFFFull);
     return ss.str();
 }
 
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace vcxproj {
+
+// SHA-256 digest of data as 64 lowercase hex digits. For keys that must not
+// collide, such as object cache entries; fnv1a64 is enough elsewhere.
+std::string sha256_hex(std::string_view data);
+
+} // namespace vcxproj
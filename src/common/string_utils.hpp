@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cctype>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace vcxproj {
@@ -34,6 +35,14 @@ inline std::string trim(const std::string& str) {
     return str.substr(first, last - first + 1);
 }
 
+// trim() without the copy; the result points into str
+inline std::string_view trim_view(std::string_view str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return {};
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
 // Split a CMake-style semicolon-separated list into individual entries
 inline std::vector<std::string> split_semicolons(const std::string& value) {
     std::vector<std::string> result;
@@ -54,6 +63,71 @@ inline std::vector<std::string> split_semicolons(const std::string& value) {
     return result;
 }
 
+// Escape a string for use inside a JSON string literal; control characters
+// become escapes rather than being dropped
+inline std::string escape_json(const std::string& str) {
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += "\\u00";
+                    result += digits[static_cast<unsigned char>(c) >> 4];
+                    result += digits[c & 0xF];
+                } else {
+                    result += c;
+                }
+                break;
+        }
+    }
+    return result;
+}
+
+// Quote a word for the platform shell: double quotes for cmd on Windows,
+// single quotes for /bin/sh elsewhere, where words made only of safe
+// characters are left as they are
+inline std::string shell_quote(const std::string& value) {
+#ifdef _WIN32
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            result += "\\\"";
+        } else {
+            result += c;
+        }
+    }
+    result += "\"";
+    return result;
+#else
+    bool safe = !value.empty();
+    for (char c : value) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && std::string("_+-./=,:@%").find(c) == std::string::npos) {
+            safe = false;
+            break;
+        }
+    }
+    if (safe) return value;
+
+    std::string result = "'";
+    for (char c : value) {
+        if (c == '\'') {
+            result += "'\\''";
+        } else {
+            result += c;
+        }
+    }
+    result += "'";
+    return result;
+#endif
+}
+
 // Unescape newlines/backslashes that the buildscript parser encoded with \x01
 inline std::string unescape_newlines(const std::string& str) {
     std::string result;
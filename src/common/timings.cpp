@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "timings.hpp"
+#include "output_file.hpp"
+#include "string_utils.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+
+namespace vcxproj {
+
+namespace {
+
+struct Span {
+    std::string phase;
+    int64_t start_us;     // since collection was enabled
+    int64_t duration_us;
+    uint32_t thread;
+};
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_mutex;
+std::chrono::steady_clock::time_point g_origin;
+std::vector<Span> g_spans;
+std::map<std::string, uint64_t> g_counters;
+
+// Small stable per-thread ids for the trace (the main thread is 1)
+uint32_t current_thread_index() {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t index = next.fetch_add(1);
+    return index;
+}
+
+int64_t micros(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+void enable_timings(bool enabled) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (enabled && !g_enabled.load() && g_spans.empty()) {
+        g_origin = std::chrono::steady_clock::now();
+        current_thread_index();
+    }
+    g_enabled.store(enabled);
+}
+
+bool timings_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void reset_timings() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_spans.clear();
+    g_counters.clear();
+    g_origin = std::chrono::steady_clock::now();
+}
+
+TimingScope::TimingScope(const char* phase)
+    : phase_(phase), active_(timings_enabled()) {
+    if (active_) {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+TimingScope::~TimingScope() {
+    if (!active_) return;
+    const auto end = std::chrono::steady_clock::now();
+    const uint32_t thread = current_thread_index();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_spans.push_back({phase_, micros(start_ - g_origin), micros(end - start_), thread});
+}
+
+void add_timing_counter(const char* counter, uint64_t amount) {
+    if (!timings_enabled()) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_counters[counter] += amount;
+}
+
+void write_timing_summary(std::ostream& out) {
+    struct PhaseTotal {
+        std::string phase;
+        int64_t first_start_us = 0;
+        size_t calls = 0;
+        int64_t total_us = 0;
+        int64_t max_us = 0;
+    };
+
+    std::vector<PhaseTotal> phases;
+    std::map<std::string, uint64_t> counters;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        std::map<std::string, size_t> index;
+        for (const auto& span : g_spans) {
+            auto [it, inserted] = index.try_emplace(span.phase, phases.size());
+            if (inserted) {
+                phases.push_back({span.phase, span.start_us});
+            }
+            auto& total = phases[it->second];
+            total.first_start_us = std::min(total.first_start_us, span.start_us);
+            total.calls++;
+            total.total_us += span.duration_us;
+            total.max_us = std::max(total.max_us, span.duration_us);
+        }
+        counters = g_counters;
+    }
+
+    // Phases in the order they first started, so nesting reads top-down
+    std::stable_sort(phases.begin(), phases.end(), [](const PhaseTotal& a, const PhaseTotal& b) {
+        return a.first_start_us < b.first_start_us;
+    });
+
+    size_t width = 5;
+    for (const auto& phase : phases) width = std::max(width, phase.phase.size());
+    for (const auto& [name, value] : counters) width = std::max(width, name.size());
+
+    const auto ms = [](int64_t us) { return static_cast<double>(us) / 1000.0; };
+    out << "\nTimings (wall time; totals include nested phases):\n";
+    out << "  " << std::left << std::setw(static_cast<int>(width)) << "Phase" << std::right
+        << std::setw(8) << "Calls" << std::setw(12) << "Total ms" << std::setw(12) << "Max ms" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (const auto& phase : phases) {
+        out << "  " << std::left << std::setw(static_cast<int>(width)) << phase.phase << std::right
+            << std::setw(8) << phase.calls << std::setw(12) << ms(phase.total_us)
+            << std::setw(12) << ms(phase.max_us) << "\n";
+    }
+    out.unsetf(std::ios::floatfield);
+
+    if (!counters.empty()) {
+        out << "\nCounters:\n";
+        for (const auto& [name, value] : counters) {
+            out << "  " << std::left << std::setw(static_cast<int>(width)) << name << std::right
+                << std::setw(8) << value << "\n";
+        }
+    }
+}
+
+bool write_timing_trace(const std::string& path) {
+    std::vector<Span> spans;
+    std::map<std::string, uint64_t> counters;
+    int64_t end_us = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        spans = g_spans;
+        counters = g_counters;
+        end_us = micros(std::chrono::steady_clock::now() - g_origin);
+    }
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"sighmake\"}}";
+    for (const auto& span : spans) {
+        out << ",\n  {\"name\": \"" << escape_json(span.phase) << "\", \"cat\": \"sighmake\", \"ph\": \"X\", "
+            << "\"ts\": " << span.start_us << ", \"dur\": " << span.duration_us
+            << ", \"pid\": 1, \"tid\": " << span.thread << "}";
+    }
+    if (!counters.empty()) {
+        out << ",\n  {\"name\": \"counters\", \"ph\": \"C\", \"ts\": " << end_us << ", \"pid\": 1, \"args\": {";
+        bool first = true;
+        for (const auto& [name, value] : counters) {
+            out << (first ? "" : ", ") << "\"" << escape_json(name) << "\": " << value;
+            first = false;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+
+    return write_file_if_changed(path, out.str()) != WriteResult::Failed;
+}
+
+} // namespace vcxproj
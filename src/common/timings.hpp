@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace vcxproj {
+
+// Phase timings and counters for --timings. Collection is off by default;
+// while it is off a TimingScope or add_timing_counter costs one atomic load.
+// Everything here is safe to call from generator worker threads.
+void enable_timings(bool enabled = true);
+bool timings_enabled();
+
+// Drops everything recorded so far (collection stays as it was)
+void reset_timings();
+
+// Records the wall time of the enclosing scope as one span of `phase`.
+// Scopes may nest and run on several threads; each span keeps its thread.
+// phase must outlive the scope.
+class TimingScope {
+public:
+    explicit TimingScope(const char* phase);
+    ~TimingScope();
+
+    TimingScope(const TimingScope&) = delete;
+    TimingScope& operator=(const TimingScope&) = delete;
+
+private:
+    const char* phase_;
+    std::chrono::steady_clock::time_point start_;
+    bool active_;
+};
+
+// Adds amount to a named counter (e.g. "include files", "wildcard matches")
+void add_timing_counter(const char* counter, uint64_t amount = 1);
+
+// Per-phase table (calls, total and longest wall time) followed by the
+// counters. Totals are inclusive of nested phases and summed over threads.
+void write_timing_summary(std::ostream& out);
+
+// Chrome trace_event JSON (load in chrome://tracing or Perfetto): one
+// complete event per span plus the counters. Returns false if the file
+// could not be written.
+bool write_timing_trace(const std::string& path);
+
+} // namespace vcxproj
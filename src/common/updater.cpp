@@ -52,32 +52,6 @@ std::string popen_read(const std::string& command) {
     return output;
 }
 
-std::string shell_quote(const std::string& value) {
-#ifdef _WIN32
-    std::string result = "\"";
-    for (char c : value) {
-        if (c == '"') {
-            result += "\\\"";
-        } else {
-            result += c;
-        }
-    }
-    result += "\"";
-    return result;
-#else
-    std::string result = "'";
-    for (char c : value) {
-        if (c == '\'') {
-            result += "'\\''";
-        } else {
-            result += c;
-        }
-    }
-    result += "'";
-    return result;
-#endif
-}
-
 std::string powershell_quote(const std::string& value) {
     std::string result = "'";
     for (char c : value) {
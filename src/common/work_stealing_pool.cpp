@@ -0,0 +1,136 @@
+#include "pch.h"
+#include "work_stealing_pool.hpp"
+#include "parallel.hpp"
+
+namespace vcxproj {
+
+namespace {
+
+// The pool and queue the current thread works for, so submit() from inside
+// a task lands on the submitting worker's own queue
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local size_t t_queue = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int jobs) {
+    if (jobs <= 0) {
+        jobs = default_job_count();
+    }
+    for (int i = 0; i < jobs; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    const size_t index = t_pool == this ? t_queue : next_queue_.fetch_add(1) % queues_.size();
+    pending_.fetch_add(1);
+    {
+        // Counted before it is visible so queued_ never drops below zero;
+        // the lock orders the increment with a worker about to sleep
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_.load() == 0; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::pop_task(size_t index, Task& task) {
+    {
+        Queue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finish_task() {
+    if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_cv_.notify_all();
+    }
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    t_pool = this;
+    t_queue = index;
+
+    for (;;) {
+        Task task;
+        if (pop_task(index, task)) {
+            queued_.fetch_sub(1);
+            bool failed = false;
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed = true;
+            }
+            if (failed) {
+                // Drop everything still queued so wait() returns promptly
+                for (auto& queue : queues_) {
+                    std::lock_guard<std::mutex> lock(queue->mutex);
+                    const size_t dropped = queue->tasks.size();
+                    queue->tasks.clear();
+                    queued_.fetch_sub(dropped);
+                    for (size_t i = 0; i < dropped; ++i) {
+                        finish_task();
+                    }
+                }
+            }
+            finish_task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+} // namespace vcxproj
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vcxproj {
+
+// Thread pool for tasks that submit follow-up tasks, such as build steps that
+// release their dependents. Each worker keeps its own queue: it runs the
+// newest task it submitted itself (so a dependent runs where its inputs were
+// just produced) and, when its queue is empty, steals the oldest task of
+// another worker.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // jobs <= 0 uses default_job_count()
+    explicit WorkStealingPool(int jobs);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return queues_.size(); }
+
+    // Queues a task. From one of this pool's workers the task goes to that
+    // worker's queue, otherwise queues are filled round-robin.
+    void submit(Task task);
+
+    // Blocks until every submitted task, including tasks submitted by tasks,
+    // has finished. The first exception thrown by a task is rethrown here;
+    // tasks still queued at that point are dropped.
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t index);
+    bool pop_task(size_t index, Task& task);
+    void finish_task();
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;                 // Guards sleeping, waking and error_
+    std::condition_variable work_cv_;  // Workers wait here for queued tasks
+    std::condition_variable idle_cv_;  // wait() waits here for pending_ == 0
+    std::atomic<size_t> queued_{0};    // Tasks sitting in queues
+    std::atomic<size_t> pending_{0};   // Tasks submitted and not yet finished
+    std::atomic<size_t> next_queue_{0};
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+} // namespace vcxproj
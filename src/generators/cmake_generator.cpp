@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "cmake_generator.hpp"
 #include "common/build_cache.hpp"
+#include "common/project_graph.hpp"
+#include "common/output_file.hpp"
 #include "common/string_utils.hpp"
 #include "common/compiler_flags.hpp"
 #include "common/language_standards.hpp"
@@ -30,6 +32,18 @@ std::string CMakeGenerator::compute_relative_path(const std::string& path, const
     }
 }
 
+// compiler_launcher as a CMake list: "ccache --foo" -> ccache;--foo
+static std::string launcher_list(const std::string& launcher) {
+    std::istringstream words(launcher);
+    std::string word;
+    std::string result;
+    while (words >> word) {
+        if (!result.empty()) result += ";";
+        result += word;
+    }
+    return result;
+}
+
 // Collect unique config names (without platform) from solution
 std::vector<std::string> CMakeGenerator::get_config_names(const Solution& solution) const {
     return solution.configurations;
@@ -888,6 +902,18 @@ void CMakeGenerator::write_target_properties(std::ostream& out, const Project& p
         props.push_back("POSITION_INDEPENDENT_CODE ON");
     }
 
+    // A launcher of its own (or none) instead of the solution's
+    if (project.compiler_launcher != solution.compiler_launcher) {
+        const std::string launcher = "\"" + launcher_list(project.compiler_launcher) + "\"";
+        props.push_back("C_COMPILER_LAUNCHER " + launcher);
+        props.push_back("CXX_COMPILER_LAUNCHER " + launcher);
+    }
+
+    if (project.unity_build) {
+        props.push_back("UNITY_BUILD ON");
+        props.push_back("UNITY_BUILD_BATCH_SIZE " + std::to_string(project.unity_batch_size));
+    }
+
     if (props.empty()) return;
 
     out << "\nset_target_properties(" << project.name << " PROPERTIES\n";
@@ -1018,7 +1044,20 @@ void CMakeGenerator::write_per_file_settings(std::ostream& out, const Project& p
             break;
         }
 
-        bool needs_props = !file_defines.empty() || excluded_all || !compile_as.empty();
+        // Sources with settings of their own stay out of unity TUs, as in
+        // the makefile generator
+        bool skip_unity = false;
+        if (project.unity_build) {
+            const FileSettings& settings = src.settings;
+            skip_unity = !settings.additional_includes.empty() || !settings.preprocessor_defines.empty() ||
+                         !settings.additional_options.empty() || !settings.object_file.empty() ||
+                         !settings.compile_as.empty() || !settings.optimization.empty();
+            for (const auto& [cfg_key, pch] : settings.pch) {
+                skip_unity = skip_unity || pch.mode == "NotUsing";
+            }
+        }
+
+        bool needs_props = !file_defines.empty() || excluded_all || !compile_as.empty() || skip_unity;
         if (!needs_props) continue;
 
         if (!has_settings) {
@@ -1041,6 +1080,10 @@ void CMakeGenerator::write_per_file_settings(std::ostream& out, const Project& p
             out << "\n    HEADER_FILE_ONLY TRUE";
         }
 
+        if (skip_unity) {
+            out << "\n    SKIP_UNITY_BUILD_INCLUSION ON";
+        }
+
         if (compile_as == "CompileAsC") {
             out << "\n    LANGUAGE C";
         } else if (compile_as == "CompileAsCpp") {
@@ -1220,11 +1263,7 @@ bool CMakeGenerator::generate_project_cmakelists(const Project& project, const S
                                                   const std::string& /*output_dir*/) {
     fs::path cmake_path = fs::path(project_dir) / "CMakeLists.txt";
 
-    std::ofstream out(cmake_path);
-    if (!out) {
-        std::cerr << "Error: Failed to create " << cmake_path << "\n";
-        return false;
-    }
+    OutputFile out(cmake_path);
 
     out << "# Auto-generated CMakeLists.txt for " << project.name << "\n";
     out << "# Generated by sighmake\n\n";
@@ -1273,6 +1312,11 @@ bool CMakeGenerator::generate_project_cmakelists(const Project& project, const S
     // Custom build rules
     write_custom_build_rules(out, project, project_dir);
 
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write " << cmake_path << "\n";
+        return false;
+    }
+
     std::cout << "  Generated: " << cmake_path << "\n";
     return true;
 }
@@ -1284,11 +1328,7 @@ bool CMakeGenerator::generate_project_cmakelists(const Project& project, const S
 bool CMakeGenerator::generate_root_cmakelists(const Solution& solution, const std::string& output_dir) {
     fs::path cmake_path = fs::path(output_dir) / "CMakeLists.txt";
 
-    std::ofstream out(cmake_path);
-    if (!out) {
-        std::cerr << "Error: Failed to create " << cmake_path << "\n";
-        return false;
-    }
+    OutputFile out(cmake_path);
 
     out << "# Auto-generated CMakeLists.txt for " << solution.name << "\n";
     out << "# Generated by sighmake\n\n";
@@ -1321,6 +1361,18 @@ bool CMakeGenerator::generate_root_cmakelists(const Solution& solution, const st
     if (!has_c && !has_cxx) out << " CXX"; // Default
     out << ")\n\n";
 
+    // Compiler launcher; a -D on the configure command line wins
+    if (!solution.compiler_launcher.empty()) {
+        const std::string launcher = "\"" + launcher_list(solution.compiler_launcher) + "\"";
+        out << "# Compiler launcher (override with -DCMAKE_<LANG>_COMPILER_LAUNCHER=...)\n";
+        for (const char* lang : {"C", "CXX"}) {
+            out << "if(NOT DEFINED CMAKE_" << lang << "_COMPILER_LAUNCHER)\n";
+            out << "    set(CMAKE_" << lang << "_COMPILER_LAUNCHER " << launcher << ")\n";
+            out << "endif()\n";
+        }
+        out << "\n";
+    }
+
     // Find packages
     if (!solution.found_packages.empty()) {
         out << "# External packages\n";
@@ -1332,33 +1384,17 @@ bool CMakeGenerator::generate_root_cmakelists(const Solution& solution, const st
         out << "\n";
     }
 
-    // Topological sort of projects
-    std::vector<const Project*> build_order;
-    std::set<std::string> visited;
-
-    std::function<void(const Project*)> visit = [&](const Project* p) {
-        if (visited.count(p->name)) return;
-        visited.insert(p->name);
-        for (const auto& dep : p->project_references) {
-            for (const auto& other : solution.projects) {
-                if (other.name == dep.name && !other.is_package_project) {
-                    visit(&other);
-                    break;
-                }
-            }
-        }
-        build_order.push_back(p);
-    };
-
-    for (const auto& proj : solution.projects) {
+    // Add subdirectories in dependency order
+    out << "# Projects (in dependency order)\n";
+    for (size_t index : solution.graph().topological_order()) {
+        const Project& proj = solution.projects[index];
         if (proj.is_package_project) continue;
-        visit(&proj);
+        out << "add_subdirectory(" << proj.name << ")\n";
     }
 
-    // Add subdirectories in dependency order
-    out << "# Projects (in dependency order)\n";
-    for (const auto* proj : build_order) {
-        out << "add_subdirectory(" << proj->name << ")\n";
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write " << cmake_path << "\n";
+        return false;
     }
 
     std::cout << "Generated root: " << cmake_path << "\n";
@@ -1417,6 +1453,7 @@ bool CMakeGenerator::generate(Solution& solution, const std::string& output_dir)
         cache.configurations = solution.configurations;
         cache.platforms = solution.platforms;
         cache.build_dir = "build";
+        cache.record_inputs(solution);
         cache.write(output_dir);
     }
 
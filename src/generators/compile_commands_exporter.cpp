@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "generators/compile_commands_exporter.hpp"
+#include "generators/makefile_generator.hpp"
+#include "common/output_file.hpp"
+#include "common/string_utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace vcxproj {
+
+namespace {
+
+// Appends a space-separated flag group, ignoring empty groups and trailing spaces
+void append_flags(std::string& command, const std::string& flags) {
+    std::string trimmed = trim(flags);
+    if (trimmed.empty()) return;
+    command += ' ';
+    command += trimmed;
+}
+
+// Gives the exporter access to the makefile generator's target planning so
+// the database always matches the flags of the generated build rules.
+class CompileCommandPlanner : public MakefileGenerator {
+public:
+    using MakefileGenerator::ProjectLookup;
+    using MakefileGenerator::TargetPlan;
+    using MakefileGenerator::CompileKind;
+    using MakefileGenerator::build_project_lookup;
+    using MakefileGenerator::find_makefile_config_key;
+    using MakefileGenerator::plan_target;
+};
+
+// Desktop (Linux/macOS) config key for config_name, falling back to a Windows
+// one so Windows-only solutions still get a database. Android configs depend
+// on make-time NDK variables and are never used.
+std::optional<std::string> find_config_key(const Project& project, const std::string& config_name) {
+    if (auto key = CompileCommandPlanner::find_makefile_config_key(project, config_name, false)) {
+        return key;
+    }
+    for (const auto& [config_key, config] : project.configurations) {
+        (void)config;
+        auto [name, platform] = parse_config_key(config_key);
+        if (name == config_name && !is_android_platform(platform)) {
+            return config_key;
+        }
+    }
+    return std::nullopt;
+}
+
+} // anonymous namespace
+
+bool export_compile_commands(const Solution& solution, const std::string& output_dir,
+                             const std::string& config_name) {
+    // Resolve the configuration (prefer Debug, otherwise the first one)
+    std::string config = config_name;
+    if (config.empty()) {
+        bool has_debug = std::find(solution.configurations.begin(), solution.configurations.end(),
+                                   "Debug") != solution.configurations.end();
+        if (has_debug || solution.configurations.empty()) {
+            config = "Debug";
+        } else {
+            config = solution.configurations.front();
+        }
+    } else if (!solution.configurations.empty() &&
+               std::find(solution.configurations.begin(), solution.configurations.end(), config) ==
+                   solution.configurations.end()) {
+        std::cerr << "Error: Configuration '" << config << "' not available for compile_commands.json.\n";
+        std::cerr << "  Available: ";
+        for (size_t i = 0; i < solution.configurations.size(); i++) {
+            if (i > 0) std::cerr << ", ";
+            std::cerr << solution.configurations[i];
+        }
+        std::cerr << "\n";
+        return false;
+    }
+
+    try {
+        if (!output_dir.empty() && !fs::exists(output_dir)) {
+            fs::create_directories(output_dir);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Failed to create output directory: " << e.what() << "\n";
+        return false;
+    }
+
+    // Paths are planned relative to build/, where the makefile and ninja
+    // generators run the compiler from
+    const fs::path build_dir = fs::absolute(fs::path(output_dir.empty() ? "." : output_dir) / "build")
+                                   .lexically_normal();
+    const std::string directory = build_dir.generic_string();
+
+    CompileCommandPlanner planner;
+    const auto project_lookup = CompileCommandPlanner::build_project_lookup(solution);
+
+#ifdef __APPLE__
+    const std::string cxx = "clang++";
+    const std::string cc = "clang";
+#else
+    const std::string cxx = "g++";
+    const std::string cc = "gcc";
+#endif
+
+    std::vector<std::string> entries;
+    for (const auto& project : solution.projects) {
+        if (project.is_package_project) continue;  // Skip synthetic find_package projects
+
+        auto config_key = find_config_key(project, config);
+        if (!config_key) continue;
+
+        CompileCommandPlanner::TargetPlan plan;
+        if (!planner.plan_target(project, *config_key, build_dir, project_lookup, plan)) {
+            return false;
+        }
+
+        for (const auto& step : plan.compile_steps) {
+            std::string command;
+            switch (step.kind) {
+                case CompileCommandPlanner::CompileKind::Cxx:
+                    command = cxx;
+                    append_flags(command, plan.cxxflags);
+                    break;
+                case CompileCommandPlanner::CompileKind::C:
+                    command = cc;
+                    append_flags(command, plan.cflags);
+                    break;
+                case CompileCommandPlanner::CompileKind::ObjCxx:
+                    command = cxx;
+                    append_flags(command, plan.cxxflags);
+                    append_flags(command, plan.objcxx_extra_flags);
+                    break;
+                default:
+                    continue;  // NASM and unknown files are not indexed
+            }
+            append_flags(command, step.file_flags);
+
+            // The build force-includes the precompiled header through its .gch;
+            // indexers get the header itself, which exists without a build
+            if (step.uses_pch && !plan.pch_header_path.empty()) {
+                command += " -include \"" + plan.pch_header_path + "\"";
+            }
+
+            // A unity TU is listed as the sources it batches, with its flags,
+            // so indexers find an entry for each real file
+            std::vector<std::string> sources = {step.source};
+            for (const auto& unity : plan.unity_sources) {
+                if (unity.path == step.source) {
+                    sources = unity.sources;
+                    break;
+                }
+            }
+
+            for (const auto& source : sources) {
+                const std::string file = (build_dir / source).lexically_normal().generic_string();
+                const std::string source_command = command + " -c -o " + step.object + " " + source;
+
+                std::string entry;
+                entry += "  {\n";
+                entry += "    \"directory\": \"" + escape_json(directory) + "\",\n";
+                entry += "    \"command\": \"" + escape_json(source_command) + "\",\n";
+                entry += "    \"file\": \"" + escape_json(file) + "\",\n";
+                entry += "    \"output\": \"" + escape_json(step.object) + "\"\n";
+                entry += "  }";
+                entries.push_back(std::move(entry));
+            }
+        }
+    }
+
+    fs::path out_path = fs::path(output_dir) / "compile_commands.json";
+    OutputFile out(out_path);
+
+    out << "[\n";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        out << entries[i] << (i + 1 < entries.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write " << out_path.string() << "\n";
+        return false;
+    }
+
+    std::cout << "Generated: " << out_path.string() << " (" << config << ", "
+              << entries.size() << " entries)\n";
+    return true;
+}
+
+} // namespace vcxproj
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "common/project_types.hpp"
+
+namespace vcxproj {
+
+// Exports a clang compilation database (compile_commands.json) for one
+// configuration of a Solution, using the same GCC/Clang flags as the makefile
+// generator. Output file: compile_commands.json in the output directory.
+// An empty config_name selects Debug (or the first configuration).
+// Returns true on success, false on failure.
+bool export_compile_commands(const Solution& solution, const std::string& output_dir,
+                             const std::string& config_name = "");
+
+} // namespace vcxproj
@@ -1,6 +1,11 @@
 #include "pch.h"
 #include "generators/deps_exporter.hpp"
 #include "common/config_type_utils.hpp"
+#include "common/project_graph.hpp"
+#include "common/output_file.hpp"
+#include "common/string_utils.hpp"
+
+#include <iomanip>
 
 namespace fs = std::filesystem;
 
@@ -29,6 +34,57 @@ std::string get_project_type(const Project& proj) {
     return proj.configurations.begin()->second.config_type;
 }
 
+// Weights are whole numbers except for build times
+std::string format_weight(double weight, const std::string& unit) {
+    std::ostringstream out;
+    if (unit == "seconds") {
+        out << std::fixed << std::setprecision(2) << weight;
+    } else {
+        out << static_cast<long long>(weight + 0.5);
+    }
+    return out.str();
+}
+
+size_t compiled_source_count(const Project& proj) {
+    size_t count = 0;
+    for (const auto& src : proj.sources) {
+        if (src.type == FileType::ClCompile || src.type == FileType::ObjCxx ||
+            src.type == FileType::MASM || src.type == FileType::NASM) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Seconds per makefile from a `sighmake --build --trace` file. Every sub-make
+// is one event of category "make" named after its makefile
+// (<project>.<config>[.Android]); a makefile run more than once adds up.
+std::map<std::string, double> read_makefile_build_times(const std::string& path) {
+    std::map<std::string, double> times;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("\"cat\": \"make\"") == std::string::npos) continue;
+
+        const std::string name_key = "\"name\": \"";
+        const std::string dur_key = "\"dur\": ";
+        size_t name_pos = line.find(name_key);
+        size_t dur_pos = line.find(dur_key);
+        if (name_pos == std::string::npos || dur_pos == std::string::npos) continue;
+
+        std::string name;
+        for (size_t i = name_pos + name_key.size(); i < line.size() && line[i] != '"'; ++i) {
+            if (line[i] == '\\' && i + 1 < line.size()) ++i;
+            name += line[i];
+        }
+        try {
+            times[name] += std::stod(line.substr(dur_pos + dur_key.size())) / 1e6;
+        } catch (const std::exception&) {
+        }
+    }
+    return times;
+}
+
 void write_css(std::ofstream& out) {
     out << "<style>\n";
     out << R"(  * { box-sizing: border-box; margin: 0; padding: 0; }
@@ -75,6 +131,17 @@ void write_css(std::ofstream& out) {
   .legend { display: flex; gap: 1.5rem; flex-wrap: wrap; margin: 0.75rem 0; font-size: 0.85rem; }
   .legend-item { display: flex; align-items: center; gap: 0.3rem; }
   .legend-swatch { width: 14px; height: 14px; border-radius: 3px; border: 1px solid #ccc; }
+  .stats { display: flex; gap: 1rem; flex-wrap: wrap; margin: 0.75rem 0; }
+  .stat { background: #fff; border-radius: 8px; padding: 0.6rem 1rem; min-width: 9rem;
+          box-shadow: 0 1px 3px rgba(0,0,0,0.1); }
+  .stat .value { font-size: 1.4rem; font-weight: 600; }
+  .stat .label { font-size: 0.8rem; color: #666; }
+  table.report { border-collapse: collapse; font-size: 0.85rem; margin: 0.5rem 0 1rem; background: #fff; }
+  table.report th, table.report td { border: 1px solid #ddd; padding: 0.3rem 0.6rem; text-align: left; }
+  table.report th { background: #f0f0f0; font-weight: 600; }
+  table.report td.num { text-align: right; }
+  table.report tr.critical td { background: #FFF3E0; }
+  .bar { display: inline-block; height: 0.8rem; background: #2196F3; border-radius: 2px; vertical-align: middle; }
   footer { margin-top: 2rem; padding-top: 1rem; border-top: 1px solid #ddd;
            color: #999; font-size: 0.8rem; }
 )";
@@ -134,44 +201,247 @@ void write_dependency_matrix(std::ofstream& out, const Solution& solution) {
     out << "</tr>\n";
 
     // Data rows
+    const ProjectGraph& graph = solution.graph();
+    std::vector<const DependencyVisibility*> row_deps(solution.projects.size(), nullptr);
     for (size_t row = 0; row < solution.projects.size(); ++row) {
         const auto& proj = solution.projects[row];
         out << "  <tr><th class=\"row-header\">" << escape_html(proj.name) << "</th>";
 
-        // Build lookup for this project's dependencies
-        std::map<std::string, DependencyVisibility> dep_map;
-        for (const auto& dep : proj.project_references) {
-            dep_map[dep.name] = dep.visibility;
+        // Visibility of this project's dependencies by column (a repeated
+        // reference keeps its last visibility)
+        for (const auto& edge : graph.dependencies(row)) {
+            row_deps[edge.project] = &proj.project_references[edge.reference].visibility;
         }
 
         for (size_t col = 0; col < solution.projects.size(); ++col) {
             if (row == col) {
                 out << "<td class=\"dep-self\">&mdash;</td>";
+            } else if (const DependencyVisibility* visibility = row_deps[col]) {
+                std::string vis_str = visibility_to_string(*visibility);
+                std::string css;
+                if (*visibility == DependencyVisibility::PUBLIC)         css = "dep-pub";
+                else if (*visibility == DependencyVisibility::PRIVATE)   css = "dep-priv";
+                else if (*visibility == DependencyVisibility::INTERFACE) css = "dep-iface";
+                out << "<td class=\"" << css << "\">" << vis_str.substr(0, 3) << "</td>";
             } else {
-                const std::string& col_name = solution.projects[col].name;
-                auto it = dep_map.find(col_name);
-                if (it != dep_map.end()) {
-                    std::string vis_str = visibility_to_string(it->second);
-                    std::string css;
-                    if (it->second == DependencyVisibility::PUBLIC)         css = "dep-pub";
-                    else if (it->second == DependencyVisibility::PRIVATE)   css = "dep-priv";
-                    else if (it->second == DependencyVisibility::INTERFACE) css = "dep-iface";
-                    out << "<td class=\"" << css << "\">" << vis_str.substr(0, 3) << "</td>";
-                } else {
-                    out << "<td class=\"dep-none\"></td>";
-                }
+                out << "<td class=\"dep-none\"></td>";
             }
         }
         out << "</tr>\n";
+
+        for (const auto& edge : graph.dependencies(row)) {
+            row_deps[edge.project] = nullptr;
+        }
     }
 
     out << "</table>\n";
     out << "</div>\n";
 }
 
+void write_critical_path(std::ofstream& out, const DependencyAnalysis& analysis) {
+    if (analysis.projects.empty()) return;
+    const std::string& unit = analysis.weight_unit;
+
+    out << "<h2>Critical Path &amp; Parallelism</h2>\n";
+    out << "<p style=\"font-size:0.85rem;color:#666;\">Projects weighted by " << escape_html(unit)
+        << ". A project's level is its longest chain of dependencies; projects of one level can build"
+        << " in parallel once the levels below are done.</p>\n";
+
+    std::ostringstream parallelism;
+    parallelism << std::fixed << std::setprecision(2) << analysis.parallelism();
+    size_t max_width = 0;
+    for (size_t width : analysis.level_widths) max_width = std::max(max_width, width);
+
+    out << "<div class=\"stats\">\n";
+    const std::pair<std::string, std::string> stats[] = {
+        {std::to_string(analysis.level_widths.size()), "levels (depth)"},
+        {std::to_string(max_width), "widest level"},
+        {format_weight(analysis.critical_weight, unit), "critical path (" + unit + ")"},
+        {format_weight(analysis.total_weight, unit), "total (" + unit + ")"},
+        {parallelism.str(), "average parallelism"},
+    };
+    for (const auto& [value, label] : stats) {
+        out << "  <div class=\"stat\"><div class=\"value\">" << escape_html(value)
+            << "</div><div class=\"label\">" << escape_html(label) << "</div></div>\n";
+    }
+    out << "</div>\n";
+
+    out << "<h3>Longest chain</h3>\n";
+    out << "<table class=\"report\">\n";
+    out << "  <tr><th>Level</th><th>Project</th><th>Weight</th><th>Cumulative</th></tr>\n";
+    for (size_t index : analysis.critical_path) {
+        const auto& node = analysis.projects[index];
+        out << "  <tr><td class=\"num\">" << node.level << "</td><td>" << escape_html(node.name)
+            << "</td><td class=\"num\">" << format_weight(node.weight, unit)
+            << "</td><td class=\"num\">" << format_weight(node.finish, unit) << "</td></tr>\n";
+    }
+    out << "</table>\n";
+
+    out << "<h3>Width per level</h3>\n";
+    out << "<table class=\"report\">\n";
+    out << "  <tr><th>Level</th><th>Projects</th><th></th></tr>\n";
+    for (size_t level = 0; level < analysis.level_widths.size(); ++level) {
+        const size_t width = analysis.level_widths[level];
+        out << "  <tr><td class=\"num\">" << level << "</td><td class=\"num\">" << width
+            << "</td><td><span class=\"bar\" style=\"width:" << (width * 240 / std::max<size_t>(max_width, 1))
+            << "px\"></span></td></tr>\n";
+    }
+    out << "</table>\n";
+
+    if (!analysis.fan_in.empty()) {
+        out << "<h3>Highest fan-in</h3>\n";
+        out << "<table class=\"report\">\n";
+        out << "  <tr><th>Project</th><th>Direct dependents</th><th>All dependents</th><th>Level</th></tr>\n";
+        for (size_t index : analysis.fan_in) {
+            const auto& node = analysis.projects[index];
+            out << "  <tr" << (node.critical ? " class=\"critical\"" : "") << "><td>" << escape_html(node.name)
+                << "</td><td class=\"num\">" << node.dependents << "</td><td class=\"num\">"
+                << node.transitive_dependents << "</td><td class=\"num\">" << node.level << "</td></tr>\n";
+        }
+        out << "</table>\n";
+        out << "<p style=\"font-size:0.85rem;color:#666;\">Highlighted projects are on the critical path.</p>\n";
+    }
+}
+
 } // anonymous namespace
 
-bool export_dependencies_html(const Solution& solution, const std::string& output_dir) {
+DependencyAnalysis analyze_dependencies(const Solution& solution, const DependencyReportOptions& options) {
+    const ProjectGraph& graph = solution.graph();
+    const size_t count = solution.projects.size();
+    constexpr size_t npos = ProjectGraph::npos;
+
+    DependencyAnalysis analysis;
+    std::vector<size_t> node_of(count, npos);
+    for (size_t i = 0; i < count; ++i) {
+        if (solution.projects[i].is_package_project) continue;
+        node_of[i] = analysis.projects.size();
+        analysis.projects.emplace_back();
+        analysis.projects.back().name = solution.projects[i].name;
+    }
+    auto& nodes = analysis.projects;
+
+    DependencyWeight weight = options.weight;
+    std::vector<double> build_times(nodes.size(), 0.0);
+    if (weight == DependencyWeight::BuildTime) {
+        bool found = false;
+        for (const auto& [makefile, seconds] : read_makefile_build_times(options.trace_file)) {
+            // Strip ".<config>" and then ".Android" until a project matches
+            std::string name = makefile;
+            for (int strip = 0; strip < 2; ++strip) {
+                size_t dot = name.rfind('.');
+                if (dot == std::string::npos) break;
+                name.erase(dot);
+                size_t index = graph.find(name);
+                if (index != npos && node_of[index] != npos) {
+                    build_times[node_of[index]] += seconds;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) {
+            std::cerr << "Warning: No project build times found in " << options.trace_file
+                      << "; weighting projects equally.\n";
+            weight = DependencyWeight::Projects;
+        }
+    }
+    analysis.weight_unit = weight == DependencyWeight::Sources ? "sources"
+                         : weight == DependencyWeight::BuildTime ? "seconds" : "projects";
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t n = node_of[i];
+        if (n == npos) continue;
+        if (weight == DependencyWeight::Sources) {
+            nodes[n].weight = static_cast<double>(compiled_source_count(solution.projects[i]));
+        } else if (weight == DependencyWeight::BuildTime) {
+            nodes[n].weight = build_times[n];
+        } else {
+            nodes[n].weight = 1.0;
+        }
+        analysis.total_weight += nodes[n].weight;
+
+        for (size_t dependent : graph.dependents(i)) {
+            if (node_of[dependent] != npos) nodes[n].dependents++;
+        }
+    }
+
+    // Levels and heaviest chains, dependencies first. A reference that closes
+    // a cycle points at a project that is not done yet and is ignored.
+    std::vector<bool> done(count, false);
+    std::vector<size_t> seen(count, npos);
+    std::vector<size_t> heaviest_dependency(nodes.size(), npos);
+    for (size_t i : graph.topological_order()) {
+        done[i] = true;
+        const size_t n = node_of[i];
+        if (n == npos) continue;
+        auto& node = nodes[n];
+        for (const auto& edge : graph.dependencies(i)) {
+            const size_t d = node_of[edge.project];
+            if (d == npos || seen[edge.project] == i || edge.project == i) continue;
+            seen[edge.project] = i;
+            node.dependencies++;
+            if (!done[edge.project]) continue;
+            node.level = std::max(node.level, nodes[d].level + 1);
+            if (heaviest_dependency[n] == npos || nodes[d].finish > nodes[heaviest_dependency[n]].finish) {
+                heaviest_dependency[n] = d;
+            }
+        }
+        node.finish = node.weight + (heaviest_dependency[n] == npos ? 0.0 : nodes[heaviest_dependency[n]].finish);
+
+        if (analysis.level_widths.size() <= node.level) analysis.level_widths.resize(node.level + 1, 0);
+        analysis.level_widths[node.level]++;
+    }
+
+    // The critical path ends at the heaviest chain (first in solution order on ties)
+    size_t end = npos;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (end == npos || nodes[n].finish > nodes[end].finish) end = n;
+    }
+    for (size_t n = end; n != npos; n = heaviest_dependency[n]) {
+        nodes[n].critical = true;
+        analysis.critical_path.push_back(n);
+    }
+    std::reverse(analysis.critical_path.begin(), analysis.critical_path.end());
+    if (end != npos) analysis.critical_weight = nodes[end].finish;
+
+    // Everything that waits on a project: union of its dependents' sets,
+    // collected dependents first (reverse topological order)
+    const size_t words = (nodes.size() + 63) / 64;
+    std::vector<uint64_t> waiting(nodes.size() * words, 0);
+    const auto& order = graph.topological_order();
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const size_t n = node_of[*it];
+        if (n == npos) continue;
+        uint64_t* bits = &waiting[n * words];
+        for (size_t dependent : graph.dependents(*it)) {
+            const size_t d = node_of[dependent];
+            if (d == npos || d == n) continue;
+            const uint64_t* other = &waiting[d * words];
+            for (size_t w = 0; w < words; ++w) bits[w] |= other[w];
+            bits[d / 64] |= uint64_t(1) << (d % 64);
+        }
+        bits[n / 64] &= ~(uint64_t(1) << (n % 64));
+        size_t total = 0;
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t value = bits[w]; value; value &= value - 1) ++total;
+        }
+        nodes[n].transitive_dependents = total;
+    }
+
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (nodes[n].dependents > 0) analysis.fan_in.push_back(n);
+    }
+    std::stable_sort(analysis.fan_in.begin(), analysis.fan_in.end(), [&](size_t a, size_t b) {
+        if (nodes[a].dependents != nodes[b].dependents) return nodes[a].dependents > nodes[b].dependents;
+        return nodes[a].transitive_dependents > nodes[b].transitive_dependents;
+    });
+    if (analysis.fan_in.size() > 10) analysis.fan_in.resize(10);
+
+    return analysis;
+}
+
+bool export_dependencies_html(const Solution& solution, const std::string& output_dir,
+                              const DependencyReportOptions& options) {
     fs::path out_path = fs::path(output_dir) / (solution.name + "_dependencies.html");
 
     std::ofstream out(out_path);
@@ -220,6 +490,7 @@ bool export_dependencies_html(const Solution& solution, const std::string& outpu
 
     write_project_cards(out, solution);
     write_dependency_matrix(out, solution);
+    write_critical_path(out, analyze_dependencies(solution, options));
 
     out << "<footer>Generated by sighmake --export-deps</footer>\n";
     out << "</body>\n";
@@ -235,4 +506,74 @@ bool export_dependencies_html(const Solution& solution, const std::string& outpu
     return true;
 }
 
+bool export_dependencies_json(const Solution& solution, const std::string& output_dir,
+                              const DependencyReportOptions& options) {
+    const DependencyAnalysis analysis = analyze_dependencies(solution, options);
+    const std::string& unit = analysis.weight_unit;
+    const ProjectGraph& graph = solution.graph();
+
+    fs::path out_path = fs::path(output_dir) / (solution.name + "_dependencies.json");
+    OutputFile out(out_path);
+
+    const auto name_list = [&](const std::vector<size_t>& indices) {
+        std::string result = "[";
+        for (size_t i = 0; i < indices.size(); ++i) {
+            result += (i > 0 ? ", \"" : "\"") + escape_json(analysis.projects[indices[i]].name) + "\"";
+        }
+        return result + "]";
+    };
+
+    out << "{\n";
+    out << "  \"solution\": \"" << escape_json(solution.name) << "\",\n";
+    out << "  \"weight\": \"" << unit << "\",\n";
+    out << "  \"depth\": " << analysis.level_widths.size() << ",\n";
+    out << "  \"level_widths\": [";
+    for (size_t level = 0; level < analysis.level_widths.size(); ++level) {
+        out << (level > 0 ? ", " : "") << analysis.level_widths[level];
+    }
+    out << "],\n";
+    out << "  \"total_weight\": " << format_weight(analysis.total_weight, unit) << ",\n";
+    out << "  \"critical_weight\": " << format_weight(analysis.critical_weight, unit) << ",\n";
+    out << "  \"parallelism\": " << std::fixed << std::setprecision(2) << analysis.parallelism() << ",\n";
+    out.unsetf(std::ios::floatfield);
+    out << "  \"critical_path\": " << name_list(analysis.critical_path) << ",\n";
+    out << "  \"fan_in\": " << name_list(analysis.fan_in) << ",\n";
+    out << "  \"projects\": [";
+
+    size_t n = 0;
+    for (size_t i = 0; i < solution.projects.size(); ++i) {
+        const auto& proj = solution.projects[i];
+        if (proj.is_package_project) continue;
+        const auto& node = analysis.projects[n++];
+
+        out << (n > 1 ? ",\n" : "\n");
+        out << "    {\"name\": \"" << escape_json(node.name) << "\", \"type\": \""
+            << escape_json(config_type::label(get_project_type(proj))) << "\", \"level\": " << node.level
+            << ", \"weight\": " << format_weight(node.weight, unit)
+            << ", \"finish\": " << format_weight(node.finish, unit)
+            << ", \"dependents\": " << node.dependents
+            << ", \"transitive_dependents\": " << node.transitive_dependents
+            << ", \"critical\": " << (node.critical ? "true" : "false") << ",\n";
+        out << "     \"dependencies\": [";
+        bool first = true;
+        for (const auto& edge : graph.dependencies(i)) {
+            const auto& dep = proj.project_references[edge.reference];
+            if (solution.projects[edge.project].is_package_project) continue;
+            out << (first ? "" : ", ") << "{\"name\": \"" << escape_json(dep.name)
+                << "\", \"visibility\": \"" << visibility_to_string(dep.visibility) << "\"}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write dependency report: " << out_path.string() << "\n";
+        return false;
+    }
+
+    std::cout << "Dependency report: " << out_path.string() << "\n";
+    return true;
+}
+
 } // namespace vcxproj
@@ -4,9 +4,59 @@
 
 namespace vcxproj {
 
+// What one project costs when looking for the critical path
+enum class DependencyWeight {
+    Projects,   // every project costs 1
+    Sources,    // number of compiled source files
+    BuildTime   // seconds per project from a `sighmake --build --trace` file
+};
+
+struct DependencyReportOptions {
+    DependencyWeight weight = DependencyWeight::Projects;
+    std::string trace_file;  // Used with DependencyWeight::BuildTime
+};
+
+// Critical-path and parallelism figures for a solution's project graph.
+// Package projects from find_package() are left out. A project's level is
+// the length of its longest dependency chain (0 = no dependencies), so every
+// project of one level can build at the same time once the lower levels
+// are done.
+struct DependencyAnalysis {
+    struct Node {
+        std::string name;
+        size_t level = 0;
+        double weight = 0.0;
+        double finish = 0.0;               // Weight of the heaviest chain ending here
+        size_t dependencies = 0;
+        size_t dependents = 0;             // Direct fan-in
+        size_t transitive_dependents = 0;  // Projects that wait on this one
+        bool critical = false;
+    };
+
+    std::string weight_unit;             // "projects", "sources" or "seconds"
+    std::vector<Node> projects;          // Solution order
+    std::vector<size_t> level_widths;    // Projects per level
+    std::vector<size_t> critical_path;   // Indices into projects, first to build first
+    std::vector<size_t> fan_in;          // Indices into projects, highest fan-in first
+    double total_weight = 0.0;
+    double critical_weight = 0.0;
+
+    // Average number of projects busy if the critical path were the only limit
+    double parallelism() const { return critical_weight > 0.0 ? total_weight / critical_weight : 0.0; }
+};
+
+DependencyAnalysis analyze_dependencies(const Solution& solution,
+                                        const DependencyReportOptions& options = {});
+
 // Exports the dependency graph of a Solution as a self-contained HTML file.
 // Output file: <solution_name>_dependencies.html in the output directory.
 // Returns true on success, false on failure.
-bool export_dependencies_html(const Solution& solution, const std::string& output_dir);
+bool export_dependencies_html(const Solution& solution, const std::string& output_dir,
+                              const DependencyReportOptions& options = {});
+
+// Exports the same graph and its critical-path analysis as JSON.
+// Output file: <solution_name>_dependencies.json in the output directory.
+bool export_dependencies_json(const Solution& solution, const std::string& output_dir,
+                              const DependencyReportOptions& options = {});
 
 } // namespace vcxproj
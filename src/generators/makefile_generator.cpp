@@ -1,28 +1,49 @@
 #include "pch.h"
 #include "makefile_generator.hpp"
 #include "common/build_cache.hpp"
+#include "common/output_file.hpp"
+#include "common/parallel.hpp"
 #include "common/string_utils.hpp"
 #include "common/file_types.hpp"
 #include "common/compiler_flags.hpp"
 #include "common/language_standards.hpp"
 
+#include <limits>
+
 namespace vcxproj {
 
 namespace {
 
-std::map<std::string, const Project*> build_project_lookup(const Solution& solution) {
-    std::map<std::string, const Project*> lookup;
-    for (const auto& project : solution.projects) {
-        if (!project.is_package_project) {
-            lookup[project.name] = &project;
+// Quote a word for /bin/sh inside a make recipe
+std::string quote_recipe_word(const std::string& word) {
+    std::string result = "'";
+    for (char c : word) {
+        if (c == '\'') {
+            result += "'\\''";
+        } else if (c == '$') {
+            result += "$$";
+        } else {
+            result += c;
         }
     }
-    return lookup;
+    result += "'";
+    return result;
 }
 
-const Project* find_project(const std::map<std::string, const Project*>& lookup, const std::string& name) {
-    auto it = lookup.find(name);
-    return it != lookup.end() ? it->second : nullptr;
+// Escape a path for use as a make target or prerequisite
+std::string escape_make_prerequisite(const std::string& path) {
+    std::string result;
+    for (char c : path) {
+        if (c == ' ' || c == '#') {
+            result += '\\';
+            result += c;
+        } else if (c == '$') {
+            result += "$$";
+        } else {
+            result += c;
+        }
+    }
+    return result;
 }
 
 template <typename T>
@@ -58,34 +79,6 @@ constexpr const char* ANDROID_HOST_TAG =
     "linux-x86_64";
 #endif
 
-std::string make_project_config_target(const Project& project, const std::string& config_name,
-                                       bool android = false) {
-    return project.name + "." + config_name + (android ? ".Android" : "");
-}
-
-// Find a config key the makefile generator can build for this config name.
-// android=true selects Android configs; android=false selects the other
-// non-Windows configs (Linux/macOS). They get separate makefiles so a solution
-// can target both without the outputs colliding.
-std::optional<std::string> find_makefile_config_key(const Project& project, const std::string& config_name,
-                                                    bool android) {
-    for (const auto& [config_key, config] : project.configurations) {
-        (void)config;
-        size_t pipe_pos = config_key.find('|');
-        std::string cfg = pipe_pos != std::string::npos
-            ? config_key.substr(0, pipe_pos)
-            : config_key;
-        std::string platform = pipe_pos != std::string::npos
-            ? config_key.substr(pipe_pos + 1)
-            : "";
-        if (cfg == config_name && !is_windows_platform(platform) &&
-            is_android_platform(platform) == android) {
-            return config_key;
-        }
-    }
-    return std::nullopt;
-}
-
 // Android loaders (System.loadLibrary, APK packaging) require the "lib" prefix
 // on shared libraries.
 std::string decorate_target_name(const std::string& name, const std::string& config_type, bool android) {
@@ -183,6 +176,46 @@ bool has_extension_case_insensitive(const std::string& path, const std::string&
 
 } // namespace
 
+const Project* MakefileGenerator::ProjectLookup::find(const std::string& name) const {
+    size_t index = graph_->find(name);
+    if (index == ProjectGraph::npos) return nullptr;
+    const Project& project = solution_->projects[index];
+    return project.is_package_project ? nullptr : &project;
+}
+
+MakefileGenerator::ProjectLookup MakefileGenerator::build_project_lookup(const Solution& solution) {
+    return ProjectLookup(solution);
+}
+
+std::string MakefileGenerator::make_project_config_target(const Project& project, const std::string& config_name,
+                                                          bool android) {
+    return project.name + "." + config_name + (android ? ".Android" : "");
+}
+
+// Find a config key the makefile generator can build for this config name.
+// android=true selects Android configs; android=false selects the other
+// non-Windows configs (Linux/macOS). They get separate makefiles so a solution
+// can target both without the outputs colliding.
+std::optional<std::string> MakefileGenerator::find_makefile_config_key(const Project& project,
+                                                                       const std::string& config_name,
+                                                                       bool android) {
+    for (const auto& [config_key, config] : project.configurations) {
+        (void)config;
+        size_t pipe_pos = config_key.find('|');
+        std::string cfg = pipe_pos != std::string::npos
+            ? config_key.substr(0, pipe_pos)
+            : config_key;
+        std::string platform = pipe_pos != std::string::npos
+            ? config_key.substr(pipe_pos + 1)
+            : "";
+        if (cfg == config_name && !is_windows_platform(platform) &&
+            is_android_platform(platform) == android) {
+            return config_key;
+        }
+    }
+    return std::nullopt;
+}
+
 // Convert Windows path to Unix path (backslash to forward slash)
 std::string MakefileGenerator::to_unix_path(const std::string& path) {
     std::string result = path;
@@ -406,6 +439,42 @@ std::string MakefileGenerator::get_compiler_flags(const Configuration& config, c
     return ss.str();
 }
 
+// Get per-file compiler flag overrides (optimization, includes, defines, options)
+std::string MakefileGenerator::get_file_compiler_flags(const SourceFile& src, const std::string& config_key,
+                                                        const std::filesystem::path& makefile_dir) {
+    std::stringstream ss;
+
+    if (const auto* opt = find_config_setting(src.settings.optimization, config_key); opt && !opt->empty()) {
+        ss << flags::optimization_to_gnu_flag(*opt) << " ";
+    }
+
+    if (const auto* includes = find_config_setting(src.settings.additional_includes, config_key)) {
+        for (const auto& inc : *includes) {
+            for (const auto& part : split_semicolons(inc)) {
+                ss << "-I\"" << compute_relative_path(part, makefile_dir) << "\" ";
+            }
+        }
+    }
+
+    if (const auto* defines = find_config_setting(src.settings.preprocessor_defines, config_key)) {
+        for (const auto& def : *defines) {
+            ss << "-D" << def << " ";
+        }
+    }
+
+    if (const auto* options = find_config_setting(src.settings.additional_options, config_key)) {
+        for (const auto& opt : *options) {
+            ss << opt << " ";
+        }
+    }
+
+    std::string result = ss.str();
+    if (!result.empty()) {
+        result.pop_back();  // Trailing space
+    }
+    return result;
+}
+
 // Get linker flags (library directories)
 std::string MakefileGenerator::get_linker_flags(const Configuration& config, const std::filesystem::path& makefile_dir,
                                                 bool android) {
@@ -497,18 +566,11 @@ std::string MakefileGenerator::get_linker_libs(const Configuration& config) {
     return ss.str();
 }
 
-// Generate a single Makefile for a project and configuration
-bool MakefileGenerator::generate_makefile(const Project& project, const Solution& solution,
-                                         const std::string& config_key, const std::string& output_path) {
-    auto project_lookup = build_project_lookup(solution);
-    return generate_makefile_with_lookup(project, solution, config_key, output_path, project_lookup);
-}
-
-bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, const Solution& solution,
-                                                      const std::string& config_key, const std::string& output_path,
-                                                      const MakefileGenerator::ProjectLookup& project_lookup) {
+bool MakefileGenerator::plan_target(const Project& project, const std::string& config_key,
+                                    const std::filesystem::path& build_file_dir,
+                                    const MakefileGenerator::ProjectLookup& project_lookup,
+                                    TargetPlan& plan) {
     namespace fs = std::filesystem;
-    (void)solution;
 
     // Get configuration
     auto it = project.configurations.find(config_key);
@@ -530,6 +592,9 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
     }
 
     const bool android = is_android_platform(platform);
+    plan.config_key = config_key;
+    plan.config_name = config_name;
+    plan.android = android;
 
     // Determine target name and extension
     std::string target_name = decorate_target_name(
@@ -560,11 +625,7 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
         target_ext = "";
     }
 
-    // Get the directory containing the makefile for computing relative paths
-    fs::path makefile_dir = fs::path(output_path).parent_path();
-    if (makefile_dir.empty()) {
-        makefile_dir = ".";
-    }
+    const fs::path& makefile_dir = build_file_dir;
 
     // Output and intermediate directories - convert to relative paths
     std::string out_dir = compute_relative_path(
@@ -577,118 +638,44 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
     if (!int_dir.empty() && int_dir.back() != '/') int_dir += '/';
 
     // Full target path
-    std::string target = out_dir + target_name + target_ext;
-
-    // Open output file
-    std::ofstream out(output_path);
-    if (!out) {
-        std::cerr << "Error: Failed to create Makefile: " << output_path << "\n";
-        return false;
-    }
-
-    // Write header
-    out << "# Auto-generated Makefile for " << project.name << " (" << config_name
-        << (android ? ", Android" : "") << ")\n";
-    out << "# Generated by sighmake\n\n";
+    plan.out_dir = out_dir;
+    plan.int_dir = int_dir;
+    plan.target = out_dir + target_name + target_ext;
 
     // Determine compiler
-    bool has_cpp_files = false;
-    bool has_c_files = false;
-    bool has_objcxx_files = false;
-    bool has_nasm_files = false;
     for (const auto& src : project.sources) {
         if (src.type == FileType::ClCompile) {
             std::string ext = file_types::lowercase_extension(src.path);
             if (file_types::is_cpp_source(ext)) {
-                has_cpp_files = true;
+                plan.has_cpp_files = true;
             } else if (file_types::is_c_source(ext)) {
-                has_c_files = true;
+                plan.has_c_files = true;
             }
         } else if (src.type == FileType::ObjCxx) {
-            has_objcxx_files = true;
+            plan.has_objcxx_files = true;
         } else if (src.type == FileType::NASM) {
-            has_nasm_files = true;
+            plan.has_nasm_files = true;
         }
     }
 
-    const bool links_binary = config.config_type == "Application" ||
-                              config.config_type == "DynamicLibrary" ||
-                              config.config_type == "Driver";
-    const bool links_with_cxx = has_cpp_files || has_objcxx_files;
-
-    // Compiler variables
-    if (android) {
-        // Android NDK toolchain. The --target wrappers are what the NDK's own
-        // clang launcher scripts do, but calling clang directly works on every
-        // host OS (the .cmd wrappers are Windows-only, the bare ones POSIX-only).
-        out << "# Android NDK toolchain (requires NDK r19 or newer)\n";
-        out << "# Override at build time, e.g.: make ANDROID_ABI=x86_64 ANDROID_API=26\n";
-        out << "ANDROID_ABI ?= arm64-v8a\n";
-        out << "ANDROID_API ?= 24\n";
-        out << "ifeq ($(strip $(ANDROID_NDK_HOME)),)\n";
-        out << "  ANDROID_NDK_HOME := $(ANDROID_NDK_ROOT)\n";
-        out << "endif\n";
-        out << "ifeq ($(strip $(ANDROID_NDK_HOME)),)\n";
-        out << "  ifneq ($(MAKECMDGOALS),clean)\n";
-        out << "    $(error ANDROID_NDK_HOME is not set. Point it at your Android NDK installation)\n";
-        out << "  endif\n";
-        out << "endif\n";
-        out << "ifeq ($(ANDROID_ABI),arm64-v8a)\n";
-        out << "  ANDROID_TRIPLE := aarch64-linux-android\n";
-        out << "else ifeq ($(ANDROID_ABI),armeabi-v7a)\n";
-        out << "  ANDROID_TRIPLE := armv7a-linux-androideabi\n";
-        out << "else ifeq ($(ANDROID_ABI),x86_64)\n";
-        out << "  ANDROID_TRIPLE := x86_64-linux-android\n";
-        out << "else ifeq ($(ANDROID_ABI),x86)\n";
-        out << "  ANDROID_TRIPLE := i686-linux-android\n";
-        out << "else\n";
-        out << "  $(error Unsupported ANDROID_ABI '$(ANDROID_ABI)'. Supported: arm64-v8a, armeabi-v7a, x86_64, x86)\n";
-        out << "endif\n";
-        out << "ANDROID_TOOLCHAIN := $(ANDROID_NDK_HOME)/toolchains/llvm/prebuilt/"
-            << ANDROID_HOST_TAG << "/bin\n";
-        out << "CXX = \"$(ANDROID_TOOLCHAIN)/clang++\" --target=$(ANDROID_TRIPLE)$(ANDROID_API)\n";
-        out << "CC = \"$(ANDROID_TOOLCHAIN)/clang\" --target=$(ANDROID_TRIPLE)$(ANDROID_API)\n";
-        out << "AR = \"$(ANDROID_TOOLCHAIN)/llvm-ar\"\n";
-        out << "STRIP = \"$(ANDROID_TOOLCHAIN)/llvm-strip\"\n";
-    } else {
-        if (links_with_cxx) {
-#ifdef __APPLE__
-            out << "CXX = clang++\n";
-#else
-            out << "CXX = g++\n";
-#endif
-        }
-        // C and assembler-only binaries still need a linker driver. Also emit
-        // CC for empty binary targets so the generated recipe is syntactically
-        // complete instead of starting with an empty $(CC).
-        if (has_c_files || (links_binary && !links_with_cxx)) {
-#ifdef __APPLE__
-            out << "CC = clang\n";
-#else
-            out << "CC = gcc\n";
-#endif
-        }
-    }
-    if (has_nasm_files) {
-        std::string nasm_exe = config.nasm.path.empty() ? "nasm" : config.nasm.path;
-        out << "NASM = " << nasm_exe << "\n";
-    }
+    plan.links_binary = config.config_type == "Application" ||
+                        config.config_type == "DynamicLibrary" ||
+                        config.config_type == "Driver";
+    plan.links_with_cxx = plan.has_cpp_files || plan.has_objcxx_files;
 
     // Compiler flags
-    std::string cxxflags = get_compiler_flags(config, project, makefile_dir, false);
-    std::string cflags = get_compiler_flags(config, project, makefile_dir, true);
-    std::string ldflags = get_linker_flags(config, makefile_dir, android);
-    std::string ldlibs = get_linker_libs(config);
+    plan.compiler_launcher = project.compiler_launcher;
+    plan.cxxflags = get_compiler_flags(config, project, makefile_dir, false);
+    plan.cflags = get_compiler_flags(config, project, makefile_dir, true);
+    plan.objcxx_extra_flags = config.cl_compile.objcxx_flags;
+    plan.ldflags = get_linker_flags(config, makefile_dir, android);
+    std::string& ldlibs = plan.ldlibs;
+    ldlibs = get_linker_libs(config);
 
-    struct ArchiveEntry {
-        std::string project_name;
-        std::string path;
-        bool whole_archive;
-    };
-    std::vector<ArchiveEntry> dep_archives;
+    std::vector<ArchiveEntry>& dep_archives = plan.dep_archives;
 
     // Add project reference outputs (.a files) to link line, including transitive PUBLIC deps
-    if (config.config_type == "Application" || config.config_type == "DynamicLibrary" || config.config_type == "Driver") {
+    if (plan.links_binary) {
         // Collect all project .a files by traversing the dependency tree
         std::set<std::string> visited_deps;
 
@@ -749,7 +736,7 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
             }
             visited_deps.insert(dep_name);
 
-            const Project* dep_proj = find_project(project_lookup, dep_name);
+            const Project* dep_proj = project_lookup.find(dep_name);
             if (!dep_proj) return;
 
             // Add this project's archive if it's a library
@@ -795,21 +782,7 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
         }
     }
 
-    if (has_cpp_files || has_objcxx_files) {
-        out << "CXXFLAGS = " << cxxflags << "\n";
-    }
-    if (has_c_files) {
-        out << "CFLAGS = " << cflags << "\n";
-    }
-    if (has_objcxx_files) {
-        out << "OBJCXXFLAGS = $(CXXFLAGS)";
-        if (!config.cl_compile.objcxx_flags.empty()) {
-            out << " " << config.cl_compile.objcxx_flags;
-        }
-        out << "\n";
-    }
-
-    if (has_nasm_files) {
+    if (plan.has_nasm_files) {
         // Build NASMFLAGS from config
         std::string nasm_fmt = config.nasm.format;
         if (nasm_fmt.empty()) nasm_fmt = "elf64";  // Default for Makefile (Linux)
@@ -825,57 +798,28 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
         if (!config.nasm.additional_options.empty()) {
             nasmflags += " " + config.nasm.additional_options;
         }
-        out << "NASMFLAGS = " << nasmflags << "\n";
-    }
-
-    if (!ldflags.empty()) {
-        out << "LDFLAGS = " << ldflags << "\n";
-    }
-    if (!ldlibs.empty()) {
-        out << "LDLIBS = " << ldlibs << "\n";
-    }
-    if (!dep_archives.empty()) {
-        out << "PROJECT_DEPS =";
-        for (const auto& archive : dep_archives) {
-            out << " \\\n  " << archive.path;
-        }
-        out << "\n";
+        plan.nasmflags = nasmflags;
     }
 
-    out << "\n";
-
-    // Output paths
-    out << "# Output\n";
-    out << "TARGET = " << target << "\n";
-    out << "OBJ_DIR = " << int_dir << "\n\n";
-
     // Check if PCH is enabled for this configuration
     auto [has_pch, pch_header] = get_pch_info(config);
-    std::string pch_header_path;
-    std::string pch_output_path;
-    std::string pch_include_base; // The path to include (without .gch extension)
+    plan.has_pch = has_pch;
 
     if (has_pch && !pch_header.empty()) {
         // Compute relative path to PCH header
-        pch_header_path = compute_relative_path(pch_header, makefile_dir);
+        plan.pch_header_path = compute_relative_path(pch_header, makefile_dir);
 
         // PCH output path: $(OBJ_DIR)/pch_filename.gch
-        pch_output_path = int_dir + fs::path(pch_header).filename().string() + ".gch";
+        plan.pch_output_path = int_dir + fs::path(pch_header).filename().string() + ".gch";
 
         // The include base is the path without .gch extension (for -include flag)
-        pch_include_base = int_dir + fs::path(pch_header).filename().string();
-
-        // Write PCH variables
-        out << "# Precompiled header\n";
-        out << "PCH_HEADER = " << pch_header_path << "\n";
-        out << "PCH_OUTPUT = " << pch_output_path << "\n\n";
+        plan.pch_include_base = int_dir + fs::path(pch_header).filename().string();
     }
 
-    // Collect source files and generate object file list
-    std::vector<std::string> obj_files;
-    std::vector<std::pair<std::string, std::string>> source_to_obj; // (source, object)
-    std::vector<bool> source_uses_pch; // Track which files use PCH
+    // unity_build candidates by compiler and PCH use, in source order
+    std::map<std::pair<CompileKind, bool>, std::vector<CompileStep>> unity_candidates;
 
+    // Collect source files and generate object file list
     for (const auto& src : project.sources) {
         if (src.type == FileType::ClCompile || src.type == FileType::ObjCxx || src.type == FileType::NASM) {
             // Check if excluded for this config
@@ -892,158 +836,320 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
                 continue;
             }
 
+            CompileStep step;
+
             // Generate object file path
             // Convert source path to relative (using the same logic as output dirs)
-            std::string src_relative = compute_relative_path(src.path, makefile_dir);
-            std::string obj_path = make_object_path(src, src_relative, config_key, int_dir, makefile_dir);
+            step.source = compute_relative_path(src.path, makefile_dir);
+            step.object = make_object_path(src, step.source, config_key, int_dir, makefile_dir);
 
             // Determine if this file uses PCH
-            bool uses_pch = has_pch && (mode == "Use" || (mode.empty() && !header.empty()));
+            step.uses_pch = has_pch && (mode == "Use" || (mode.empty() && !header.empty()));
+
+            std::string ext = file_types::lowercase_extension(step.source);
+            if (file_types::is_cpp_source(ext)) {
+                step.kind = CompileKind::Cxx;
+            } else if (file_types::is_c_source(ext)) {
+                step.kind = CompileKind::C;
+            } else if (file_types::is_objcxx_source(ext)) {
+                step.kind = CompileKind::ObjCxx;
+            } else if (ext == ".asm" || ext == ".nasm") {
+                step.kind = CompileKind::Nasm;
+            }
+
+            if (step.kind != CompileKind::Nasm) {
+                step.file_flags = get_file_compiler_flags(src, config_key, makefile_dir);
+            }
+
+            // Sources with settings of their own keep their own translation unit
+            if (project.unity_build && src.type == FileType::ClCompile &&
+                (step.kind == CompileKind::Cxx || step.kind == CompileKind::C) &&
+                step.file_flags.empty() && mode != "NotUsing" &&
+                !find_config_setting(src.settings.object_file, config_key) &&
+                !find_config_setting(src.settings.compile_as, config_key)) {
+                unity_candidates[{step.kind, step.uses_pch}].push_back(std::move(step));
+                continue;
+            }
 
-            obj_files.push_back(obj_path);
-            source_to_obj.push_back({src_relative, obj_path});
-            source_uses_pch.push_back(uses_pch);
+            plan.compile_steps.push_back(std::move(step));
         }
     }
 
-    // Object files list
-    out << "# Object files\n";
-    out << "OBJS =";
-    for (const auto& obj : obj_files) {
-        out << " \\\n  " << obj;
-    }
-    out << "\n\n";
+    // Batch the candidates into unity TUs of unity_batch_size sources. They
+    // live outside OBJ_DIR so `make clean` keeps them.
+    const size_t batch_size = project.unity_batch_size > 0
+        ? static_cast<size_t>(project.unity_batch_size)
+        : std::numeric_limits<size_t>::max();
+    const std::string unity_dir = "unity/" + make_project_config_target(project, config_name, android) + "/";
+    plan.unity_dir = unity_dir;
+    for (auto& [key, candidates] : unity_candidates) {
+        const auto [kind, uses_pch] = key;
+        for (size_t first = 0; first < candidates.size();) {
+            const size_t count = std::min(batch_size, candidates.size() - first);
+            if (count == 1) {
+                plan.compile_steps.push_back(std::move(candidates[first++]));
+                continue;
+            }
 
-    // Phony targets
-    if (!config.pre_build_event.command.empty()) {
-        out << ".PHONY: all clean prebuild\n\n";
-    } else {
-        out << ".PHONY: all clean\n\n";
+            const std::string stem = "unity_" + std::to_string(plan.unity_sources.size()) +
+                                     (kind == CompileKind::C ? "_c" : "_cxx");
+            UnitySource unity;
+            unity.path = unity_dir + stem + (kind == CompileKind::C ? ".c" : ".cpp");
+            for (size_t i = first; i < first + count; ++i) {
+                unity.sources.push_back(candidates[i].source);
+            }
+            first += count;
+
+            CompileStep step;
+            step.source = unity.path;
+            step.object = int_dir + "unity/" + stem + ".o";
+            step.kind = kind;
+            step.uses_pch = uses_pch;
+            plan.compile_steps.push_back(std::move(step));
+            plan.unity_sources.push_back(std::move(unity));
+        }
     }
 
-    out << ".DEFAULT_GOAL := all\n\n";
-
-    // Pre-build event
-    if (!config.pre_build_event.command.empty()) {
-        out << "# Pre-build event\n";
-        out << "prebuild:\n";
-        out << "\t" << config.pre_build_event.command << "\n\n";
+    // The #include lines are relative to the unity TU's own directory
+    for (auto& unity : plan.unity_sources) {
+        const fs::path path = (makefile_dir / unity.path).lexically_normal();
+        unity.content = "/* Generated by sighmake (unity_build); do not edit */\n";
+        for (const auto& source : unity.sources) {
+            const fs::path source_path = (makefile_dir / source).lexically_normal();
+            fs::path include = source_path.lexically_relative(path.parent_path());
+            if (include.empty()) {
+                include = source_path;
+            }
+            unity.content += "#include \"" + include.generic_string() + "\"\n";
+        }
     }
 
-    // Default target
-    out << "all: $(TARGET)\n\n";
+    return true;
+}
 
-    // PCH compilation rule
-    if (has_pch && !pch_header_path.empty()) {
-        out << "# Precompiled header compilation\n";
-        out << "$(PCH_OUTPUT): $(PCH_HEADER)\n";
-        out << "\t@mkdir -p $(dir $@)\n";
-        out << "\t$(CXX) $(CXXFLAGS) -x c++-header -o $@ $<\n\n";
+// Written at generation time, like CMake writes its unity sources at
+// configure time
+bool MakefileGenerator::write_unity_sources(const TargetPlan& plan, const std::filesystem::path& build_file_dir) {
+    namespace fs = std::filesystem;
+    for (const auto& unity : plan.unity_sources) {
+        const fs::path path = (build_file_dir / unity.path).lexically_normal();
+
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        if (ec) {
+            std::cerr << "Error: Failed to create unity source directory: "
+                      << path.parent_path().string() << " (" << ec.message() << ")\n";
+            return false;
+        }
+        if (write_file_if_changed(path, unity.content) == WriteResult::Failed) {
+            std::cerr << "Error: Failed to write unity source: " << path.string() << "\n";
+            return false;
+        }
     }
 
-    // Link rule
-    if (!config.pre_build_event.command.empty()) {
-        out << "$(OBJS)";
-        if (has_pch && !pch_header_path.empty()) {
-            out << " $(PCH_OUTPUT)";
+    // A smaller batch count or a project without unity_build any more leaves
+    // unity TUs the plan no longer lists
+    const fs::path unity_dir = (build_file_dir / plan.unity_dir).lexically_normal();
+    std::set<std::string> planned;
+    for (const auto& unity : plan.unity_sources) {
+        planned.insert(fs::path(unity.path).filename().string());
+    }
+    std::vector<fs::path> stale;
+    std::error_code ec;
+    for (fs::directory_iterator it(unity_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        const std::string ext = it->path().extension().string();
+        if (name.rfind("unity_", 0) == 0 && (ext == ".c" || ext == ".cpp") && !planned.count(name)) {
+            stale.push_back(it->path());
         }
-        out << ": | prebuild\n\n";
-        out << "$(TARGET): $(OBJS)";
-        if (!dep_archives.empty()) {
-            out << " $(PROJECT_DEPS)";
-        }
-        out << " | prebuild\n";
-    } else {
-        out << "$(TARGET): $(OBJS)";
-        if (!dep_archives.empty()) {
-            out << " $(PROJECT_DEPS)";
+    }
+    for (const auto& path : stale) {
+        fs::remove(path, ec);
+    }
+    if (plan.unity_sources.empty()) {
+        fs::remove(unity_dir, ec);  // Only if nothing else is in it
+    }
+    return true;
+}
+
+// Generate a single Makefile for a project and configuration
+void MakefileGenerator::write_target_variables(std::ostream& out, const TargetPlan& plan,
+                                               const std::string& var_prefix) {
+    const std::string& p = var_prefix;
+
+    // A SIGHMAKE_COMPILER_LAUNCHER given on the make command line (as --build
+    // does) wins over the buildscript's. Plain assignment keeps an environment
+    // variable of that name from wrapping the compiles.
+    if (p.empty()) {
+        out << "SIGHMAKE_COMPILER_LAUNCHER ="
+            << (plan.compiler_launcher.empty() ? "" : " " + plan.compiler_launcher) << "\n";
+    } else if (!plan.compiler_launcher.empty()) {
+        out << p << "COMPILER_LAUNCHER = $(or $(SIGHMAKE_COMPILER_LAUNCHER)," << plan.compiler_launcher << ")\n";
+    }
+
+    if (plan.has_cpp_files || plan.has_objcxx_files) {
+        out << p << "CXXFLAGS = " << plan.cxxflags << "\n";
+    }
+    if (plan.has_c_files) {
+        out << p << "CFLAGS = " << plan.cflags << "\n";
+    }
+    if (plan.has_objcxx_files) {
+        out << p << "OBJCXXFLAGS = $(" << p << "CXXFLAGS)";
+        if (!plan.objcxx_extra_flags.empty()) {
+            out << " " << plan.objcxx_extra_flags;
         }
         out << "\n";
     }
-    out << "\t@mkdir -p $(dir $@)\n";
 
-    // Pre-link event
-    if (!config.pre_link_event.command.empty()) {
-        out << "\t" << config.pre_link_event.command << "\n";
+    if (plan.has_nasm_files) {
+        out << p << "NASMFLAGS = " << plan.nasmflags << "\n";
     }
 
-    if (config.config_type == "Application" || config.config_type == "DynamicLibrary" || config.config_type == "Driver") {
-        // Link executable or shared library
-        std::string compiler = links_with_cxx ? "$(CXX)" : "$(CC)";
-        if (config.config_type == "DynamicLibrary") {
-            out << "\t" << compiler << " -shared $(LDFLAGS) -o $@ $(OBJS) $(LDLIBS)\n";
-        } else {
-            out << "\t" << compiler << " $(LDFLAGS) -o $@ $(OBJS) $(LDLIBS)\n";
+    if (!plan.ldflags.empty()) {
+        out << p << "LDFLAGS = " << plan.ldflags << "\n";
+    }
+    if (!plan.ldlibs.empty()) {
+        out << p << "LDLIBS = " << plan.ldlibs << "\n";
+    }
+    if (!plan.dep_archives.empty()) {
+        out << p << "PROJECT_DEPS =";
+        for (const auto& archive : plan.dep_archives) {
+            out << " \\\n  " << archive.path;
         }
-    } else if (config.config_type == "StaticLibrary") {
-        // Create static library (Android uses the NDK's llvm-ar via $(AR))
-        out << "\t" << (android ? "$(AR)" : "ar") << " rcs $@ $(OBJS)\n";
+        out << "\n";
     }
 
-    // Post-build event
-    if (!config.post_build_event.command.empty()) {
-        out << "\t" << config.post_build_event.command << "\n";
-    }
+    out << "\n";
 
-    // Strip debug symbols for Release builds (executables and shared libraries only)
-    // On Linux, debug symbols are embedded in the binary unlike Windows .pdb files
-    if (config.config_type == "Application" || config.config_type == "DynamicLibrary" || config.config_type == "Driver") {
-        std::string release_config_name = config_key;
-        size_t release_pipe_pos = release_config_name.find('|');
-        if (release_pipe_pos != std::string::npos) {
-            release_config_name = release_config_name.substr(0, release_pipe_pos);
+    // Output paths
+    out << "# Output\n";
+    out << p << "TARGET = " << plan.target << "\n";
+    out << p << "OBJ_DIR = " << plan.int_dir << "\n\n";
+
+    if (!plan.pch_header_path.empty()) {
+        // Write PCH variables
+        out << "# Precompiled header\n";
+        out << p << "PCH_HEADER = " << plan.pch_header_path << "\n";
+        out << p << "PCH_OUTPUT = " << plan.pch_output_path << "\n\n";
+    }
+
+    // Object files list
+    out << "# Object files\n";
+    out << p << "OBJS =";
+    for (const auto& step : plan.compile_steps) {
+        out << " \\\n  " << step.object;
+    }
+    out << "\n\n";
+}
+
+void MakefileGenerator::write_target_rules(std::ostream& out, const Configuration& config,
+                                           const TargetPlan& plan, const std::string& var_prefix,
+                                           const std::string& prebuild_target,
+                                           const std::vector<std::string>& order_only_deps) {
+    auto var = [&var_prefix](const char* name) {
+        return "$(" + var_prefix + name + ")";
+    };
+    const bool android = plan.android;
+    const bool has_pch = plan.has_pch;
+
+    // Compile recipes (never link recipes) start with the launcher; make
+    // drops the leading space when it is empty
+    const std::string launcher = plan.compiler_launcher.empty() || var_prefix.empty()
+        ? "$(SIGHMAKE_COMPILER_LAUNCHER)"
+        : var("COMPILER_LAUNCHER");
+
+    // PCH compilation rule
+    if (has_pch && !plan.pch_header_path.empty()) {
+        out << "# Precompiled header compilation\n";
+        out << var("PCH_OUTPUT") << ": " << var("PCH_HEADER") << "\n";
+        out << "\t@mkdir -p $(dir $@)\n";
+        out << "\t" << launcher << " $(CXX) " << var("CXXFLAGS") << " -x c++-header -o $@ $<\n\n";
+    }
+
+    // Link rule
+    if (!prebuild_target.empty()) {
+        out << var("OBJS");
+        if (has_pch && !plan.pch_header_path.empty()) {
+            out << " " << var("PCH_OUTPUT");
         }
-        if (release_config_name == "Release") {
-            if (android) {
-                // Host strip can't handle Android ELF binaries; use the NDK's llvm-strip
-                out << "\t$(STRIP) --strip-unneeded $@\n";
-            } else {
+        out << ": | " << prebuild_target << "\n\n";
+    }
+    out << var("TARGET") << ": " << var("OBJS");
+    if (!plan.dep_archives.empty()) {
+        out << " " << var("PROJECT_DEPS");
+    }
+    if (!order_only_deps.empty()) {
+        out << " |";
+        for (const auto& dep : order_only_deps) {
+            out << " " << dep;
+        }
+    }
+    out << "\n";
+    out << "\t@mkdir -p $(dir $@)\n";
+
+    // Pre-link event
+    if (!config.pre_link_event.command.empty()) {
+        out << "\t" << config.pre_link_event.command << "\n";
+    }
+
+    if (plan.links_binary) {
+        // Link executable or shared library
+        std::string compiler = plan.links_with_cxx ? "$(CXX)" : "$(CC)";
+        if (config.config_type == "DynamicLibrary") {
+            out << "\t" << compiler << " -shared " << var("LDFLAGS") << " -o $@ " << var("OBJS")
+                << " " << var("LDLIBS") << "\n";
+        } else {
+            out << "\t" << compiler << " " << var("LDFLAGS") << " -o $@ " << var("OBJS")
+                << " " << var("LDLIBS") << "\n";
+        }
+    } else if (config.config_type == "StaticLibrary") {
+        // Create static library (Android uses the NDK's llvm-ar via $(AR))
+        out << "\t" << (android ? "$(AR)" : "ar") << " rcs $@ " << var("OBJS") << "\n";
+    }
+
+    // Post-build event
+    if (!config.post_build_event.command.empty()) {
+        out << "\t" << config.post_build_event.command << "\n";
+    }
+
+    // Strip debug symbols for Release builds (executables and shared libraries only)
+    // On Linux, debug symbols are embedded in the binary unlike Windows .pdb files
+    if (plan.links_binary && plan.config_name == "Release") {
+        if (android) {
+            // Host strip can't handle Android ELF binaries; use the NDK's llvm-strip
+            out << "\t$(STRIP) --strip-unneeded $@\n";
+        } else {
 #ifdef __APPLE__
-                if (config.config_type == "DynamicLibrary") {
-                    out << "\tstrip -x $@\n";
-                } else {
-                    out << "\tstrip $@\n";
-                }
-#else
+            if (config.config_type == "DynamicLibrary") {
+                out << "\tstrip -x $@\n";
+            } else {
                 out << "\tstrip $@\n";
-#endif
             }
+#else
+            out << "\tstrip $@\n";
+#endif
         }
     }
 
     out << "\n";
 
     // Compilation rules for each source file
-    for (size_t i = 0; i < source_to_obj.size(); ++i) {
-        const auto& [src, obj] = source_to_obj[i];
-        bool uses_pch = source_uses_pch[i];
-
-        std::string ext = file_types::lowercase_extension(src);
-
+    for (const auto& step : plan.compile_steps) {
         std::string compiler;
         std::string flags;
-        bool is_nasm = false;
-        if (file_types::is_cpp_source(ext)) {
-            compiler = "$(CXX)";
-            flags = "$(CXXFLAGS)";
-        } else if (file_types::is_c_source(ext)) {
-            compiler = "$(CC)";
-            flags = "$(CFLAGS)";
-        } else if (file_types::is_objcxx_source(ext)) {
-            compiler = "$(CXX)";
-            flags = "$(OBJCXXFLAGS)";
-        } else if (ext == ".asm" || ext == ".nasm") {
-            compiler = "$(NASM)";
-            flags = "$(NASMFLAGS)";
-            is_nasm = true;
-        } else {
-            continue; // Skip unknown file types
+        const bool is_nasm = step.kind == CompileKind::Nasm;
+        switch (step.kind) {
+            case CompileKind::Cxx:    compiler = "$(CXX)";     flags = var("CXXFLAGS");    break;
+            case CompileKind::C:      compiler = "$(CC)";      flags = var("CFLAGS");      break;
+            case CompileKind::ObjCxx: compiler = "$(CXX)";     flags = var("OBJCXXFLAGS"); break;
+            case CompileKind::Nasm:   compiler = var("NASM");  flags = var("NASMFLAGS");   break;
+            case CompileKind::Unknown: continue; // Skip unknown file types
         }
 
         // Write dependency line - add PCH dependency if file uses it
-        out << obj << ": " << src;
-        if (!is_nasm && uses_pch && has_pch) {
-            out << " $(PCH_OUTPUT)";
+        out << step.object << ": " << step.source;
+        if (!is_nasm && step.uses_pch && has_pch) {
+            out << " " << var("PCH_OUTPUT");
         }
         out << "\n";
 
@@ -1052,67 +1158,179 @@ bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, co
         if (is_nasm) {
             out << "\t" << compiler << " " << flags << " -o $@ $<\n\n";
         } else {
-            out << "\t" << compiler << " " << flags;
+            out << "\t" << launcher << " " << compiler << " " << flags;
+            if (!step.file_flags.empty()) {
+                out << " " << step.file_flags;
+            }
 
             // Add -include flag to force PCH inclusion for files that use it
-            if (uses_pch && has_pch && !pch_include_base.empty()) {
-                out << " -include \"" << pch_include_base << "\"";
+            if (step.uses_pch && has_pch && !plan.pch_include_base.empty()) {
+                out << " -include \"" << plan.pch_include_base << "\"";
             }
 
             out << " -MMD -MP -c -o $@ $<\n\n";
         }
     }
+}
+
+bool MakefileGenerator::generate_makefile(const Project& project, const Solution& solution,
+                                         const std::string& config_key, const std::string& output_path) {
+    auto project_lookup = build_project_lookup(solution);
+    return generate_makefile_with_lookup(project, solution, config_key, output_path, project_lookup);
+}
+
+bool MakefileGenerator::generate_makefile_with_lookup(const Project& project, const Solution& solution,
+                                                      const std::string& config_key, const std::string& output_path,
+                                                      const MakefileGenerator::ProjectLookup& project_lookup,
+                                                      std::ostream& log) {
+    namespace fs = std::filesystem;
+    (void)solution;
+
+    // Get the directory containing the makefile for computing relative paths
+    fs::path makefile_dir = fs::path(output_path).parent_path();
+    if (makefile_dir.empty()) {
+        makefile_dir = ".";
+    }
+
+    TargetPlan plan;
+    if (!plan_target(project, config_key, makefile_dir, project_lookup, plan) ||
+        !write_unity_sources(plan, makefile_dir)) {
+        return false;
+    }
+    const Configuration& config = project.configurations.at(config_key);
+    const bool android = plan.android;
+    const bool has_pch = plan.has_pch;
+
+    // Buffer the Makefile; it only reaches disk if its content changed
+    OutputFile out(output_path);
+
+    // Write header
+    out << "# Auto-generated Makefile for " << project.name << " (" << plan.config_name
+        << (android ? ", Android" : "") << ")\n";
+    out << "# Generated by sighmake\n\n";
+
+    // Compiler variables
+    if (android) {
+        // Android NDK toolchain. The --target wrappers are what the NDK's own
+        // clang launcher scripts do, but calling clang directly works on every
+        // host OS (the .cmd wrappers are Windows-only, the bare ones POSIX-only).
+        out << "# Android NDK toolchain (requires NDK r19 or newer)\n";
+        out << "# Override at build time, e.g.: make ANDROID_ABI=x86_64 ANDROID_API=26\n";
+        out << "ANDROID_ABI ?= arm64-v8a\n";
+        out << "ANDROID_API ?= 24\n";
+        out << "ifeq ($(strip $(ANDROID_NDK_HOME)),)\n";
+        out << "  ANDROID_NDK_HOME := $(ANDROID_NDK_ROOT)\n";
+        out << "endif\n";
+        out << "ifeq ($(strip $(ANDROID_NDK_HOME)),)\n";
+        out << "  ifneq ($(MAKECMDGOALS),clean)\n";
+        out << "    $(error ANDROID_NDK_HOME is not set. Point it at your Android NDK installation)\n";
+        out << "  endif\n";
+        out << "endif\n";
+        out << "ifeq ($(ANDROID_ABI),arm64-v8a)\n";
+        out << "  ANDROID_TRIPLE := aarch64-linux-android\n";
+        out << "else ifeq ($(ANDROID_ABI),armeabi-v7a)\n";
+        out << "  ANDROID_TRIPLE := armv7a-linux-androideabi\n";
+        out << "else ifeq ($(ANDROID_ABI),x86_64)\n";
+        out << "  ANDROID_TRIPLE := x86_64-linux-android\n";
+        out << "else ifeq ($(ANDROID_ABI),x86)\n";
+        out << "  ANDROID_TRIPLE := i686-linux-android\n";
+        out << "else\n";
+        out << "  $(error Unsupported ANDROID_ABI '$(ANDROID_ABI)'. Supported: arm64-v8a, armeabi-v7a, x86_64, x86)\n";
+        out << "endif\n";
+        out << "ANDROID_TOOLCHAIN := $(ANDROID_NDK_HOME)/toolchains/llvm/prebuilt/"
+            << ANDROID_HOST_TAG << "/bin\n";
+        out << "CXX = \"$(ANDROID_TOOLCHAIN)/clang++\" --target=$(ANDROID_TRIPLE)$(ANDROID_API)\n";
+        out << "CC = \"$(ANDROID_TOOLCHAIN)/clang\" --target=$(ANDROID_TRIPLE)$(ANDROID_API)\n";
+        out << "AR = \"$(ANDROID_TOOLCHAIN)/llvm-ar\"\n";
+        out << "STRIP = \"$(ANDROID_TOOLCHAIN)/llvm-strip\"\n";
+    } else {
+        if (plan.links_with_cxx) {
+#ifdef __APPLE__
+            out << "CXX = clang++\n";
+#else
+            out << "CXX = g++\n";
+#endif
+        }
+        // C and assembler-only binaries still need a linker driver. Also emit
+        // CC for empty binary targets so the generated recipe is syntactically
+        // complete instead of starting with an empty $(CC).
+        if (plan.has_c_files || (plan.links_binary && !plan.links_with_cxx)) {
+#ifdef __APPLE__
+            out << "CC = clang\n";
+#else
+            out << "CC = gcc\n";
+#endif
+        }
+    }
+    if (plan.has_nasm_files) {
+        std::string nasm_exe = config.nasm.path.empty() ? "nasm" : config.nasm.path;
+        out << "NASM = " << nasm_exe << "\n";
+    }
+
+    write_target_variables(out, plan, "");
+
+    // Phony targets
+    if (!config.pre_build_event.command.empty()) {
+        out << ".PHONY: all clean prebuild\n\n";
+    } else {
+        out << ".PHONY: all clean\n\n";
+    }
+
+    out << ".DEFAULT_GOAL := all\n\n";
+
+    // Pre-build event
+    if (!config.pre_build_event.command.empty()) {
+        out << "# Pre-build event\n";
+        out << "prebuild:\n";
+        out << "\t" << config.pre_build_event.command << "\n\n";
+    }
+
+    // Default target
+    out << "all: $(TARGET)\n\n";
+
+    const std::string prebuild_target = config.pre_build_event.command.empty() ? "" : "prebuild";
+    write_target_rules(out, config, plan, "", prebuild_target,
+                       prebuild_target.empty() ? std::vector<std::string>{}
+                                               : std::vector<std::string>{prebuild_target});
 
     // Clean rule
     out << "clean:\n";
-    if (has_pch && !pch_output_path.empty()) {
+    if (has_pch && !plan.pch_output_path.empty()) {
         out << "\trm -rf $(OBJ_DIR) $(TARGET) $(PCH_OUTPUT)\n\n";
     } else {
         out << "\trm -rf $(OBJ_DIR) $(TARGET)\n\n";
     }
 
     // Include dependency files
-    if (!obj_files.empty()) {
+    if (!plan.compile_steps.empty()) {
         out << "# Include dependencies\n";
         out << "-include $(OBJS:.o=.d)\n";
     }
 
-    out.close();
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write Makefile: " << output_path << "\n";
+        return false;
+    }
 
-    std::cout << "Generated: " << output_path << "\n";
+    log << "Generated: " << output_path << "\n";
     return true;
 }
 
-// Generate all Makefiles for a solution
-bool MakefileGenerator::generate(Solution& solution, const std::string& output_dir) {
+bool MakefileGenerator::generate_recursive_makefiles(const Solution& solution, const std::string& output_dir) {
     namespace fs = std::filesystem;
 
-    // Create output directory if it doesn't exist
-    if (!output_dir.empty() && !fs::exists(output_dir)) {
-        try {
-            fs::create_directories(output_dir);
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Failed to create output directory: " << e.what() << "\n";
-            return false;
-        }
-    }
-
-    // Create build directory
     fs::path build_dir = fs::path(output_dir) / "build";
-    if (!fs::exists(build_dir)) {
-        try {
-            fs::create_directories(build_dir);
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Failed to create build directory: " << e.what() << "\n";
-            return false;
-        }
-    }
-
     std::cout << "Generating Makefiles for solution: " << solution.name << "\n";
 
     auto project_lookup = build_project_lookup(solution);
 
-    // Generate Makefiles for each project and configuration
+    // Collect one Makefile per project and configuration, in a fixed order
+    struct MakefileJob {
+        const Project* project;
+        std::string config_key;
+        std::string path;
+    };
+    std::vector<MakefileJob> jobs;
     for (const auto& project : solution.projects) {
         if (project.is_package_project) continue;  // Skip synthetic find_package projects
         // Generate a Makefile for each configuration
@@ -1135,10 +1353,24 @@ bool MakefileGenerator::generate(Solution& solution, const std::string& output_d
             std::string makefile_name =
                 make_project_config_target(project, config_name, is_android_platform(platform));
             fs::path makefile_path = build_dir / makefile_name;
+            jobs.push_back({&project, config_key, makefile_path.string()});
+        }
+    }
 
-            if (!generate_makefile_with_lookup(project, solution, config_key, makefile_path.string(), project_lookup)) {
-                return false;
-            }
+    // Makefiles are independent of each other, so write them on worker threads.
+    // Each job logs into its own buffer; logs are printed in job order.
+    std::vector<std::string> logs(jobs.size());
+    std::vector<char> succeeded(jobs.size(), 0);
+    parallel_for(jobs.size(), jobs_, [&](size_t i) {
+        std::ostringstream log;
+        succeeded[i] = generate_makefile_with_lookup(*jobs[i].project, solution, jobs[i].config_key,
+                                                     jobs[i].path, project_lookup, log);
+        logs[i] = log.str();
+    });
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        std::cout << logs[i];
+        if (!succeeded[i]) {
+            return false;
         }
     }
 
@@ -1147,8 +1379,53 @@ bool MakefileGenerator::generate(Solution& solution, const std::string& output_d
         return false;
     }
 
+    return true;
+}
+
+// Generate all Makefiles for a solution
+bool MakefileGenerator::generate(Solution& solution, const std::string& output_dir) {
+    namespace fs = std::filesystem;
+
+    // Create output directory if it doesn't exist
+    if (!output_dir.empty() && !fs::exists(output_dir)) {
+        try {
+            fs::create_directories(output_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Failed to create output directory: " << e.what() << "\n";
+            return false;
+        }
+    }
+
+    // Create build directory
+    fs::path build_dir = fs::path(output_dir) / "build";
+    if (!fs::exists(build_dir)) {
+        try {
+            fs::create_directories(build_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Failed to create build directory: " << e.what() << "\n";
+            return false;
+        }
+    }
+
+    if (flat_) {
+        std::cout << "Generating flat Makefile for solution: " << solution.name << "\n";
+        if (!generate_flat_makefile(solution, output_dir)) {
+            return false;
+        }
+    } else if (!generate_recursive_makefiles(solution, output_dir)) {
+        return false;
+    }
+
     std::cout << "Makefile generation complete!\n";
 
+    // Mark the generation time for the self-regeneration rule
+    if (!regenerate_command_.empty()) {
+        std::ofstream stamp(build_dir / REGENERATE_STAMP);
+        if (!stamp) {
+            std::cerr << "Warning: Failed to write " << (build_dir / REGENERATE_STAMP).string() << "\n";
+        }
+    }
+
     // Write build cache for --build support
     {
         BuildCache cache;
@@ -1161,23 +1438,149 @@ bool MakefileGenerator::generate(Solution& solution, const std::string& output_d
             }
         }
         cache.build_dir = "build";
+        cache.record_inputs(solution);
         cache.write(output_dir);
     }
 
     return true;
 }
 
+void MakefileGenerator::write_regenerate_rule(std::ostream& out, const Solution& solution) const {
+    if (regenerate_command_.empty()) {
+        return;
+    }
+
+    // Inputs that no longer exist (hash 0) can't be prerequisites
+    std::vector<std::string> inputs;
+    for (const auto& input : solution.inputs) {
+        if (input.hash != 0) {
+            inputs.push_back(escape_make_prerequisite(input.path));
+        }
+    }
+    if (inputs.empty()) {
+        return;
+    }
+
+    std::string command = "cd " + quote_recipe_word(regenerate_dir_) + " &&";
+    for (const auto& word : regenerate_command_) {
+        command += " " + quote_recipe_word(word);
+    }
+
+    // The stamp (not the Makefile) is the real target: unchanged output is
+    // never rewritten, so the Makefile's own mtime can't mark regeneration.
+    // The empty recipe on Makefile lets make notice it was remade and restart.
+    out << "# Regenerate when a buildscript or wildcard directory changes\n";
+    out << "SIGHMAKE_INPUTS :=";
+    for (const auto& input : inputs) {
+        out << " \\\n\t" << input;
+    }
+    out << "\n\n";
+    out << "Makefile: " << REGENERATE_STAMP << " ;\n\n";
+    out << REGENERATE_STAMP << ": $(SIGHMAKE_INPUTS)\n";
+    out << "\t@echo \"Buildscripts changed, regenerating...\"\n";
+    out << "\t@" << command << "\n";
+    out << "\t@touch $@\n\n";
+}
+
+void MakefileGenerator::write_install_rules(std::ostream& out, const Solution& solution,
+                                            const std::set<std::string>& configs,
+                                            const std::string& default_config,
+                                            const std::string& output_dir) {
+    namespace fs = std::filesystem;
+
+    // Install executable targets from Release (or default) config.
+    // Android configs are excluded: their binaries target devices, not the host.
+    const fs::path build_dir = fs::path(output_dir) / "build";
+    if (!configs.empty()) {
+        std::string install_config = configs.count("Release") ? "Release" : default_config;
+
+        // Collect installable targets (executables and shared libraries)
+        struct InstallTarget {
+            std::string binary_path;  // Relative to build dir
+            std::string name;         // Binary name for destination
+        };
+        std::vector<InstallTarget> exe_targets;
+        std::vector<InstallTarget> lib_targets;
+
+        for (const auto& proj : solution.projects) {
+            if (proj.is_package_project) continue;
+            for (const auto& [config_key, config] : proj.configurations) {
+                size_t pipe_pos = config_key.find('|');
+                std::string cfg_name = (pipe_pos != std::string::npos)
+                    ? config_key.substr(0, pipe_pos) : config_key;
+                std::string plat = (pipe_pos != std::string::npos)
+                    ? config_key.substr(pipe_pos + 1) : "";
+
+                if (cfg_name != install_config) continue;
+                if (is_windows_platform(plat)) continue;
+                if (is_android_platform(plat)) continue;  // Device binaries - never installed on the host
+
+                std::string target_name = config.target_name.empty() ? proj.name : config.target_name;
+                std::string target_ext = config.target_ext;
+                if (target_ext.empty()) {
+                    if (config.config_type == "DynamicLibrary") {
+#ifdef __APPLE__
+                        target_ext = ".dylib";
+#else
+                        target_ext = ".so";
+#endif
+                    }
+                } else if (config.config_type == "Application" && target_ext == ".exe") {
+                    target_ext.clear();
+                }
+                const std::string binary_name = target_name + target_ext;
+                std::string out_dir = config.out_dir.empty() ? "build/" + cfg_name : config.out_dir;
+                // Make path relative to build dir
+                fs::path out_path = fs::path(out_dir);
+                std::string rel_out = out_path.is_absolute()
+                    ? compute_relative_path(out_path.string(), build_dir)
+                    : compute_relative_path((fs::path(output_dir) / out_dir).string(), build_dir);
+                if (!rel_out.empty() && rel_out.back() != '/') rel_out += '/';
+
+                if (config.config_type == "Application") {
+                    exe_targets.push_back({rel_out + binary_name, binary_name});
+                } else if (config.config_type == "DynamicLibrary") {
+                    lib_targets.push_back({rel_out + binary_name, binary_name});
+                }
+                break;  // Only need one non-Windows platform config per project
+            }
+        }
+
+        if (!exe_targets.empty() || !lib_targets.empty()) {
+            out << "install: " << install_config << "\n";
+            if (!exe_targets.empty()) {
+                out << "\tinstall -d $(DESTDIR)$(PREFIX)/bin\n";
+                for (const auto& t : exe_targets) {
+                    out << "\tinstall -m 755 " << t.binary_path << " $(DESTDIR)$(PREFIX)/bin/" << t.name << "\n";
+                }
+            }
+            if (!lib_targets.empty()) {
+                out << "\tinstall -d $(DESTDIR)$(PREFIX)/lib\n";
+                for (const auto& t : lib_targets) {
+                    out << "\tinstall -m 755 " << t.binary_path << " $(DESTDIR)$(PREFIX)/lib/" << t.name << "\n";
+                }
+            }
+            out << "\n";
+
+            out << "uninstall:\n";
+            for (const auto& t : exe_targets) {
+                out << "\trm -f $(DESTDIR)$(PREFIX)/bin/" << t.name << "\n";
+            }
+            for (const auto& t : lib_targets) {
+                out << "\trm -f $(DESTDIR)$(PREFIX)/lib/" << t.name << "\n";
+            }
+            out << "\n";
+        }
+    }
+}
+
 bool MakefileGenerator::generate_master_makefile(const Solution& solution, const std::string& output_dir) {
     namespace fs = std::filesystem;
 
     fs::path build_dir = fs::path(output_dir) / "build";
     fs::path makefile_path = build_dir / "Makefile";
 
-    std::ofstream out(makefile_path);
-    if (!out) {
-        std::cerr << "Error: Failed to create master Makefile: " << makefile_path << "\n";
-        return false;
-    }
+    OutputFile out(makefile_path);
 
     // Collect unique config names (without platform), skipping Windows platforms.
     // Android configs are tracked separately - they build through the NDK and get
@@ -1209,6 +1612,10 @@ bool MakefileGenerator::generate_master_makefile(const Solution& solution, const
         out << "all:\n\t@echo \"No projects to build\"\n";
         std::cerr << "Warning: No non-Windows platforms found. Makefile has no targets.\n";
         std::cerr << "  Hint: Add 'Linux' or 'Android' to your platforms list, e.g.: platforms = x64, Linux\n";
+        if (!out.commit()) {
+            std::cerr << "Error: Failed to write master Makefile: " << makefile_path << "\n";
+            return false;
+        }
         return true;
     }
 
@@ -1303,7 +1710,7 @@ bool MakefileGenerator::generate_master_makefile(const Solution& solution, const
                 const std::string target = make_project_config_target(*proj, cfg, android);
                 std::set<std::string> dependencies;
                 for (const auto& dep : proj->project_references) {
-                    const Project* dep_project = find_project(project_lookup, dep.name);
+                    const Project* dep_project = project_lookup.find(dep.name);
                     if (!dep_project || !find_makefile_config_key(*dep_project, cfg, android)) {
                         continue;
                     }
@@ -1351,91 +1758,236 @@ bool MakefileGenerator::generate_master_makefile(const Solution& solution, const
     }
     out << "\n";
 
-    // Install target - install executable targets from Release (or default) config.
-    // Android configs are excluded: their binaries target devices, not the host.
-    if (!configs.empty()) {
-        std::string install_config = configs.count("Release") ? "Release" : default_config;
+    write_install_rules(out, solution, configs, default_config, output_dir);
+    write_regenerate_rule(out, solution);
 
-        // Collect installable targets (executables and shared libraries)
-        struct InstallTarget {
-            std::string binary_path;  // Relative to build dir
-            std::string name;         // Binary name for destination
-        };
-        std::vector<InstallTarget> exe_targets;
-        std::vector<InstallTarget> lib_targets;
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write master Makefile: " << makefile_path << "\n";
+        return false;
+    }
 
-        for (const auto& proj : solution.projects) {
-            if (proj.is_package_project) continue;
-            for (const auto& [config_key, config] : proj.configurations) {
-                size_t pipe_pos = config_key.find('|');
-                std::string cfg_name = (pipe_pos != std::string::npos)
-                    ? config_key.substr(0, pipe_pos) : config_key;
-                std::string plat = (pipe_pos != std::string::npos)
-                    ? config_key.substr(pipe_pos + 1) : "";
+    std::cout << "Generated master Makefile: " << makefile_path << "\n";
+    return true;
+}
 
-                if (cfg_name != install_config) continue;
-                if (is_windows_platform(plat)) continue;
-                if (is_android_platform(plat)) continue;  // Device binaries - never installed on the host
+bool MakefileGenerator::generate_flat_makefile(const Solution& solution, const std::string& output_dir) {
+    namespace fs = std::filesystem;
+
+    fs::path build_dir = fs::path(output_dir) / "build";
+    fs::path makefile_path = build_dir / "Makefile";
+
+    // Collect desktop config names. Android configs depend on make-time NDK
+    // variables that only the per-project Makefiles define.
+    std::set<std::string> configs;
+    bool skipped_android = false;
+    for (const auto& project : solution.projects) {
+        if (project.is_package_project) continue;  // Skip synthetic find_package projects
+        for (const auto& [config_key, config] : project.configurations) {
+            (void)config;
+            auto [config_name, platform] = parse_config_key(config_key);
+            if (is_windows_platform(platform)) continue;
+            if (is_android_platform(platform)) {
+                skipped_android = true;
+                continue;
+            }
+            configs.insert(config_name);
+        }
+    }
+    if (skipped_android) {
+        std::cerr << "Warning: Android configurations are not supported by --flat; "
+                     "omit --flat for Android builds.\n";
+    }
+
+    OutputFile out(makefile_path);
+
+    if (configs.empty()) {
+        // Nothing to build
+        out << "# Empty solution - no targets\n";
+        out << "all:\n\t@echo \"No projects to build\"\n";
+        if (!out.commit()) {
+            std::cerr << "Error: Failed to write Makefile: " << makefile_path << "\n";
+            return false;
+        }
+        std::cerr << "Warning: No non-Windows platforms found. Makefile has no targets.\n";
+        std::cerr << "  Hint: Add 'Linux' to your platforms list, e.g.: platforms = x64, Linux\n";
+        std::cout << "Generated: " << makefile_path.string() << "\n";
+        return true;
+    }
+
+    const std::string default_config = configs.count("Debug") ? "Debug" : *configs.begin();
+    const ProjectLookup project_lookup = build_project_lookup(solution);
+
+    // Plan every project configuration; paths are relative to build/ exactly
+    // as in the per-project Makefiles
+    struct FlatTarget {
+        const Project* project;
+        TargetPlan plan;
+        std::string name;  // e.g. "App.Debug", also the variable prefix
+    };
+    std::vector<FlatTarget> targets;
+    std::vector<std::string> target_keys;
+    std::vector<const Project*> buildable_projects;
+    for (const auto& project : solution.projects) {
+        if (project.is_package_project) continue;
+        buildable_projects.push_back(&project);
+        for (const auto& cfg : configs) {
+            auto config_key = find_makefile_config_key(project, cfg, false);
+            if (!config_key) continue;
+
+            FlatTarget target;
+            target.project = &project;
+            target.name = make_project_config_target(project, cfg);
+            targets.push_back(std::move(target));
+            target_keys.push_back(*config_key);
+        }
+    }
+
+    // Planning dominates generation time; targets are independent
+    std::vector<char> planned(targets.size(), 0);
+    parallel_for(targets.size(), jobs_, [&](size_t i) {
+        planned[i] = plan_target(*targets[i].project, target_keys[i], build_dir, project_lookup, targets[i].plan) &&
+                     write_unity_sources(targets[i].plan, build_dir);
+    });
+    if (std::find(planned.begin(), planned.end(), 0) != planned.end()) {
+        return false;
+    }
+
+    out << "# Flat Makefile - generated by sighmake\n";
+    out << "# All projects and configurations share one dependency graph, so\n";
+    out << "# make -j overlaps compilation across project boundaries.\n";
+    out << "# Build all projects with: make\n";
+    out << "# Build specific config:   make Release\n";
+    out << "# Build specific project:  make ProjectName\n";
+    out << "# Clean all:               make clean\n";
+    out << "# Install:                 sudo make install\n";
+    out << "# Install to custom dir:   make install PREFIX=/opt/myapp\n\n";
+
+    out << "PREFIX ?= /usr/local\n\n";
+
+    // Compile launcher override; only the make command line sets it
+    out << "SIGHMAKE_COMPILER_LAUNCHER =\n\n";
 
-                std::string target_name = config.target_name.empty() ? proj.name : config.target_name;
-                std::string target_ext = config.target_ext;
-                if (target_ext.empty()) {
-                    if (config.config_type == "DynamicLibrary") {
 #ifdef __APPLE__
-                        target_ext = ".dylib";
+    out << "CXX = clang++\n";
+    out << "CC = clang\n\n";
 #else
-                        target_ext = ".so";
+    out << "CXX = g++\n";
+    out << "CC = gcc\n\n";
 #endif
-                    }
-                } else if (config.config_type == "Application" && target_ext == ".exe") {
-                    target_ext.clear();
-                }
-                const std::string binary_name = target_name + target_ext;
-                std::string out_dir = config.out_dir.empty() ? "build/" + cfg_name : config.out_dir;
-                // Make path relative to build dir
-                fs::path out_path = fs::path(out_dir);
-                std::string rel_out = out_path.is_absolute()
-                    ? compute_relative_path(out_path.string(), build_dir)
-                    : compute_relative_path((fs::path(output_dir) / out_dir).string(), build_dir);
-                if (!rel_out.empty() && rel_out.back() != '/') rel_out += '/';
 
-                if (config.config_type == "Application") {
-                    exe_targets.push_back({rel_out + binary_name, binary_name});
-                } else if (config.config_type == "DynamicLibrary") {
-                    lib_targets.push_back({rel_out + binary_name, binary_name});
-                }
-                break;  // Only need one non-Windows platform config per project
-            }
+    // .PHONY targets
+    out << ".PHONY: all clean install uninstall";
+    for (const auto& cfg : configs) {
+        out << " " << cfg;
+    }
+    for (const auto* proj : buildable_projects) {
+        out << " " << proj->name;
+    }
+    for (const auto& target : targets) {
+        out << " " << target.name;
+        const Configuration& config = target.project->configurations.at(target.plan.config_key);
+        if (!config.pre_build_event.command.empty()) {
+            out << " " << target.name << ".prebuild";
         }
+    }
+    out << "\n\n";
 
-        if (!exe_targets.empty() || !lib_targets.empty()) {
-            out << "install: " << install_config << "\n";
-            if (!exe_targets.empty()) {
-                out << "\tinstall -d $(DESTDIR)$(PREFIX)/bin\n";
-                for (const auto& t : exe_targets) {
-                    out << "\tinstall -m 755 " << t.binary_path << " $(DESTDIR)$(PREFIX)/bin/" << t.name << "\n";
-                }
-            }
-            if (!lib_targets.empty()) {
-                out << "\tinstall -d $(DESTDIR)$(PREFIX)/lib\n";
-                for (const auto& t : lib_targets) {
-                    out << "\tinstall -m 755 " << t.binary_path << " $(DESTDIR)$(PREFIX)/lib/" << t.name << "\n";
-                }
-            }
-            out << "\n";
+    out << ".DEFAULT_GOAL := all\n\n";
+    out << "all: " << default_config << "\n\n";
 
-            out << "uninstall:\n";
-            for (const auto& t : exe_targets) {
-                out << "\trm -f $(DESTDIR)$(PREFIX)/bin/" << t.name << "\n";
+    // Per-configuration targets (e.g., make Debug, make Release)
+    for (const auto& cfg : configs) {
+        out << cfg << ":";
+        for (const auto& target : targets) {
+            if (target.plan.config_name == cfg) {
+                out << " " << target.name;
             }
-            for (const auto& t : lib_targets) {
-                out << "\trm -f $(DESTDIR)$(PREFIX)/lib/" << t.name << "\n";
+        }
+        out << "\n\n";
+    }
+
+    // Per-project targets (builds default config)
+    for (const auto* proj : buildable_projects) {
+        out << proj->name << ":";
+        if (find_makefile_config_key(*proj, default_config, false)) {
+            out << " " << make_project_config_target(*proj, default_config);
+        }
+        out << "\n\n";
+    }
+
+    for (const auto& target : targets) {
+        const Project& project = *target.project;
+        const TargetPlan& plan = target.plan;
+        const Configuration& config = project.configurations.at(plan.config_key);
+        const std::string prefix = target.name + "_";
+
+        out << "# ============================================================================\n";
+        out << "# " << project.name << " (" << plan.config_name << ")\n";
+        out << "# ============================================================================\n\n";
+
+        if (plan.has_nasm_files) {
+            out << prefix << "NASM = " << (config.nasm.path.empty() ? "nasm" : config.nasm.path) << "\n";
+        }
+        write_target_variables(out, plan, prefix);
+
+        std::string prebuild_target;
+        if (!config.pre_build_event.command.empty()) {
+            prebuild_target = target.name + ".prebuild";
+            out << "# Pre-build event\n";
+            out << prebuild_target << ":\n";
+            out << "\t" << config.pre_build_event.command << "\n\n";
+        }
+
+        out << target.name << ": $(" << prefix << "TARGET)\n\n";
+
+        // Referenced projects only order the link step; their archives are
+        // already real prerequisites, so compilation overlaps freely
+        std::vector<std::string> order_only;
+        if (!prebuild_target.empty()) {
+            order_only.push_back(prebuild_target);
+        }
+        std::set<std::string> dep_targets;
+        for (const auto& dep : project.project_references) {
+            const Project* dep_project = project_lookup.find(dep.name);
+            if (!dep_project || !find_makefile_config_key(*dep_project, plan.config_name, false)) {
+                continue;
             }
-            out << "\n";
+            dep_targets.insert(make_project_config_target(*dep_project, plan.config_name));
         }
+        order_only.insert(order_only.end(), dep_targets.begin(), dep_targets.end());
+
+        write_target_rules(out, config, plan, prefix, prebuild_target, order_only);
     }
 
-    std::cout << "Generated master Makefile: " << makefile_path << "\n";
+    // Clean target
+    out << "clean:\n";
+    for (const auto& target : targets) {
+        const std::string prefix = target.name + "_";
+        out << "\trm -rf $(" << prefix << "OBJ_DIR) $(" << prefix << "TARGET)";
+        if (target.plan.has_pch && !target.plan.pch_output_path.empty()) {
+            out << " $(" << prefix << "PCH_OUTPUT)";
+        }
+        out << "\n";
+    }
+    out << "\n";
+
+    write_install_rules(out, solution, configs, default_config, output_dir);
+    write_regenerate_rule(out, solution);
+
+    // Include dependency files
+    out << "# Include dependencies\n";
+    for (const auto& target : targets) {
+        if (!target.plan.compile_steps.empty()) {
+            out << "-include $(" << target.name << "_OBJS:.o=.d)\n";
+        }
+    }
+
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write Makefile: " << makefile_path << "\n";
+        return false;
+    }
+
+    std::cout << "Generated: " << makefile_path.string() << "\n";
     return true;
 }
 
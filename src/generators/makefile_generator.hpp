@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/project_types.hpp"
+#include "common/project_graph.hpp"
 #include "common/generator.hpp"
 
 namespace vcxproj {
@@ -28,12 +29,168 @@ public:
     // Generate master Makefile to build all projects
     bool generate_master_makefile(const Solution& solution, const std::string& output_dir);
 
-private:
-    using ProjectLookup = std::map<std::string, const Project*>;
+    // Generate a single non-recursive Makefile containing every project and
+    // configuration, so make -j can overlap work across project boundaries
+    bool generate_flat_makefile(const Solution& solution, const std::string& output_dir);
+
+    // Emit one flat Makefile instead of per-project Makefiles (--flat)
+    void set_flat(bool flat) { flat_ = flat; }
+    bool flat() const { return flat_; }
+
+    // Worker threads used to plan and write targets (-j); 0 uses every core
+    void set_jobs(int jobs) { jobs_ = jobs; }
+    int jobs() const { return jobs_; }
+
+    // Command (program first) that re-runs sighmake from working_dir. When set,
+    // the top-level Makefile regenerates itself once a buildscript or wildcard
+    // directory recorded in Solution::inputs is newer than the last generation.
+    void set_regenerate_command(std::vector<std::string> command, std::string working_dir) {
+        regenerate_command_ = std::move(command);
+        regenerate_dir_ = std::move(working_dir);
+    }
+
+    // Stamp file in build/ touched after each generation
+    static constexpr const char* REGENERATE_STAMP = ".sighmake.stamp";
+
+protected:
+    // Buildable (non-package) projects of a solution by name, answered from
+    // the solution's ProjectGraph
+    class ProjectLookup {
+    public:
+        explicit ProjectLookup(const Solution& solution)
+            : solution_(&solution), graph_(&solution.graph()) {}
+
+        // Null if no buildable project has this name
+        const Project* find(const std::string& name) const;
+
+    private:
+        const Solution* solution_;
+        const ProjectGraph* graph_;
+    };
+
+    // Project library linked into a binary target
+    struct ArchiveEntry {
+        std::string project_name;
+        std::string path;
+        bool whole_archive;
+    };
+
+    // Tool used to compile a translation unit
+    enum class CompileKind {
+        Cxx,
+        C,
+        ObjCxx,
+        Nasm,
+        Unknown  // Listed as an object but no rule is emitted
+    };
+
+    // One source -> object compilation
+    struct CompileStep {
+        std::string source;   // Relative to the build file directory
+        std::string object;   // Relative to the build file directory
+        CompileKind kind = CompileKind::Unknown;
+        bool uses_pch = false;
+        std::string file_flags;  // Per-file FileSettings overrides, appended after the target flags
+    };
+
+    // Generated translation unit that #includes a batch of sources (unity_build)
+    struct UnitySource {
+        std::string path;                  // Relative to the build file directory
+        std::vector<std::string> sources;  // Relative to the build file directory
+        std::string content;               // The #include lines, written by write_unity_sources
+    };
+
+    // Fully resolved description of one project configuration, shared by every
+    // backend that emits GCC/Clang build rules (per-project Makefiles, ninja).
+    // All paths are relative to the directory the build file is written into.
+    struct TargetPlan {
+        std::string config_key;
+        std::string config_name;
+        bool android = false;
+
+        std::string target;             // Output binary/archive path
+        std::string out_dir;            // Ends with '/'
+        std::string int_dir;            // Ends with '/'
+
+        bool has_cpp_files = false;
+        bool has_c_files = false;
+        bool has_objcxx_files = false;
+        bool has_nasm_files = false;
+        bool links_binary = false;      // Application, DynamicLibrary or Driver
+        bool links_with_cxx = false;
+
+        std::string compiler_launcher;  // Prefix for compile commands (empty = none)
+        std::string cxxflags;
+        std::string cflags;
+        std::string objcxx_extra_flags; // Appended to CXXFLAGS for .mm/.m files
+        std::string nasmflags;
+        std::string ldflags;
+        std::string ldlibs;             // Includes dependency archives
+        std::vector<ArchiveEntry> dep_archives;
+
+        bool has_pch = false;
+        std::string pch_header_path;
+        std::string pch_output_path;
+        std::string pch_include_base;   // Passed to -include (without .gch)
+
+        std::vector<CompileStep> compile_steps;
+        std::vector<UnitySource> unity_sources;  // Compiled by the compile_steps with the same source
+        std::string unity_dir;                   // Where unity_sources live, relative to the build file directory
+    };
+
+    // Resolve everything needed to emit build rules for project/config_key.
+    // Writes nothing; with unity_build the unity TUs are only planned.
+    // Returns false (after printing an error) if the configuration is missing.
+    bool plan_target(const Project& project, const std::string& config_key,
+                     const std::filesystem::path& build_file_dir,
+                     const ProjectLookup& project_lookup, TargetPlan& plan);
+
+    // Write the plan's unity TUs under build_file_dir, only when their content
+    // changes so regenerating rebuilds nothing, and delete unity TUs an earlier
+    // generation left in unity_dir. Returns false (after printing an error) if
+    // a directory or file cannot be written.
+    static bool write_unity_sources(const TargetPlan& plan, const std::filesystem::path& build_file_dir);
+
+    // Lookup of buildable (non-package) projects by name
+    static ProjectLookup build_project_lookup(const Solution& solution);
+
+    // Phony target name for a project configuration (e.g. "App.Debug", "App.Debug.Android")
+    static std::string make_project_config_target(const Project& project, const std::string& config_name,
+                                                  bool android = false);
+
+    // Config key the GCC/Clang backends can build for this config name, if any.
+    // android=true selects Android configs; android=false the other non-Windows ones.
+    static std::optional<std::string> find_makefile_config_key(const Project& project,
+                                                               const std::string& config_name,
+                                                               bool android);
+
+    // Emit the flag, output and object variables of one target. var_prefix is
+    // prepended to every variable name ("" in per-project Makefiles).
+    static void write_target_variables(std::ostream& out, const TargetPlan& plan,
+                                       const std::string& var_prefix);
+
+    // Emit the PCH, link and per-object compile rules of one target using the
+    // variables written by write_target_variables with the same prefix
+    static void write_target_rules(std::ostream& out, const Configuration& config,
+                                   const TargetPlan& plan, const std::string& var_prefix,
+                                   const std::string& prebuild_target,
+                                   const std::vector<std::string>& order_only_deps);
+
+    // Per-project Makefiles chained together by the master Makefile
+    bool generate_recursive_makefiles(const Solution& solution, const std::string& output_dir);
+
+    // Emit the Makefile self-regeneration rule (nothing if no command is set)
+    void write_regenerate_rule(std::ostream& out, const Solution& solution) const;
+
+    // Emit install/uninstall rules for the Release (or default) configuration
+    void write_install_rules(std::ostream& out, const Solution& solution,
+                             const std::set<std::string>& configs, const std::string& default_config,
+                             const std::string& output_dir);
 
     bool generate_makefile_with_lookup(const Project& project, const Solution& solution,
                                        const std::string& config_key, const std::string& output_path,
-                                       const ProjectLookup& project_lookup);
+                                       const ProjectLookup& project_lookup,
+                                       std::ostream& log = std::cout);
 
     // Helper functions for assembling flag strings
     std::string get_compiler_flags(const Configuration& config, const Project& project,
@@ -41,6 +198,8 @@ private:
     std::string get_linker_flags(const Configuration& config, const std::filesystem::path& makefile_dir,
                                  bool android);
     std::string get_linker_libs(const Configuration& config);
+    std::string get_file_compiler_flags(const SourceFile& src, const std::string& config_key,
+                                        const std::filesystem::path& makefile_dir);
 
     // Helper to convert Windows paths to Unix paths
     std::string to_unix_path(const std::string& path);
@@ -62,6 +221,14 @@ private:
         const SourceFile& src,
         const std::string& config_key,
         const Configuration& config);
+
+protected:
+    int jobs_ = 0;
+
+private:
+    bool flat_ = false;
+    std::vector<std::string> regenerate_command_;
+    std::string regenerate_dir_;
 };
 
 } // namespace vcxproj
@@ -0,0 +1,467 @@
+#include "pch.h"
+#include "ninja_generator.hpp"
+#include "common/build_cache.hpp"
+#include "common/output_file.hpp"
+#include "common/parallel.hpp"
+
+namespace vcxproj {
+
+std::string NinjaGenerator::escape_path(const std::string& path) {
+    std::string result;
+    result.reserve(path.size());
+    for (char c : path) {
+        if (c == '$' || c == ' ' || c == ':') {
+            result += '$';
+        }
+        result += c;
+    }
+    return result;
+}
+
+std::string NinjaGenerator::escape_value(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        if (c == '$') {
+            result += '$';
+        }
+        result += c;
+    }
+    return result;
+}
+
+std::string NinjaGenerator::join_command_lines(const std::string& command) {
+    std::string result;
+    size_t start = 0;
+    while (start <= command.size()) {
+        size_t end = command.find('\n', start);
+        if (end == std::string::npos) {
+            end = command.size();
+        }
+        std::string line = trim(command.substr(start, end - start));
+        if (!line.empty()) {
+            if (!result.empty()) {
+                result += " && ";
+            }
+            result += line;
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+std::string NinjaGenerator::sanitize_identifier(const std::string& name) {
+    std::string result;
+    result.reserve(name.size());
+    for (unsigned char c : name) {
+        result += (std::isalnum(c) || c == '_') ? static_cast<char>(c) : '_';
+    }
+    return result;
+}
+
+bool NinjaGenerator::generate(Solution& solution, const std::string& output_dir) {
+    namespace fs = std::filesystem;
+
+    // Create output directory if it doesn't exist
+    if (!output_dir.empty() && !fs::exists(output_dir)) {
+        try {
+            fs::create_directories(output_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Failed to create output directory: " << e.what() << "\n";
+            return false;
+        }
+    }
+
+    // Create build directory (same layout as the makefile generator so
+    // relative paths and default output directories match)
+    fs::path build_dir = fs::path(output_dir) / "build";
+    if (!fs::exists(build_dir)) {
+        try {
+            fs::create_directories(build_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Failed to create build directory: " << e.what() << "\n";
+            return false;
+        }
+    }
+
+    std::cout << "Generating build.ninja for solution: " << solution.name << "\n";
+
+    if (!generate_ninja_file(solution, build_dir.string())) {
+        return false;
+    }
+
+    std::cout << "Ninja generation complete!\n";
+
+    // Write build cache for --build support
+    {
+        BuildCache cache;
+        cache.generator = "ninja";
+        cache.solution_name = solution.name;
+        cache.configurations = solution.configurations;
+        for (const auto& p : solution.platforms) {
+            if (!is_windows_platform(p) && !is_android_platform(p)) {
+                cache.platforms.push_back(p);
+            }
+        }
+        cache.build_dir = "build";
+        cache.record_inputs(solution);
+        cache.write(output_dir);
+    }
+
+    return true;
+}
+
+bool NinjaGenerator::generate_ninja_file(const Solution& solution, const std::string& build_dir) {
+    namespace fs = std::filesystem;
+
+    const fs::path ninja_dir(build_dir);
+    const fs::path ninja_path = ninja_dir / NINJA_FILENAME;
+    const ProjectLookup project_lookup = build_project_lookup(solution);
+
+    // Collect desktop config names. Android configs rely on make-time NDK
+    // variables (ANDROID_ABI/ANDROID_API) and stay with the makefile generator.
+    std::set<std::string> configs;
+    bool skipped_android = false;
+    for (const auto& project : solution.projects) {
+        if (project.is_package_project) continue;
+        for (const auto& [config_key, config] : project.configurations) {
+            (void)config;
+            auto [config_name, platform] = parse_config_key(config_key);
+            if (is_windows_platform(platform)) continue;
+            if (is_android_platform(platform)) {
+                skipped_android = true;
+                continue;
+            }
+            configs.insert(config_name);
+        }
+    }
+    if (skipped_android) {
+        std::cerr << "Warning: Android configurations are not supported by the ninja generator; "
+                     "use -g makefile for Android builds.\n";
+    }
+
+    OutputFile out(ninja_path);
+
+    out << "# Auto-generated build.ninja for " << solution.name << "\n";
+    out << "# Generated by sighmake\n";
+
+    if (configs.empty()) {
+        out << "# Empty solution - no targets\n\n";
+        out << "build all: phony\n";
+        out << "default all\n";
+        std::cerr << "Warning: No non-Windows platforms found. build.ninja has no targets.\n";
+        std::cerr << "  Hint: Add 'Linux' to your platforms list, e.g.: platforms = x64, Linux\n";
+        if (!out.commit()) {
+            std::cerr << "Error: Failed to write build.ninja: " << ninja_path << "\n";
+            return false;
+        }
+        std::cout << "Generated: " << ninja_path.string() << "\n";
+        return true;
+    }
+
+    // Plan every project configuration up front so the whole solution is one graph
+    struct PlannedTarget {
+        const Project* project;
+        TargetPlan plan;
+        std::string var_prefix;  // Unique suffix for this target's top-level variables
+        std::string phony;       // e.g. "App.Debug"
+    };
+    std::vector<PlannedTarget> targets;
+    std::vector<std::string> target_keys;
+    for (const auto& project : solution.projects) {
+        if (project.is_package_project) continue;
+        for (const auto& cfg : configs) {
+            auto config_key = find_makefile_config_key(project, cfg, false);
+            if (!config_key) continue;
+
+            PlannedTarget planned;
+            planned.project = &project;
+            planned.var_prefix = sanitize_identifier(project.name + "_" + cfg);
+            planned.phony = make_project_config_target(project, cfg);
+            targets.push_back(std::move(planned));
+            target_keys.push_back(*config_key);
+        }
+    }
+
+    // Targets are planned independently on worker threads (-j)
+    std::vector<char> planned_ok(targets.size(), 0);
+    parallel_for(targets.size(), jobs_, [&](size_t i) {
+        planned_ok[i] = plan_target(*targets[i].project, target_keys[i], ninja_dir, project_lookup,
+                                    targets[i].plan) &&
+                        write_unity_sources(targets[i].plan, ninja_dir);
+    });
+    if (std::find(planned_ok.begin(), planned_ok.end(), 0) != planned_ok.end()) {
+        return false;
+    }
+
+    const std::string default_config = configs.count("Debug") ? "Debug" : *configs.begin();
+
+    out << "# Build default config:    ninja\n";
+    out << "# Build specific config:   ninja Release\n";
+    out << "# Build specific project:  ninja ProjectName\n";
+    out << "# Clean:                   ninja -t clean\n\n";
+
+    out << "ninja_required_version = 1.5\n\n";
+
+#ifdef __APPLE__
+    out << "cxx = clang++\n";
+    out << "cc = clang\n";
+#else
+    out << "cxx = g++\n";
+    out << "cc = gcc\n";
+#endif
+    out << "ar = ar\n";
+    out << "nasm = nasm\n\n";
+
+    // Compile rules use gcc-style depfiles that ninja folds into .ninja_deps,
+    // so no-op builds never re-read thousands of .d files. $launcher is the
+    // project's compiler_launcher plus a space, or empty.
+    out << "rule cxx\n";
+    out << "  command = $launcher$cxx $cxxflags $fileflags $pchflags -MMD -MF $out.d -c -o $out $in\n";
+    out << "  depfile = $out.d\n";
+    out << "  deps = gcc\n";
+    out << "  description = CXX $out\n\n";
+
+    out << "rule cc\n";
+    out << "  command = $launcher$cc $cflags $fileflags $pchflags -MMD -MF $out.d -c -o $out $in\n";
+    out << "  depfile = $out.d\n";
+    out << "  deps = gcc\n";
+    out << "  description = CC $out\n\n";
+
+    out << "rule objcxx\n";
+    out << "  command = $launcher$cxx $objcxxflags $fileflags $pchflags -MMD -MF $out.d -c -o $out $in\n";
+    out << "  depfile = $out.d\n";
+    out << "  deps = gcc\n";
+    out << "  description = OBJCXX $out\n\n";
+
+    out << "rule nasm\n";
+    out << "  command = $nasm $nasmflags -o $out $in\n";
+    out << "  description = NASM $out\n\n";
+
+    out << "rule pch\n";
+    out << "  command = $launcher$cxx $cxxflags -x c++-header -MMD -MF $out.d -o $out $in\n";
+    out << "  depfile = $out.d\n";
+    out << "  deps = gcc\n";
+    out << "  description = PCH $out\n\n";
+
+    out << "rule link\n";
+    out << "  command = $prelink$ld $ldflags -o $out $in $ldlibs$postlink\n";
+    out << "  description = LINK $out\n\n";
+
+    // Archives are rebuilt into a temporary and only replace the old archive
+    // when the contents differ. With restat, dependents are not relinked when
+    // an object was recompiled to identical bytes.
+    out << "rule archive\n";
+    out << "  command = ${prelink}rm -f $out.tmp && $ar rcs $out.tmp $in && "
+           "(cmp -s $out.tmp $out && rm -f $out.tmp || mv -f $out.tmp $out)$postlink\n";
+    out << "  description = AR $out\n";
+    out << "  restat = 1\n\n";
+
+    out << "rule event\n";
+    out << "  command = $cmd\n";
+    out << "  description = $desc\n\n";
+
+    for (const auto& planned : targets) {
+        const Project& project = *planned.project;
+        const TargetPlan& plan = planned.plan;
+        const Configuration& config = project.configurations.at(plan.config_key);
+        const std::string& vp = planned.var_prefix;
+
+        out << "# " << project.name << " (" << plan.config_name << ")\n";
+        if (!plan.compiler_launcher.empty()) {
+            out << "launcher_" << vp << " = " << escape_value(plan.compiler_launcher) << "$ \n";
+        }
+        if (plan.has_cpp_files || plan.has_objcxx_files) {
+            out << "cxxflags_" << vp << " = " << escape_value(plan.cxxflags) << "\n";
+        }
+        if (plan.has_c_files) {
+            out << "cflags_" << vp << " = " << escape_value(plan.cflags) << "\n";
+        }
+        if (plan.has_objcxx_files) {
+            out << "objcxxflags_" << vp << " = $cxxflags_" << vp;
+            if (!plan.objcxx_extra_flags.empty()) {
+                out << " " << escape_value(plan.objcxx_extra_flags);
+            }
+            out << "\n";
+        }
+        if (plan.has_nasm_files) {
+            out << "nasmflags_" << vp << " = " << escape_value(plan.nasmflags) << "\n";
+        }
+        out << "\n";
+
+        // Pre-build event: an edge whose output never exists, so it runs on every build
+        std::string order_only;
+        if (!config.pre_build_event.command.empty()) {
+            const std::string prebuild = planned.phony + ".prebuild";
+            out << "build " << escape_path(prebuild) << ": event\n";
+            out << "  cmd = " << escape_value(join_command_lines(config.pre_build_event.command)) << "\n";
+            out << "  desc = PREBUILD " << project.name << " (" << plan.config_name << ")\n\n";
+            order_only = " || " + escape_path(prebuild);
+        }
+
+        const bool uses_pch_rule = plan.has_pch && !plan.pch_header_path.empty();
+        if (uses_pch_rule) {
+            out << "build " << escape_path(plan.pch_output_path) << ": pch "
+                << escape_path(plan.pch_header_path) << order_only << "\n";
+            out << "  cxxflags = $cxxflags_" << vp << "\n";
+            if (!plan.compiler_launcher.empty()) {
+                out << "  launcher = $launcher_" << vp << "\n";
+            }
+            out << "\n";
+        }
+
+        std::vector<std::string> objects;
+        for (const auto& step : plan.compile_steps) {
+            const char* rule = nullptr;
+            const char* flags_var = nullptr;
+            switch (step.kind) {
+                case CompileKind::Cxx:    rule = "cxx";    flags_var = "cxxflags";    break;
+                case CompileKind::C:      rule = "cc";     flags_var = "cflags";      break;
+                case CompileKind::ObjCxx: rule = "objcxx"; flags_var = "objcxxflags"; break;
+                case CompileKind::Nasm:   rule = "nasm";   flags_var = "nasmflags";   break;
+                case CompileKind::Unknown: break;
+            }
+            if (!rule) continue;
+            objects.push_back(step.object);
+
+            const bool is_nasm = step.kind == CompileKind::Nasm;
+            const bool with_pch = !is_nasm && step.uses_pch && uses_pch_rule;
+
+            out << "build " << escape_path(step.object) << ": " << rule << " " << escape_path(step.source);
+            if (with_pch) {
+                out << " | " << escape_path(plan.pch_output_path);
+            }
+            out << order_only << "\n";
+            out << "  " << flags_var << " = $" << flags_var << "_" << vp << "\n";
+            if (!is_nasm && !plan.compiler_launcher.empty()) {
+                out << "  launcher = $launcher_" << vp << "\n";
+            }
+            if (is_nasm && !config.nasm.path.empty()) {
+                out << "  nasm = " << escape_value(config.nasm.path) << "\n";
+            }
+            if (!step.file_flags.empty()) {
+                out << "  fileflags = " << escape_value(step.file_flags) << "\n";
+            }
+            if (with_pch && !plan.pch_include_base.empty()) {
+                out << "  pchflags = -include \"" << escape_value(plan.pch_include_base) << "\"\n";
+            }
+        }
+        if (!plan.compile_steps.empty()) {
+            out << "\n";
+        }
+
+        // Build-order dependencies on referenced projects (archives are also
+        // implicit inputs of the link edge so changes trigger a relink)
+        std::set<std::string> dep_targets;
+        for (const auto& dep : project.project_references) {
+            const Project* dep_project = project_lookup.find(dep.name);
+            if (!dep_project) continue;
+            if (!find_makefile_config_key(*dep_project, plan.config_name, false)) continue;
+            dep_targets.insert(make_project_config_target(*dep_project, plan.config_name));
+        }
+
+        // Event commands are escaped here; the strip suffix keeps $out as a
+        // ninja variable reference
+        std::string prelink;
+        if (!config.pre_link_event.command.empty()) {
+            prelink = escape_value(join_command_lines(config.pre_link_event.command)) + " && ";
+        }
+        std::string postlink;
+        if (!config.post_build_event.command.empty()) {
+            postlink += " && " + escape_value(join_command_lines(config.post_build_event.command));
+        }
+        if (plan.links_binary && plan.config_name == "Release") {
+#ifdef __APPLE__
+            postlink += config.config_type == "DynamicLibrary" ? " && strip -x $out" : " && strip $out";
+#else
+            postlink += " && strip $out";
+#endif
+        }
+
+        const bool is_static = config.config_type == "StaticLibrary";
+        if (plan.links_binary || is_static) {
+            out << "build " << escape_path(plan.target) << ": " << (is_static ? "archive" : "link");
+            for (const auto& obj : objects) {
+                out << " " << escape_path(obj);
+            }
+            if (!plan.dep_archives.empty()) {
+                out << " |";
+                for (const auto& archive : plan.dep_archives) {
+                    out << " " << escape_path(archive.path);
+                }
+            }
+            if (!order_only.empty() || !dep_targets.empty()) {
+                out << " ||";
+                if (!config.pre_build_event.command.empty()) {
+                    out << " " << escape_path(planned.phony + ".prebuild");
+                }
+                for (const auto& dep_target : dep_targets) {
+                    out << " " << escape_path(dep_target);
+                }
+            }
+            out << "\n";
+            if (!is_static) {
+                out << "  ld = " << (plan.links_with_cxx ? "$cxx" : "$cc") << "\n";
+                out << "  ldflags = " << (config.config_type == "DynamicLibrary" ? "-shared " : "")
+                    << escape_value(plan.ldflags) << "\n";
+                out << "  ldlibs = " << escape_value(plan.ldlibs) << "\n";
+            }
+            if (!prelink.empty()) {
+                out << "  prelink = " << prelink << "\n";
+            }
+            if (!postlink.empty()) {
+                out << "  postlink = " << postlink << "\n";
+            }
+            out << "build " << escape_path(planned.phony) << ": phony " << escape_path(plan.target) << "\n\n";
+        } else {
+            // Utility projects: nothing to link, the phony target just builds the objects
+            out << "build " << escape_path(planned.phony) << ": phony";
+            for (const auto& obj : objects) {
+                out << " " << escape_path(obj);
+            }
+            if (!dep_targets.empty()) {
+                out << " ||";
+                for (const auto& dep_target : dep_targets) {
+                    out << " " << escape_path(dep_target);
+                }
+            }
+            out << "\n\n";
+        }
+    }
+
+    // Per-configuration and per-project aliases
+    out << "# Aliases\n";
+    for (const auto& cfg : configs) {
+        out << "build " << escape_path(cfg) << ": phony";
+        for (const auto& planned : targets) {
+            if (planned.plan.config_name == cfg) {
+                out << " " << escape_path(planned.phony);
+            }
+        }
+        out << "\n";
+    }
+    std::set<std::string> seen_projects;
+    for (const auto& planned : targets) {
+        if (!seen_projects.insert(planned.project->name).second) continue;
+        out << "build " << escape_path(planned.project->name) << ": phony";
+        if (find_makefile_config_key(*planned.project, default_config, false)) {
+            out << " " << escape_path(make_project_config_target(*planned.project, default_config));
+        }
+        out << "\n";
+    }
+    out << "build all: phony " << escape_path(default_config) << "\n\n";
+    out << "default all\n";
+
+    if (!out.commit()) {
+        std::cerr << "Error: Failed to write build.ninja: " << ninja_path << "\n";
+        return false;
+    }
+
+    std::cout << "Generated: " << ninja_path.string() << "\n";
+    return true;
+}
+
+// Register this generator with the factory
+REGISTER_GENERATOR(NinjaGenerator, "ninja");
+
+} // namespace vcxproj
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/project_types.hpp"
+#include "common/generator.hpp"
+#include "generators/makefile_generator.hpp"
+
+namespace vcxproj {
+
+// Generator for a single build.ninja covering every project and configuration.
+// Shares flag assembly and target planning with MakefileGenerator so the two
+// backends always compile with identical command lines.
+class NinjaGenerator : public MakefileGenerator {
+public:
+    NinjaGenerator() = default;
+
+    // Generate build/build.ninja (implements Generator interface)
+    bool generate(Solution& solution, const std::string& output_dir) override;
+
+    // Get generator name
+    std::string name() const override { return "ninja"; }
+
+    // Get generator description
+    std::string description() const override {
+        return "Ninja build file generator for Linux/macOS (GCC/Clang)";
+    }
+
+    // Write the build.ninja for a solution into build_dir
+    bool generate_ninja_file(const Solution& solution, const std::string& build_dir);
+
+    static constexpr const char* NINJA_FILENAME = "build.ninja";
+
+private:
+    // Escape a path for use in a build statement ($, space and colon)
+    static std::string escape_path(const std::string& path);
+
+    // Escape a value for use on the right-hand side of a variable binding
+    static std::string escape_value(const std::string& value);
+
+    // Join the lines of a multi-line build event command with " && " so the
+    // whole command fits on one variable binding
+    static std::string join_command_lines(const std::string& command);
+
+    // Make a string usable as part of a ninja variable name
+    static std::string sanitize_identifier(const std::string& name);
+};
+
+} // namespace vcxproj
@@ -4,6 +4,8 @@
 #include "common/vs_detector.hpp"
 #include "common/toolset_registry.hpp"
 #include "common/build_cache.hpp"
+#include "common/project_graph.hpp"
+#include "common/output_file.hpp"
 #include "common/string_utils.hpp"
 #include "common/file_types.hpp"
 #include "common/compiler_flags.hpp"
@@ -113,6 +115,11 @@ static bool project_matches_dependency_name(const Project& project, const std::s
 }
 
 static const Project* find_dependency_project(const Solution& solution, const std::string& dependency_name) {
+    // Exact project names come straight from the graph; aliases need a scan
+    size_t index = solution.graph().find(dependency_name);
+    if (index != ProjectGraph::npos) {
+        return &solution.projects[index];
+    }
     for (const auto& project : solution.projects) {
         if (project_matches_dependency_name(project, dependency_name)) {
             return &project;
@@ -138,15 +145,6 @@ static std::string to_msvc_filter_path(std::string filter) {
     return filter;
 }
 
-static uint64_t fnv1a64(const std::string& value) {
-    uint64_t hash = 14695981039346656037ull;
-    for (unsigned char c : value) {
-        hash ^= c;
-        hash *= 1099511628211ull;
-    }
-    return hash;
-}
-
 static std::string make_stable_filter_guid(const std::string& seed) {
     uint64_t high = fnv1a64(seed);
     uint64_t low = fnv1a64(seed + "#filter");
@@ -172,6 +170,15 @@ static void collect_filter_and_parents(const std::string& filter, std::set<std::
     }
 }
 
+// Serializes doc exactly as xml_document::save_file would ("wb" mode) but only
+// touches the file when the bytes changed, so Visual Studio doesn't reload it
+static bool save_xml_if_changed(const pugi::xml_document& doc, const std::string& path,
+                                const char* indent, unsigned int flags) {
+    std::ostringstream buffer;
+    doc.save(buffer, indent, flags);
+    return write_file_if_changed(path, buffer.str(), true) != WriteResult::Failed;
+}
+
 std::string VcxprojGenerator::escape_xml(const std::string& str) {
     std::string result;
     result.reserve(str.size());
@@ -695,20 +702,18 @@ bool VcxprojGenerator::generate_vcxproj(const Project& project, const Solution&
                     if (!dep.link_library_dependencies) continue;
                     if (!dep.whole_archive) continue;
                     // Find the dependency project to determine its output library name
-                    for (const auto& sol_proj : solution.projects) {
-                        if (sol_proj.name == dep.name) {
-                            std::string lib_name;
-                            auto dep_cfg_it = sol_proj.configurations.find(config_key);
-                            if (dep_cfg_it != sol_proj.configurations.end() && !dep_cfg_it->second.target_name.empty()) {
-                                lib_name = dep_cfg_it->second.target_name;
-                            } else {
-                                lib_name = sol_proj.name;
-                            }
-                            if (!whole_archive_opts.empty()) whole_archive_opts += " ";
-                            whole_archive_opts += "/WHOLEARCHIVE:" + lib_name;
-                            break;
-                        }
+                    size_t dep_index = solution.graph().find(dep.name);
+                    if (dep_index == ProjectGraph::npos) continue;
+                    const Project& sol_proj = solution.projects[dep_index];
+                    std::string lib_name;
+                    auto dep_cfg_it = sol_proj.configurations.find(config_key);
+                    if (dep_cfg_it != sol_proj.configurations.end() && !dep_cfg_it->second.target_name.empty()) {
+                        lib_name = dep_cfg_it->second.target_name;
+                    } else {
+                        lib_name = sol_proj.name;
                     }
+                    if (!whole_archive_opts.empty()) whole_archive_opts += " ";
+                    whole_archive_opts += "/WHOLEARCHIVE:" + lib_name;
                 }
                 // Combine existing additional_options with whole-archive flags
                 std::string combined_options = cfg.link.additional_options;
@@ -1420,7 +1425,7 @@ bool VcxprojGenerator::generate_vcxproj(const Project& project, const Solution&
     }
 
     // Save to file
-    bool saved = doc.save_file(output_path.c_str(), "  ", pugi::format_default | pugi::format_write_bom);
+    bool saved = save_xml_if_changed(doc, output_path, "  ", pugi::format_default | pugi::format_write_bom);
     if (!saved) {
         return false;
     }
@@ -1478,14 +1483,11 @@ bool VcxprojGenerator::generate_vcxproj_filters(const Project& project, const st
 
     fs::path filters_path = vcxproj_path;
     filters_path += ".filters";
-    return doc.save_file(filters_path.string().c_str(), "  ", pugi::format_default | pugi::format_write_bom);
+    return save_xml_if_changed(doc, filters_path.string(), "  ", pugi::format_default | pugi::format_write_bom);
 }
 
 bool VcxprojGenerator::generate_sln(const Solution& solution, const std::string& output_path) {
-    std::ofstream file(output_path);
-    if (!file.is_open()) {
-        return false;
-    }
+    OutputFile file(output_path);
 
     // Header - version-appropriate for the target toolset
     std::string toolset = resolve_solution_toolset(solution);
@@ -1602,8 +1604,7 @@ bool VcxprojGenerator::generate_sln(const Solution& solution, const std::string&
     }
 
     file << "EndGlobal\n";
-    file.close();
-    return true;
+    return file.commit();
 }
 
 bool VcxprojGenerator::generate_slnx(const Solution& solution, const std::string& output_path) {
@@ -1689,7 +1690,7 @@ bool VcxprojGenerator::generate_slnx(const Solution& solution, const std::string
     }
 
     // Save to file with tab indentation
-    return doc.save_file(output_path.c_str(), "\t", pugi::format_default);
+    return save_xml_if_changed(doc, output_path, "\t", pugi::format_default);
 }
 
 bool VcxprojGenerator::generate(Solution& solution, const std::string& output_dir) {
@@ -1919,6 +1920,7 @@ bool VcxprojGenerator::generate(Solution& solution, const std::string& output_di
             }
         }
         cache.build_dir = build_dir_;
+        cache.record_inputs(solution);
         cache.write(output_dir);
     }
 
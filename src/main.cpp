@@ -7,11 +7,17 @@
 #include "generators/vcxproj_generator.hpp"
 #include "generators/makefile_generator.hpp"
 #include "generators/deps_exporter.hpp"
+#include "generators/compile_commands_exporter.hpp"
 #include "generators/cmake_generator.hpp"
 #include "parsers/vcxproj_reader.hpp"
 #include "parsers/vcproj_reader.hpp"
 #include "common/toolset_registry.hpp"
 #include "common/build_runner.hpp"
+#include "common/build_cache.hpp"
+#include "common/build_trace.hpp"
+#include "common/object_cache.hpp"
+#include "common/output_file.hpp"
+#include "common/timings.hpp"
 #include "common/updater.hpp"
 #include "common/string_utils.hpp"
 #include "common/defaults.hpp"
@@ -29,12 +35,28 @@ void print_usage(const char* program_name) {
     std::cout << "  .buildscript               Sighmake buildscript (INI-style)\n";
     std::cout << "  CMakeLists.txt / .cmake    CMake project files\n\n";
     std::cout << "Generation options:\n";
-    std::cout << "  -g, --generator <type>     Generator type (vcxproj, cmake, makefile, buildscript)\n";
+    std::cout << "  -g, --generator <type>     Generator type (vcxproj, cmake, makefile, ninja,\n";
+    std::cout << "                             buildscript)\n";
     std::cout << "  -B, --build-dir <dir>      Subdirectory for generated .vcxproj/.sln/.slnx\n";
     std::cout << "                             (vcxproj generator only; default: build)\n";
+    std::cout << "      --flat                 Emit one non-recursive Makefile for the whole\n";
+    std::cout << "                             solution (makefile generator only)\n";
+    std::cout << "      --fresh                Regenerate even if no buildscript input changed\n";
+    std::cout << "  -j, --parallel <N>         Worker threads for recursive wildcards, top-level\n";
+    std::cout << "                             includes and makefile/ninja generation\n";
+    std::cout << "                             (default: one per core)\n";
     std::cout << "  -D <NAME>=<VALUE>          Define a variable for ${NAME} substitution\n";
     std::cout << "  -t, --toolset <name>       Default toolset (msvc2022, msvc2019, etc)\n";
-    std::cout << "      --export-deps          Export dependency report as HTML\n\n";
+    std::cout << "      --export-deps          Export dependency report as HTML and JSON\n";
+    std::cout << "      --deps-weight <w>      Weight the report's critical path by 'projects'\n";
+    std::cout << "                             (default) or compiled 'sources'\n";
+    std::cout << "      --deps-trace <file>    Weight it by project build times from --build --trace\n";
+    std::cout << "      --compile-commands     Write compile_commands.json (any generator)\n";
+    std::cout << "      --compile-commands-config <cfg>\n";
+    std::cout << "                             Configuration for compile_commands.json\n";
+    std::cout << "                             (default: Debug)\n";
+    std::cout << "      --timings              Print wall time and counters per phase\n";
+    std::cout << "      --timings-trace <file> Write phase timings as Chrome trace JSON\n\n";
     std::cout << "Build options:\n";
     std::cout << "  -b, --build <dir>          Build using previously generated project files\n";
     std::cout << "      --config <cfg>         Build configuration (e.g. Debug, Release)\n";
@@ -43,7 +65,19 @@ void print_usage(const char* program_name) {
     std::cout << "      --no-project-references Do not build referenced projects with --project\n";
     std::cout << "      --clean                Clean build artifacts without building\n";
     std::cout << "      --clean-first          Clean before building\n";
-    std::cout << "  -j, --parallel <N>         Parallel build jobs\n\n";
+    std::cout << "  -j, --parallel <N>         Parallel build jobs\n";
+    std::cout << "      --executor native      Run build.ninja in-process (ninja generator; no\n";
+    std::cout << "                             make or ninja needed)\n";
+    std::cout << "      --trace <file>         Time every compile and link (makefile builds and\n";
+    std::cout << "                             --executor native) and write a Chrome trace plus\n";
+    std::cout << "                             the slowest sources\n";
+    std::cout << "      --cache                Reuse objects from the local object cache\n";
+    std::cout << "                             (makefile builds and --executor native)\n";
+    std::cout << "      --cache-dir <dir>      Object cache directory (implies --cache; default:\n";
+    std::cout << "                             ~/.cache/sighmake/objects)\n";
+    std::cout << "      --cache-size <size>    Evict least recently used objects above this size\n";
+    std::cout << "                             (default: 5G)\n";
+    std::cout << "      --cache-stats [dir]    Print object cache hit/miss statistics\n\n";
     std::cout << "Conversion:\n";
     std::cout << "  -c, --convert              Convert Visual Studio solutions (.sln/.slnx) or\n";
     std::cout << "                             single projects (.vcxproj/.vcproj) to buildscripts\n";
@@ -61,6 +95,7 @@ void print_usage(const char* program_name) {
     std::cout << "  " << program_name << " project.buildscript -t msvc2022\n";
     std::cout << "  " << program_name << " project.buildscript -D ENGINE=C:/Engine\n";
     std::cout << "  " << program_name << " CMakeLists.txt -g makefile\n";
+    std::cout << "  " << program_name << " project.buildscript -g ninja\n";
     std::cout << "  " << program_name << " --build . --config Release -j 8\n";
     std::cout << "  " << program_name << " --build . --config Debug --project MyPlugin --no-project-references\n";
     std::cout << "  " << program_name << " --convert solution.slnx\n";
@@ -71,8 +106,38 @@ void print_usage(const char* program_name) {
     std::cout << "  SIGHMAKE_DEFAULT_TOOLSET   Default toolset when -t is not specified\n";
     std::cout << "  SIGHMAKE_UPDATE_MANIFEST_URL Override updater manifest URL\n";
     std::cout << "  SIGHMAKE_DEBUG             Set to 1 for verbose [DEBUG] diagnostics\n";
+    std::cout << "  SIGHMAKE_COMPILER_LAUNCHER Compiler launcher for --build (e.g. ccache)\n";
 }
 
+// Prints the --timings summary and writes the --timings-trace file when
+// generation ends, whichever way main returns
+class TimingReport {
+public:
+    TimingReport(bool summary, std::string trace_path)
+        : summary_(summary), trace_path_(std::move(trace_path)) {
+        if (summary_ || !trace_path_.empty()) {
+            vcxproj::enable_timings();
+        }
+    }
+
+    ~TimingReport() {
+        if (summary_) {
+            vcxproj::write_timing_summary(std::cout);
+        }
+        if (!trace_path_.empty()) {
+            if (vcxproj::write_timing_trace(trace_path_)) {
+                std::cout << "Timing trace: " << trace_path_ << "\n";
+            } else {
+                std::cerr << "Warning: Failed to write timing trace " << trace_path_ << "\n";
+            }
+        }
+    }
+
+private:
+    bool summary_;
+    std::string trace_path_;
+};
+
 void print_update_usage(const char* program_name) {
     std::cout << "Usage: " << program_name << " update [options]\n\n";
     std::cout << "Options:\n";
@@ -83,6 +148,11 @@ void print_update_usage(const char* program_name) {
 
 int main(int argc, char* argv[]) {
 
+    // Recipe shell hook installed by --build --trace: `sighmake --trace-command -c <line>`
+    if (argc == 4 && strcmp(argv[1], vcxproj::TRACE_COMMAND_FLAG) == 0 && strcmp(argv[2], "-c") == 0) {
+        return vcxproj::run_traced_command(argv[3]);
+    }
+
     // Check for SIGHMAKE_DEFAULT_TOOLSET environment variable
     if (const char* env_toolset = std::getenv("SIGHMAKE_DEFAULT_TOOLSET")) {
         auto& registry = vcxproj::ToolsetRegistry::instance();
@@ -179,6 +249,24 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // Object cache statistics: `--cache-stats [dir]`
+    if (strcmp(argv[1], "--cache-stats") == 0) {
+        vcxproj::ObjectCache cache(argc >= 3 ? argv[2] : vcxproj::ObjectCache::default_directory());
+        const vcxproj::ObjectCacheStats stats = cache.stats();
+        const uint64_t lookups = stats.hits + stats.misses;
+        std::cout << "Object cache: " << cache.directory() << "\n";
+        std::cout << "  hits         " << stats.hits;
+        if (lookups > 0) {
+            std::cout << " (" << (stats.hits * 100 / lookups) << "%)";
+        }
+        std::cout << "\n";
+        std::cout << "  misses       " << stats.misses << "\n";
+        std::cout << "  uncacheable  " << stats.uncacheable << "\n";
+        std::cout << "  evictions    " << stats.evictions << "\n";
+        std::cout << "  size         " << stats.bytes << " bytes\n";
+        return 0;
+    }
+
     // Handle --build mode
     if (argc >= 2 && (strcmp(argv[1], "--build") == 0 || strcmp(argv[1], "-b") == 0)) {
         if (argc < 3) {
@@ -205,6 +293,30 @@ int main(int argc, char* argv[]) {
                 options.build_project_references = false;
             } else if ((strcmp(argv[i], "--parallel") == 0 || strcmp(argv[i], "-j") == 0) && i + 1 < argc) {
                 options.parallel = std::atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--executor") == 0 && i + 1 < argc) {
+                options.executor = argv[++i];
+                if (options.executor != "native") {
+                    std::cerr << "Error: Unknown executor '" << options.executor << "' (expected 'native')\n";
+                    return 1;
+                }
+            } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                options.trace_file = argv[++i];
+                options.executable = vcxproj::updater::current_executable_path(argv[0]);
+            } else if (strcmp(argv[i], "--cache") == 0) {
+                if (options.cache_dir.empty()) {
+                    options.cache_dir = vcxproj::ObjectCache::default_directory();
+                }
+                options.executable = vcxproj::updater::current_executable_path(argv[0]);
+            } else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+                options.cache_dir = fs::absolute(argv[++i]).string();
+                options.executable = vcxproj::updater::current_executable_path(argv[0]);
+            } else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+                auto size = vcxproj::ObjectCache::parse_size(argv[++i]);
+                if (!size || *size == 0) {
+                    std::cerr << "Error: Invalid --cache-size '" << argv[i] << "' (expected e.g. 500M or 5G)\n";
+                    return 1;
+                }
+                options.cache_size = *size;
             } else {
                 std::cerr << "Error: Unknown --build option: " << argv[i] << "\n";
                 return 1;
@@ -228,7 +340,15 @@ int main(int argc, char* argv[]) {
     std::string default_toolset;
     bool convert_mode = false;
     bool export_deps = false;
+    vcxproj::DependencyReportOptions deps_options;
+    bool export_compile_db = false;
+    std::string compile_db_config;
+    bool flat_makefile = false;
+    bool fresh = false;
+    int generation_jobs = 0;  // 0 = one worker per core
     std::map<std::string, std::string> cli_variables;
+    bool timings = false;
+    std::string timings_trace_path;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -286,8 +406,58 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: -B requires an argument\n";
                 return 1;
             }
+        } else if (strcmp(argv[i], "--flat") == 0) {
+            flat_makefile = true;
+        } else if (strcmp(argv[i], "--fresh") == 0) {
+            fresh = true;
+        } else if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--parallel") == 0) {
+            if (i + 1 < argc) {
+                generation_jobs = std::atoi(argv[++i]);
+            } else {
+                std::cerr << "Error: -j requires an argument\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--timings") == 0) {
+            timings = true;
+        } else if (strcmp(argv[i], "--timings-trace") == 0) {
+            if (i + 1 < argc) {
+                timings_trace_path = argv[++i];
+            } else {
+                std::cerr << "Error: --timings-trace requires an argument\n";
+                return 1;
+            }
         } else if (strcmp(argv[i], "--export-deps") == 0) {
             export_deps = true;
+        } else if (strcmp(argv[i], "--deps-weight") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "projects") == 0) {
+                deps_options.weight = vcxproj::DependencyWeight::Projects;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "sources") == 0) {
+                deps_options.weight = vcxproj::DependencyWeight::Sources;
+            } else {
+                std::cerr << "Error: --deps-weight requires 'projects' or 'sources'\n";
+                return 1;
+            }
+            ++i;
+            export_deps = true;
+        } else if (strcmp(argv[i], "--deps-trace") == 0) {
+            if (i + 1 < argc) {
+                deps_options.weight = vcxproj::DependencyWeight::BuildTime;
+                deps_options.trace_file = argv[++i];
+                export_deps = true;
+            } else {
+                std::cerr << "Error: --deps-trace requires an argument\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--compile-commands") == 0) {
+            export_compile_db = true;
+        } else if (strcmp(argv[i], "--compile-commands-config") == 0) {
+            if (i + 1 < argc) {
+                compile_db_config = argv[++i];
+                export_compile_db = true;
+            } else {
+                std::cerr << "Error: --compile-commands-config requires an argument\n";
+                return 1;
+            }
         } else if (strcmp(argv[i], "-D") == 0) {
             if (i + 1 < argc) {
                 std::string def = argv[++i];
@@ -316,6 +486,9 @@ int main(int argc, char* argv[]) {
         return 1;
 
     }
+    TimingReport timing_report(timings, timings_trace_path);
+    vcxproj::TimingScope total_timing("total");
+
     // Apply CLI default toolset if specified
     if (!default_toolset.empty()) {
         auto& registry = vcxproj::ToolsetRegistry::instance();
@@ -378,7 +551,7 @@ int main(int argc, char* argv[]) {
                 proj.vcxproj_path = input_path.filename().string();
 
                 solution.name = proj.name;
-                solution.uuid = vcxproj::generate_uuid();
+                solution.uuid = vcxproj::make_stable_uuid("solution|" + solution.name);
 
                 std::set<std::string> configs, platforms;
                 for (const auto& [config_key, cfg] : proj.configurations) {
@@ -424,7 +597,8 @@ int main(int argc, char* argv[]) {
             }
 
             if (export_deps) {
-                vcxproj::export_dependencies_html(solution, base_dir);
+                vcxproj::export_dependencies_html(solution, base_dir, deps_options);
+                vcxproj::export_dependencies_json(solution, base_dir, deps_options);
             }
 
             std::cout << "\nSuccess! Generated " << solution.projects.size() << " buildscript(s).\n";
@@ -432,6 +606,36 @@ int main(int argc, char* argv[]) {
         }
 
         // Normal mode: buildscript -> project files
+
+        // Everything besides the input files that shapes the generated output.
+        // -j is left out on purpose: generation is deterministic across job counts.
+        // The toolset is the effective default, whether it came from -t or
+        // SIGHMAKE_DEFAULT_TOOLSET.
+        std::string generation_options = std::string("version=") + SIGHMAKE_VERSION +
+                                         ";generator=" + generator_type +
+                                         ";toolset=" + vcxproj::ToolsetRegistry::instance().get_default() +
+                                         ";build_dir=" + build_dir +
+                                         ";flat=" + (flat_makefile ? "1" : "0") +
+                                         ";export_deps=" + (export_deps ? "1" : "0") +
+                                         ";deps_weight=" + std::to_string(static_cast<int>(deps_options.weight)) +
+                                         ":" + deps_options.trace_file +
+                                         ";compile_commands=" + (export_compile_db ? "1:" + compile_db_config : "0");
+        for (const auto& [name, value] : cli_variables) {
+            generation_options += ";D:" + name + "=" + value;
+        }
+        std::replace(generation_options.begin(), generation_options.end(), '\n', ' ');
+
+        // Skip parsing and generation entirely when no recorded input changed
+        if (!fresh) {
+            vcxproj::TimingScope timing("BuildCache::is_up_to_date");
+            auto cache = vcxproj::BuildCache::read(output_dir);
+            if (cache && cache->is_up_to_date(generation_options, output_dir)) {
+                std::cout << "Up to date: no buildscript inputs changed since the last generation "
+                             "(use --fresh to regenerate).\n";
+                return 0;
+            }
+        }
+
         vcxproj::Solution solution;
         fs::path input_path(buildscript_path);
         std::string filename = vcxproj::to_lower(input_path.filename().string());
@@ -440,6 +644,7 @@ int main(int argc, char* argv[]) {
         if (filename == "cmakelists.txt" || ext == ".cmake") {
             std::cout << "Parsing CMake file: " << buildscript_path << "\n";
             vcxproj::CMakeParser parser;
+            parser.set_jobs(generation_jobs);
             solution = parser.parse(buildscript_path);
         } else {
             std::cout << "Parsing buildscript: " << buildscript_path << "\n";
@@ -447,11 +652,18 @@ int main(int argc, char* argv[]) {
             if (!cli_variables.empty()) {
                 parser.set_variables(cli_variables);
             }
+            parser.set_jobs(generation_jobs);
+            parser.set_package_cache_dir(output_dir, !fresh);
             solution = parser.parse(buildscript_path);
         }
 
         std::cout << "Solution: " << solution.name << "\n";
         std::cout << "Projects: " << solution.projects.size() << "\n";
+        solution.generation_options = generation_options;
+        vcxproj::add_timing_counter("projects", solution.projects.size());
+        for (const auto& project : solution.projects) {
+            vcxproj::add_timing_counter("source files", project.sources.size());
+        }
 
         // Create the appropriate generator
         auto& factory = vcxproj::GeneratorFactory::instance();
@@ -481,20 +693,69 @@ int main(int argc, char* argv[]) {
                       << generator->name() << "'.\n";
         }
 
+        // Makefile-based generators plan and write targets on -j worker threads,
+        // and generated Makefiles re-run this exact command when inputs change
+        if (auto* makegen = dynamic_cast<vcxproj::MakefileGenerator*>(generator.get())) {
+            makegen->set_jobs(generation_jobs);
+
+            std::vector<std::string> regenerate_command;
+            regenerate_command.push_back(vcxproj::updater::current_executable_path(argv[0]));
+            for (int i = 1; i < argc; i++) {
+                // Flags that only report on this run are not repeated
+                if (strcmp(argv[i], "--fresh") == 0 || strcmp(argv[i], "--timings") == 0) {
+                    continue;
+                }
+                if (strcmp(argv[i], "--timings-trace") == 0) {
+                    ++i;
+                    continue;
+                }
+                regenerate_command.push_back(argv[i]);
+            }
+            makegen->set_regenerate_command(std::move(regenerate_command), fs::current_path().string());
+        }
+
+        // --flat selects the single non-recursive Makefile layout
+        if (flat_makefile) {
+            auto* makegen = dynamic_cast<vcxproj::MakefileGenerator*>(generator.get());
+            if (makegen && generator->name() == "makefile") {
+                makegen->set_flat(true);
+            } else {
+                std::cerr << "Warning: --flat is only honored by the makefile generator; ignored for '"
+                          << generator->name() << "'.\n";
+            }
+        }
+
         // Generate project files
-        if (!generator->generate(solution, output_dir)) {
-            std::cerr << "Error: Generation failed\n";
-            return 1;
+        const std::string generate_phase = "generate (" + generator->name() + ")";
+        {
+            vcxproj::TimingScope timing(generate_phase.c_str());
+            if (!generator->generate(solution, output_dir)) {
+                std::cerr << "Error: Generation failed\n";
+                return 1;
+            }
         }
 
         // Export dependency report if requested
         if (export_deps) {
-            if (!vcxproj::export_dependencies_html(solution, output_dir)) {
+            vcxproj::TimingScope timing("export_dependencies");
+            if (!vcxproj::export_dependencies_html(solution, output_dir, deps_options) ||
+                !vcxproj::export_dependencies_json(solution, output_dir, deps_options)) {
                 std::cerr << "Warning: Failed to generate dependency report\n";
             }
         }
 
-        std::cout << "\nSuccess! All files generated.\n";
+        // Export compilation database if requested
+        if (export_compile_db) {
+            vcxproj::TimingScope timing("export_compile_commands");
+            if (!vcxproj::export_compile_commands(solution, output_dir, compile_db_config)) {
+                std::cerr << "Warning: Failed to generate compile_commands.json\n";
+            }
+        }
+
+        // Files whose content didn't change were left untouched
+        const auto stats = vcxproj::output_stats();
+        std::cout << "\nSuccess! All files generated (" << stats.written << " written, "
+                  << stats.unchanged << " unchanged).\n";
         return 0;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "buildscript_lexer.hpp"
+#include "common/string_utils.hpp"
+
+namespace vcxproj {
+
+namespace {
+
+constexpr std::string_view TRIPLE_QUOTE = "\"\"\"";
+
+// Everything before the first '#'
+std::string_view strip_comment(std::string_view text) {
+    return text.substr(0, text.find('#'));
+}
+
+void append_escaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        if (c == '\n') {
+            out += "\x01n";
+        } else if (c == '\\') {
+            out += "\x01\\";
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // namespace
+
+bool BuildscriptLexer::next_physical(std::string_view& line) {
+    if (pos_ >= source_.size()) {
+        return false;
+    }
+    size_t end = source_.find('\n', pos_);
+    if (end == std::string_view::npos) {
+        end = source_.size();
+    }
+    line = source_.substr(pos_, end - pos_);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);  // CRLF files read in binary mode
+    }
+    pos_ = end + 1;
+    ++line_number_;
+    return true;
+}
+
+bool BuildscriptLexer::next(BuildscriptLine& line) {
+    std::string_view physical;
+    while (next_physical(physical)) {
+        line.line_number = line_number_;
+
+        // A value starting with """ or a lone { continues on the next lines
+        const size_t eq_pos = physical.find('=');
+        if (eq_pos != std::string_view::npos) {
+            const std::string_view prefix = physical.substr(0, eq_pos + 1);
+            const std::string_view value = physical.substr(eq_pos + 1);
+            const size_t first = value.find_first_not_of(" \t");
+
+            if (first != std::string_view::npos && value.compare(first, 3, TRIPLE_QUOTE) == 0) {
+                if (!fold_quoted(prefix, value.substr(first + 3))) {
+                    return false;  // Unterminated at the end of the buffer
+                }
+                line.text = trim_view(folded_);
+                return true;
+            }
+            if (trim_view(strip_comment(value)) == "{") {
+                if (!fold_braced(prefix)) {
+                    return false;
+                }
+                line.text = trim_view(folded_);
+                return true;
+            }
+        }
+
+        line.text = trim_view(physical);
+        return true;
+    }
+    return false;
+}
+
+bool BuildscriptLexer::fold_quoted(std::string_view prefix, std::string_view rest) {
+    folded_.assign(prefix);
+    folded_ += ' ';
+
+    // Closed on the same line
+    size_t close = rest.find(TRIPLE_QUOTE);
+    if (close != std::string_view::npos) {
+        append_escaped(folded_, rest.substr(0, close));
+        return true;
+    }
+    if (!trim_view(rest).empty()) {
+        append_escaped(folded_, rest);
+        append_escaped(folded_, "\n");
+    }
+
+    std::string_view physical;
+    while (next_physical(physical)) {
+        close = physical.find(TRIPLE_QUOTE);
+        if (close != std::string_view::npos) {
+            append_escaped(folded_, physical.substr(0, close));
+            return true;
+        }
+        append_escaped(folded_, physical);
+        append_escaped(folded_, "\n");
+    }
+    return false;
+}
+
+bool BuildscriptLexer::fold_braced(std::string_view prefix) {
+    folded_.assign(prefix);
+    folded_ += ' ';
+    bool first_item = true;
+    auto add_item = [&](std::string_view item) {
+        if (item.empty()) {
+            return;
+        }
+        if (!first_item) {
+            folded_ += ',';
+        }
+        folded_.append(item);
+        first_item = false;
+    };
+
+    std::string_view physical;
+    while (next_physical(physical)) {
+        const std::string_view item = trim_view(strip_comment(physical));
+        // The closing brace ends the last significant item, if any
+        if (!item.empty() && item.back() == '}') {
+            add_item(trim_view(item.substr(0, item.size() - 1)));
+            return true;
+        }
+        add_item(item);
+    }
+    return false;
+}
+
+LexedBuildscript::LexedBuildscript(std::string_view source) {
+    // Logical lines are never longer than the buffer, except for the escapes
+    // of a """ value
+    text.reserve(source.size());
+    BuildscriptLexer lexer(source);
+    BuildscriptLine line;
+    while (lexer.next(line)) {
+        lines.push_back({static_cast<uint32_t>(text.size()),
+                         static_cast<uint32_t>(line.text.size()),
+                         line.line_number});
+        text.append(line.text);
+    }
+}
+
+bool read_buildscript_file(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    content.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    file.seekg(0);
+    file.read(content.data(), static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<size_t>(file.gcount()));
+    return true;
+}
+
+} // namespace vcxproj
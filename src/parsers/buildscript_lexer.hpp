@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vcxproj {
+
+// One logical buildscript line: a physical line, or a whole """ or { }
+// multi-line value folded into a single `key = value` line
+struct BuildscriptLine {
+    std::string_view text;  // Trimmed
+    int line_number = 0;    // 1-based line the logical line starts on
+};
+
+// Single pass over a buildscript buffer. Ordinary lines are views into the
+// buffer, which must outlive the lexer; only multi-line values are copied,
+// into storage the next call reuses. A """ value keeps its newlines and
+// backslashes escaped with \x01 (see unescape_newlines); { } items, one per
+// line with # comments, are joined with commas.
+class BuildscriptLexer {
+public:
+    explicit BuildscriptLexer(std::string_view source) : source_(source) {}
+
+    // Next logical line, valid until the following call; false at the end
+    bool next(BuildscriptLine& line);
+
+private:
+    // Next physical line without its '\n'
+    bool next_physical(std::string_view& line);
+
+    // Folds the rest of a """ value opened on the current line into folded_
+    bool fold_quoted(std::string_view prefix, std::string_view rest);
+
+    // Folds the items of a { } value opened on the current line into folded_
+    bool fold_braced(std::string_view prefix);
+
+    std::string_view source_;
+    size_t pos_ = 0;
+    int line_number_ = 0;
+    std::string folded_;
+};
+
+// Every logical line of a buffer, copied back to back into one string so it
+// outlives the buffer. The parser keeps one per include file and replays it
+// for each include instead of reading and lexing the file again.
+struct LexedBuildscript {
+    struct Line {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        int line_number = 0;
+    };
+
+    std::string text;
+    std::vector<Line> lines;
+
+    explicit LexedBuildscript(std::string_view source);
+
+    size_t size() const { return lines.size(); }
+    BuildscriptLine operator[](size_t i) const {
+        return {std::string_view(text).substr(lines[i].offset, lines[i].length), lines[i].line_number};
+    }
+};
+
+// Reads a whole file with one read; false if it cannot be opened
+bool read_buildscript_file(const std::string& path, std::string& content);
+
+} // namespace vcxproj
@@ -1,9 +1,17 @@
 #include "pch.h"
 #include "buildscript_parser.hpp"
+#include "buildscript_lexer.hpp"
 #include "common/toolset_registry.hpp"
 #include "common/string_utils.hpp"
 #include "common/config_type_utils.hpp"
 #include "common/defaults.hpp"
+#include "common/build_cache.hpp"
+#include "common/glob.hpp"
+#include "common/project_graph.hpp"
+#include "common/timings.hpp"
+#include "common/parallel.hpp"
+
+#include <unordered_set>
 
 namespace fs = std::filesystem;
 
@@ -42,9 +50,44 @@ std::string BuildscriptParser::trim(const std::string& str) {
     return vcxproj::trim(str);
 }
 
+static bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+// Lines that leave deferred includes waiting: blank lines, comments and
+// further include = lines (see BuildscriptParser::flush_deferred_includes)
+static bool keeps_includes_deferred(std::string_view line) {
+    if (line.empty() || line[0] == '#' || line[0] == ';') {
+        return true;
+    }
+    return starts_with(line, "include") && starts_with(trim_view(line.substr(7)), "=");
+}
+
+// Solution settings that parsing a buildscript can change; everything else
+// it adds to the solution belongs to a project
+static bool same_solution_settings(const Solution& a, const Solution& b) {
+    return a.name == b.name &&
+           a.configurations == b.configurations &&
+           a.platforms == b.platforms &&
+           a.solution_level_preprocessor_definitions == b.solution_level_preprocessor_definitions &&
+           a.solution_level_preprocessor_definitions_per_config == b.solution_level_preprocessor_definitions_per_config &&
+           a.compiler_launcher == b.compiler_launcher &&
+           a.target_toolset == b.target_toolset;
+}
+
+static void copy_solution_settings(const Solution& from, Solution& to) {
+    to.name = from.name;
+    to.configurations = from.configurations;
+    to.platforms = from.platforms;
+    to.solution_level_preprocessor_definitions = from.solution_level_preprocessor_definitions;
+    to.solution_level_preprocessor_definitions_per_config = from.solution_level_preprocessor_definitions_per_config;
+    to.compiler_launcher = from.compiler_launcher;
+    to.target_toolset = from.target_toolset;
+}
+
 // Check whether all parentheses outside quoted strings are balanced,
 // used to detect when a multi-line function call is complete.
-static bool parens_balanced(const std::string& str) {
+static bool parens_balanced(std::string_view str) {
     int paren_count = 0;
     bool in_string = false;
     for (size_t i = 0; i < str.size(); ++i) {
@@ -121,140 +164,6 @@ static void apply_target_link_libraries(const std::string& call_text, Project& p
     }
 }
 
-std::string preprocess_multiline(const std::string& content) {
-    std::string processed_content;
-    std::istringstream preprocess_stream(content);
-    std::string line;
-    
-    bool in_multiline_quote = false; // """
-    bool in_brace_block = false;     // { }
-    
-    std::string multiline_accumulator;
-    std::string multiline_prefix;
-    std::vector<std::string> brace_items;
-
-    while (std::getline(preprocess_stream, line)) {
-        if (in_multiline_quote) {
-            // Check if this line contains the closing """
-            size_t close_pos = line.find("\"\"\"");
-            if (close_pos != std::string::npos) {
-                // End of multiline value
-                multiline_accumulator += line.substr(0, close_pos);
-                // Write accumulated multiline as escaped single line
-                processed_content += multiline_prefix;
-                // Escape newlines in accumulated value
-                for (char c : multiline_accumulator) {
-                    if (c == '\n') {
-                        processed_content += "\x01n";
-                    } else if (c == '\\') {
-                        processed_content += "\x01\\";
-                    } else {
-                        processed_content += c;
-                    }
-                }
-                processed_content += "\n";
-                in_multiline_quote = false;
-                multiline_accumulator.clear();
-                multiline_prefix.clear();
-            } else {
-                // Continue accumulating
-                multiline_accumulator += line + "\n";
-            }
-            continue;
-        }
-
-        if (in_brace_block) {
-            // Remove comments for checking }
-            std::string no_comment = line;
-            size_t comment_pos = line.find('#');
-            if (comment_pos != std::string::npos) no_comment = line.substr(0, comment_pos);
-            
-            std::string trimmed = trim(no_comment);
-            
-            // Check for closing brace
-            // We assume } is the last significant char or the only one
-            if (trimmed == "}" || (trimmed.size() > 0 && trimmed.back() == '}')) {
-                 // If line is "file.cpp }", we should capture "file.cpp"
-                 if (trimmed != "}") {
-                     std::string item = trimmed.substr(0, trimmed.size() - 1);
-                     item = trim(item);
-                     if (!item.empty()) brace_items.push_back(item);
-                 }
-                 
-                 // Join items
-                 std::string joined;
-                 for(size_t i=0; i<brace_items.size(); ++i) {
-                     if (i > 0) joined += ",";
-                     joined += brace_items[i];
-                 }
-                 
-                 processed_content += multiline_prefix + joined + "\n";
-                 in_brace_block = false;
-                 brace_items.clear();
-                 multiline_prefix.clear();
-            } else {
-                if (!trimmed.empty()) {
-                    brace_items.push_back(trimmed);
-                }
-            }
-            continue;
-        }
-
-        // Check for start of multiline value or brace block
-        size_t eq_pos = line.find('=');
-        if (eq_pos != std::string::npos) {
-            std::string value_part = line.substr(eq_pos + 1);
-            size_t first_nonspace = value_part.find_first_not_of(" \t");
-            
-            // Check for """
-            if (first_nonspace != std::string::npos &&
-                value_part.substr(first_nonspace, 3) == "\"\"\"") {
-                // Start of multiline value
-                in_multiline_quote = true;
-                multiline_prefix = line.substr(0, eq_pos + 1) + " ";
-                // Check if closing """ is on the same line
-                size_t close_pos = value_part.find("\"\"\"", first_nonspace + 3);
-                if (close_pos != std::string::npos) {
-                    // Single line with """ ... """
-                    multiline_accumulator = value_part.substr(first_nonspace + 3, close_pos - first_nonspace - 3);
-                    processed_content += multiline_prefix;
-                    for (char c : multiline_accumulator) {
-                        if (c == '\n') {
-                            processed_content += "\x01n";
-                        } else if (c == '\\') {
-                            processed_content += "\x01\\";
-                        } else {
-                            processed_content += c;
-                        }
-                    }
-                    processed_content += "\n";
-                    in_multiline_quote = false;
-                    multiline_accumulator.clear();
-                    multiline_prefix.clear();
-                }
-                continue;
-            }
-            
-            // Check for {
-            // Ignore comments in value part
-            std::string no_comment = value_part;
-            size_t comment_pos = value_part.find('#');
-            if (comment_pos != std::string::npos) no_comment = value_part.substr(0, comment_pos);
-            
-            if (trim(no_comment) == "{") {
-                in_brace_block = true;
-                multiline_prefix = line.substr(0, eq_pos + 1) + " ";
-                continue;
-            }
-        }
-        
-        // Normal line, pass through
-        processed_content += line + "\n";
-    }
-
-    return processed_content;
-}
-
 std::vector<std::string> BuildscriptParser::split(const std::string& str, char delim) {
     std::vector<std::string> tokens;
     std::stringstream ss(str);
@@ -268,6 +177,30 @@ std::vector<std::string> BuildscriptParser::split(const std::string& str, char d
     return tokens;
 }
 
+std::vector<std::string> BuildscriptParser::split_file_list(const std::string& str) {
+    // Like split(str, ','), but a comma inside a glob brace set ({cpp,cc})
+    // belongs to the pattern
+    std::vector<std::string> tokens;
+    std::string token;
+    int depth = 0;
+    for (char c : str) {
+        if (c == '{') {
+            ++depth;
+        } else if (c == '}' && depth > 0) {
+            --depth;
+        } else if (c == ',' && depth == 0) {
+            std::string trimmed = trim(token);
+            if (!trimmed.empty()) tokens.push_back(trimmed);
+            token.clear();
+            continue;
+        }
+        token += c;
+    }
+    std::string trimmed = trim(token);
+    if (!trimmed.empty()) tokens.push_back(trimmed);
+    return tokens;
+}
+
 std::pair<std::string, bool> BuildscriptParser::parse_filename_with_condition(const std::string& entry) {
     std::string trimmed = trim(entry);
     if (trimmed.empty()) return {"", false};
@@ -323,104 +256,23 @@ BuildscriptParser::parse_filename_with_condition_extended(const std::string& ent
 
 // Helper to check if a path contains wildcard characters
 static bool is_wildcard_path(const std::string& path) {
-    return path.find('*') != std::string::npos;
+    return has_glob_chars(path);
 }
 
 std::vector<std::string> BuildscriptParser::expand_wildcards(const std::string& pattern,
                                                               const std::string& base_path) {
-    std::vector<std::string> result;
-
-    // Check if pattern includes ** for recursive search
-    bool recursive = pattern.find("**") != std::string::npos;
-
-    std::string dir;
-    std::string file_pattern;
-
-    if (recursive) {
-        // Extract the base directory (part before **)
-        size_t star_pos = pattern.find("**");
-        std::string prefix = pattern.substr(0, star_pos);
-
-        // Remove trailing slash/backslash from prefix
-        while (!prefix.empty() && (prefix.back() == '/' || prefix.back() == '\\')) {
-            prefix.pop_back();
-        }
-
-        // Get the file pattern (part after **)
-        std::string suffix = pattern.substr(star_pos + 2);
-        // Remove leading slash/backslash from suffix
-        while (!suffix.empty() && (suffix.front() == '/' || suffix.front() == '\\')) {
-            suffix.erase(0, 1);
-        }
-
-        // Directory is the prefix, file pattern is the filename part of suffix
-        dir = prefix.empty() ? "." : prefix;
-        fs::path suffix_path(suffix);
-        file_pattern = suffix_path.filename().string();
-    } else {
-        fs::path full_pattern = fs::path(base_path) / pattern;
-        dir = full_pattern.parent_path().string();
-        file_pattern = full_pattern.filename().string();
-    }
-
-    if (dir.empty()) dir = ".";
-
-    // Check if this is a wildcard pattern
-    if (file_pattern.find('*') == std::string::npos) {
-        // Not a wildcard, just return the path
-        result.push_back(pattern);
-        return result;
-    }
-
-    // Convert wildcard to regex
-    std::string regex_pattern = file_pattern;
-    // Escape special regex characters except *
-    for (size_t i = 0; i < regex_pattern.size(); ++i) {
-        char c = regex_pattern[i];
-        if (c == '.' || c == '+' || c == '?' || c == '[' || c == ']' ||
-            c == '(' || c == ')' || c == '{' || c == '}' || c == '^' || c == '$') {
-            regex_pattern.insert(i, "\\");
-            ++i;
-        } else if (c == '*') {
-            regex_pattern.replace(i, 1, ".*");
-            ++i;
-        }
-    }
-
-    std::regex re(regex_pattern, std::regex::icase);
-
-    try {
-        fs::path search_dir = fs::path(base_path) / dir;
-        if (fs::exists(search_dir)) {
-            if (recursive) {
-                for (const auto& entry : fs::recursive_directory_iterator(search_dir)) {
-                    if (entry.is_regular_file()) {
-                        std::string filename = entry.path().filename().string();
-                        if (std::regex_match(filename, re)) {
-                            // Make path relative to base_path
-                            std::string rel_path = fs::relative(entry.path(), base_path).string();
-                            result.push_back(rel_path);
-                        }
-                    }
-                }
-            } else {
-                for (const auto& entry : fs::directory_iterator(search_dir)) {
-                    if (entry.is_regular_file()) {
-                        std::string filename = entry.path().filename().string();
-                        if (std::regex_match(filename, re)) {
-                            // Make path relative to base_path
-                            std::string rel_path = fs::relative(entry.path(), base_path).string();
-                            result.push_back(rel_path);
-                        }
-                    }
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Error expanding wildcard " << pattern << ": " << e.what() << "\n";
-    }
-    
-    return result;
+    // Every directory the glob lists is a regeneration input: adding or
+    // removing a file there can change what the pattern matches
+    GlobOptions options;
+    options.cache = &directory_cache();
+    options.jobs = jobs_;
+    options.on_directory = [this](const fs::path& dir) { record_directory_input(dir); };
+
+    TimingScope timing("expand_wildcards");
+    auto matches = glob_files(pattern, base_path, options);
+    add_timing_counter("wildcard patterns");
+    add_timing_counter("wildcard matches", matches.size());
+    return matches;
 }
 
 std::string BuildscriptParser::resolve_path(const std::string& path, const std::string& base_path) {
@@ -466,47 +318,102 @@ std::string BuildscriptParser::resolve_path(const std::string& path, const std::
 }
 
 SourceFile* BuildscriptParser::find_or_create_source(const std::string& path, ParseState& state) {
+    return find_or_create_source_ref(path, state).get();
+}
+
+BuildscriptParser::SourceRef BuildscriptParser::find_or_create_source_ref(const std::string& path,
+                                                                          ParseState& state) {
     if (!state.current_project) return nullptr;
 
     // Resolve path relative to base_path to get absolute path
     std::string abs_path_str = resolve_path(path, state.base_path);
     std::string active_filter = state.get_current_file_filter_path();
 
+    const size_t project_pos = static_cast<size_t>(state.current_project - state.solution->projects.data());
+    if (state.source_index.size() <= project_pos) {
+        state.source_index.resize(project_pos + 1);
+    }
+    auto& index = state.source_index[project_pos];
+    auto& sources = state.current_project->sources;
+
     // Look for existing entry using absolute path
-    for (auto& src : state.current_project->sources) {
-        if (src.path == abs_path_str) {
-            if (!active_filter.empty()) {
-                src.filter = active_filter;
-            }
-            return &src;
+    auto [it, inserted] = index.try_emplace(abs_path_str, sources.size());
+    if (!inserted) {
+        auto& src = sources[it->second];
+        if (!active_filter.empty()) {
+            src.filter = active_filter;
         }
+        return SourceRef(state.solution, project_pos, it->second);
     }
 
     // Create new entry with absolute path
-    state.current_project->sources.emplace_back();
-    auto& src = state.current_project->sources.back();
+    sources.emplace_back();
+    auto& src = sources.back();
     src.path = abs_path_str;
     src.type = get_file_type(abs_path_str);
     src.filter = active_filter;
-    return &src;
+    return SourceRef(state.solution, project_pos, it->second);
 }
 
 void BuildscriptParser::set_variables(const std::map<std::string, std::string>& vars) {
     initial_variables_ = vars;
 }
 
+void BuildscriptParser::set_jobs(int jobs) {
+    jobs_ = jobs;
+}
+
+void BuildscriptParser::set_package_cache_dir(const std::string& dir, bool reuse_results) {
+    package_cache_dir_ = dir;
+    reuse_package_results_ = reuse_results;
+}
+
+void BuildscriptParser::record_directory_input(const fs::path& dir) {
+    std::string path = fs::absolute(dir).lexically_normal().generic_string();
+    if (!recorded_directories_.insert(path).second) {
+        return;
+    }
+    GenerationInput input;
+    input.path = path;
+    input.is_directory = true;
+
+    // Hash the listing the glob already read instead of listing it again
+    auto listing = directory_cache().list(dir);
+    if (listing->exists) {
+        std::vector<std::string> names;
+        names.reserve(listing->entries.size());
+        for (const auto& entry : listing->entries) {
+            names.push_back(entry.is_directory ? entry.name + '/' : entry.name);
+        }
+        input.hash = hash_directory_entries(std::move(names));
+    }
+    inputs_.push_back(std::move(input));
+}
+
 Solution BuildscriptParser::parse(const std::string& filepath) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    TimingScope timing("BuildscriptParser::parse");
+    std::string content;
+    if (!read_buildscript_file(filepath, content)) {
         throw std::runtime_error("Cannot open buildscript: " + filepath);
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-
     fs::path base = fs::path(filepath).parent_path();
 
-    Solution solution = parse_string(buffer.str(), base.empty() ? "." : base.string());
+    if (!package_cache_dir_.empty() && reuse_package_results_) {
+        package_cache_.load(package_cache_dir_);
+    }
+
+    Solution solution = parse_string(content, base.empty() ? "." : base.string());
+
+    if (!package_cache_dir_.empty()) {
+        package_cache_.save(package_cache_dir_);
+    }
+
+    // The top-level buildscript is the first generation input
+    GenerationInput input;
+    input.path = fs::absolute(filepath).lexically_normal().generic_string();
+    input.hash = fnv1a64(content);
+    solution.inputs.insert(solution.inputs.begin(), std::move(input));
 
     // Track the initial file as included
     solution.name = solution.name.empty() && !solution.projects.empty()
@@ -518,7 +425,12 @@ Solution BuildscriptParser::parse(const std::string& filepath) {
 
 Solution BuildscriptParser::parse_string(const std::string& content, const std::string& base_path) {
     Solution solution;
-    solution.uuid = generate_uuid();
+    inputs_.clear();
+    recorded_directories_.clear();
+    directory_cache_.clear();
+    include_cache_.clear();
+    recorded_includes_.clear();
+    package_cache_.begin_run();
     // Initialize with defaults - these will be updated if [config:...] sections are discovered
     solution.configurations = defaults::configurations();
     solution.platforms = defaults::platforms();
@@ -526,18 +438,13 @@ Solution BuildscriptParser::parse_string(const std::string& content, const std::
     ParseState state;
     state.solution = &solution;
     state.base_path = base_path;
+    state.root_path = base_path;
     state.variables = initial_variables_;
 
-    // Pre-process content to handle multiline values (""")
-    std::string processed_content = preprocess_multiline(content);
-
-    // Parse the processed content
-    std::istringstream stream(processed_content);
-    std::string line;
+    parse_lines(LexedBuildscript(content), state);
 
-    while (std::getline(stream, line)) {
-        state.line_number++;
-        parse_line(line, state);
+    if (solution.target_toolset.empty()) {
+        solution.target_toolset = state.first_project_toolset;
     }
 
     // Update configurations from discovered [config:...] sections
@@ -579,7 +486,7 @@ Solution BuildscriptParser::parse_string(const std::string& content, const std::
         sf.name = (last_slash == std::string::npos) ? path : path.substr(last_slash + 1);
         sf.path = path;
         sf.parent = (last_slash == std::string::npos) ? std::string() : path.substr(0, last_slash);
-        sf.uuid = generate_uuid();
+        sf.uuid = make_stable_uuid("folder|" + path);
         solution.folders.push_back(sf);
     }
 
@@ -836,6 +743,14 @@ Solution BuildscriptParser::parse_string(const std::string& content, const std::
             // Users can manually specify ignore_libs if needed
         }
 
+        // Projects use the solution's compiler launcher unless they set one;
+        // "none" opts a project out
+        if (project.compiler_launcher.empty()) {
+            project.compiler_launcher = solution.compiler_launcher;
+        } else if (project.compiler_launcher == "none") {
+            project.compiler_launcher.clear();
+        }
+
         // Apply solution-level preprocessor definitions to ALL projects and configurations
         if (!solution.solution_level_preprocessor_definitions.empty()) {
             for (const auto& config_key : solution.get_config_keys()) {
@@ -955,15 +870,30 @@ Solution BuildscriptParser::parse_string(const std::string& content, const std::
     // This must happen after all projects are parsed and defaults are applied
     propagate_target_link_libraries(solution);
 
+    // Stable solution GUID from the (effective) solution name
+    const std::string& solution_name = solution.name.empty() && !solution.projects.empty()
+                                       ? solution.projects[0].name
+                                       : solution.name;
+    solution.uuid = make_stable_uuid("solution|" + solution_name);
+    // Includes parsed in parallel each record the files they read; keep the
+    // first record of every path
+    std::unordered_set<std::string> seen_inputs;
+    for (auto& input : inputs_) {
+        if (seen_inputs.insert(input.path).second) {
+            solution.inputs.push_back(std::move(input));
+        }
+    }
+    inputs_.clear();
+
     return solution;
 }
 
-void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
-    std::string trimmed = trim(line);
+void BuildscriptParser::parse_line(std::string_view trimmed, ParseState& state) {
 
     // If we're accumulating a uses_pch() call, continue accumulating
     if (state.in_uses_pch) {
-        state.uses_pch_accumulator += " " + trimmed;
+        state.uses_pch_accumulator += ' ';
+        state.uses_pch_accumulator += trimmed;
         if (parens_balanced(state.uses_pch_accumulator)) {
             // Function call complete, parse it
             parse_uses_pch(state.uses_pch_accumulator, state);
@@ -975,7 +905,8 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
 
     // If we're accumulating a target_link_libraries() call, continue accumulating
     if (state.in_target_link_libraries) {
-        state.target_link_libraries_accumulator += " " + trimmed;
+        state.target_link_libraries_accumulator += ' ';
+        state.target_link_libraries_accumulator += trimmed;
         if (parens_balanced(state.target_link_libraries_accumulator)) {
             // Function call complete, parse it
             apply_target_link_libraries(state.target_link_libraries_accumulator, *state.current_project);
@@ -991,18 +922,18 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for if statement
-    if (trimmed.rfind("if", 0) == 0) {
+    if (starts_with(trimmed, "if")) {
         size_t start_paren = trimmed.find('(');
         size_t end_paren = trimmed.rfind(')');
         size_t brace_pos = trimmed.rfind('{');
 
-        if (start_paren != std::string::npos && end_paren != std::string::npos) {
-            std::string condition = trimmed.substr(start_paren + 1, end_paren - start_paren - 1);
-            auto result = evaluate_condition(condition);
+        if (start_paren != std::string_view::npos && end_paren != std::string_view::npos) {
+            auto result = evaluate_condition(
+                std::string(trimmed.substr(start_paren + 1, end_paren - start_paren - 1)));
             bool cond_met = result.should_execute;
             bool parent_exec = state.is_executing();
 
-            if (brace_pos != std::string::npos && brace_pos > end_paren) {
+            if (brace_pos != std::string_view::npos && brace_pos > end_paren) {
                 // Brace on same line: if(condition) {
                 state.conditional_stack.push_back({parent_exec && cond_met, cond_met, 0, result.platform_filter});
             } else {
@@ -1036,10 +967,10 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     // Handle skipping (must be done before other checks)
     if (!state.is_executing()) {
         // Track nested braces to handle if blocks or other blocks inside skipped code
-        if (trimmed.find('{') != std::string::npos) {
+        if (trimmed.find('{') != std::string_view::npos) {
              state.conditional_stack.back().ignored_brace_depth++;
         }
-        if (trimmed.find('}') != std::string::npos) {
+        if (trimmed.find('}') != std::string_view::npos) {
              if (state.conditional_stack.back().ignored_brace_depth > 0) {
                  state.conditional_stack.back().ignored_brace_depth--;
              } else {
@@ -1050,11 +981,11 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for folder() block
-    if (trimmed.rfind("folder", 0) == 0 && trimmed.find('(') != std::string::npos) {
+    if (starts_with(trimmed, "folder") && trimmed.find('(') != std::string_view::npos) {
         size_t start_paren = trimmed.find('(');
         size_t end_paren = trimmed.rfind(')');
-        if (start_paren != std::string::npos && end_paren != std::string::npos && end_paren > start_paren) {
-            std::string folder_name = trim(trimmed.substr(start_paren + 1, end_paren - start_paren - 1));
+        if (start_paren != std::string_view::npos && end_paren != std::string_view::npos && end_paren > start_paren) {
+            std::string folder_name(trim_view(trimmed.substr(start_paren + 1, end_paren - start_paren - 1)));
             // Strip quotes
             if (folder_name.size() >= 2 && folder_name.front() == '"' && folder_name.back() == '"')
                 folder_name = folder_name.substr(1, folder_name.size() - 2);
@@ -1065,7 +996,7 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
                     : ParseState::FolderKind::Solution;
 
             size_t brace_pos = trimmed.rfind('{');
-            if (brace_pos != std::string::npos && brace_pos > end_paren) {
+            if (brace_pos != std::string_view::npos && brace_pos > end_paren) {
                 state.push_folder(folder_name, folder_kind);
             } else {
                 state.pending_folder_brace = true;
@@ -1098,28 +1029,27 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     // Check for section headers (including template syntax like [config:X] : Template:Y)
     if (trimmed[0] == '[') {
         size_t bracket_end = trimmed.find(']');
-        if (bracket_end != std::string::npos) {
-            std::string after = trim(trimmed.substr(bracket_end + 1));
-            if (after.empty() || after.find(": Template:") == 0 || after.find(":Template:") == 0) {
-                parse_section(trimmed, state);
+        if (bracket_end != std::string_view::npos) {
+            std::string_view after = trim_view(trimmed.substr(bracket_end + 1));
+            if (after.empty() || starts_with(after, ": Template:") || starts_with(after, ":Template:")) {
+                parse_section(std::string(trimmed), state);
                 return;
             }
         }
     }
 
     // Check for file_properties() function call
-    if (trimmed.find("file_properties(") == 0) {
+    if (starts_with(trimmed, "file_properties(")) {
         if (!state.current_project) {
-            std::cerr << "Warning: file_properties() outside of project context at line " << state.line_number << "\n";
+            *warnings_ << "Warning: file_properties() outside of project context at line " << state.line_number << "\n";
             return;
         }
 
         // Extract file list between parentheses
         size_t start_paren = trimmed.find('(');
         size_t end_paren = trimmed.rfind(')');
-        if (start_paren != std::string::npos && end_paren != std::string::npos && end_paren > start_paren) {
-            std::string content = trimmed.substr(start_paren + 1, end_paren - start_paren - 1);
-            auto file_paths = split(content, ',');
+        if (start_paren != std::string_view::npos && end_paren != std::string_view::npos && end_paren > start_paren) {
+            auto file_paths = split(std::string(trimmed.substr(start_paren + 1, end_paren - start_paren - 1)), ',');
 
             state.file_properties_files.clear();
             for (const auto& file_path : file_paths) {
@@ -1132,7 +1062,7 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
 
             // Check if the line ends with {
             size_t brace_pos = trimmed.find('{', end_paren);
-            if (brace_pos != std::string::npos) {
+            if (brace_pos != std::string_view::npos) {
                 state.in_file_properties = true;
                 state.current_file = nullptr;  // Clear current file since we're setting multiple files
             }
@@ -1141,19 +1071,19 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for set_file_properties() function call
-    if (trimmed.find("set_file_properties(") == 0) {
+    if (starts_with(trimmed, "set_file_properties(")) {
         if (!state.current_project) {
-            std::cerr << "Warning: set_file_properties() outside of project context at line " << state.line_number << "\n";
+            *warnings_ << "Warning: set_file_properties() outside of project context at line " << state.line_number << "\n";
             return;
         }
 
         // Extract file path (first argument before comma)
         size_t start_paren = trimmed.find('(');
         size_t comma_pos = trimmed.find(',', start_paren);
-        if (start_paren != std::string::npos && comma_pos != std::string::npos) {
-            std::string file_path = trim(trimmed.substr(start_paren + 1, comma_pos - start_paren - 1));
+        if (start_paren != std::string_view::npos && comma_pos != std::string_view::npos) {
+            std::string file_path(trim_view(trimmed.substr(start_paren + 1, comma_pos - start_paren - 1)));
             if (!file_path.empty()) {
-                state.set_file_properties_file = find_or_create_source(file_path, state);
+                state.set_file_properties_file = find_or_create_source_ref(file_path, state);
                 state.in_set_file_properties = true;
                 state.current_file = nullptr;  // Clear current file context
             }
@@ -1177,9 +1107,9 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
         }
         // Parse key = value pairs inside the block
         size_t eq_pos = trimmed.find('=');
-        if (eq_pos != std::string::npos) {
-            std::string cb_key = trim(trimmed.substr(0, eq_pos));
-            std::string cb_value = trim(trimmed.substr(eq_pos + 1));
+        if (eq_pos != std::string_view::npos) {
+            std::string_view cb_key = trim_view(trimmed.substr(0, eq_pos));
+            std::string cb_value(trim_view(trimmed.substr(eq_pos + 1)));
             for (const auto& config_key : state.solution->get_config_keys()) {
                 if (cb_key == "command") {
                     state.custom_build_file->custom_command[config_key] = cb_value;
@@ -1196,9 +1126,9 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for custom_build() function call
-    if (trimmed.find("custom_build(") == 0) {
+    if (starts_with(trimmed, "custom_build(")) {
         if (!state.current_project) {
-            std::cerr << "Warning: custom_build() outside of project context at line " << state.line_number << "\n";
+            *warnings_ << "Warning: custom_build() outside of project context at line " << state.line_number << "\n";
             return;
         }
 
@@ -1206,24 +1136,21 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
         size_t start_paren = trimmed.find('(');
         size_t end_paren = trimmed.rfind(')');
 
-        std::string content;
-        bool is_single_line = (end_paren != std::string::npos && end_paren > start_paren);
+        bool is_single_line = (end_paren != std::string_view::npos && end_paren > start_paren);
 
-        if (is_single_line) {
-            content = trimmed.substr(start_paren + 1, end_paren - start_paren - 1);
-        } else {
-            // Multi-line: first arg is the file path (rest of this line after '(')
-            content = trimmed.substr(start_paren + 1);
-        }
+        // Multi-line: first arg is the file path (rest of this line after '(')
+        std::string_view content = is_single_line
+            ? trimmed.substr(start_paren + 1, end_paren - start_paren - 1)
+            : trimmed.substr(start_paren + 1);
 
         // Parse: first comma-separated token is the file path
-        auto parts = split(content, ',');
+        auto parts = split(std::string(content), ',');
         if (parts.empty()) return;
 
         std::string file_path = trim(parts[0]);
         if (file_path.empty()) return;
 
-        SourceFile* file = find_or_create_source(file_path, state);
+        SourceRef file = find_or_create_source_ref(file_path, state);
         if (!file) return;
         file->type = FileType::CustomBuild;
 
@@ -1231,7 +1158,7 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
         for (size_t i = 1; i < parts.size(); ++i) {
             std::string part = trim(parts[i]);
             size_t eq_pos = part.find('=');
-            if (eq_pos == std::string::npos) continue;
+            if (eq_pos == std::string_view::npos) continue;
             std::string cb_key = trim(part.substr(0, eq_pos));
             std::string cb_value = trim(part.substr(eq_pos + 1));
             for (const auto& config_key : state.solution->get_config_keys()) {
@@ -1256,15 +1183,15 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for target_link_libraries() function call
-    if (trimmed.find("target_link_libraries(") == 0) {
+    if (starts_with(trimmed, "target_link_libraries(")) {
         if (!state.current_project) {
-            std::cerr << "Warning: target_link_libraries() outside of project context at line " << state.line_number << "\n";
+            *warnings_ << "Warning: target_link_libraries() outside of project context at line " << state.line_number << "\n";
             return;
         }
 
         if (parens_balanced(trimmed)) {
             // Single-line function call (all parens matched)
-            apply_target_link_libraries(trimmed, *state.current_project);
+            apply_target_link_libraries(std::string(trimmed), *state.current_project);
         } else {
             // Multi-line function call, start accumulating
             state.in_target_link_libraries = true;
@@ -1274,10 +1201,10 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for uses_pch() function call
-    if (trimmed.find("uses_pch(") == 0) {
+    if (starts_with(trimmed, "uses_pch(")) {
         if (parens_balanced(trimmed)) {
             // Single-line function call (all parens matched)
-            parse_uses_pch(trimmed, state);
+            parse_uses_pch(std::string(trimmed), state);
         } else {
             // Multi-line function call, start accumulating
             state.in_uses_pch = true;
@@ -1287,22 +1214,20 @@ void BuildscriptParser::parse_line(const std::string& line, ParseState& state) {
     }
 
     // Check for find_package() function call
-    if (trimmed.find("find_package(") == 0) {
-        parse_find_package(trimmed, state);
+    if (starts_with(trimmed, "find_package(")) {
+        parse_find_package(std::string(trimmed), state);
         return;
     }
 
     // Parse key=value pairs
     size_t eq_pos = trimmed.find('=');
-    if (eq_pos == std::string::npos) {
-        std::cerr << "Warning: Invalid line " << state.line_number << ": " << trimmed << "\n";
+    if (eq_pos == std::string_view::npos) {
+        *warnings_ << "Warning: Invalid line " << state.line_number << ": " << trimmed << "\n";
         return;
     }
 
-    std::string key = trim(trimmed.substr(0, eq_pos));
-    std::string value = trim(trimmed.substr(eq_pos + 1));
-
-    parse_key_value(key, value, state);
+    const std::string key(trim_view(trimmed.substr(0, eq_pos)));
+    parse_key_value(key, trim_view(trimmed.substr(eq_pos + 1)), state);
 }
 
 bool BuildscriptParser::parse_section(const std::string& line, ParseState& state) {
@@ -1328,7 +1253,10 @@ bool BuildscriptParser::parse_section(const std::string& line, ParseState& state
         state.solution->projects.emplace_back();
         state.current_project = &state.solution->projects.back();
         state.current_project->name = trim(section.substr(8));
-        state.current_project->uuid = generate_uuid();
+        // Derived from the project's name and buildscript location so repeated
+        // generation keeps the same GUID; an explicit uuid key overrides it
+        std::string project_dir = fs::path(state.base_path).lexically_relative(state.root_path).generic_string();
+        state.current_project->uuid = make_stable_uuid("project|" + project_dir + "|" + state.current_project->name);
         state.current_project->root_namespace = state.current_project->name;
         // Store the buildscript directory for path resolution in custom commands
         state.current_project->buildscript_path = state.base_path;
@@ -1342,7 +1270,7 @@ bool BuildscriptParser::parse_section(const std::string& line, ParseState& state
     // [file:path] - for per-file settings block
     if (section.rfind("file:", 0) == 0) {
         std::string file_path = trim(section.substr(5));
-        state.current_file = find_or_create_source(file_path, state);
+        state.current_file = find_or_create_source_ref(file_path, state);
         state.current_config.clear();
         state.current_section = ParseState::SectionContext::File;
         return true;
@@ -1418,12 +1346,19 @@ bool BuildscriptParser::parse_section(const std::string& line, ParseState& state
         return true;
     }
     
-    std::cerr << "Warning: Unknown section '" << section << "' at line " << state.line_number << "\n";
+    *warnings_ << "Warning: Unknown section '" << section << "' at line " << state.line_number << "\n";
     return false;
 }
 
-void BuildscriptParser::parse_key_value(const std::string& key, const std::string& value,
+void BuildscriptParser::parse_key_value(const std::string& key, std::string_view value,
                                          ParseState& state) {
+    // A top-level include waits for the include lines after it, unless its
+    // path depends on variables the includes before it may set
+    if (key == "include" && value.find("${") == std::string_view::npos && can_defer_include(state)) {
+        state.deferred_includes.push_back({std::string(value), state.line_number});
+        return;
+    }
+
     // Resolve ${VARIABLE} references in the value
     std::string resolved_value = resolve_variables(value, state);
 
@@ -1624,7 +1559,41 @@ void BuildscriptParser::parse_key_value(const std::string& key, const std::strin
     }
 }
 
+const BuildscriptParser::IncludeFile& BuildscriptParser::IncludeCache::get(const std::string& canonical_path,
+                                                                         bool& hit) {
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = files_[canonical_path];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+        }
+        entry = slot.get();
+    }
+
+    hit = true;
+    std::call_once(entry->read, [&] {
+        hit = false;
+        IncludeFile& file = entry->file;
+        file.exists = fs::exists(canonical_path);
+        std::string content;
+        if (file.exists && read_buildscript_file(canonical_path, content)) {
+            file.hash = fnv1a64(content);
+            file.lexed = std::make_unique<const LexedBuildscript>(content);
+        }
+    });
+    return entry->file;
+}
+
+void BuildscriptParser::IncludeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.clear();
+}
+
 void BuildscriptParser::process_include(const std::string& include_path, ParseState& state) {
+    TimingScope timing("process_include");
+    add_timing_counter("include files");
+
     // Resolve include path relative to base_path
     fs::path full_path = fs::path(state.base_path) / include_path;
     std::string canonical_path;
@@ -1637,66 +1606,245 @@ void BuildscriptParser::process_include(const std::string& include_path, ParseSt
     }
 
     // Check for circular includes
-    for (const auto& included : state.included_files) {
+    for (const auto& included : state.include_stack) {
         if (included == canonical_path) {
-            std::cerr << "Warning: Circular include detected: " << include_path << "\n";
+            *warnings_ << "Warning: Circular include detected: " << include_path << "\n";
             return;
         }
     }
 
-    // Check if file exists
-    if (!fs::exists(canonical_path)) {
-        std::cerr << "Warning: Include file not found: " << include_path << "\n";
-        return;
+    // Read and lex each file once per parse; later includes replay its lines
+    bool hit = false;
+    const IncludeFile& cached = include_cache().get(canonical_path, hit);
+    if (hit) {
+        add_timing_counter("include cache hits");
     }
 
-    // Mark as included
-    state.included_files.push_back(canonical_path);
+    // Each parser records the inputs it used: a worker's are dropped with its
+    // result if the include is parsed again. A missing file is still an
+    // input: creating it later must trigger regeneration.
+    if ((!cached.exists || cached.lexed) && recorded_includes_.insert(canonical_path).second) {
+        GenerationInput input;
+        input.path = fs::path(canonical_path).lexically_normal().generic_string();
+        if (cached.exists) {
+            input.hash = cached.hash;
+        }
+        inputs_.push_back(std::move(input));
+    }
 
-    // Read and parse the included file
-    std::ifstream file(canonical_path);
-    if (!file.is_open()) {
-        std::cerr << "Warning: Cannot open include file: " << include_path << "\n";
+    if (!cached.exists) {
+        *warnings_ << "Warning: Include file not found: " << include_path << "\n";
         return;
     }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-
-    // Pre-process content to handle multiline values (""")
-    std::string processed_content = preprocess_multiline(buffer.str());
+    if (!cached.lexed) {
+        *warnings_ << "Warning: Cannot open include file: " << include_path << "\n";
+        return;
+    }
+    const LexedBuildscript& lexed = *cached.lexed;
 
     // Parse the included content with the same state
-    std::istringstream stream(processed_content);
-    std::string line;
     int saved_line_number = state.line_number;
-    state.line_number = 0;
 
     // Get base path for the included file
     fs::path include_base = fs::path(canonical_path).parent_path();
     std::string saved_base_path = state.base_path;
     state.base_path = include_base.string();
 
-    // Save and restore current_project and current_file to prevent included files from affecting parent context
-    Project* saved_current_project = state.current_project;
-    SourceFile* saved_current_file = state.current_file;
+    // Save and restore current_project and current_file to prevent included files from affecting parent context.
+    // The project is saved by position: projects the included file adds can reallocate the vector.
+    const size_t saved_current_project = state.current_project
+        ? static_cast<size_t>(state.current_project - state.solution->projects.data())
+        : std::string::npos;
+    SourceRef saved_current_file = state.current_file;
     std::string saved_current_config = state.current_config;
     auto saved_current_section = state.current_section;
 
-    while (std::getline(stream, line)) {
-        state.line_number++;
-        parse_line(line, state);
-    }
+    state.include_stack.push_back(canonical_path);
+    parse_lines(lexed, state);
+    state.include_stack.pop_back();
 
     // Restore original state
     state.line_number = saved_line_number;
     state.base_path = saved_base_path;
-    state.current_project = saved_current_project;
+    state.current_project = saved_current_project == std::string::npos
+        ? nullptr
+        : &state.solution->projects[saved_current_project];
     state.current_file = saved_current_file;
     state.current_config = saved_current_config;
     state.current_section = saved_current_section;
 }
 
+void BuildscriptParser::parse_lines(const LexedBuildscript& lines, ParseState& state) {
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const BuildscriptLine line = lines[i];
+        if (!state.deferred_includes.empty() && !keeps_includes_deferred(line.text)) {
+            flush_deferred_includes(state);
+        }
+        state.line_number = line.line_number;
+        parse_line(line.text, state);
+    }
+    flush_deferred_includes(state);
+}
+
+bool BuildscriptParser::can_defer_include(const ParseState& state) const {
+    // Only includes that parse_key_value hands to parse_solution_setting
+    return jobs_ != 1 &&
+           state.current_project == nullptr &&
+           state.current_file == nullptr &&
+           !state.in_file_properties &&
+           !state.in_set_file_properties;
+}
+
+bool BuildscriptParser::same_open_blocks(const ParseState& a, const ParseState& b) {
+    return a.conditional_stack.size() == b.conditional_stack.size() &&
+           a.is_executing() == b.is_executing() &&
+           a.get_platform_filter() == b.get_platform_filter() &&
+           a.pending_if_condition == b.pending_if_condition &&
+           a.solution_folder_stack == b.solution_folder_stack &&
+           a.file_filter_stack == b.file_filter_stack &&
+           a.folder_kind_stack == b.folder_kind_stack &&
+           a.pending_folder_brace == b.pending_folder_brace &&
+           a.in_uses_pch == b.in_uses_pch &&
+           a.in_target_link_libraries == b.in_target_link_libraries &&
+           a.in_file_properties == b.in_file_properties &&
+           a.in_set_file_properties == b.in_set_file_properties &&
+           a.in_custom_build == b.in_custom_build;
+}
+
+bool BuildscriptParser::same_include_context(const ParseState& a, const ParseState& b) {
+    return same_solution_settings(*a.solution, *b.solution) &&
+           a.discovered_configs == b.discovered_configs &&
+           a.discovered_platforms == b.discovered_platforms &&
+           same_open_blocks(a, b);
+}
+
+void BuildscriptParser::flush_deferred_includes(ParseState& state) {
+    if (state.deferred_includes.empty()) {
+        return;
+    }
+    std::vector<DeferredInclude> includes = std::move(state.deferred_includes);
+    state.deferred_includes.clear();
+    const int saved_line_number = state.line_number;
+
+    if (includes.size() == 1) {
+        state.line_number = includes[0].line_number;
+        process_include(includes[0].path, state);
+        state.line_number = saved_line_number;
+        return;
+    }
+
+    TimingScope timing("parallel includes");
+    add_timing_counter("includes parsed in parallel", includes.size());
+
+    // The state every include starts from. Includes outside a project cannot
+    // reach the projects parsed so far: the snapshot keeps the solution's
+    // settings but neither its projects nor their source index.
+    Solution settings;
+    copy_solution_settings(*state.solution, settings);
+    auto source_index = std::move(state.source_index);
+    state.source_index.clear();
+    ParseState snapshot = state;
+    snapshot.solution = &settings;
+    state.source_index = std::move(source_index);
+
+    struct PartialResult {
+        Solution solution;
+        std::unique_ptr<ParseState> state;
+        std::vector<GenerationInput> inputs;
+        std::ostringstream warnings;
+        std::ostringstream messages;
+        std::exception_ptr error;
+    };
+    std::vector<PartialResult> partials(includes.size());
+
+    parallel_for(includes.size(), jobs_, [&](size_t i) {
+        PartialResult& partial = partials[i];
+        BuildscriptParser worker;
+        worker.jobs_ = 1;
+        worker.shared_directory_cache_ = &directory_cache();
+        worker.shared_package_cache_ = &package_cache();
+        worker.shared_include_cache_ = &include_cache();
+        worker.warnings_ = &partial.warnings;
+        worker.messages_ = &partial.messages;
+
+        copy_solution_settings(*snapshot.solution, partial.solution);
+        partial.state = std::make_unique<ParseState>(snapshot);
+        ParseState& worker_state = *partial.state;
+        worker_state.solution = &partial.solution;
+        worker_state.track_variables = true;
+        worker_state.line_number = includes[i].line_number;
+        try {
+            worker.process_include(includes[i].path, worker_state);
+        } catch (...) {
+            partial.error = std::current_exception();
+        }
+        partial.inputs = std::move(worker.inputs_);
+    });
+
+    // Merge in include order. A result stands only if the includes merged
+    // before it changed nothing it read; otherwise it is parsed again here.
+    Solution& solution = *state.solution;
+    for (size_t i = 0; i < includes.size(); ++i) {
+        PartialResult& partial = partials[i];
+        ParseState& result = *partial.state;
+
+        bool valid = same_include_context(state, snapshot) && same_open_blocks(result, snapshot);
+        for (const auto& [name, seen] : result.variables_read) {
+            if (!valid) break;
+            auto it = state.variables.find(name);
+            valid = it == state.variables.end() ? !seen : seen && *seen == it->second;
+        }
+        if (!valid) {
+            add_timing_counter("includes parsed again");
+            state.line_number = includes[i].line_number;
+            process_include(includes[i].path, state);
+            continue;
+        }
+
+        *warnings_ << partial.warnings.str();
+        *messages_ << partial.messages.str();
+        if (partial.error) {
+            std::rethrow_exception(partial.error);
+        }
+
+        copy_solution_settings(partial.solution, solution);
+        for (auto& [name, package] : partial.solution.found_packages) {
+            solution.found_packages[name] = std::move(package);
+        }
+        result.source_index.resize(partial.solution.projects.size());
+        state.source_index.resize(solution.projects.size());
+        for (size_t p = 0; p < partial.solution.projects.size(); ++p) {
+            solution.projects.push_back(std::move(partial.solution.projects[p]));
+            state.source_index.push_back(std::move(result.source_index[p]));
+        }
+
+        for (const auto& name : result.variables_written) {
+            state.variables[name] = result.variables[name];
+        }
+        state.found_packages.insert(result.found_packages.begin(), result.found_packages.end());
+        if (state.first_project_toolset.empty()) {
+            state.first_project_toolset = result.first_project_toolset;
+        }
+        state.discovered_configs = std::move(result.discovered_configs);
+        state.discovered_platforms = std::move(result.discovered_platforms);
+        state.explicitly_defined_config_keys.insert(result.explicitly_defined_config_keys.begin(),
+                                                    result.explicitly_defined_config_keys.end());
+        state.user_defined_config_sections = state.user_defined_config_sections || result.user_defined_config_sections;
+        for (const auto& [config, template_name] : result.config_templates) {
+            auto before = snapshot.config_templates.find(config);
+            if (before == snapshot.config_templates.end() || before->second != template_name) {
+                state.config_templates[config] = template_name;
+            }
+        }
+        state.pending_template_applications.insert(result.pending_template_applications.begin(),
+                                                   result.pending_template_applications.end());
+
+        inputs_.insert(inputs_.end(), std::make_move_iterator(partial.inputs.begin()),
+                       std::make_move_iterator(partial.inputs.end()));
+    }
+    state.line_number = saved_line_number;
+}
+
 void BuildscriptParser::parse_solution_setting(const std::string& key, const std::string& value,
                                                 ParseState& state) {
     if (key == "name") {
@@ -1714,7 +1862,10 @@ void BuildscriptParser::parse_solution_setting(const std::string& key, const std
             state.solution->solution_level_preprocessor_definitions.end(),
             defs.begin(), defs.end()
         );
+    } else if (key == "compiler_launcher") {
+        state.solution->compiler_launcher = value == "none" ? "" : value;
     } else if (key == "include") {
+        flush_deferred_includes(state);
         process_include(value, state);
     }
 }
@@ -1752,6 +1903,19 @@ bool BuildscriptParser::parse_project_basic_setting(const std::string& key, cons
         proj.uuid = value;
     } else if (key == "root_namespace") {
         proj.root_namespace = value;
+    } else if (key == "compiler_launcher") {
+        proj.compiler_launcher = value;
+    } else if (key == "unity_build") {
+        proj.unity_build = (value == "true" || value == "yes" || value == "1");
+    } else if (key == "unity_batch_size") {
+        char* end = nullptr;
+        long size = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || size < 0) {
+            *warnings_ << "Warning: Invalid unity_batch_size '" << value
+                       << "' at line " << state.line_number << "\n";
+        } else {
+            proj.unity_batch_size = static_cast<int>(size);
+        }
     } else if (key == "ignore_warn_duplicated_filename") {
         proj.ignore_warn_compile_duplicated_filename = (value == "true" || value == "yes" || value == "1");
     } else if (key == "type") {
@@ -1790,7 +1954,7 @@ bool BuildscriptParser::parse_project_basic_setting(const std::string& key, cons
             
             // Warn if unknown (but still allow for forward compatibility)
             if (!registry.is_known(toolset_id)) {
-                std::cerr << "Warning: Unknown toolset '" << toolset_id << "'\n";
+                *warnings_ << "Warning: Unknown toolset '" << toolset_id << "'\n";
             }
             
             for (const auto& config_key : state.solution->get_config_keys()) {
@@ -1798,9 +1962,9 @@ bool BuildscriptParser::parse_project_basic_setting(const std::string& key, cons
             }
             proj.project_level_defaults.platform_toolset = toolset_id;
 
-            // Set solution-level target_toolset if not already set
-            if (state.solution->target_toolset.empty()) {
-                state.solution->target_toolset = toolset_id;
+            // The first one becomes the solution's target_toolset after parsing
+            if (state.first_project_toolset.empty()) {
+                state.first_project_toolset = toolset_id;
             }
         }
     } else if (key == "windows_sdk" || key == "windows_sdk_version" || key == "windows_target_platform_version") {
@@ -1850,7 +2014,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
 
     // Source files - with platform-conditional override support
     if (key == "sources" || key == "src" || key == "files") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
 
         // Pass 1: Collect explicit files with conditions (non-wildcards with conditions)
         // Map: absolute_path -> condition_matched (true if should include)
@@ -1908,7 +2072,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
             }
         }
     } else if (key == "headers" || key == "includes_files") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
 
         // Pass 1: Collect explicit files with conditions
         std::map<std::string, bool> explicit_overrides;
@@ -1955,7 +2119,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
             }
         }
     } else if (key == "resources" || key == "resource_files") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
 
         // Pass 1: Collect explicit files with conditions
         std::map<std::string, bool> explicit_overrides;
@@ -2004,7 +2168,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
     }
     // MASM assembly files
     else if (key == "masm" || key == "asm_sources" || key == "assembly") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
 
         // Mark project as having MASM files
         proj.has_masm_files = true;
@@ -2056,7 +2220,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
     }
     // NASM assembly files
     else if (key == "nasm" || key == "nasm_sources") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
 
         // Mark project as having NASM files
         proj.has_nasm_files = true;
@@ -2108,7 +2272,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
     }
     // Message Compiler (.mc) files
     else if (key == "mc" || key == "mc_sources" || key == "message_compile") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
         proj.has_mc_files = true;
 
         std::map<std::string, bool> explicit_overrides;
@@ -2146,7 +2310,7 @@ bool BuildscriptParser::parse_project_source_setting(const std::string& key, con
     }
     // IDL/MIDL (.idl) files
     else if (key == "idl" || key == "idl_sources" || key == "midl_sources") {
-        auto entries = split(value, ',');
+        auto entries = split_file_list(value);
         proj.has_idl_files = true;
 
         std::map<std::string, bool> explicit_overrides;
@@ -2280,9 +2444,9 @@ bool BuildscriptParser::parse_project_compiler_setting(const std::string& key, c
     } else if (key == "language" || key == "lang") {
         // Validate language value
         if (value != "C" && value != "C++" && !value.empty()) {
-            std::cerr << "Warning: Invalid language '" << value
-                      << "' at line " << state.line_number
-                      << ". Use 'C' or 'C++'.\n";
+            *warnings_ << "Warning: Invalid language '" << value
+                       << "' at line " << state.line_number
+                       << ". Use 'C' or 'C++'.\n";
         }
         proj.language = value;
     } else if (key == "c_standard" || key == "cstd") {
@@ -3001,7 +3165,7 @@ bool BuildscriptParser::parse_config_setting(const std::string& key, const std::
             cfg.platform_toolset = *resolved;
             
             if (!registry.is_known(*resolved)) {
-                std::cerr << "Warning: Unknown toolset '" << *resolved << "'\n";
+                *warnings_ << "Warning: Unknown toolset '" << *resolved << "'\n";
             }
         }
     } else if (key == "windows_sdk" || key == "windows_sdk_version" || key == "windows_target_platform_version") {
@@ -3394,15 +3558,15 @@ void BuildscriptParser::apply_template(Project& project, const std::string& deri
     // Validate template exists
     auto template_it = project.configurations.find(template_key);
     if (template_it == project.configurations.end()) {
-        std::cerr << "Warning: Template configuration '" << template_key
-                  << "' not found for derived config '" << derived_key << "'\n";
+        *warnings_ << "Warning: Template configuration '" << template_key
+                   << "' not found for derived config '" << derived_key << "'\n";
         return;
     }
 
     // Check for circular reference
     if (derived_key == template_key) {
-        std::cerr << "Error: Circular template reference detected: '"
-                  << derived_key << "' references itself\n";
+        *warnings_ << "Error: Circular template reference detected: '"
+                   << derived_key << "' references itself\n";
         return;
     }
 
@@ -3633,7 +3797,7 @@ void BuildscriptParser::apply_template(Project& project, const std::string& deri
 
 void BuildscriptParser::parse_uses_pch(const std::string& line, ParseState& state) {
     if (!state.current_project) {
-        std::cerr << "Warning: uses_pch() outside of project context at line " << state.line_number << "\n";
+        *warnings_ << "Warning: uses_pch() outside of project context at line " << state.line_number << "\n";
         return;
     }
 
@@ -3641,7 +3805,7 @@ void BuildscriptParser::parse_uses_pch(const std::string& line, ParseState& stat
     size_t start_paren = line.find('(');
     size_t end_paren = line.rfind(')');
     if (start_paren == std::string::npos || end_paren == std::string::npos) {
-        std::cerr << "Warning: Malformed uses_pch() at line " << state.line_number << "\n";
+        *warnings_ << "Warning: Malformed uses_pch() at line " << state.line_number << "\n";
         return;
     }
 
@@ -3685,7 +3849,7 @@ void BuildscriptParser::parse_uses_pch(const std::string& line, ParseState& stat
 
     // We should have 3 or 4 parameters: mode, header, [output], file_list
     if (params.size() < 3) {
-        std::cerr << "Warning: uses_pch() requires at least 3 parameters at line " << state.line_number << "\n";
+        *warnings_ << "Warning: uses_pch() requires at least 3 parameters at line " << state.line_number << "\n";
         return;
     }
 
@@ -3785,171 +3949,212 @@ BuildscriptParser::ConditionResult BuildscriptParser::evaluate_condition(const s
          if (sub == "x64") return {is_windows, "Win32"};
     }
 
-    std::cerr << "Warning: Unknown condition '" << condition << "'\n";
+    *warnings_ << "Warning: Unknown condition '" << condition << "'\n";
     return {false, ""};
 }
 
+// Marks the projects that lie on a cycle of edges (Tarjan's strongly
+// connected components, iterative so long chains can't overflow the stack)
+static std::vector<char> find_cycle_members(const std::vector<std::vector<size_t>>& edges) {
+    const size_t npos = ProjectGraph::npos;
+    const size_t count = edges.size();
+    std::vector<size_t> index(count, npos), low(count, 0);
+    std::vector<char> on_stack(count, 0), on_cycle(count, 0);
+    std::vector<size_t> component;
+    std::vector<std::pair<size_t, size_t>> walk;  // (project, next edge)
+    size_t next_index = 0;
+
+    for (size_t root = 0; root < count; ++root) {
+        if (index[root] != npos) continue;
+        walk.push_back({root, 0});
+        index[root] = low[root] = next_index++;
+        component.push_back(root);
+        on_stack[root] = 1;
+
+        while (!walk.empty()) {
+            auto& [node, next] = walk.back();
+            if (next < edges[node].size()) {
+                size_t child = edges[node][next++];
+                if (child == node) {
+                    on_cycle[node] = 1;
+                } else if (index[child] == npos) {
+                    index[child] = low[child] = next_index++;
+                    component.push_back(child);
+                    on_stack[child] = 1;
+                    walk.push_back({child, 0});
+                } else if (on_stack[child]) {
+                    low[node] = std::min(low[node], index[child]);
+                }
+                continue;
+            }
+
+            const size_t done = node;
+            walk.pop_back();
+            if (!walk.empty()) {
+                low[walk.back().first] = std::min(low[walk.back().first], low[done]);
+            }
+            if (low[done] != index[done]) continue;
+
+            // done is the root of a component: pop it off
+            const bool cycle = component.back() != done;
+            size_t member;
+            do {
+                member = component.back();
+                component.pop_back();
+                on_stack[member] = 0;
+                if (cycle) on_cycle[member] = 1;
+            } while (member != done);
+        }
+    }
+    return on_cycle;
+}
+
+// Appends the values of source that list does not contain yet
+static void append_unique(std::vector<std::string>& list, std::unordered_set<std::string>& present,
+                          const std::vector<std::string>& source) {
+    for (const auto& value : source) {
+        if (present.insert(value).second) {
+            list.push_back(value);
+        }
+    }
+}
+
 void BuildscriptParser::propagate_target_link_libraries(Solution& solution) {
     // For each project, propagate public_includes, public_libs, and public_defines
     // from all projects it depends on via target_link_libraries (project_references)
     // Respects CMake-style visibility: PUBLIC, PRIVATE, INTERFACE
-    for (auto& proj : solution.projects) {
-        // Work queue: (dependency_name, effective_visibility)
-        std::vector<std::pair<std::string, DependencyVisibility>> to_process;
-        std::set<std::string> processed;
-
-        // Initialize with direct dependencies
-        for (const auto& dep : proj.project_references) {
-            if (!dep.link_library_dependencies) {
-                continue;
+    //
+    // A dependency's effective visibility never changes along a chain: PUBLIC
+    // and INTERFACE references pass on the visibility of the direct reference,
+    // PRIVATE references stop the chain. So the projects whose public settings
+    // a dependent receives through dependency d depend only on d, and are
+    // computed once per project (its "export closure") in dependencies-first
+    // order, instead of re-walking d's whole subtree for every dependent.
+    TimingScope timing("propagate_target_link_libraries");
+    solution.invalidate_graph();
+    const ProjectGraph& graph = solution.graph();
+    const size_t count = graph.size();
+    const auto config_keys = solution.get_config_keys();
+
+    // References a dependent's requirements travel through
+    std::vector<std::vector<size_t>> exported(count);
+    for (size_t i = 0; i < count; ++i) {
+        for (const auto& edge : graph.dependencies(i)) {
+            const auto& ref = solution.projects[i].project_references[edge.reference];
+            if (ref.link_library_dependencies && ref.visibility != DependencyVisibility::PRIVATE) {
+                exported[i].push_back(edge.project);
             }
-            to_process.push_back({dep.name, dep.visibility});
         }
+    }
 
-        while (!to_process.empty()) {
-            auto [dep_name, visibility] = to_process.back();
-            to_process.pop_back();
-
-            if (processed.count(dep_name)) continue;
-            processed.insert(dep_name);
-
-            // Find the dependency project
-            Project* dep = nullptr;
-            for (auto& p : solution.projects) {
-                if (p.name == dep_name) {
-                    dep = &p;
-                    break;
+    // seen[i] == stamp marks project i as visited by the current walk
+    std::vector<size_t> seen(count, ProjectGraph::npos);
+    size_t stamp = 0;
+
+    // Export closure of d: d, then its exported dependencies depth-first,
+    // last reference first (the order a worklist walk from d visits them)
+    std::vector<std::vector<size_t>> closure(count);
+    std::vector<char> ready(count, 0);
+    const std::vector<char> on_cycle = find_cycle_members(exported);
+    for (size_t d : graph.topological_order()) {
+        auto& out = closure[d];
+        ++stamp;
+        bool mergeable = !on_cycle[d];
+        for (size_t dep : exported[d]) {
+            mergeable = mergeable && ready[dep];
+        }
+
+        if (mergeable) {
+            // Dependencies' closures are final: splice them in, skipping repeats
+            seen[d] = stamp;
+            out.push_back(d);
+            for (auto it = exported[d].rbegin(); it != exported[d].rend(); ++it) {
+                for (size_t project : closure[*it]) {
+                    if (seen[project] != stamp) {
+                        seen[project] = stamp;
+                        out.push_back(project);
+                    }
                 }
             }
-            if (!dep) continue;
-
-            // Determine what to do based on visibility
-            // Two independent decisions: local addition vs transitive propagation
-            // should_add_locally: Add to current project's configuration (PUBLIC or PRIVATE)
-            // should_propagate_transitively: Add to processing queue for dependents (PUBLIC or INTERFACE)
-            bool should_add_locally =
-                (visibility == DependencyVisibility::PUBLIC ||
-                 visibility == DependencyVisibility::PRIVATE);
-
-            bool should_propagate_transitively =
-                (visibility == DependencyVisibility::PUBLIC ||
-                 visibility == DependencyVisibility::INTERFACE);
-
-            // Propagate to all configurations
-            for (const auto& config_key : solution.get_config_keys()) {
-                // Add locally if visibility permits (PUBLIC or PRIVATE)
+        } else {
+            // On a cycle, a dependency's closure can lead back into d before
+            // d's other dependencies are visited; walk it directly instead
+            std::vector<size_t> to_process{d};
+            while (!to_process.empty()) {
+                size_t project = to_process.back();
+                to_process.pop_back();
+                if (seen[project] == stamp) continue;
+                seen[project] = stamp;
+                out.push_back(project);
+                for (size_t dep : exported[project]) {
+                    if (seen[dep] != stamp) to_process.push_back(dep);
+                }
+            }
+        }
+        ready[d] = 1;
+    }
+
+    for (size_t p = 0; p < count; ++p) {
+        auto& proj = solution.projects[p];
+
+        // Direct dependencies are visited last reference first. Each project
+        // is taken once, from the first dependency that reaches it; one first
+        // reached through an INTERFACE reference is not added locally.
+        //   should_add_locally: PUBLIC or PRIVATE direct reference
+        //   transitive (PUBLIC/INTERFACE) references: see the export closure
+        std::vector<const Project*> to_add;
+        ++stamp;
+        const auto& direct = graph.dependencies(p);
+        for (auto it = direct.rbegin(); it != direct.rend(); ++it) {
+            const auto& ref = proj.project_references[it->reference];
+            if (!ref.link_library_dependencies) continue;
+            const bool should_add_locally = ref.visibility != DependencyVisibility::INTERFACE;
+            for (size_t project : closure[it->project]) {
+                if (seen[project] == stamp) continue;
+                seen[project] = stamp;
                 if (should_add_locally) {
-                    // Propagate public_includes (all-config)
-                    auto& proj_includes = proj.configurations[config_key]
-                        .cl_compile.additional_include_directories;
-                    for (const auto& inc : dep->public_includes) {
-                        if (std::find(proj_includes.begin(), proj_includes.end(), inc)
-                            == proj_includes.end()) {
-                            proj_includes.push_back(inc);
-                        }
-                    }
-                    // Propagate public_includes (per-config)
-                    auto inc_it = dep->public_includes_per_config.find(config_key);
-                    if (inc_it != dep->public_includes_per_config.end()) {
-                        for (const auto& inc : inc_it->second) {
-                            if (std::find(proj_includes.begin(), proj_includes.end(), inc)
-                                == proj_includes.end()) {
-                                proj_includes.push_back(inc);
-                            }
-                        }
-                    }
-
-                    // Propagate public_libs (all-config)
-                    auto& proj_libs = proj.configurations[config_key]
-                        .link.additional_dependencies;
-                    for (const auto& lib : dep->public_libs) {
-                        if (std::find(proj_libs.begin(), proj_libs.end(), lib)
-                            == proj_libs.end()) {
-                            proj_libs.push_back(lib);
-                        }
-                    }
-                    // Propagate public_libs (per-config)
-                    auto lib_it = dep->public_libs_per_config.find(config_key);
-                    if (lib_it != dep->public_libs_per_config.end()) {
-                        for (const auto& lib : lib_it->second) {
-                            if (std::find(proj_libs.begin(), proj_libs.end(), lib)
-                                == proj_libs.end()) {
-                                proj_libs.push_back(lib);
-                            }
-                        }
-                    }
-
-                    // Propagate public_libdirs (all-config)
-                    auto& proj_libdirs = proj.configurations[config_key]
-                        .link.additional_library_directories;
-                    for (const auto& dir : dep->public_libdirs) {
-                        if (std::find(proj_libdirs.begin(), proj_libdirs.end(), dir)
-                            == proj_libdirs.end()) {
-                            proj_libdirs.push_back(dir);
-                        }
-                    }
-                    // Propagate public_libdirs (per-config)
-                    auto libdir_it = dep->public_libdirs_per_config.find(config_key);
-                    if (libdir_it != dep->public_libdirs_per_config.end()) {
-                        for (const auto& dir : libdir_it->second) {
-                            if (std::find(proj_libdirs.begin(), proj_libdirs.end(), dir)
-                                == proj_libdirs.end()) {
-                                proj_libdirs.push_back(dir);
-                            }
-                        }
-                    }
-
-                    // Propagate public_defines (all-config)
-                    auto& proj_defines = proj.configurations[config_key]
-                        .cl_compile.preprocessor_definitions;
-                    for (const auto& def : dep->public_defines) {
-                        if (std::find(proj_defines.begin(), proj_defines.end(), def)
-                            == proj_defines.end()) {
-                            proj_defines.push_back(def);
-                        }
-                    }
-                    // Propagate public_defines (per-config)
-                    auto def_it = dep->public_defines_per_config.find(config_key);
-                    if (def_it != dep->public_defines_per_config.end()) {
-                        for (const auto& def : def_it->second) {
-                            if (std::find(proj_defines.begin(), proj_defines.end(), def)
-                                == proj_defines.end()) {
-                                proj_defines.push_back(def);
-                            }
-                        }
-                    }
+                    to_add.push_back(&solution.projects[project]);
                 }
             }
+        }
+        if (to_add.empty()) continue;
+
+        // Propagate to all configurations, all-config values before per-config
+        // ones for each dependency
+        for (const auto& config_key : config_keys) {
+            auto& config = proj.configurations[config_key];
+            auto& proj_includes = config.cl_compile.additional_include_directories;
+            auto& proj_libs = config.link.additional_dependencies;
+            auto& proj_libdirs = config.link.additional_library_directories;
+            auto& proj_defines = config.cl_compile.preprocessor_definitions;
+            std::unordered_set<std::string> includes(proj_includes.begin(), proj_includes.end());
+            std::unordered_set<std::string> libs(proj_libs.begin(), proj_libs.end());
+            std::unordered_set<std::string> libdirs(proj_libdirs.begin(), proj_libdirs.end());
+            std::unordered_set<std::string> defines(proj_defines.begin(), proj_defines.end());
+
+            for (const Project* dep : to_add) {
+                append_unique(proj_includes, includes, dep->public_includes);
+                auto inc_it = dep->public_includes_per_config.find(config_key);
+                if (inc_it != dep->public_includes_per_config.end()) {
+                    append_unique(proj_includes, includes, inc_it->second);
+                }
 
-            // Handle transitive dependencies (dependencies of dependencies)
-            for (const auto& trans_dep : dep->project_references) {
-                if (!trans_dep.link_library_dependencies) {
-                    continue;
+                append_unique(proj_libs, libs, dep->public_libs);
+                auto lib_it = dep->public_libs_per_config.find(config_key);
+                if (lib_it != dep->public_libs_per_config.end()) {
+                    append_unique(proj_libs, libs, lib_it->second);
+                }
+
+                append_unique(proj_libdirs, libdirs, dep->public_libdirs);
+                auto libdir_it = dep->public_libdirs_per_config.find(config_key);
+                if (libdir_it != dep->public_libdirs_per_config.end()) {
+                    append_unique(proj_libdirs, libdirs, libdir_it->second);
                 }
-                if (!processed.count(trans_dep.name)) {
-                    // Determine effective visibility for transitive dependency
-                    DependencyVisibility effective_vis;
-
-                    if (trans_dep.visibility == DependencyVisibility::PRIVATE) {
-                        // PRIVATE doesn't propagate - skip it
-                        continue;
-                    } else if (trans_dep.visibility == DependencyVisibility::PUBLIC) {
-                        // PUBLIC propagates based on current visibility
-                        if (visibility == DependencyVisibility::PRIVATE) {
-                            // PRIVATE boundary: add to current project but don't propagate further
-                            effective_vis = DependencyVisibility::PRIVATE;
-                        } else {
-                            effective_vis = visibility;  // Inherit current visibility
-                        }
-                    } else {  // INTERFACE
-                        // INTERFACE means "propagate to consumers" - inherit current visibility
-                        // PUBLIC + INTERFACE → PUBLIC (consumer gets it and propagates)
-                        // PRIVATE + INTERFACE → PRIVATE (consumer gets it locally only)
-                        // INTERFACE + INTERFACE → INTERFACE (consumer doesn't get it, passes through)
-                        effective_vis = visibility;
-                    }
 
-                    to_process.push_back({trans_dep.name, effective_vis});
+                append_unique(proj_defines, defines, dep->public_defines);
+                auto def_it = dep->public_defines_per_config.find(config_key);
+                if (def_it != dep->public_defines_per_config.end()) {
+                    append_unique(proj_defines, defines, def_it->second);
                 }
             }
         }
@@ -3957,8 +4162,8 @@ void BuildscriptParser::propagate_target_link_libraries(Solution& solution) {
 }
 
 // Resolve ${VARIABLE} references in a string
-std::string BuildscriptParser::resolve_variables(const std::string& str, const ParseState& state) {
-    std::string result = str;
+std::string BuildscriptParser::resolve_variables(std::string_view str, const ParseState& state) {
+    std::string result(str);
     size_t pos = 0;
 
     while ((pos = result.find("${", pos)) != std::string::npos) {
@@ -3968,9 +4173,8 @@ std::string BuildscriptParser::resolve_variables(const std::string& str, const P
         std::string var_name = result.substr(pos + 2, end - (pos + 2));
 
         std::string var_value;
-        auto it = state.variables.find(var_name);
-        if (it != state.variables.end()) {
-            var_value = it->second;
+        if (const std::string* value = state.find_variable(var_name)) {
+            var_value = *value;
         }
         // If variable not found, replace with empty string
 
@@ -3983,11 +4187,14 @@ std::string BuildscriptParser::resolve_variables(const std::string& str, const P
 
 // Parse find_package() function call
 void BuildscriptParser::parse_find_package(const std::string& line, ParseState& state) {
+    TimingScope timing("parse_find_package");
+    add_timing_counter("find_package calls");
+
     // Extract content between parentheses
     size_t start_paren = line.find('(');
     size_t end_paren = line.rfind(')');
     if (start_paren == std::string::npos || end_paren == std::string::npos) {
-        std::cerr << "Warning: Malformed find_package() at line " << state.line_number << "\n";
+        *warnings_ << "Warning: Malformed find_package() at line " << state.line_number << "\n";
         return;
     }
 
@@ -4000,8 +4207,8 @@ void BuildscriptParser::parse_find_package(const std::string& line, ParseState&
     }
 
     if (tokens.empty()) {
-        std::cerr << "Warning: find_package() requires at least a package name at line "
-                  << state.line_number << "\n";
+        *warnings_ << "Warning: find_package() requires at least a package name at line "
+                   << state.line_number << "\n";
         return;
     }
 
@@ -4023,46 +4230,57 @@ void BuildscriptParser::parse_find_package(const std::string& line, ParseState&
     std::string package_lower = to_lower(package_name);
 
     // Call appropriate package finder
-    PackageFindResult result;
-
+    using Finder = PackageFindResult (BuildscriptParser::*)(PackageProbe&);
+    Finder finder = nullptr;
     if (package_lower == "vulkan") {
-        result = find_vulkan();
+        finder = &BuildscriptParser::find_vulkan;
     } else if (package_lower == "opengl") {
-        result = find_opengl();
+        finder = &BuildscriptParser::find_opengl;
     } else if (package_lower == "sdl2") {
-        result = find_sdl2();
+        finder = &BuildscriptParser::find_sdl2;
     } else if (package_lower == "sdl3") {
-        result = find_sdl3();
+        finder = &BuildscriptParser::find_sdl3;
     } else if (package_lower == "directx11") {
-        result = find_directx11();
+        finder = &BuildscriptParser::find_directx11;
     } else if (package_lower == "directx12") {
-        result = find_directx12();
+        finder = &BuildscriptParser::find_directx12;
     } else if (package_lower == "directx9" || package_lower == "dx9") {
-        result = find_directx9();
+        package_lower = "directx9";
+        finder = &BuildscriptParser::find_directx9;
     } else if (package_lower == "directx10" || package_lower == "dx10") {
-        result = find_directx10();
+        package_lower = "directx10";
+        finder = &BuildscriptParser::find_directx10;
+    }
+
+    PackageFindResult result;
+    if (finder) {
+        // Probed once per run, and reused across runs while nothing it
+        // looked at changed
+        result = package_cache().find(package_lower, [&](PackageProbe& probe) {
+            return (this->*finder)(probe);
+        });
     } else {
-        std::cerr << "Warning: Unknown package '" << package_name << "' at line "
-                  << state.line_number << "\n";
+        *warnings_ << "Warning: Unknown package '" << package_name << "' at line "
+                   << state.line_number << "\n";
         result.found = false;
         result.error_message = "Unknown package: " + package_name;
     }
 
     if (result.found) {
         // Set variables
-        state.variables[package_name + "_FOUND"] = "TRUE";
-        state.variables[package_name + "_INCLUDE_DIRS"] = result.include_dirs;
-        state.variables[package_name + "_LIBRARIES"] = result.libraries;
+        state.set_variable(package_name + "_FOUND", "TRUE");
+        state.set_variable(package_name + "_INCLUDE_DIRS", result.include_dirs);
+        state.set_variable(package_name + "_LIBRARIES", result.libraries);
         if (!result.library_dirs.empty()) {
-            state.variables[package_name + "_LIBRARY_DIRS"] = result.library_dirs;
+            state.set_variable(package_name + "_LIBRARY_DIRS", result.library_dirs);
             // Also set as _LIBRARY_DIRS_X86 for packages that provide both architectures
-            state.variables[package_name + "_LIBRARY_DIRS_X86"] = result.library_dirs;
+            state.set_variable(package_name + "_LIBRARY_DIRS_X86", result.library_dirs);
         }
         if (!result.library_dirs_x64.empty()) {
-            state.variables[package_name + "_LIBRARY_DIRS_X64"] = result.library_dirs_x64;
+            state.set_variable(package_name + "_LIBRARY_DIRS_X64", result.library_dirs_x64);
         }
         if (!result.version.empty()) {
-            state.variables[package_name + "_VERSION"] = result.version;
+            state.set_variable(package_name + "_VERSION", result.version);
         }
         state.found_packages.insert(package_name);
 
@@ -4071,37 +4289,70 @@ void BuildscriptParser::parse_find_package(const std::string& line, ParseState&
             state.solution->found_packages[package_name] = result;
         }
 
-        std::cout << "[find_package] Found " << package_name;
+        *messages_ << "[find_package] Found " << package_name;
         if (!result.version.empty()) {
-            std::cout << " version " << result.version;
+            *messages_ << " version " << result.version;
         }
-        std::cout << "\n";
-        std::cout << "  Include dirs: " << result.include_dirs << "\n";
-        std::cout << "  Libraries: " << result.libraries << "\n";
+        *messages_ << "\n";
+        *messages_ << "  Include dirs: " << result.include_dirs << "\n";
+        *messages_ << "  Libraries: " << result.libraries << "\n";
         if (!result.library_dirs.empty()) {
-            std::cout << "  Library dirs (x86): " << result.library_dirs << "\n";
+            *messages_ << "  Library dirs (x86): " << result.library_dirs << "\n";
         }
         if (!result.library_dirs_x64.empty()) {
-            std::cout << "  Library dirs (x64): " << result.library_dirs_x64 << "\n";
+            *messages_ << "  Library dirs (x64): " << result.library_dirs_x64 << "\n";
         }
     } else {
-        state.variables[package_name + "_FOUND"] = "FALSE";
+        state.set_variable(package_name + "_FOUND", "FALSE");
 
         if (required) {
             throw std::runtime_error("Required package '" + package_name +
                                      "' not found: " + result.error_message);
         } else {
-            std::cerr << "[find_package] Package " << package_name << " not found: "
-                      << result.error_message << "\n";
+            *warnings_ << "[find_package] Package " << package_name << " not found: "
+                       << result.error_message << "\n";
         }
     }
 }
 
 #if defined(__linux__) || defined(__APPLE__)
+// Standard output of a shell command, empty if it cannot be run
+static std::string read_command_output(const std::string& command) {
+    std::string output;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe) {
+        char buffer[1024];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            output += buffer;
+        }
+        pclose(pipe);
+    }
+    return output;
+}
+
 // Unix pkg-config helper (Linux and macOS)
-PackageFindResult BuildscriptParser::try_pkg_config(const std::string& package_name) {
+PackageFindResult BuildscriptParser::try_pkg_config(PackageProbe& probe, const std::string& package_name) {
     PackageFindResult result;
 
+    // pkg-config's answer changes with its search path: the variables that
+    // set it, its directories (where a new .pc file shows up) and the .pc
+    // files it reads. The default directories are asked for once per run.
+    std::string search_path = package_cache().run_value("pkg-config pc_path", [] {
+        return read_command_output("pkg-config --variable pc_path pkg-config 2>/dev/null");
+    });
+    for (const char* variable : {"PKG_CONFIG_PATH", "PKG_CONFIG_LIBDIR"}) {
+        if (const char* dirs = probe.env(variable)) {
+            search_path += ':';
+            search_path += dirs;
+        }
+    }
+    probe.env("PKG_CONFIG_SYSROOT_DIR");
+    for (const auto& dir : split(search_path, ':')) {
+        if (!trim(dir).empty()) {
+            probe.watch(trim(dir));
+        }
+    }
+
     // Check if pkg-config can find the package
     std::string check_cmd = "pkg-config --exists " + package_name + " 2>/dev/null";
     int ret = std::system(check_cmd.c_str());
@@ -4111,16 +4362,34 @@ PackageFindResult BuildscriptParser::try_pkg_config(const std::string& package_n
         return result;
     }
 
-    // Get cflags (includes)
-    std::string cflags_cmd = "pkg-config --cflags " + package_name + " 2>/dev/null";
-    FILE* pipe = popen(cflags_cmd.c_str(), "r");
-    if (pipe) {
-        char buffer[1024];
-        std::string cflags;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            cflags += buffer;
+    // The flags also come from every .pc reached through Requires and
+    // Requires.private, so watch the whole chain, not just the package's own
+    std::vector<std::string> pending = {package_name};
+    std::set<std::string> seen = {package_name};
+    while (!pending.empty()) {
+        const std::string name = pending.back();
+        pending.pop_back();
+        std::string pc_dir = trim(read_command_output("pkg-config --variable pcfiledir " + name + " 2>/dev/null"));
+        if (!pc_dir.empty()) {
+            probe.watch(fs::path(pc_dir) / (name + ".pc"));
+        }
+
+        // One required package per line, possibly with a version constraint
+        std::istringstream required(read_command_output(
+            "pkg-config --print-requires --print-requires-private " + name + " 2>/dev/null"));
+        std::string line;
+        while (std::getline(required, line)) {
+            std::istringstream words(line);
+            std::string dependency;
+            if (words >> dependency && seen.insert(dependency).second) {
+                pending.push_back(dependency);
+            }
         }
-        pclose(pipe);
+    }
+
+    // Get cflags (includes)
+    {
+        std::string cflags = read_command_output("pkg-config --cflags " + package_name + " 2>/dev/null");
 
         // Parse -I flags
         std::istringstream iss(cflags);
@@ -4138,15 +4407,8 @@ PackageFindResult BuildscriptParser::try_pkg_config(const std::string& package_n
     }
 
     // Get libs
-    std::string libs_cmd = "pkg-config --libs " + package_name + " 2>/dev/null";
-    pipe = popen(libs_cmd.c_str(), "r");
-    if (pipe) {
-        char buffer[1024];
-        std::string libs;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            libs += buffer;
-        }
-        pclose(pipe);
+    {
+        std::string libs = read_command_output("pkg-config --libs " + package_name + " 2>/dev/null");
 
         // Parse -l and -L flags
         std::istringstream iss(libs);
@@ -4171,15 +4433,7 @@ PackageFindResult BuildscriptParser::try_pkg_config(const std::string& package_n
     }
 
     // Get version
-    std::string version_cmd = "pkg-config --modversion " + package_name + " 2>/dev/null";
-    pipe = popen(version_cmd.c_str(), "r");
-    if (pipe) {
-        char buffer[128];
-        if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            result.version = trim(buffer);
-        }
-        pclose(pipe);
-    }
+    result.version = trim(read_command_output("pkg-config --modversion " + package_name + " 2>/dev/null"));
 
     result.found = true;
     return result;
@@ -4187,18 +4441,18 @@ PackageFindResult BuildscriptParser::try_pkg_config(const std::string& package_n
 #endif // defined(__linux__) || defined(__APPLE__)
 
 // Package finder: Vulkan
-PackageFindResult BuildscriptParser::find_vulkan() {
+PackageFindResult BuildscriptParser::find_vulkan(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
     // Windows: Check VULKAN_SDK environment variable
-    const char* vulkan_sdk = std::getenv("VULKAN_SDK");
+    const char* vulkan_sdk = probe.env("VULKAN_SDK");
     if (vulkan_sdk) {
         fs::path sdk_path(vulkan_sdk);
         fs::path include_path = sdk_path / "Include";
         fs::path lib_path = sdk_path / "Lib";
 
-        if (fs::exists(include_path) && fs::exists(lib_path)) {
+        if (probe.exists(include_path) && probe.exists(lib_path)) {
             result.found = true;
             result.include_dirs = include_path.string();
             result.library_dirs = lib_path.string();
@@ -4212,19 +4466,19 @@ PackageFindResult BuildscriptParser::find_vulkan() {
 
 #elif defined(__linux__) || defined(__APPLE__)
     // Linux/macOS: Try pkg-config first, then fallback to standard paths
-    result = try_pkg_config("vulkan");
+    result = try_pkg_config(probe, "vulkan");
 
     if (result.found && result.include_dirs.empty()) {
         // pkg-config found Vulkan but no -I flags (system include path)
         // Set default include path for vulkan/vulkan.h
-        if (fs::exists("/usr/include/vulkan/vulkan.h")) {
+        if (probe.exists("/usr/include/vulkan/vulkan.h")) {
             result.include_dirs = "/usr/include";
         }
     }
 
     if (!result.found) {
         // Fallback: Check standard paths
-        if (fs::exists("/usr/include/vulkan/vulkan.h")) {
+        if (probe.exists("/usr/include/vulkan/vulkan.h")) {
             result.found = true;
             result.include_dirs = "/usr/include";
             result.libraries = "vulkan";
@@ -4240,7 +4494,7 @@ PackageFindResult BuildscriptParser::find_vulkan() {
 }
 
 // Package finder: OpenGL
-PackageFindResult BuildscriptParser::find_opengl() {
+PackageFindResult BuildscriptParser::find_opengl(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
@@ -4251,11 +4505,11 @@ PackageFindResult BuildscriptParser::find_opengl() {
 
 #elif defined(__linux__) || defined(__APPLE__)
     // Linux/macOS: Try pkg-config first
-    result = try_pkg_config("gl");
+    result = try_pkg_config(probe, "gl");
 
     if (!result.found) {
         // Fallback: Check standard paths
-        if (fs::exists("/usr/include/GL/gl.h")) {
+        if (probe.exists("/usr/include/GL/gl.h")) {
             result.found = true;
             result.include_dirs = "/usr/include";
             result.libraries = "GL";
@@ -4271,14 +4525,14 @@ PackageFindResult BuildscriptParser::find_opengl() {
 }
 
 // Package finder: SDL2
-PackageFindResult BuildscriptParser::find_sdl2() {
+PackageFindResult BuildscriptParser::find_sdl2(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
     // Windows: Check SDL2_DIR environment variable
-    const char* sdl2_dir = std::getenv("SDL2_DIR");
+    const char* sdl2_dir = probe.env("SDL2_DIR");
     if (!sdl2_dir) {
-        sdl2_dir = std::getenv("SDL2");
+        sdl2_dir = probe.env("SDL2");
     }
 
     if (sdl2_dir) {
@@ -4287,12 +4541,12 @@ PackageFindResult BuildscriptParser::find_sdl2() {
         fs::path lib_path = sdk_path / "lib" / "x64";
 
         // Try alternate paths
-        if (!fs::exists(lib_path)) {
+        if (!probe.exists(lib_path)) {
             lib_path = sdk_path / "lib";
         }
 
-        if (fs::exists(include_path / "SDL.h") ||
-            fs::exists(include_path / "SDL2" / "SDL.h")) {
+        if (probe.exists(include_path / "SDL.h") ||
+            probe.exists(include_path / "SDL2" / "SDL.h")) {
             result.found = true;
             result.include_dirs = include_path.string();
             result.library_dirs = lib_path.string();
@@ -4311,12 +4565,12 @@ PackageFindResult BuildscriptParser::find_sdl2() {
 
         for (const auto& path : search_paths) {
             fs::path sdk_path(path);
-            if (fs::exists(sdk_path / "include" / "SDL.h") ||
-                fs::exists(sdk_path / "include" / "SDL2" / "SDL.h")) {
+            if (probe.exists(sdk_path / "include" / "SDL.h") ||
+                probe.exists(sdk_path / "include" / "SDL2" / "SDL.h")) {
                 result.found = true;
                 result.include_dirs = (sdk_path / "include").string();
                 fs::path lib_path = sdk_path / "lib" / "x64";
-                if (!fs::exists(lib_path)) {
+                if (!probe.exists(lib_path)) {
                     lib_path = sdk_path / "lib";
                 }
                 result.library_dirs = lib_path.string();
@@ -4332,11 +4586,11 @@ PackageFindResult BuildscriptParser::find_sdl2() {
 
 #elif defined(__linux__) || defined(__APPLE__)
     // Linux/macOS: Use pkg-config
-    result = try_pkg_config("sdl2");
+    result = try_pkg_config(probe, "sdl2");
 
     if (!result.found) {
         // Fallback
-        if (fs::exists("/usr/include/SDL2/SDL.h")) {
+        if (probe.exists("/usr/include/SDL2/SDL.h")) {
             result.found = true;
             result.include_dirs = "/usr/include/SDL2";
             result.libraries = "SDL2";
@@ -4352,14 +4606,14 @@ PackageFindResult BuildscriptParser::find_sdl2() {
 }
 
 // Package finder: SDL3
-PackageFindResult BuildscriptParser::find_sdl3() {
+PackageFindResult BuildscriptParser::find_sdl3(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
     // Windows: Check SDL3_DIR environment variable
-    const char* sdl3_dir = std::getenv("SDL3_DIR");
+    const char* sdl3_dir = probe.env("SDL3_DIR");
     if (!sdl3_dir) {
-        sdl3_dir = std::getenv("SDL3");
+        sdl3_dir = probe.env("SDL3");
     }
 
     if (sdl3_dir) {
@@ -4367,11 +4621,11 @@ PackageFindResult BuildscriptParser::find_sdl3() {
         fs::path include_path = sdk_path / "include";
         fs::path lib_path = sdk_path / "lib" / "x64";
 
-        if (!fs::exists(lib_path)) {
+        if (!probe.exists(lib_path)) {
             lib_path = sdk_path / "lib";
         }
 
-        if (fs::exists(include_path / "SDL3" / "SDL.h")) {
+        if (probe.exists(include_path / "SDL3" / "SDL.h")) {
             result.found = true;
             result.include_dirs = include_path.string();
             result.library_dirs = lib_path.string();
@@ -4390,11 +4644,11 @@ PackageFindResult BuildscriptParser::find_sdl3() {
 
         for (const auto& path : search_paths) {
             fs::path sdk_path(path);
-            if (fs::exists(sdk_path / "include" / "SDL3" / "SDL.h")) {
+            if (probe.exists(sdk_path / "include" / "SDL3" / "SDL.h")) {
                 result.found = true;
                 result.include_dirs = (sdk_path / "include").string();
                 fs::path lib_path = sdk_path / "lib" / "x64";
-                if (!fs::exists(lib_path)) {
+                if (!probe.exists(lib_path)) {
                     lib_path = sdk_path / "lib";
                 }
                 result.library_dirs = lib_path.string();
@@ -4410,11 +4664,11 @@ PackageFindResult BuildscriptParser::find_sdl3() {
 
 #elif defined(__linux__) || defined(__APPLE__)
     // Linux/macOS: Use pkg-config
-    result = try_pkg_config("sdl3");
+    result = try_pkg_config(probe, "sdl3");
 
     if (!result.found) {
         // Fallback
-        if (fs::exists("/usr/include/SDL3/SDL.h")) {
+        if (probe.exists("/usr/include/SDL3/SDL.h")) {
             result.found = true;
             result.include_dirs = "/usr/include/SDL3";
             result.libraries = "SDL3";
@@ -4430,7 +4684,9 @@ PackageFindResult BuildscriptParser::find_sdl3() {
 }
 
 // Package finder: DirectX11
-PackageFindResult BuildscriptParser::find_directx11() {
+// Nothing is probed: the result depends only on the platform, so a cached
+// one never goes stale
+PackageFindResult BuildscriptParser::find_directx11(PackageProbe& /*probe*/) {
     PackageFindResult result;
 
 #if defined(_WIN32)
@@ -4446,7 +4702,9 @@ PackageFindResult BuildscriptParser::find_directx11() {
 }
 
 // Package finder: DirectX12
-PackageFindResult BuildscriptParser::find_directx12() {
+// Nothing is probed: the result depends only on the platform, so a cached
+// one never goes stale
+PackageFindResult BuildscriptParser::find_directx12(PackageProbe& /*probe*/) {
     PackageFindResult result;
 
 #if defined(_WIN32)
@@ -4462,19 +4720,19 @@ PackageFindResult BuildscriptParser::find_directx12() {
 }
 
 // Package finder: DirectX 9 (Legacy DirectX SDK June 2010)
-PackageFindResult BuildscriptParser::find_directx9() {
+PackageFindResult BuildscriptParser::find_directx9(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
     // First, check DXSDK_DIR environment variable (set by DirectX SDK installer)
-    const char* dxsdk_dir = std::getenv("DXSDK_DIR");
+    const char* dxsdk_dir = probe.env("DXSDK_DIR");
 
     fs::path sdk_path;
     bool found_sdk = false;
 
     if (dxsdk_dir) {
         sdk_path = fs::path(dxsdk_dir);
-        if (fs::exists(sdk_path / "Include" / "d3d9.h")) {
+        if (probe.exists(sdk_path / "Include" / "d3d9.h")) {
             found_sdk = true;
         }
     }
@@ -4490,7 +4748,7 @@ PackageFindResult BuildscriptParser::find_directx9() {
 
         for (const auto& path : search_paths) {
             fs::path candidate(path);
-            if (fs::exists(candidate / "Include" / "d3d9.h")) {
+            if (probe.exists(candidate / "Include" / "d3d9.h")) {
                 sdk_path = candidate;
                 found_sdk = true;
                 break;
@@ -4503,14 +4761,14 @@ PackageFindResult BuildscriptParser::find_directx9() {
         fs::path lib_path_x86 = sdk_path / "Lib" / "x86";
         fs::path lib_path_x64 = sdk_path / "Lib" / "x64";
 
-        if (fs::exists(include_path) && (fs::exists(lib_path_x86) || fs::exists(lib_path_x64))) {
+        if (probe.exists(include_path) && (probe.exists(lib_path_x86) || probe.exists(lib_path_x64))) {
             result.found = true;
             result.include_dirs = include_path.string();
             // Default to x86 for legacy/Source Engine compatibility
-            if (fs::exists(lib_path_x86)) {
+            if (probe.exists(lib_path_x86)) {
                 result.library_dirs = lib_path_x86.string();
             }
-            if (fs::exists(lib_path_x64)) {
+            if (probe.exists(lib_path_x64)) {
                 result.library_dirs_x64 = lib_path_x64.string();
             }
             result.libraries = "d3d9.lib;d3dx9.lib;dinput8.lib;dxguid.lib";
@@ -4523,6 +4781,7 @@ PackageFindResult BuildscriptParser::find_directx9() {
                               "Install from DXSDK_Jun10.exe or set DXSDK_DIR environment variable.";
     }
 #else
+    (void)probe;
     result.error_message = "DirectX 9 is only available on Windows";
 #endif
 
@@ -4530,19 +4789,19 @@ PackageFindResult BuildscriptParser::find_directx9() {
 }
 
 // Package finder: DirectX 10 (Legacy DirectX SDK June 2010)
-PackageFindResult BuildscriptParser::find_directx10() {
+PackageFindResult BuildscriptParser::find_directx10(PackageProbe& probe) {
     PackageFindResult result;
 
 #if defined(_WIN32)
     // First, check DXSDK_DIR environment variable (set by DirectX SDK installer)
-    const char* dxsdk_dir = std::getenv("DXSDK_DIR");
+    const char* dxsdk_dir = probe.env("DXSDK_DIR");
 
     fs::path sdk_path;
     bool found_sdk = false;
 
     if (dxsdk_dir) {
         sdk_path = fs::path(dxsdk_dir);
-        if (fs::exists(sdk_path / "Include" / "d3d10.h")) {
+        if (probe.exists(sdk_path / "Include" / "d3d10.h")) {
             found_sdk = true;
         }
     }
@@ -4558,7 +4817,7 @@ PackageFindResult BuildscriptParser::find_directx10() {
 
         for (const auto& path : search_paths) {
             fs::path candidate(path);
-            if (fs::exists(candidate / "Include" / "d3d10.h")) {
+            if (probe.exists(candidate / "Include" / "d3d10.h")) {
                 sdk_path = candidate;
                 found_sdk = true;
                 break;
@@ -4571,14 +4830,14 @@ PackageFindResult BuildscriptParser::find_directx10() {
         fs::path lib_path_x86 = sdk_path / "Lib" / "x86";
         fs::path lib_path_x64 = sdk_path / "Lib" / "x64";
 
-        if (fs::exists(include_path) && (fs::exists(lib_path_x86) || fs::exists(lib_path_x64))) {
+        if (probe.exists(include_path) && (probe.exists(lib_path_x86) || probe.exists(lib_path_x64))) {
             result.found = true;
             result.include_dirs = include_path.string();
             // Default to x86 for legacy/Source Engine compatibility
-            if (fs::exists(lib_path_x86)) {
+            if (probe.exists(lib_path_x86)) {
                 result.library_dirs = lib_path_x86.string();
             }
-            if (fs::exists(lib_path_x64)) {
+            if (probe.exists(lib_path_x64)) {
                 result.library_dirs_x64 = lib_path_x64.string();
             }
             result.libraries = "d3d10.lib;d3dx10.lib;dxgi.lib";
@@ -4591,6 +4850,7 @@ PackageFindResult BuildscriptParser::find_directx10() {
                               "Install from DXSDK_Jun10.exe or set DXSDK_DIR environment variable.";
     }
 #else
+    (void)probe;
     result.error_message = "DirectX 10 is only available on Windows";
 #endif
 
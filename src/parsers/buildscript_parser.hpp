@@ -1,6 +1,14 @@
 #pragma once
 
 #include "common/project_types.hpp"
+#include "common/glob.hpp"
+#include "common/package_cache.hpp"
+#include "buildscript_lexer.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string_view>
 
 namespace vcxproj {
 
@@ -12,32 +20,83 @@ public:
     // Set variables from command-line -D definitions (before calling parse())
     void set_variables(const std::map<std::string, std::string>& vars);
 
+    // Threads used to read directories for recursive wildcards and to parse
+    // runs of top-level includes (0 = one per core, 1 parses sequentially)
+    void set_jobs(int jobs);
+
+    // Keep find_package() results in dir/.sighmake_packages across runs. With
+    // reuse_results false every package is probed again and the file rewritten.
+    void set_package_cache_dir(const std::string& dir, bool reuse_results = true);
+
     // Parse a buildscript file and return a Solution
     Solution parse(const std::string& filepath);
 
     // Parse from string content
     Solution parse_string(const std::string& content, const std::string& base_path = ".");
+
+    // Propagate public_includes, public_libs, public_libdirs and public_defines
+    // from dependencies into each project's configurations. Run by parse();
+    // exposed for solutions assembled in code.
+    static void propagate_target_link_libraries(Solution& solution);
     
 private:
+    // Handle to a source file that the parser keeps across lines. A
+    // SourceFile* dangles as soon as its project's sources (or the solution's
+    // projects) grow; positions stay valid because nothing is erased while
+    // parsing.
+    class SourceRef {
+    public:
+        SourceRef() = default;
+        SourceRef(std::nullptr_t) {}
+        SourceRef(Solution* solution, size_t project, size_t source)
+            : solution_(solution), project_(project), source_(source) {}
+
+        SourceFile* get() const {
+            return solution_ ? &solution_->projects[project_].sources[source_] : nullptr;
+        }
+        SourceFile* operator->() const { return get(); }
+
+        bool operator==(std::nullptr_t) const { return solution_ == nullptr; }
+        bool operator!=(std::nullptr_t) const { return solution_ != nullptr; }
+        explicit operator bool() const { return solution_ != nullptr; }
+
+    private:
+        Solution* solution_ = nullptr;
+        size_t project_ = 0;
+        size_t source_ = 0;
+    };
+
+    // An include = line outside any project, held back so that a run of them
+    // can be parsed in parallel (see flush_deferred_includes)
+    struct DeferredInclude {
+        std::string path;
+        int line_number = 0;
+    };
+
     // Current parsing state
     struct ParseState {
         Solution* solution = nullptr;
         Project* current_project = nullptr;
-        SourceFile* current_file = nullptr;
+        SourceRef current_file;
         std::string current_config;  // Track current [config:...] section
         std::string base_path;
+        std::string root_path;  // base_path of the top-level buildscript (seeds stable UUIDs)
         int line_number = 0;
-        std::vector<std::string> included_files;  // Track included files to prevent circular includes
+        std::vector<std::string> include_stack;  // Include files being parsed, to detect circular includes
+        std::vector<DeferredInclude> deferred_includes;  // Top-level includes not parsed yet
         std::string uses_pch_accumulator;  // Accumulate multi-line uses_pch() calls
         bool in_uses_pch = false;  // Track if we're inside a uses_pch() call
         std::string target_link_libraries_accumulator;  // Accumulate multi-line target_link_libraries() calls
         bool in_target_link_libraries = false;  // Track if we're inside a target_link_libraries() call
         std::vector<std::string> file_properties_files;  // Paths of files in file_properties() block
         bool in_file_properties = false;  // Track if we're inside a file_properties() block
-        SourceFile* set_file_properties_file = nullptr;  // File being set in set_file_properties() block
+        SourceRef set_file_properties_file;  // File being set in set_file_properties() block
         bool in_set_file_properties = false;  // Track if we're inside a set_file_properties() block
-        SourceFile* custom_build_file = nullptr;  // File being configured in custom_build() block
+        SourceRef custom_build_file;  // File being configured in custom_build() block
         bool in_custom_build = false;  // Track if we're inside a custom_build() block
+        // Absolute source path -> position in sources, per project position in
+        // solution->projects, so file lookups don't scan every source
+        std::vector<std::unordered_map<std::string, size_t>> source_index;
         std::set<std::string> discovered_configs;  // Track configs discovered from [config:...] sections
         std::set<std::string> discovered_platforms;  // Track platforms discovered from [config:...] sections
         std::set<std::string> explicitly_defined_config_keys;  // Full "Config|Platform" keys with explicit [config:] sections
@@ -52,6 +111,33 @@ private:
         // Variables storage for find_package() results
         std::map<std::string, std::string> variables;
         std::set<std::string> found_packages;
+        // First project-level toolset, the solution's target_toolset unless
+        // it has one. Kept out of the solution while parsing so a project's
+        // setting doesn't change the context later includes are parsed in.
+        std::string first_project_toolset;
+
+        // While an include is parsed speculatively: variables it read before
+        // setting them, with the value seen (nullopt if undefined), and the
+        // variables it set
+        bool track_variables = false;
+        mutable std::map<std::string, std::optional<std::string>> variables_read;
+        std::set<std::string> variables_written;
+
+        const std::string* find_variable(const std::string& name) const {
+            auto it = variables.find(name);
+            const std::string* value = it != variables.end() ? &it->second : nullptr;
+            if (track_variables && !variables_written.count(name)) {
+                variables_read.emplace(name, value ? std::optional<std::string>(*value) : std::nullopt);
+            }
+            return value;
+        }
+
+        void set_variable(const std::string& name, std::string value) {
+            variables[name] = std::move(value);
+            if (track_variables) {
+                variables_written.insert(name);
+            }
+        }
 
         // Pending if condition (when { is on next line)
         bool pending_if_condition = false;  // True if we saw if() without { on same line
@@ -145,8 +231,8 @@ private:
         }
     };
     
-    // Parse a single line
-    void parse_line(const std::string& line, ParseState& state);
+    // Parse a single logical line, already trimmed by the lexer
+    void parse_line(std::string_view trimmed, ParseState& state);
     
     // Result of evaluating an if() condition
     struct ConditionResult {
@@ -161,7 +247,7 @@ private:
     bool parse_section(const std::string& line, ParseState& state);
     
     // Parse key=value pair
-    void parse_key_value(const std::string& key, const std::string& value, ParseState& state);
+    void parse_key_value(const std::string& key, std::string_view value, ParseState& state);
     
     // Parse solution-level settings
     void parse_solution_setting(const std::string& key, const std::string& value, ParseState& state);
@@ -189,8 +275,6 @@ private:
     void apply_template(Project& project, const std::string& derived_key,
                        const std::string& template_key, ParseState& state);
 
-    // Propagate public_includes, public_libs, and public_defines from dependencies
-    void propagate_target_link_libraries(Solution& solution);
 
     // Parse uses_pch() function call
     void parse_uses_pch(const std::string& line, ParseState& state);
@@ -199,25 +283,29 @@ private:
     void parse_find_package(const std::string& line, ParseState& state);
 
     // Resolve ${VARIABLE} references in a string
-    std::string resolve_variables(const std::string& str, const ParseState& state);
-
-    // Package finders
-    PackageFindResult find_vulkan();
-    PackageFindResult find_opengl();
-    PackageFindResult find_sdl2();
-    PackageFindResult find_sdl3();
-    PackageFindResult find_directx11();
-    PackageFindResult find_directx12();
-    PackageFindResult find_directx9();
-    PackageFindResult find_directx10();
+    std::string resolve_variables(std::string_view str, const ParseState& state);
+
+    // Package finders; each records the environment variables and paths it
+    // looked at in probe
+    PackageFindResult find_vulkan(PackageProbe& probe);
+    PackageFindResult find_opengl(PackageProbe& probe);
+    PackageFindResult find_sdl2(PackageProbe& probe);
+    PackageFindResult find_sdl3(PackageProbe& probe);
+    PackageFindResult find_directx11(PackageProbe& probe);
+    PackageFindResult find_directx12(PackageProbe& probe);
+    PackageFindResult find_directx9(PackageProbe& probe);
+    PackageFindResult find_directx10(PackageProbe& probe);
 
 #if defined(__linux__) || defined(__APPLE__)
     // Unix pkg-config helper (Linux and macOS)
-    PackageFindResult try_pkg_config(const std::string& package_name);
+    PackageFindResult try_pkg_config(PackageProbe& probe, const std::string& package_name);
 #endif
 
     // Helper to split string by delimiter
     static std::vector<std::string> split(const std::string& str, char delim);
+
+    // Helper to split a comma-separated file list, keeping glob brace sets whole
+    static std::vector<std::string> split_file_list(const std::string& str);
     
     // Helper to trim whitespace
     static std::string trim(const std::string& str);
@@ -225,12 +313,35 @@ private:
     // Helper to expand wildcards in source paths
     std::vector<std::string> expand_wildcards(const std::string& pattern, const std::string& base_path);
     
-    // Helper to find or create a source file entry
+    // Helper to find or create a source file entry. The pointer is only valid
+    // until the next file is added; keep a SourceRef across lines instead.
     SourceFile* find_or_create_source(const std::string& path, ParseState& state);
+    SourceRef find_or_create_source_ref(const std::string& path, ParseState& state);
 
     // Helper to process include directive
     void process_include(const std::string& include_path, ParseState& state);
 
+    // Parses the logical lines of one buffer, then any includes its last
+    // lines deferred
+    void parse_lines(const LexedBuildscript& lines, ParseState& state);
+
+    // Whether an include = line may wait to be parsed with the ones after it
+    bool can_defer_include(const ParseState& state) const;
+
+    // Parses the deferred includes in order. Each is parsed on a worker from
+    // a copy of the state they all started from; a result is merged only if
+    // the includes merged before it left everything it read unchanged,
+    // otherwise that include is parsed again on the merged state.
+    void flush_deferred_includes(ParseState& state);
+
+    // Whether two states have the same if() blocks, folders and multi-line
+    // calls open
+    static bool same_open_blocks(const ParseState& a, const ParseState& b);
+
+    // Whether two states agree on everything an include can read: solution
+    // settings, discovered configs and open blocks
+    static bool same_include_context(const ParseState& a, const ParseState& b);
+
     // Helper to parse filename with optional condition: "file.cpp" [!linux]
     // Returns pair of {clean_path, should_include}
     std::pair<std::string, bool> parse_filename_with_condition(const std::string& entry);
@@ -242,8 +353,67 @@ private:
     // Helper to resolve a path relative to base_path and return absolute path
     static std::string resolve_path(const std::string& path, const std::string& base_path);
 
+    // Record a directory listed by a wildcard as a generation input (once per parse)
+    void record_directory_input(const std::filesystem::path& dir);
+
     // Variables provided via set_variables() before parsing
     std::map<std::string, std::string> initial_variables_;
+
+    // Included buildscripts and wildcard directories seen by the current parse
+    std::vector<GenerationInput> inputs_;
+    std::set<std::string> recorded_directories_;
+
+    // Directory listings shared by every wildcard of the current parse
+    DirectoryCache directory_cache_;
+    DirectoryCache* shared_directory_cache_ = nullptr;  // The main parser's, on include workers
+    DirectoryCache& directory_cache() {
+        return shared_directory_cache_ ? *shared_directory_cache_ : directory_cache_;
+    }
+
+    // find_package() results of this run and earlier ones
+    PackageCache package_cache_;
+    PackageCache* shared_package_cache_ = nullptr;  // The main parser's, on include workers
+    PackageCache& package_cache() {
+        return shared_package_cache_ ? *shared_package_cache_ : package_cache_;
+    }
+    std::string package_cache_dir_;
+    bool reuse_package_results_ = true;
+
+    // Warnings and find_package() reports; include workers buffer them until
+    // their result is merged, so output keeps the sequential order
+    std::ostream* warnings_ = &std::cerr;
+    std::ostream* messages_ = &std::cout;
+
+    // Include files read by the current parse, by canonical path. A fragment
+    // included by many projects is read and lexed once, then replayed, also
+    // across include workers. Safe to share between threads.
+    struct IncludeFile {
+        bool exists = false;
+        std::unique_ptr<const LexedBuildscript> lexed;  // Null if missing or unreadable
+        uint64_t hash = 0;
+    };
+    class IncludeCache {
+    public:
+        // The file at canonical_path, read on first use; hit tells whether an
+        // earlier call read it
+        const IncludeFile& get(const std::string& canonical_path, bool& hit);
+        void clear();
+
+    private:
+        struct Entry {
+            std::once_flag read;
+            IncludeFile file;
+        };
+        std::mutex mutex_;  // Guards files_, not held while reading
+        std::unordered_map<std::string, std::unique_ptr<Entry>> files_;
+    };
+    IncludeCache include_cache_;
+    IncludeCache* shared_include_cache_ = nullptr;  // The main parser's, on include workers
+    IncludeCache& include_cache() {
+        return shared_include_cache_ ? *shared_include_cache_ : include_cache_;
+    }
+    std::set<std::string> recorded_includes_;  // Include files already in inputs_
+    int jobs_ = 0;
 };
 
 } // namespace vcxproj
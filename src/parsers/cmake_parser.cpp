@@ -2,6 +2,9 @@
 #include "cmake_parser.hpp"
 #include "common/string_utils.hpp"
 #include "common/defaults.hpp"
+#include "common/glob.hpp"
+#include "common/project_graph.hpp"
+#include "common/timings.hpp"
 
 namespace fs = std::filesystem;
 
@@ -136,7 +139,62 @@ namespace {
     };
 }
 
+CMakeParser::ParseState CMakeParser::ParseState::nested_scope() const {
+    ParseState scope;
+    scope.solution = solution;
+    scope.base_path = base_path;
+    scope.line_number = line_number;
+    scope.parent = this;
+    scope.current_source_dir = current_source_dir;
+    scope.current_binary_dir = current_binary_dir;
+    return scope;
+}
+
+const std::string* CMakeParser::ParseState::find_variable(const std::string& name) const {
+    for (const ParseState* scope = this; scope; scope = scope->parent) {
+        auto it = scope->variables.find(name);
+        if (it != scope->variables.end()) {
+            return it->second ? &*it->second : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+std::string CMakeParser::ParseState::get_variable(const std::string& name) const {
+    const std::string* value = find_variable(name);
+    return value ? *value : std::string();
+}
+
+void CMakeParser::ParseState::set_variable(const std::string& name, std::string value) {
+    variables[name] = std::move(value);
+}
+
+void CMakeParser::ParseState::unset_variable(const std::string& name) {
+    if (parent && parent->find_variable(name)) {
+        variables[name] = std::nullopt;
+    } else {
+        variables.erase(name);
+    }
+}
+
+std::shared_ptr<const CMakeParser::FunctionDef> CMakeParser::ParseState::find_function(const std::string& name) const {
+    for (const ParseState* scope = this; scope; scope = scope->parent) {
+        auto it = scope->functions.find(name);
+        if (it != scope->functions.end()) return it->second;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CMakeParser::FunctionDef> CMakeParser::ParseState::find_macro(const std::string& name) const {
+    for (const ParseState* scope = this; scope; scope = scope->parent) {
+        auto it = scope->macros.find(name);
+        if (it != scope->macros.end()) return it->second;
+    }
+    return nullptr;
+}
+
 Solution CMakeParser::parse(const std::string& filepath) {
+    TimingScope timing("CMakeParser::parse");
     std::ifstream file(filepath);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open CMakeLists.txt: " + filepath);
@@ -151,7 +209,7 @@ Solution CMakeParser::parse(const std::string& filepath) {
 
 Solution CMakeParser::parse_string(const std::string& content, const std::string& base_path) {
     Solution solution;
-    solution.uuid = generate_uuid();
+    directory_cache_.clear();
     // Default configurations
     solution.configurations = defaults::configurations();
     solution.platforms = defaults::platforms();
@@ -163,30 +221,30 @@ Solution CMakeParser::parse_string(const std::string& content, const std::string
     state.current_binary_dir = base_path;
     
     // Initialize standard CMake variables
-    state.variables["CMAKE_SOURCE_DIR"] = base_path;
-    state.variables["CMAKE_CURRENT_SOURCE_DIR"] = base_path;
-    state.variables["CMAKE_BINARY_DIR"] = base_path;
-    state.variables["CMAKE_CURRENT_BINARY_DIR"] = base_path;
-    state.variables["PROJECT_SOURCE_DIR"] = base_path;
-    state.variables["PROJECT_BINARY_DIR"] = base_path;
-    state.variables["CMAKE_VERSION"] = "3.31.0";
+    state.set_variable("CMAKE_SOURCE_DIR", base_path);
+    state.set_variable("CMAKE_CURRENT_SOURCE_DIR", base_path);
+    state.set_variable("CMAKE_BINARY_DIR", base_path);
+    state.set_variable("CMAKE_CURRENT_BINARY_DIR", base_path);
+    state.set_variable("PROJECT_SOURCE_DIR", base_path);
+    state.set_variable("PROJECT_BINARY_DIR", base_path);
+    state.set_variable("CMAKE_VERSION", "3.31.0");
 #ifdef _WIN32
-    state.variables["WIN32"] = "TRUE";
-    state.variables["MSVC"] = "TRUE";
-    state.variables["CMAKE_SYSTEM_NAME"] = "Windows";
-    state.variables["CMAKE_C_COMPILER_ID"] = "MSVC";
-    state.variables["CMAKE_CXX_COMPILER_ID"] = "MSVC";
+    state.set_variable("WIN32", "TRUE");
+    state.set_variable("MSVC", "TRUE");
+    state.set_variable("CMAKE_SYSTEM_NAME", "Windows");
+    state.set_variable("CMAKE_C_COMPILER_ID", "MSVC");
+    state.set_variable("CMAKE_CXX_COMPILER_ID", "MSVC");
 #elif defined(__APPLE__)
-    state.variables["APPLE"] = "TRUE";
-    state.variables["UNIX"] = "TRUE";
-    state.variables["CMAKE_SYSTEM_NAME"] = "Darwin";
-    state.variables["CMAKE_C_COMPILER_ID"] = "AppleClang";
-    state.variables["CMAKE_CXX_COMPILER_ID"] = "AppleClang";
+    state.set_variable("APPLE", "TRUE");
+    state.set_variable("UNIX", "TRUE");
+    state.set_variable("CMAKE_SYSTEM_NAME", "Darwin");
+    state.set_variable("CMAKE_C_COMPILER_ID", "AppleClang");
+    state.set_variable("CMAKE_CXX_COMPILER_ID", "AppleClang");
 #else
-    state.variables["UNIX"] = "TRUE";
-    state.variables["CMAKE_SYSTEM_NAME"] = "Linux";
-    state.variables["CMAKE_C_COMPILER_ID"] = "GNU";
-    state.variables["CMAKE_CXX_COMPILER_ID"] = "GNU";
+    state.set_variable("UNIX", "TRUE");
+    state.set_variable("CMAKE_SYSTEM_NAME", "Linux");
+    state.set_variable("CMAKE_C_COMPILER_ID", "GNU");
+    state.set_variable("CMAKE_CXX_COMPILER_ID", "GNU");
 #endif
 
     auto tokens = tokenize(content);
@@ -224,6 +282,7 @@ Solution CMakeParser::parse_string(const std::string& content, const std::string
 
     // Post-process: Convert additional_dependencies to project_references if they match projects
     // This handles forward references where target_link_libraries is called before the library target is defined
+    const ProjectGraph& graph = solution.graph();
     for (auto& proj : solution.projects) {
         for (auto& [config_key, cfg] : proj.configurations) {
             auto& deps = cfg.link.additional_dependencies;
@@ -237,15 +296,7 @@ Solution CMakeParser::parse_string(const std::string& content, const std::string
                 }
 
                 // Check if it matches a project name
-                Project* dep_proj = nullptr;
-                for (auto& p : solution.projects) {
-                    if (p.name == dep_name) {
-                        dep_proj = &p;
-                        break;
-                    }
-                }
-
-                if (dep_proj) {
+                if (graph.find(dep_name) != ProjectGraph::npos) {
                     // Move to project_references
                     auto ref_it = std::find_if(proj.project_references.begin(),
                                                proj.project_references.end(),
@@ -266,12 +317,14 @@ Solution CMakeParser::parse_string(const std::string& content, const std::string
     }
 
     // Post-process: Propagate include directories from linked projects
+    solution.invalidate_graph();
     propagate_include_directories(solution);
 
     // If no project() command was found, use a default name
     if (solution.name.empty()) {
         solution.name = "CMakeProject";
     }
+    solution.uuid = make_stable_uuid("solution|" + solution.name);
 
     return solution;
 }
@@ -345,11 +398,7 @@ std::string CMakeParser::resolve_variables(const std::string& str, const ParseSt
         
         std::string var_name = result.substr(pos + 2, end - (pos + 2));
         
-        std::string var_value;
-        auto it = state.variables.find(var_name);
-        if (it != state.variables.end()) {
-            var_value = it->second;
-        }
+        std::string var_value = state.get_variable(var_name);
         
         result.replace(pos, end - pos + 1, var_value);
         pos += var_value.length();
@@ -378,11 +427,11 @@ void CMakeParser::handle_project(const std::vector<std::string>& args, ParseStat
         if (state.solution->name.empty()) {
             state.solution->name = args[0];
         }
-        state.variables["PROJECT_NAME"] = args[0];
-        state.variables["PROJECT_SOURCE_DIR"] = state.current_source_dir.empty() ? state.base_path : state.current_source_dir;
-        state.variables["PROJECT_BINARY_DIR"] = state.current_binary_dir.empty() ? state.base_path : state.current_binary_dir;
-        state.variables[args[0] + "_SOURCE_DIR"] = state.variables["PROJECT_SOURCE_DIR"];
-        state.variables[args[0] + "_BINARY_DIR"] = state.variables["PROJECT_BINARY_DIR"];
+        state.set_variable("PROJECT_NAME", args[0]);
+        state.set_variable("PROJECT_SOURCE_DIR", state.current_source_dir.empty() ? state.base_path : state.current_source_dir);
+        state.set_variable("PROJECT_BINARY_DIR", state.current_binary_dir.empty() ? state.base_path : state.current_binary_dir);
+        state.set_variable(args[0] + "_SOURCE_DIR", state.get_variable("PROJECT_SOURCE_DIR"));
+        state.set_variable(args[0] + "_BINARY_DIR", state.get_variable("PROJECT_BINARY_DIR"));
     }
 }
 
@@ -398,7 +447,7 @@ void CMakeParser::handle_add_executable(const std::vector<std::string>& args, Pa
         proj = &state.solution->projects.back();
         proj->name = target_name;
         proj->project_name = target_name;
-        proj->uuid = generate_uuid();
+        proj->uuid = make_stable_uuid("project|" + target_name);
         proj->root_namespace = target_name;
     }
 
@@ -408,9 +457,9 @@ void CMakeParser::handle_add_executable(const std::vector<std::string>& args, Pa
     }
 
     // Apply CMAKE_CXX_STANDARD if set
-    auto std_it = state.variables.find("CMAKE_CXX_STANDARD");
-    if (std_it != state.variables.end() && !std_it->second.empty()) {
-        std::string std_value = "stdcpp" + std_it->second;
+    const std::string* std_it = state.find_variable("CMAKE_CXX_STANDARD");
+    if (std_it && !std_it->empty()) {
+        std::string std_value = "stdcpp" + *std_it;
         for (const auto& config_key : state.solution->get_config_keys()) {
             proj->configurations[config_key].cl_compile.language_standard = std_value;
         }
@@ -451,7 +500,7 @@ void CMakeParser::handle_add_library(const std::vector<std::string>& args, Parse
         proj = &state.solution->projects.back();
         proj->name = target_name;
         proj->project_name = target_name;
-        proj->uuid = generate_uuid();
+        proj->uuid = make_stable_uuid("project|" + target_name);
         proj->root_namespace = target_name;
     }
 
@@ -481,9 +530,9 @@ void CMakeParser::handle_add_library(const std::vector<std::string>& args, Parse
     }
 
     // Apply CMAKE_CXX_STANDARD if set
-    auto std_it = state.variables.find("CMAKE_CXX_STANDARD");
-    if (std_it != state.variables.end() && !std_it->second.empty()) {
-        std::string std_value = "stdcpp" + std_it->second;
+    const std::string* std_it = state.find_variable("CMAKE_CXX_STANDARD");
+    if (std_it && !std_it->empty()) {
+        std::string std_value = "stdcpp" + *std_it;
         for (const auto& config_key : state.solution->get_config_keys()) {
             proj->configurations[config_key].cl_compile.language_standard = std_value;
         }
@@ -525,18 +574,15 @@ void CMakeParser::handle_add_subdirectory(const std::vector<std::string>& args,
     }
 
     // Create a new scope
-    // We create a copy of the state but share the solution pointer
-    ParseState sub_state = state;
+    // Reads fall through to the parent state; the solution pointer is shared
+    ParseState sub_state = state.nested_scope();
     sub_state.base_path = subdir_path.string();
     sub_state.current_source_dir = subdir_path.string();
     sub_state.current_binary_dir = binary_dir.string();
     
     // Update CMake variables for the new scope
-    sub_state.variables["CMAKE_CURRENT_SOURCE_DIR"] = subdir_path.string();
-    sub_state.variables["CMAKE_CURRENT_BINARY_DIR"] = binary_dir.string();
-    
-    // Clear parent-scope vars before parsing subdirectory
-    sub_state.parent_scope_vars.clear();
+    sub_state.set_variable("CMAKE_CURRENT_SOURCE_DIR", subdir_path.string());
+    sub_state.set_variable("CMAKE_CURRENT_BINARY_DIR", binary_dir.string());
 
     // Read and parse
     try {
@@ -552,7 +598,7 @@ void CMakeParser::handle_add_subdirectory(const std::vector<std::string>& args,
 
         // Apply parent-scope variables back to parent state
         for (const auto& [name, value] : sub_state.parent_scope_vars) {
-            state.variables[name] = value;
+            state.set_variable(name, value);
         }
 
         // Note: Other variables modified in sub_state are discarded (proper scoping)
@@ -598,10 +644,10 @@ void CMakeParser::handle_set(const std::vector<std::string>& args, ParseState& s
     } else if (is_cache) {
         // For CACHE variables, set in current scope
         // In real CMake, CACHE variables persist across runs, but we simulate
-        state.variables[var_name] = value;
+        state.set_variable(var_name, value);
     } else {
         // Normal variable set
-        state.variables[var_name] = value;
+        state.set_variable(var_name, value);
     }
 
     // Handle special CMake variables
@@ -626,8 +672,8 @@ void CMakeParser::handle_option(const std::vector<std::string>& args, ParseState
     }
     
     // Only set if not already set (cache behavior simulation)
-    if (state.variables.find(opt_name) == state.variables.end()) {
-        state.variables[opt_name] = opt_val;
+    if (!state.find_variable(opt_name)) {
+        state.set_variable(opt_name, opt_val);
     }
 }
 
@@ -646,8 +692,8 @@ void CMakeParser::handle_cmake_dependent_option(const std::vector<std::string>&
     }
 
     std::string value = evaluate_condition(condition_args, state) ? args[2] : args[4];
-    if (state.variables.find(args[0]) == state.variables.end()) {
-        state.variables[args[0]] = value;
+    if (!state.find_variable(args[0])) {
+        state.set_variable(args[0], value);
     }
 }
 
@@ -719,7 +765,7 @@ void CMakeParser::handle_list(const std::vector<std::string>& args, ParseState&
     std::string subcmd = args[0];
     std::string list_name = args[1];
     
-    std::string current_val = state.variables[list_name];
+    std::string current_val = state.get_variable(list_name);
     std::vector<std::string> current_list;
     
     // Split current value by ;
@@ -742,7 +788,7 @@ void CMakeParser::handle_list(const std::vector<std::string>& args, ParseState&
         if (!new_val.empty()) new_val += ";";
         new_val += it;
     }
-    state.variables[list_name] = new_val;
+    state.set_variable(list_name, new_val);
 }
 
 void CMakeParser::handle_target_compile_options(const std::vector<std::string>& args, ParseState& state) {
@@ -803,7 +849,7 @@ void CMakeParser::handle_find_library(const std::vector<std::string>& args, Pars
     if (!lib_name.empty()) {
         // Just set it to the name (assuming it's in system path)
         // or relative path if we want to simulate finding it?
-        state.variables[var_name] = lib_name + ".lib"; // Assume .lib on Windows
+        state.set_variable(var_name, lib_name + ".lib"); // Assume .lib on Windows
     }
 }
 
@@ -837,12 +883,14 @@ void CMakeParser::handle_find_path(const std::vector<std::string>& args, ParseSt
     }
     
     if (!path.empty()) {
-        state.variables[var_name] = path;
+        state.set_variable(var_name, path);
     }
 }
 
 void CMakeParser::handle_find_package(const std::vector<std::string>& args, ParseState& state) {
     if (args.empty()) return;
+    TimingScope timing("handle_find_package");
+    add_timing_counter("find_package calls");
 
     std::string package_name = args[0];
     bool required = false;
@@ -863,55 +911,55 @@ void CMakeParser::handle_find_package(const std::vector<std::string>& args, Pars
     }
 
     // Set found variable
-    state.variables[package_name + "_FOUND"] = "TRUE";
-    state.variables[package_name + "_VERSION"] = "1.0.0";
+    state.set_variable(package_name + "_FOUND", "TRUE");
+    state.set_variable(package_name + "_VERSION", "1.0.0");
 
     // Check for environment variable override
     std::string env_var = package_name + "_DIR";
     const char* env_path = std::getenv(env_var.c_str());
 
     if (env_path) {
-        state.variables[package_name + "_DIR"] = env_path;
-        state.variables[package_name + "_INCLUDE_DIRS"] = std::string(env_path) + "/include";
-        state.variables[package_name + "_LIBRARIES"] = package_name;
+        state.set_variable(package_name + "_DIR", env_path);
+        state.set_variable(package_name + "_INCLUDE_DIRS", std::string(env_path) + "/include");
+        state.set_variable(package_name + "_LIBRARIES", package_name);
         std::cout << "[CMake] Found package " << package_name << " at " << env_path << "\n";
     } else {
         // Hardcoded well-known packages
         if (package_name == "Boost") {
-            state.variables["Boost_INCLUDE_DIRS"] = "C:/boost/include";
-            state.variables["Boost_LIBRARY_DIRS"] = "C:/boost/lib";
+            state.set_variable("Boost_INCLUDE_DIRS", "C:/boost/include");
+            state.set_variable("Boost_LIBRARY_DIRS", "C:/boost/lib");
             std::string libs;
             for (const auto& comp : components) {
                 if (!libs.empty()) libs += ";";
                 libs += "boost_" + comp;
             }
-            state.variables["Boost_LIBRARIES"] = libs.empty() ? "boost_system" : libs;
+            state.set_variable("Boost_LIBRARIES", libs.empty() ? "boost_system" : libs);
         } else if (package_name == "OpenGL") {
-            state.variables["OPENGL_FOUND"] = "TRUE";
-            state.variables["OPENGL_INCLUDE_DIR"] = "";
-            state.variables["OPENGL_LIBRARIES"] = "opengl32.lib";
+            state.set_variable("OPENGL_FOUND", "TRUE");
+            state.set_variable("OPENGL_INCLUDE_DIR", "");
+            state.set_variable("OPENGL_LIBRARIES", "opengl32.lib");
         } else if (package_name == "Threads") {
-            state.variables["CMAKE_THREAD_LIBS_INIT"] = "";
-            state.variables["Threads_FOUND"] = "TRUE";
+            state.set_variable("CMAKE_THREAD_LIBS_INIT", "");
+            state.set_variable("Threads_FOUND", "TRUE");
         } else if (package_name == "OpenCV") {
-            state.variables["OpenCV_INCLUDE_DIRS"] = "C:/opencv/include";
-            state.variables["OpenCV_LIBS"] = "opencv_core;opencv_imgproc;opencv_highgui";
+            state.set_variable("OpenCV_INCLUDE_DIRS", "C:/opencv/include");
+            state.set_variable("OpenCV_LIBS", "opencv_core;opencv_imgproc;opencv_highgui");
         } else if (package_name == "Qt5" || package_name == "Qt6") {
-            state.variables[package_name + "_FOUND"] = "TRUE";
-            state.variables[package_name + "_INCLUDE_DIRS"] = "C:/" + package_name + "/include";
+            state.set_variable(package_name + "_FOUND", "TRUE");
+            state.set_variable(package_name + "_INCLUDE_DIRS", "C:/" + package_name + "/include");
             for (const auto& comp : components) {
-                state.variables[package_name + comp + "_FOUND"] = "TRUE";
-                state.variables[package_name + comp + "_LIBRARIES"] = "Qt::" + comp;
+                state.set_variable(package_name + comp + "_FOUND", "TRUE");
+                state.set_variable(package_name + comp + "_LIBRARIES", "Qt::" + comp);
             }
         } else if (package_name == "GTest" || package_name == "gtest") {
-            state.variables["GTest_FOUND"] = "TRUE";
-            state.variables["GTEST_INCLUDE_DIRS"] = "";
-            state.variables["GTEST_LIBRARIES"] = "gtest;gtest_main";
-            state.variables["GTEST_MAIN_LIBRARIES"] = "gtest_main";
+            state.set_variable("GTest_FOUND", "TRUE");
+            state.set_variable("GTEST_INCLUDE_DIRS", "");
+            state.set_variable("GTEST_LIBRARIES", "gtest;gtest_main");
+            state.set_variable("GTEST_MAIN_LIBRARIES", "gtest_main");
         } else {
             // Generic simulation
-            state.variables[package_name + "_INCLUDE_DIRS"] = "";
-            state.variables[package_name + "_LIBRARIES"] = package_name;
+            state.set_variable(package_name + "_INCLUDE_DIRS", "");
+            state.set_variable(package_name + "_LIBRARIES", package_name);
         }
 
         std::cout << "[CMake] Simulated finding package " << package_name;
@@ -951,7 +999,7 @@ void CMakeParser::handle_math(const std::vector<std::string>& args, ParseState&
     long long result = 0;
     IntegerExpressionParser parser(expression);
     if (parser.parse(result)) {
-        state.variables[args[1]] = std::to_string(result);
+        state.set_variable(args[1], std::to_string(result));
     } else {
         std::cerr << "[CMake] Warning: unsupported math(EXPR) expression: " << expression << "\n";
     }
@@ -1255,6 +1303,7 @@ void CMakeParser::handle_file(const std::vector<std::string>& args, ParseState&
 
     std::string mode = args[0];
     if (mode == "GLOB" || mode == "GLOB_RECURSE") {
+        TimingScope timing("file(GLOB)");
         std::string out_var = args[1];
         std::vector<std::string> patterns;
         for (size_t i = 2; i < args.size(); ++i) {
@@ -1265,57 +1314,31 @@ void CMakeParser::handle_file(const std::vector<std::string>& args, ParseState&
         std::vector<std::string> found_files;
 
         for (const auto& pattern : patterns) {
-            fs::path base_search_path = state.base_path;
-            std::string filename_pattern = pattern;
-            
-            if (pattern.find('/') != std::string::npos || pattern.find('\\') != std::string::npos) {
-                 fs::path p(pattern);
-                 if (p.has_parent_path()) {
-                     base_search_path /= p.parent_path();
-                     filename_pattern = p.filename().string();
-                 } else {
-                     filename_pattern = p.string();
-                 }
+            // GLOB_RECURSE matches the file name in every directory below the
+            // pattern's directory, which is what a "**" component expresses
+            std::string glob = pattern;
+            if (recursive) {
+                fs::path p(pattern);
+                glob = p.has_parent_path() ? (p.parent_path() / "**" / p.filename()).string()
+                                           : "**/" + pattern;
             }
-            
-            std::string regex_str = "^";
-            for (char c : filename_pattern) {
-                if (c == '*') regex_str += ".*";
-                else if (c == '.') regex_str += "\\.";
-                else regex_str += c;
+
+            GlobOptions options;
+            options.cache = &directory_cache_;
+            options.jobs = jobs_;
+            for (const auto& match : glob_files(glob, state.base_path, options)) {
+                found_files.push_back((fs::path(state.base_path) / match).string());
             }
-            regex_str += "$";
-            
-            try {
-                std::regex re(regex_str, std::regex::icase);
-                if (fs::exists(base_search_path)) {
-                    if (recursive) {
-                        for (const auto& entry : fs::recursive_directory_iterator(base_search_path)) {
-                            if (entry.is_regular_file()) {
-                                if (std::regex_match(entry.path().filename().string(), re)) {
-                                    found_files.push_back(entry.path().string());
-                                }
-                            }
-                        }
-                    } else {
-                         for (const auto& entry : fs::directory_iterator(base_search_path)) {
-                            if (entry.is_regular_file()) {
-                                if (std::regex_match(entry.path().filename().string(), re)) {
-                                    found_files.push_back(entry.path().string());
-                                }
-                            }
-                        }
-                    }
-                }
-            } catch (...) {}
+            add_timing_counter("wildcard patterns");
         }
 
+        add_timing_counter("wildcard matches", found_files.size());
         std::string result;
         for (const auto& f : found_files) {
             if (!result.empty()) result += ";";
             result += f;
         }
-        state.variables[out_var] = result;
+        state.set_variable(out_var, result);
     }
 }
 
@@ -1335,7 +1358,7 @@ void CMakeParser::add_sources_to_project(Project* project, const std::vector<std
             if (item.empty()) continue;
             
             // Check for wildcards
-            if (item.find('*') != std::string::npos) {
+            if (has_glob_chars(item)) {
                  // Expand glob
                  auto expanded = expand_glob(item, state.base_path);
                  for (const auto& ex : expanded) {
@@ -1354,104 +1377,18 @@ void CMakeParser::add_sources_to_project(Project* project, const std::vector<std
 }
 
 std::vector<std::string> CMakeParser::expand_glob(const std::string& pattern, const std::string& base_path) {
-    std::vector<std::string> result;
-
-    // Check if pattern includes ** for recursive search
-    bool recursive = pattern.find("**") != std::string::npos;
-
-    std::string dir;
-    std::string file_pattern;
-
-    if (recursive) {
-        // Extract the base directory (part before **)
-        size_t star_pos = pattern.find("**");
-        std::string prefix = pattern.substr(0, star_pos);
-
-        // Remove trailing slash/backslash from prefix
-        while (!prefix.empty() && (prefix.back() == '/' || prefix.back() == '\\')) {
-            prefix.pop_back();
-        }
-
-        // Get the file pattern (part after **)
-        std::string suffix = pattern.substr(star_pos + 2);
-        // Remove leading slash/backslash from suffix
-        while (!suffix.empty() && (suffix.front() == '/' || suffix.front() == '\\')) {
-            suffix.erase(0, 1);
-        }
-
-        // Directory is the prefix, file pattern is the filename part of suffix
-        dir = prefix.empty() ? "." : prefix;
-        fs::path suffix_path(suffix);
-        file_pattern = suffix_path.filename().string();
-    } else {
-        fs::path full_pattern = fs::path(base_path) / pattern;
-        dir = full_pattern.parent_path().string();
-        file_pattern = full_pattern.filename().string();
-    }
-
-    if (dir.empty()) dir = ".";
-
-    // Check if this is a wildcard pattern
-    if (file_pattern.find('*') == std::string::npos && file_pattern.find('?') == std::string::npos) {
-        // Not a wildcard, just return the path
-        result.push_back(pattern);
-        return result;
-    }
-
-    // Convert wildcard to regex
-    std::string regex_pattern = file_pattern;
-    // Escape special regex characters except * and ?
-    for (size_t i = 0; i < regex_pattern.size(); ++i) {
-        char c = regex_pattern[i];
-        if (c == '.' || c == '+' || c == '[' || c == ']' ||
-            c == '(' || c == ')' || c == '{' || c == '}' || c == '^' || c == '$') {
-            regex_pattern.insert(i, "\\");
-            ++i;
-        } else if (c == '*') {
-            regex_pattern.replace(i, 1, ".*");
-            ++i;
-        } else if (c == '?') {
-            regex_pattern.replace(i, 1, ".");
-        }
-    }
-
-    std::regex re(regex_pattern, std::regex::icase);
-
-    try {
-        fs::path search_dir = fs::path(base_path) / dir;
-        if (fs::exists(search_dir) && fs::is_directory(search_dir)) {
-            if (recursive) {
-                for (const auto& entry : fs::recursive_directory_iterator(search_dir)) {
-                    if (entry.is_regular_file()) {
-                        std::string filename = entry.path().filename().string();
-                        if (std::regex_match(filename, re)) {
-                            // Make path relative to base_path
-                            std::string rel_path = fs::relative(entry.path(), base_path).string();
-                            // Normalize path separators to forward slashes (CMake convention)
-                            std::replace(rel_path.begin(), rel_path.end(), '\\', '/');
-                            result.push_back(rel_path);
-                        }
-                    }
-                }
-            } else {
-                for (const auto& entry : fs::directory_iterator(search_dir)) {
-                    if (entry.is_regular_file()) {
-                        std::string filename = entry.path().filename().string();
-                        if (std::regex_match(filename, re)) {
-                            // Make path relative to base_path
-                            std::string rel_path = fs::relative(entry.path(), base_path).string();
-                            // Normalize path separators to forward slashes (CMake convention)
-                            std::replace(rel_path.begin(), rel_path.end(), '\\', '/');
-                            result.push_back(rel_path);
-                        }
-                    }
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "[CMake] Warning: Error expanding glob " << pattern << ": " << e.what() << "\n";
+    GlobOptions options;
+    options.cache = &directory_cache_;
+    options.jobs = jobs_;
+
+    TimingScope timing("expand_glob");
+    std::vector<std::string> result = glob_files(pattern, base_path, options);
+    add_timing_counter("wildcard patterns");
+    add_timing_counter("wildcard matches", result.size());
+    // Normalize path separators to forward slashes (CMake convention)
+    for (auto& path : result) {
+        std::replace(path.begin(), path.end(), '\\', '/');
     }
-
     return result;
 }
 
@@ -1668,7 +1605,7 @@ void CMakeParser::handle_foreach(const std::vector<std::string>& args, size_t& i
         if (mode == "LISTS") {
             // foreach(var IN LISTS list1 list2 ...)
             for (size_t j = 3; j < args.size(); ++j) {
-                std::string list_val = state.variables[args[j]];
+                std::string list_val = state.get_variable(args[j]);
                 // Split by semicolon
                 std::stringstream ss(list_val);
                 std::string item;
@@ -1720,23 +1657,23 @@ void CMakeParser::handle_foreach(const std::vector<std::string>& args, size_t& i
     std::vector<Token> body = capture_until("endforeach", i, tokens);
 
     // Save old variable value
-    auto old_it = state.variables.find(loop_var);
+    const std::string* old_it = state.find_variable(loop_var);
     std::string old_value;
-    bool had_value = (old_it != state.variables.end());
-    if (had_value) old_value = old_it->second;
+    bool had_value = (old_it != nullptr);
+    if (had_value) old_value = *old_it;
 
     // Execute loop
     for (const auto& item : items) {
-        state.variables[loop_var] = item;
+        state.set_variable(loop_var, item);
         size_t body_i = 0;
         execute_tokens(body, body_i, state);
     }
 
     // Restore old variable value
     if (had_value) {
-        state.variables[loop_var] = old_value;
+        state.set_variable(loop_var, old_value);
     } else {
-        state.variables.erase(loop_var);
+        state.unset_variable(loop_var);
     }
 }
 
@@ -1799,55 +1736,55 @@ void CMakeParser::execute_tokens(const std::vector<Token>& tokens, size_t& i, Pa
                     else if (command == "return") return; // Return from function/file
                     else {
                         // Check user-defined functions
-                        auto it = state.functions.find(command);
-                        if (it != state.functions.end()) {
-                            // Execute function
-                            ParseState func_state = state; // Copy global state
+                        auto function = state.find_function(command);
+                        if (function) {
+                            // Execute function in a new scope over the caller's
+                            ParseState func_state = state.nested_scope();
                             
                             // Map arguments
-                            for (size_t k = 0; k < it->second.params.size() && k < args.size(); ++k) {
-                                func_state.variables[it->second.params[k]] = args[k];
+                            for (size_t k = 0; k < function->params.size() && k < args.size(); ++k) {
+                                func_state.set_variable(function->params[k], args[k]);
                             }
                             
                             // ARGN support (simple version)
                             std::string argn;
-                            for (size_t k = it->second.params.size(); k < args.size(); ++k) {
+                            for (size_t k = function->params.size(); k < args.size(); ++k) {
                                 if (!argn.empty()) argn += ";";
                                 argn += args[k];
                             }
-                            func_state.variables["ARGN"] = argn;
+                            func_state.set_variable("ARGN", argn);
                             
                             size_t func_i = 0;
-                            execute_tokens(it->second.body, func_i, func_state);
+                            execute_tokens(function->body, func_i, func_state);
                             
                             // Propagate changes back for parent scope variables if explicitly set?
                             // CMake functions have new scope, macros don't.
-                            // This implementation copies state, so it behaves like a function scope.
+                            // Variables set in func_state are dropped with it, like a function scope.
                             // Modifications to `solution` (pointer) are persisted.
                         } else {
-                             auto macro_it = state.macros.find(command);
-                             if (macro_it != state.macros.end()) {
+                             auto macro = state.find_macro(command);
+                             if (macro) {
                                  // Execute macro (in current scope)
                                  // Arguments are replaced textually in real CMake, but here we can try binding variables
                                  // Map arguments
                                  std::map<std::string, std::string> old_vars;
-                                 for (size_t k = 0; k < macro_it->second.params.size() && k < args.size(); ++k) {
-                                     std::string param = macro_it->second.params[k];
-                                     if (state.variables.count(param)) old_vars[param] = state.variables[param];
-                                     state.variables[param] = args[k];
+                                 for (size_t k = 0; k < macro->params.size() && k < args.size(); ++k) {
+                                     std::string param = macro->params[k];
+                                     if (const std::string* old = state.find_variable(param)) old_vars[param] = *old;
+                                     state.set_variable(param, args[k]);
                                  }
                                  
                                  // ARGN
                                  std::string argn;
-                                 for (size_t k = macro_it->second.params.size(); k < args.size(); ++k) {
+                                 for (size_t k = macro->params.size(); k < args.size(); ++k) {
                                      if (!argn.empty()) argn += ";";
                                      argn += args[k];
                                  }
-                                 if (state.variables.count("ARGN")) old_vars["ARGN"] = state.variables["ARGN"];
-                                 state.variables["ARGN"] = argn;
+                                 if (const std::string* old = state.find_variable("ARGN")) old_vars["ARGN"] = *old;
+                                 state.set_variable("ARGN", argn);
 
                                  size_t macro_i = 0;
-                                 execute_tokens(macro_it->second.body, macro_i, state);
+                                 execute_tokens(macro->body, macro_i, state);
                                  
                                  // Restore variables? Macros typically overwrite.
                                  // Real macros don't have scope, so variables persist.
@@ -1906,7 +1843,7 @@ void CMakeParser::handle_function_def(const std::vector<std::string>& args, size
         i++;
     }
     
-    state.functions[func_name] = def;
+    state.functions[func_name] = std::make_shared<const FunctionDef>(std::move(def));
 }
 
 void CMakeParser::handle_macro_def(const std::vector<std::string>& args, size_t& i, const std::vector<Token>& tokens, ParseState& state) {
@@ -1941,7 +1878,7 @@ void CMakeParser::handle_macro_def(const std::vector<std::string>& args, size_t&
         i++;
     }
     
-    state.macros[macro_name] = def;
+    state.macros[macro_name] = std::make_shared<const FunctionDef>(std::move(def));
 }
 
 void CMakeParser::handle_if(const std::vector<std::string>& args, size_t& i, const std::vector<Token>& tokens, ParseState& state) {
@@ -2087,8 +2024,8 @@ bool CMakeParser::evaluate_condition(const std::vector<std::string>& args, Parse
     auto upper = [](const std::string& value) { return to_upper(value); };
 
     auto resolve_term = [&](const std::string& term) {
-        auto it = state.variables.find(term);
-        return it != state.variables.end() ? it->second : term;
+        const std::string* value = state.find_variable(term);
+        return value ? *value : term;
     };
 
     auto is_false = [&](const std::string& value) {
@@ -2148,7 +2085,7 @@ bool CMakeParser::evaluate_condition(const std::vector<std::string>& args, Parse
     }
 
     if (args[0] == "DEFINED" && args.size() > 1) {
-        return state.variables.find(args[1]) != state.variables.end();
+        return state.find_variable(args[1]) != nullptr;
     }
 
     if (args.size() >= 3) {
@@ -2173,50 +2110,46 @@ bool CMakeParser::evaluate_condition(const std::vector<std::string>& args, Parse
     }
 
     const std::string& term = args[0];
-    auto it = state.variables.find(term);
-    if (it == state.variables.end()) {
+    const std::string* it = state.find_variable(term);
+    if (!it) {
         return is_true_constant(term);
     }
 
-    const std::string& value = it->second;
+    const std::string& value = *it;
     if (is_true_constant(value)) return true;
     return !is_false(value);
 }
 
 void CMakeParser::propagate_include_directories(Solution& solution) {
     // For each project, propagate include directories from its dependencies
-    for (auto& proj : solution.projects) {
+    TimingScope timing("propagate_include_directories");
+    const ProjectGraph& graph = solution.graph();
+    const auto config_keys = solution.get_config_keys();
+
+    // processed_deps[i] == pass marks project i as visited for the current project
+    std::vector<size_t> processed_deps(graph.size(), ProjectGraph::npos);
+    for (size_t pass = 0; pass < solution.projects.size(); ++pass) {
+        auto& proj = solution.projects[pass];
         // Now propagate from dependencies (recursively)
-        std::vector<std::string> to_process;
-        std::set<std::string> processed_deps; // Track which dependencies we've visited
+        std::vector<size_t> to_process;
 
-        // Initialize with direct dependency names
-        for (const auto& dep : proj.project_references) {
-            to_process.push_back(dep.name);
+        // Initialize with direct dependencies
+        for (const auto& edge : graph.dependencies(pass)) {
+            to_process.push_back(edge.project);
         }
 
         while (!to_process.empty()) {
-            std::string dep_name = to_process.back();
+            size_t dep_index = to_process.back();
             to_process.pop_back();
 
             // Skip if we've already processed this dependency
-            if (processed_deps.count(dep_name)) continue;
-            processed_deps.insert(dep_name);
-
-            // Find the dependency project
-            Project* dep_proj = nullptr;
-            for (auto& p : solution.projects) {
-                if (p.name == dep_name) {
-                    dep_proj = &p;
-                    break;
-                }
-            }
-
-            if (!dep_proj) continue;
+            if (processed_deps[dep_index] == pass) continue;
+            processed_deps[dep_index] = pass;
+            Project* dep_proj = &solution.projects[dep_index];
 
             // Copy include directories from dependency to current project
             // Process EACH config separately to avoid cross-config pollution
-            for (const auto& config_key : solution.get_config_keys()) {
+            for (const auto& config_key : config_keys) {
                 // Create per-config set for deduplication
                 std::set<std::string> processed_includes;
 
@@ -2238,9 +2171,9 @@ void CMakeParser::propagate_include_directories(Solution& solution) {
             }
 
             // Add transitive dependencies (dependencies of dependencies)
-            for (const auto& transitive_dep : dep_proj->project_references) {
-                if (processed_deps.count(transitive_dep.name) == 0) {
-                    to_process.push_back(transitive_dep.name);
+            for (const auto& edge : graph.dependencies(dep_index)) {
+                if (processed_deps[edge.project] != pass) {
+                    to_process.push_back(edge.project);
                 }
             }
         }
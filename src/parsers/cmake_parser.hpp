@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/project_types.hpp"
+#include "common/glob.hpp"
 
 namespace vcxproj {
 
@@ -14,6 +15,9 @@ public:
     // Parse from string content
     Solution parse_string(const std::string& content, const std::string& base_path = ".");
 
+    // Threads used to read directories for file(GLOB_RECURSE) and ** sources (0 = one per core)
+    void set_jobs(int jobs) { jobs_ = jobs; }
+
 private:
     // Basic token types
     enum class TokenType {
@@ -36,22 +40,46 @@ private:
         std::vector<Token> body;
     };
 
+    // Definitions are immutable once captured and shared by every scope that
+    // can see them
+    using FunctionTable = std::map<std::string, std::shared_ptr<const FunctionDef>>;
+
+    // One variable scope: the top-level file, a subdirectory or a function
+    // call. Variables, functions and macros set here overlay those of the
+    // enclosing scope, which is only read, so entering a scope copies nothing.
     struct ParseState {
         Solution* solution = nullptr;
         std::string base_path;
         int line_number = 0;
 
-        // Variables state
-        std::map<std::string, std::string> variables;
+        // Enclosing scope, consulted for anything not set in this one
+        const ParseState* parent = nullptr;
+
+        // Variables set in this scope; std::nullopt hides an enclosing scope's value
+        std::map<std::string, std::optional<std::string>> variables;
         std::map<std::string, std::string> parent_scope_vars;  // For PARENT_SCOPE support
 
         // Current context
         std::string current_source_dir;
         std::string current_binary_dir;
 
-        // Defined functions and macros
-        std::map<std::string, FunctionDef> functions;
-        std::map<std::string, FunctionDef> macros;
+        // Functions and macros defined in this scope
+        FunctionTable functions;
+        FunctionTable macros;
+
+        // A scope inside this one, for add_subdirectory() or a function call.
+        // This state must outlive it.
+        ParseState nested_scope() const;
+
+        // Value visible in this scope, nullptr if the variable is not defined
+        const std::string* find_variable(const std::string& name) const;
+        // Value visible in this scope, empty if the variable is not defined
+        std::string get_variable(const std::string& name) const;
+        void set_variable(const std::string& name, std::string value);
+        void unset_variable(const std::string& name);
+
+        std::shared_ptr<const FunctionDef> find_function(const std::string& name) const;
+        std::shared_ptr<const FunctionDef> find_macro(const std::string& name) const;
     };
 
     // Context for evaluating generator expressions
@@ -130,6 +158,10 @@ private:
 
     // Helper to propagate include directories from linked projects
     void propagate_include_directories(Solution& solution);
+
+    // Directory listings shared by every glob of the current parse
+    DirectoryCache directory_cache_;
+    int jobs_ = 0;
 };
 
 } // namespace vcxproj
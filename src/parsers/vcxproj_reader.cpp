@@ -1749,7 +1749,7 @@ Solution SlnReader::read_sln(const std::string& filepath) {
 
     // Extract solution name from filename
     solution.name = fs::path(filepath).stem().string();
-    solution.uuid = generate_uuid();
+    solution.uuid = make_stable_uuid("solution|" + solution.name);
 
     return solution;
 }
@@ -1944,12 +1944,12 @@ Solution SlnReader::read_slnx(const std::string& filepath) {
         folder.name = (last_slash == std::string::npos) ? path : path.substr(last_slash + 1);
         folder.path = path;
         folder.parent = (last_slash == std::string::npos) ? std::string() : path.substr(0, last_slash);
-        folder.uuid = generate_uuid();
+        folder.uuid = make_stable_uuid("folder|" + path);
         solution.folders.push_back(folder);
     }
 
     solution.name = fs::path(filepath).stem().string();
-    solution.uuid = generate_uuid();
+    solution.uuid = make_stable_uuid("solution|" + solution.name);
 
     return solution;
 }
@@ -668,7 +668,7 @@ void VpcParser::handle_project(std::vector<Token>& tokens, size_t& i, ParseState
         state.solution.projects.emplace_back();
         proj = &state.solution.projects.back();
         proj->name = name;
-        proj->uuid = generate_uuid();
+        proj->uuid = make_stable_uuid("project|" + name);
     }
 
     state.current_project = proj;
@@ -1330,9 +1330,9 @@ void VpcParser::finalize_solution(ParseState& state) {
         state.solution.platforms = defaults::platforms();
     }
 
-    // Generate UUID if missing
+    // Derive a stable UUID if missing
     if (state.solution.uuid.empty()) {
-        state.solution.uuid = generate_uuid();
+        state.solution.uuid = make_stable_uuid("solution|" + state.solution.name);
     }
 
     // Ensure each project has configurations for all solution config/platform combos
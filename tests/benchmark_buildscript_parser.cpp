@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/buildscript_lexer.hpp"
+#include "parsers/buildscript_parser.hpp"
+#include "common/string_utils.hpp"
+
+#include <chrono>
+
+using namespace vcxproj;
+
+// Benchmarks are hidden; run them with: sighmake_tests "[benchmark]"
+
+// Large synthetic buildscript: 400 projects, each with a { } source list, a
+// """ build event, per-config and per-file settings and comments
+static std::string make_large_buildscript() {
+    std::string script = "[solution]\nname = Big\nconfigurations = Debug, Release\nplatforms = Win32, x64\n\n";
+    for (int p = 0; p < 400; ++p) {
+        const std::string name = "module" + std::to_string(p);
+        script += "# " + name + ": generated project with the usual settings\n";
+        script += "[project:" + name + "]\n";
+        script += "type = " + std::string(p % 10 == 0 ? "exe" : "lib") + "\n";
+        script += "sources = {\n";
+        for (int f = 0; f < 40; ++f) {
+            script += "    src/" + name + "/file" + std::to_string(f) + ".cpp  # translation unit " +
+                      std::to_string(f) + "\n";
+        }
+        script += "}\n";
+        script += "includes = include, src/" + name + ", ../shared/include, ../thirdparty/include\n";
+        script += "defines = " + name + "_EXPORTS, USE_FEATURE_A, USE_FEATURE_B\n";
+        script += "defines[Debug|x64] = " + name + "_DEBUG, TRACE_ALLOCATIONS\n";
+        script += "optimization[Release|x64] = MaxSpeed\n";
+        script += "warning_level = Level4\n";
+        script += "std = 17\n";
+        script += "src/" + name + "/file0.cpp:defines = FIRST_UNIT\n";
+        script += "postbuild = \"\"\"\n    echo built " + name + "\n    copy $(TargetPath) ..\\out\n\"\"\"\n";
+        if (p > 0) {
+            script += "target_link_libraries(module" + std::to_string(p - 1) + ")\n";
+        }
+        script += "\n";
+    }
+    return script;
+}
+
+// The line splitting the parser did before BuildscriptLexer: fold multi-line
+// values into a second copy of the file, then getline and trim each line
+static size_t legacy_split(const std::string& content) {
+    std::string processed;
+    std::istringstream in(content);
+    std::string line;
+    std::string prefix;
+    std::string accumulated;
+    std::vector<std::string> items;
+    bool in_quote = false;
+    bool in_brace = false;
+    while (std::getline(in, line)) {
+        if (in_quote) {
+            size_t close = line.find("\"\"\"");
+            if (close == std::string::npos) {
+                accumulated += line + "\n";
+                continue;
+            }
+            accumulated += line.substr(0, close);
+            processed += prefix;
+            for (char c : accumulated) {
+                if (c == '\n') processed += "\x01n";
+                else if (c == '\\') processed += "\x01\\";
+                else processed += c;
+            }
+            processed += "\n";
+            in_quote = false;
+            accumulated.clear();
+            continue;
+        }
+        if (in_brace) {
+            std::string trimmed = trim(line.substr(0, line.find('#')));
+            if (!trimmed.empty() && trimmed.back() == '}') {
+                std::string item = trim(trimmed.substr(0, trimmed.size() - 1));
+                if (!item.empty()) items.push_back(item);
+                std::string joined;
+                for (size_t i = 0; i < items.size(); ++i) {
+                    if (i > 0) joined += ",";
+                    joined += items[i];
+                }
+                processed += prefix + joined + "\n";
+                in_brace = false;
+                items.clear();
+            } else if (!trimmed.empty()) {
+                items.push_back(trimmed);
+            }
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            std::string value = line.substr(eq + 1);
+            size_t first = value.find_first_not_of(" \t");
+            if (first != std::string::npos && value.substr(first, 3) == "\"\"\"") {
+                in_quote = true;
+                prefix = line.substr(0, eq + 1) + " ";
+                continue;
+            }
+            if (trim(value.substr(0, value.find('#'))) == "{") {
+                in_brace = true;
+                prefix = line.substr(0, eq + 1) + " ";
+                continue;
+            }
+        }
+        processed += line + "\n";
+    }
+
+    size_t total = 0;
+    std::istringstream stream(processed);
+    while (std::getline(stream, line)) {
+        total += trim(line).size();
+    }
+    return total;
+}
+
+static size_t lexer_split(const std::string& content) {
+    BuildscriptLexer lexer(content);
+    BuildscriptLine line;
+    size_t total = 0;
+    while (lexer.next(line)) {
+        total += line.text.size();
+    }
+    return total;
+}
+
+// Megabytes of buildscript per second over `runs` calls of fn
+template <typename Fn>
+static double throughput_mb_s(const std::string& content, int runs, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(content.size()) * runs / (1024.0 * 1024.0) / elapsed.count();
+}
+
+TEST_CASE("Buildscript lexing and parsing throughput", "[.][benchmark][buildscript_parser]") {
+    const std::string content = make_large_buildscript();
+    REQUIRE(lexer_split(content) == legacy_split(content));
+
+    BuildscriptParser parser;
+    REQUIRE(parser.parse_string(content, ".").projects.size() == 400);
+
+    std::cout << "Buildscript of " << content.size() / 1024 << " KiB:\n"
+              << "  legacy line splitting: " << throughput_mb_s(content, 20, [&] { legacy_split(content); })
+              << " MB/s\n"
+              << "  BuildscriptLexer:      " << throughput_mb_s(content, 20, [&] { lexer_split(content); })
+              << " MB/s\n"
+              << "  parse_string:          "
+              << throughput_mb_s(content, 3, [&] { parser.parse_string(content, "."); }) << " MB/s\n";
+
+    BENCHMARK("legacy line splitting") {
+        return legacy_split(content);
+    };
+    BENCHMARK("BuildscriptLexer") {
+        return lexer_split(content);
+    };
+    BENCHMARK("parse_string") {
+        return parser.parse_string(content, ".").projects.size();
+    };
+}
+
+// Solution whose root includes 300 project buildscripts, each sharing a
+// common settings fragment
+struct ProjectIncludeTree {
+    std::filesystem::path path;
+
+    ProjectIncludeTree() {
+        namespace fs = std::filesystem;
+        path = fs::temp_directory_path() / "sighmake_bench_project_includes";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path / "common");
+        std::ofstream(path / "common" / "settings.buildscript")
+            << "std = 17\nwarning_level = Level4\ndefines = {\n    USE_FEATURE_A\n    USE_FEATURE_B\n}\n";
+
+        std::ofstream root(path / "root.buildscript");
+        root << "[solution]\nname = Big\nconfigurations = Debug, Release\nplatforms = Win32, x64\n\n";
+        for (int p = 0; p < 300; ++p) {
+            const std::string name = "module" + std::to_string(p);
+            fs::create_directories(path / name);
+            std::ofstream script(path / name / (name + ".buildscript"));
+            script << "[project:" << name << "]\ntype = lib\nsources = {\n";
+            for (int f = 0; f < 40; ++f) {
+                script << "    src/file" << f << ".cpp\n";
+            }
+            script << "}\ninclude = ../common/settings.buildscript\n"
+                   << "includes = include, ../shared/include\n"
+                   << "defines[Debug|x64] = " << name << "_DEBUG\n"
+                   << "src/file0.cpp:defines = FIRST_UNIT\n";
+            if (p > 0) {
+                script << "target_link_libraries(module" << p - 1 << ")\n";
+            }
+            root << "include = " << name << "/" << name << ".buildscript\n";
+        }
+    }
+
+    ~ProjectIncludeTree() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+};
+
+TEST_CASE("Parallel parsing of project includes", "[.][benchmark][buildscript_parser]") {
+    ProjectIncludeTree tree;
+    const std::string root = (tree.path / "root.buildscript").string();
+
+    BuildscriptParser sequential;
+    sequential.set_jobs(1);
+    BuildscriptParser parallel;
+    parallel.set_jobs(0);
+    REQUIRE(parallel.parse(root).projects.size() == sequential.parse(root).projects.size());
+
+    BENCHMARK("sequential includes") {
+        return sequential.parse(root).projects.size();
+    };
+    BENCHMARK("parallel includes") {
+        return parallel.parse(root).projects.size();
+    };
+}
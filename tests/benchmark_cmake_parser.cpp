@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/cmake_parser.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Benchmarks are hidden; run them with: sighmake_tests "[benchmark]"
+
+// Synthetic CMake tree: six levels of add_subdirectory with three children
+// each (1093 directories). The root sets 300 variables and defines 30
+// functions and macros, so every scope entered has a lot it could copy; each
+// directory sets a few variables of its own and adds a library through a
+// function
+struct CMakeTree {
+    fs::path path;
+    size_t directories = 0;
+
+    CMakeTree() {
+        path = fs::temp_directory_path() / "sighmake_bench_cmake_tree";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+
+        std::ostringstream root;
+        root << "cmake_minimum_required(VERSION 3.16)\nproject(Deep)\n";
+        for (int v = 0; v < 300; ++v) {
+            root << "set(SETTING_" << v << " value_" << v << " other_" << v << ")\n";
+        }
+        for (int f = 0; f < 30; ++f) {
+            root << "function(helper_" << f << " name)\n";
+            for (int s = 0; s < 10; ++s) {
+                root << "    set(local_" << s << " \"${name}_" << s << "\")\n";
+            }
+            root << "endfunction()\n";
+            root << "macro(macro_helper_" << f << " name)\n"
+                 << "    list(APPEND ALL_NAMES ${name})\n"
+                 << "endmacro()\n";
+        }
+        root << "function(add_module name)\n"
+             << "    add_library(${name} STATIC ${name}.cpp)\n"
+             << "    target_compile_definitions(${name} PRIVATE ${SETTING_7})\n"
+             << "    helper_3(${name})\n"
+             << "endfunction()\n";
+        write(path, root.str(), "m", 0);
+    }
+
+    ~CMakeTree() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    void write(const fs::path& dir, std::string content, const std::string& name, int depth) {
+        fs::create_directories(dir);
+        ++directories;
+        content += "set(MODULE_NAME " + name + ")\n";
+        content += "set(MODULE_DEPTH " + std::to_string(depth) + ")\n";
+        content += "macro_helper_1(" + name + ")\n";
+        content += "add_module(" + name + ")\n";
+        if (depth < 6) {
+            for (int c = 0; c < 3; ++c) {
+                std::string child = "c" + std::to_string(c);
+                content += "add_subdirectory(" + child + ")\n";
+                write(dir / child, "", name + "_" + std::to_string(c), depth + 1);
+            }
+        }
+        std::ofstream(dir / "CMakeLists.txt") << content;
+    }
+};
+
+TEST_CASE("CMake parsing of a deep add_subdirectory tree", "[.][benchmark][cmake_parser]") {
+    CMakeTree tree;
+    const std::string cmakelists = (tree.path / "CMakeLists.txt").string();
+
+    CMakeParser parser;
+    REQUIRE(parser.parse(cmakelists).projects.size() == tree.directories);
+
+    BENCHMARK("CMakeParser::parse, 1093 directories") {
+        CMakeParser bench_parser;
+        return bench_parser.parse(cmakelists).projects.size();
+    };
+}
@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/glob.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Benchmarks are hidden; run them with: sighmake_tests "[benchmark]"
+
+// Synthetic source tree: 40 modules x 5 subdirectories x 50 files, mixing
+// sources, headers and files no pattern cares about
+struct SyntheticTree {
+    fs::path path;
+    size_t cpp_files = 0;
+
+    SyntheticTree() {
+        path = fs::temp_directory_path() / "sighmake_bench_glob";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        static const char* extensions[] = {".cpp", ".h", ".inl", ".txt", ".cpp"};
+        for (int m = 0; m < 40; ++m) {
+            for (int d = 0; d < 5; ++d) {
+                fs::path dir = path / "src" / ("module" + std::to_string(m)) / ("part" + std::to_string(d));
+                fs::create_directories(dir);
+                for (int f = 0; f < 50; ++f) {
+                    const char* ext = extensions[f % 5];
+                    std::ofstream(dir / ("file" + std::to_string(f) + ext));
+                    if (std::string(ext) == ".cpp") ++cpp_files;
+                }
+            }
+        }
+    }
+
+    ~SyntheticTree() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+// The expansion the parsers used before glob_files: a recursive walk matching
+// every file name against an icase std::regex, then fs::relative per match
+static std::vector<std::string> regex_expand(const std::string& dir, const std::string& file_pattern,
+                                             const std::string& base_path) {
+    std::string regex_pattern;
+    for (char c : file_pattern) {
+        if (c == '*') {
+            regex_pattern += ".*";
+        } else if (c == '.') {
+            regex_pattern += "\\.";
+        } else {
+            regex_pattern += c;
+        }
+    }
+    std::regex re(regex_pattern, std::regex::icase);
+
+    std::vector<std::string> result;
+    for (const auto& entry : fs::recursive_directory_iterator(fs::path(base_path) / dir)) {
+        if (entry.is_regular_file() && std::regex_match(entry.path().filename().string(), re)) {
+            result.push_back(fs::relative(entry.path(), base_path).string());
+        }
+    }
+    return result;
+}
+
+TEST_CASE("Glob expansion on a large tree", "[.][benchmark][glob]") {
+    SyntheticTree tree;
+    const std::string base = tree.path.string();
+
+    REQUIRE(glob_files("src/**/*.cpp", base).size() == tree.cpp_files);
+    REQUIRE(regex_expand("src", "*.cpp", base).size() == tree.cpp_files);
+
+    BENCHMARK("std::regex src/**/*.cpp") {
+        return regex_expand("src", "*.cpp", base);
+    };
+    BENCHMARK("glob_files src/**/*.cpp") {
+        return glob_files("src/**/*.cpp", base);
+    };
+
+    // Pruning: only one module's directories are ever listed
+    BENCHMARK("std::regex src/module7/**/*.cpp") {
+        return regex_expand("src/module7", "*.cpp", base);
+    };
+    BENCHMARK("glob_files src/module7/**/*.cpp") {
+        return glob_files("src/module7/**/*.cpp", base);
+    };
+    BENCHMARK("glob_files src/*/part2/*.cpp") {
+        return glob_files("src/*/part2/*.cpp", base);
+    };
+}
+
+TEST_CASE("Glob expansion of overlapping patterns", "[.][benchmark][glob]") {
+    SyntheticTree tree;
+    const std::string base = tree.path.string();
+    const char* patterns[] = {"src/**/*.cpp", "src/**/*.h", "src/**/*.inl"};
+
+    // Three wildcard lines over the same tree, as sources/headers/etc. would be
+    BENCHMARK("separate walks") {
+        size_t count = 0;
+        for (const char* pattern : patterns) count += glob_files(pattern, base).size();
+        return count;
+    };
+    BENCHMARK("shared DirectoryCache") {
+        DirectoryCache cache;
+        GlobOptions options;
+        options.cache = &cache;
+        size_t count = 0;
+        for (const char* pattern : patterns) count += glob_files(pattern, base, options).size();
+        return count;
+    };
+    BENCHMARK("shared DirectoryCache, parallel reads") {
+        DirectoryCache cache;
+        GlobOptions options;
+        options.cache = &cache;
+        options.jobs = 0;
+        size_t count = 0;
+        for (const char* pattern : patterns) count += glob_files(pattern, base, options).size();
+        return count;
+    };
+}
+
+TEST_CASE("Glob name matching", "[.][benchmark][glob]") {
+    std::vector<std::string> names;
+    for (int i = 0; i < 10000; ++i) {
+        names.push_back("some_source_file_" + std::to_string(i) + (i % 3 ? ".cpp" : ".h"));
+    }
+
+    std::regex re(".*_file_.*\\.cpp", std::regex::icase);
+    BENCHMARK("std::regex_match *_file_*.cpp") {
+        size_t count = 0;
+        for (const auto& name : names) count += std::regex_match(name, re);
+        return count;
+    };
+
+    GlobPattern pattern("*_file_*.cpp");
+    BENCHMARK("GlobPattern *_file_*.cpp") {
+        size_t count = 0;
+        for (const auto& name : names) count += pattern.matches(name);
+        return count;
+    };
+}
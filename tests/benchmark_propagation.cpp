@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/buildscript_parser.hpp"
+
+using namespace vcxproj;
+
+// Benchmarks are hidden; run them with: sighmake_tests "[benchmark]"
+
+// Deep layered library stack: every project links three projects of the next
+// layer (mostly PUBLIC, some INTERFACE/PRIVATE), so each consumer reaches most
+// of the stack below it, the shape of engine -> core -> platform -> thirdparty
+static Solution make_layered_solution(int layers, int width) {
+    Solution solution;
+    solution.configurations = {"Debug", "Release"};
+    solution.platforms = {"Win32", "x64"};
+    static const DependencyVisibility visibilities[] = {
+        DependencyVisibility::PUBLIC, DependencyVisibility::PUBLIC,
+        DependencyVisibility::INTERFACE, DependencyVisibility::PRIVATE};
+
+    for (int layer = 0; layer < layers; ++layer) {
+        for (int i = 0; i < width; ++i) {
+            Project project;
+            project.name = "lib_" + std::to_string(layer) + "_" + std::to_string(i);
+            project.public_includes = {project.name + "/include", "shared/include" + std::to_string(i)};
+            project.public_defines = {"HAS_" + project.name};
+            project.public_libs = {project.name + ".lib"};
+            project.public_libdirs_per_config["Debug|x64"] = {project.name + "/lib/debug"};
+            for (const auto& config_key : solution.get_config_keys()) {
+                project.configurations[config_key];
+            }
+            if (layer + 1 < layers) {
+                for (int k = 0; k < 3; ++k) {
+                    int target = (i + k * 3) % width;
+                    project.project_references.push_back(ProjectDependency(
+                        "lib_" + std::to_string(layer + 1) + "_" + std::to_string(target),
+                        visibilities[(i + k) % 4]));
+                }
+            }
+            solution.projects.push_back(std::move(project));
+        }
+    }
+    return solution;
+}
+
+// The propagation the parser ran before export closures were memoized: a
+// fresh worklist walk per project, dependencies found by a linear scan
+static void walk_per_project(Solution& solution) {
+    for (auto& proj : solution.projects) {
+        std::vector<std::pair<std::string, DependencyVisibility>> to_process;
+        std::set<std::string> processed;
+        for (const auto& dep : proj.project_references) {
+            if (dep.link_library_dependencies) to_process.push_back({dep.name, dep.visibility});
+        }
+
+        while (!to_process.empty()) {
+            auto [dep_name, visibility] = to_process.back();
+            to_process.pop_back();
+            if (!processed.insert(dep_name).second) continue;
+
+            Project* dep = nullptr;
+            for (auto& p : solution.projects) {
+                if (p.name == dep_name) {
+                    dep = &p;
+                    break;
+                }
+            }
+            if (!dep) continue;
+
+            if (visibility != DependencyVisibility::INTERFACE) {
+                auto add = [](std::vector<std::string>& list, const std::vector<std::string>& values) {
+                    for (const auto& value : values) {
+                        if (std::find(list.begin(), list.end(), value) == list.end()) list.push_back(value);
+                    }
+                };
+                auto add_per_config = [&](std::vector<std::string>& list,
+                                          const std::map<std::string, std::vector<std::string>>& values,
+                                          const std::string& config_key) {
+                    auto it = values.find(config_key);
+                    if (it != values.end()) add(list, it->second);
+                };
+                for (const auto& config_key : solution.get_config_keys()) {
+                    auto& config = proj.configurations[config_key];
+                    add(config.cl_compile.additional_include_directories, dep->public_includes);
+                    add_per_config(config.cl_compile.additional_include_directories,
+                                   dep->public_includes_per_config, config_key);
+                    add(config.link.additional_dependencies, dep->public_libs);
+                    add_per_config(config.link.additional_dependencies, dep->public_libs_per_config, config_key);
+                    add(config.link.additional_library_directories, dep->public_libdirs);
+                    add_per_config(config.link.additional_library_directories,
+                                   dep->public_libdirs_per_config, config_key);
+                    add(config.cl_compile.preprocessor_definitions, dep->public_defines);
+                    add_per_config(config.cl_compile.preprocessor_definitions,
+                                   dep->public_defines_per_config, config_key);
+                }
+            }
+
+            for (const auto& trans_dep : dep->project_references) {
+                if (!trans_dep.link_library_dependencies) continue;
+                if (trans_dep.visibility == DependencyVisibility::PRIVATE) continue;
+                if (!processed.count(trans_dep.name)) to_process.push_back({trans_dep.name, visibility});
+            }
+        }
+    }
+}
+
+static bool same_propagated_settings(const Solution& a, const Solution& b) {
+    for (size_t i = 0; i < a.projects.size(); ++i) {
+        for (const auto& [config_key, config] : a.projects[i].configurations) {
+            const auto& other = b.projects[i].configurations.at(config_key);
+            if (config.cl_compile.additional_include_directories !=
+                    other.cl_compile.additional_include_directories ||
+                config.cl_compile.preprocessor_definitions != other.cl_compile.preprocessor_definitions ||
+                config.link.additional_dependencies != other.link.additional_dependencies ||
+                config.link.additional_library_directories != other.link.additional_library_directories) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Dependency propagation on a deep library stack", "[.][benchmark][propagation]") {
+    // 40 layers x 8 projects, 4 configurations
+    const Solution base = make_layered_solution(40, 8);
+
+    Solution memoized = base;
+    BuildscriptParser::propagate_target_link_libraries(memoized);
+    Solution walked = base;
+    walk_per_project(walked);
+    REQUIRE(same_propagated_settings(memoized, walked));
+
+    // Both include copying the unpropagated solution
+    BENCHMARK("walk per project") {
+        Solution solution = base;
+        walk_per_project(solution);
+        return solution.projects.size();
+    };
+    BENCHMARK("memoized export closures") {
+        Solution solution = base;
+        BuildscriptParser::propagate_target_link_libraries(solution);
+        return solution.projects.size();
+    };
+}
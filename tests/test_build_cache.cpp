@@ -0,0 +1,165 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/build_cache.hpp"
+#include "common/package_cache.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// RAII temp dir for build cache tests
+struct CacheDir {
+    fs::path path;
+
+    CacheDir() {
+        path = fs::temp_directory_path() / "sighmake_test_build_cache";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path / "build");
+    }
+
+    ~CacheDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+// Cache with one buildscript and one wildcard directory recorded as inputs
+static BuildCache make_cache(const CacheDir& dir) {
+    fs::create_directories(dir.path / "src");
+    std::ofstream(dir.path / "src" / "a.cpp") << "int a;\n";
+    std::ofstream(dir.path / "app.buildscript") << "[project:App]\ntype = exe\n";
+
+    Solution solution;
+    solution.generation_options = "generator=makefile";
+
+    GenerationInput script;
+    script.path = (dir.path / "app.buildscript").generic_string();
+    script.hash = hash_input_file(script.path);
+    solution.inputs.push_back(script);
+
+    GenerationInput sources;
+    sources.path = (dir.path / "src").generic_string();
+    sources.is_directory = true;
+    sources.hash = hash_input_directory(sources.path);
+    solution.inputs.push_back(sources);
+
+    BuildCache cache;
+    cache.generator = "makefile";
+    cache.build_dir = "build";
+    cache.record_inputs(solution);
+    return cache;
+}
+
+// ============================================================================
+// Input hashing
+// ============================================================================
+
+TEST_CASE("hash_input_file tracks content", "[build_cache]") {
+    CacheDir dir;
+    fs::path file = dir.path / "a.buildscript";
+
+    CHECK(hash_input_file(file.string()) == 0);
+    std::ofstream(file) << "[solution]\n";
+    uint64_t first = hash_input_file(file.string());
+    CHECK(first != 0);
+    CHECK(hash_input_file(file.string()) == first);
+
+    std::ofstream(file) << "[solution]\nname = X\n";
+    CHECK(hash_input_file(file.string()) != first);
+}
+
+TEST_CASE("hash_input_directory tracks entry names", "[build_cache]") {
+    CacheDir dir;
+    fs::path src = dir.path / "src";
+
+    CHECK(hash_input_directory(src.string()) == 0);
+    fs::create_directories(src);
+    std::ofstream(src / "a.cpp") << "int a;\n";
+    uint64_t first = hash_input_directory(src.string());
+    CHECK(first != 0);
+
+    // Editing a file's content does not change the listing
+    std::ofstream(src / "a.cpp") << "int a = 1;\n";
+    CHECK(hash_input_directory(src.string()) == first);
+
+    std::ofstream(src / "b.cpp") << "int b;\n";
+    CHECK(hash_input_directory(src.string()) != first);
+}
+
+// ============================================================================
+// Incremental regeneration
+// ============================================================================
+
+TEST_CASE("BuildCache round-trips options and inputs", "[build_cache]") {
+    CacheDir dir;
+    BuildCache cache = make_cache(dir);
+    REQUIRE(cache.write(dir.path.string()));
+
+    auto read = BuildCache::read(dir.path.string());
+    REQUIRE(read.has_value());
+    CHECK(read->options == "generator=makefile");
+    REQUIRE(read->inputs.size() == 2);
+    CHECK(read->inputs[0].path == cache.inputs[0].path);
+    CHECK(read->inputs[0].hash == cache.inputs[0].hash);
+    CHECK_FALSE(read->inputs[0].is_directory);
+    CHECK(read->inputs[1].is_directory);
+    CHECK(read->inputs[1].hash == cache.inputs[1].hash);
+}
+
+TEST_CASE("BuildCache is up to date until an input changes", "[build_cache]") {
+    CacheDir dir;
+    BuildCache cache = make_cache(dir);
+    const std::string root = dir.path.string();
+
+    CHECK(cache.is_up_to_date("generator=makefile", root));
+
+    SECTION("different options") {
+        CHECK_FALSE(cache.is_up_to_date("generator=ninja", root));
+    }
+    SECTION("edited buildscript") {
+        std::ofstream(dir.path / "app.buildscript") << "[project:App]\ntype = lib\n";
+        CHECK_FALSE(cache.is_up_to_date("generator=makefile", root));
+    }
+    SECTION("new file matched by a wildcard") {
+        std::ofstream(dir.path / "src" / "b.cpp") << "int b;\n";
+        CHECK_FALSE(cache.is_up_to_date("generator=makefile", root));
+    }
+    SECTION("generated output removed") {
+        fs::remove_all(dir.path / "build");
+        CHECK_FALSE(cache.is_up_to_date("generator=makefile", root));
+    }
+}
+
+#ifndef _WIN32
+TEST_CASE("BuildCache is stale when a find_package() variable changes", "[build_cache]") {
+    CacheDir dir;
+    BuildCache cache = make_cache(dir);
+    const std::string root = dir.path.string();
+    ::setenv("SIGHMAKE_TEST_SDK_DIR", "/opt/sdk-1", 1);
+
+    // First run: the probe reads the variable and is stored next to the cache
+    {
+        PackageCache packages;
+        packages.find("sdk", [](PackageProbe& probe) {
+            PackageFindResult result;
+            result.found = probe.env("SIGHMAKE_TEST_SDK_DIR") != nullptr;
+            return result;
+        });
+        REQUIRE(packages.save(root));
+    }
+    CHECK(cache.is_up_to_date("generator=makefile", root));
+
+    // Second run with the variable changed must regenerate
+    ::setenv("SIGHMAKE_TEST_SDK_DIR", "/opt/sdk-2", 1);
+    CHECK_FALSE(cache.is_up_to_date("generator=makefile", root));
+    ::unsetenv("SIGHMAKE_TEST_SDK_DIR");
+    CHECK_FALSE(cache.is_up_to_date("generator=makefile", root));
+}
+#endif
+
+TEST_CASE("BuildCache without recorded inputs is never up to date", "[build_cache]") {
+    CacheDir dir;
+    BuildCache cache;
+    cache.generator = "makefile";
+    CHECK_FALSE(cache.is_up_to_date("", dir.path.string()));
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/build_trace.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+static std::string read_text(const fs::path& path) {
+    std::ifstream in(path);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("Build trace classifies generated recipe lines", "[build_trace]") {
+    auto compile = classify_trace_command(
+        "g++ -O2 -Iinclude -include \"obj/Debug/pch.h\" -MMD -MP -c -o obj/Debug/src/main.o src/main.cpp");
+    CHECK(compile.kind == "compile");
+    CHECK(compile.label == "src/main.cpp");
+
+    auto pch = classify_trace_command("g++ -O2 -x c++-header -o obj/Debug/pch.h.gch src/pch.h");
+    CHECK(pch.kind == "compile");
+    CHECK(pch.label == "src/pch.h");
+
+    auto link = classify_trace_command("g++ -pthread -o ../bin/Debug/app obj/Debug/a.o obj/Debug/b.o -lm");
+    CHECK(link.kind == "link");
+    CHECK(link.label == "../bin/Debug/app");
+
+    auto archive = classify_trace_command("ar rcs ../lib/Debug/libcore.a obj/Debug/core.o");
+    CHECK(archive.kind == "archive");
+    CHECK(archive.label == "../lib/Debug/libcore.a");
+
+    auto make = classify_trace_command("make -f core.Debug");
+    CHECK(make.kind == "make");
+    CHECK(make.label == "core.Debug");
+
+    auto other = classify_trace_command("mkdir -p obj/Debug/src");
+    CHECK(other.kind == "other");
+    CHECK(other.label == "mkdir");
+}
+
+TEST_CASE("Build trace classifies chained build event commands", "[build_trace]") {
+    auto info = classify_trace_command("echo prelink && clang++ -o app main.o && strip app");
+    CHECK(info.kind == "link");
+    CHECK(info.label == "app");
+}
+
+#ifndef _WIN32
+TEST_CASE("Traced commands keep their exit code and append to the log", "[build_trace]") {
+    fs::path log = fs::temp_directory_path() / "sighmake_test_build_trace.log";
+    fs::remove(log);
+    ::setenv(TRACE_LOG_ENV, log.string().c_str(), 1);
+
+    CHECK(run_traced_command("true") == 0);
+    CHECK(run_traced_command("exit 3") == 3);
+    CHECK(run_traced_command("printf 'a\\tb' > /dev/null") == 0);
+    ::unsetenv(TRACE_LOG_ENV);
+
+    auto events = read_trace_log(log.string());
+    fs::remove(log);
+
+    REQUIRE(events.size() == 3);
+    CHECK(events[0].command == "true");
+    CHECK(events[0].exit_code == 0);
+    CHECK(events[1].exit_code == 3);
+    CHECK(events[2].command == "printf 'a\\tb' > /dev/null");
+    for (const auto& event : events) {
+        CHECK(event.end_us >= event.start_us);
+    }
+}
+#endif
+
+TEST_CASE("Build trace packs overlapping commands into rows", "[build_trace]") {
+    std::vector<TraceEvent> events = {
+        {"g++ -c -o a.o a.cpp", 1000, 5000, 0},
+        {"g++ -c -o b.o b.cpp", 1500, 2500, 0},
+        {"g++ -c -o c.o c.cpp", 3000, 4000, 1},
+        {"g++ -o app a.o b.o c.o", 5000, 6000, 0},
+    };
+
+    fs::path path = fs::temp_directory_path() / "sighmake_test_build_trace.json";
+    REQUIRE(write_build_trace(events, path.string()));
+    const std::string json = read_text(path);
+    fs::remove(path);
+
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"a.cpp\", \"cat\": \"compile\", \"ph\": \"X\", \"ts\": 0, \"dur\": 4000, "
+                    "\"pid\": 1, \"tid\": 1") != std::string::npos);
+    CHECK(json.find("\"name\": \"b.cpp\", \"cat\": \"compile\", \"ph\": \"X\", \"ts\": 500, \"dur\": 1000, "
+                    "\"pid\": 1, \"tid\": 2") != std::string::npos);
+    // b.cpp finished before c.cpp started, so c.cpp reuses its row
+    CHECK(json.find("\"name\": \"c.cpp\", \"cat\": \"compile\", \"ph\": \"X\", \"ts\": 2000, \"dur\": 1000, "
+                    "\"pid\": 1, \"tid\": 2, \"args\": {\"exit_code\": 1") != std::string::npos);
+    CHECK(json.find("\"name\": \"app\", \"cat\": \"link\"") != std::string::npos);
+    CHECK(json.find("\"tid\": 3") == std::string::npos);
+}
+
+TEST_CASE("Build trace escapes control characters in commands", "[build_trace]") {
+    std::vector<TraceEvent> events = {{"echo \"one\"\necho\ttwo\x01", 0, 10, 0}};
+
+    fs::path path = fs::temp_directory_path() / "sighmake_test_build_trace.json";
+    REQUIRE(write_build_trace(events, path.string()));
+    const std::string json = read_text(path);
+    fs::remove(path);
+
+    CHECK(json.find("\"command\": \"echo \\\"one\\\"\\necho\\ttwo\\u0001\"") != std::string::npos);
+}
+
+TEST_CASE("Build trace summary lists the slowest translation units", "[build_trace]") {
+    std::vector<TraceEvent> events = {
+        {"g++ -c -o fast.o fast.cpp", 0, 1000, 0},
+        {"g++ -c -o slow.o slow.cpp", 0, 3000000, 0},
+        {"g++ -c -o medium.o medium.cpp", 0, 2000000, 0},
+        {"g++ -o app fast.o slow.o medium.o", 3000000, 3500000, 0},
+    };
+
+    std::ostringstream out;
+    write_build_trace_summary(events, out, 2);
+    const std::string text = out.str();
+
+    CHECK(text.find("4 commands in 3.50 s wall time") != std::string::npos);
+    CHECK(text.find("slow.cpp") < text.find("medium.cpp"));
+    CHECK(text.find("fast.cpp") == std::string::npos);
+    CHECK(text.find("link") != std::string::npos);
+}
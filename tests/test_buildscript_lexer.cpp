@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/buildscript_lexer.hpp"
+
+using namespace vcxproj;
+
+// All logical lines of source
+static std::vector<BuildscriptLine> lex_all(std::string_view source, std::vector<std::string>& texts) {
+    BuildscriptLexer lexer(source);
+    std::vector<BuildscriptLine> lines;
+    BuildscriptLine line;
+    while (lexer.next(line)) {
+        texts.emplace_back(line.text);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST_CASE("Lexer yields trimmed views of ordinary lines", "[buildscript_lexer]") {
+    const std::string source = "[project:App]\n  type = exe  \n\n# comment\r\nsources = main.cpp";
+    std::vector<std::string> texts;
+    auto lines = lex_all(source, texts);
+
+    REQUIRE(texts == std::vector<std::string>{"[project:App]", "type = exe", "", "# comment", "sources = main.cpp"});
+    CHECK(lines[1].line_number == 2);
+    CHECK(lines[4].line_number == 5);
+    // Ordinary lines are not copied
+    CHECK(lines[1].text.data() == source.data() + source.find("type"));
+}
+
+TEST_CASE("Lexer folds triple-quoted values", "[buildscript_lexer]") {
+    const std::string source =
+        "postbuild = \"\"\"\n"
+        "copy a\\b c\n"
+        "  echo done\n"
+        "\"\"\"\n"
+        "message = \"\"\"one line\"\"\"\n"
+        "name = App\n";
+    std::vector<std::string> texts;
+    auto lines = lex_all(source, texts);
+
+    REQUIRE(texts.size() == 3);
+    CHECK(texts[0] == "postbuild = copy a\x01\\b c\x01n  echo done\x01n");
+    CHECK(texts[1] == "message = one line");
+    CHECK(texts[2] == "name = App");
+    CHECK(lines[1].line_number == 5);
+    CHECK(lines[2].line_number == 6);
+}
+
+TEST_CASE("Lexer joins brace lists", "[buildscript_lexer]") {
+    const std::string source =
+        "sources = {  # all of them\n"
+        "    a.cpp\n"
+        "    # b.cpp is gone\n"
+        "\n"
+        "    c.cpp  # keep\n"
+        "    d.cpp }\n"
+        "defines = { }\n"
+        "type = lib\n";
+    std::vector<std::string> texts;
+    auto lines = lex_all(source, texts);
+
+    REQUIRE(texts.size() == 3);
+    CHECK(texts[0] == "sources = a.cpp,c.cpp,d.cpp");
+    CHECK(texts[1] == "defines = { }");  // Not a block: the brace must stand alone
+    CHECK(texts[2] == "type = lib");
+    CHECK(lines[2].line_number == 8);
+}
+
+TEST_CASE("Lexer drops an unterminated multi-line value", "[buildscript_lexer]") {
+    std::vector<std::string> texts;
+    lex_all("name = App\nsources = {\n  a.cpp\n", texts);
+    CHECK(texts == std::vector<std::string>{"name = App"});
+}
+
+TEST_CASE("LexedBuildscript keeps the lines after the buffer is gone", "[buildscript_lexer]") {
+    std::string source = "name = App\nsources = {\n  a.cpp\n  b.cpp\n}\ntype = lib\n";
+    LexedBuildscript lexed(source);
+    source.assign(source.size(), 'x');
+
+    REQUIRE(lexed.size() == 3);
+    CHECK(lexed[0].text == "name = App");
+    CHECK(lexed[1].text == "sources = a.cpp,b.cpp");
+    CHECK(lexed[1].line_number == 2);
+    CHECK(lexed[2].text == "type = lib");
+    CHECK(lexed[2].line_number == 6);
+}
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "catch_amalgamated.hpp"
 #include "parsers/buildscript_parser.hpp"
+#include "common/build_cache.hpp"
+#include "common/timings.hpp"
 
 using namespace vcxproj;
 namespace fs = std::filesystem;
@@ -96,6 +98,38 @@ type = exe
     CHECK(sol.projects[0].name == "MyApp");
 }
 
+TEST_CASE("Project and solution UUIDs are stable across parses", "[buildscript_parser]") {
+    const std::string script = R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Win32
+
+[project:MyApp]
+type = exe
+
+[project:MyLib]
+type = lib
+
+[project:Pinned]
+type = lib
+uuid = 11111111-2222-3333-4444-555555555555
+)";
+    BuildscriptParser first_parser;
+    BuildscriptParser second_parser;
+    auto first = first_parser.parse_string(script);
+    auto second = second_parser.parse_string(script);
+
+    REQUIRE(first.projects.size() == 3);
+    CHECK(!first.uuid.empty());
+    CHECK(first.uuid == second.uuid);
+    CHECK(first.projects[0].uuid == second.projects[0].uuid);
+    CHECK(first.projects[1].uuid == second.projects[1].uuid);
+    CHECK(first.projects[0].uuid != first.projects[1].uuid);
+    // An explicit uuid key still wins
+    CHECK(first.projects[2].uuid == "11111111-2222-3333-4444-555555555555");
+}
+
 TEST_CASE("Parse project type exe", "[buildscript_parser]") {
     BuildscriptParser parser;
     auto sol = parser.parse_string(R"(
@@ -2878,3 +2912,328 @@ defines = ${PREFIX}_${SUFFIX}_DEFINE
     REQUIRE(it != proj.configurations.end());
     CHECK(contains(it->second.cl_compile.preprocessor_definitions, "MY_APP_DEFINE"));
 }
+
+TEST_CASE("Parser records buildscripts and wildcard directories as inputs", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_generation_inputs";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir / "Engine" / "src", ec);
+
+    std::ofstream(temp_dir / "Engine" / "src" / "a.cpp") << "int a;\n";
+    std::ofstream(temp_dir / "root.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+include = Engine/Engine.buildscript
+)";
+    std::ofstream(temp_dir / "Engine" / "Engine.buildscript") << R"(
+[project:Engine]
+type = lib
+sources = src/*.cpp
+)";
+
+    BuildscriptParser parser;
+    auto sol = parser.parse((temp_dir / "root.buildscript").string());
+
+    auto find_input = [&](const std::filesystem::path& path) -> const GenerationInput* {
+        std::string key = std::filesystem::absolute(path).lexically_normal().generic_string();
+        for (const auto& input : sol.inputs) {
+            if (input.path == key) return &input;
+        }
+        return nullptr;
+    };
+
+    REQUIRE(sol.inputs.size() == 3);
+    CHECK(sol.inputs[0].path.find("root.buildscript") != std::string::npos);
+
+    const auto* root = find_input(temp_dir / "root.buildscript");
+    REQUIRE(root != nullptr);
+    CHECK_FALSE(root->is_directory);
+    CHECK(root->hash == hash_input_file((temp_dir / "root.buildscript").string()));
+
+    const auto* include = find_input(std::filesystem::canonical(temp_dir / "Engine" / "Engine.buildscript"));
+    REQUIRE(include != nullptr);
+    CHECK(include->hash != 0);
+
+    const auto* dir = find_input(std::filesystem::canonical(temp_dir / "Engine" / "src"));
+    REQUIRE(dir != nullptr);
+    CHECK(dir->is_directory);
+    CHECK(dir->hash == hash_input_directory(dir->path));
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
+
+TEST_CASE("Parser expands brace sets and character classes in source globs", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_glob_sources";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir / "src" / "win", ec);
+
+    for (const char* name : {"a.cpp", "b.cc", "c.c", "v1.cpp", "vx.cpp"}) {
+        std::ofstream(temp_dir / "src" / name) << "\n";
+    }
+    std::ofstream(temp_dir / "src" / "win" / "w.cpp") << "\n";
+    std::ofstream(temp_dir / "app.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = src/[abc].{cpp,cc}, src/v[0-9].cpp
+)";
+
+    BuildscriptParser parser;
+    auto sol = parser.parse((temp_dir / "app.buildscript").string());
+    REQUIRE(sol.projects.size() == 1);
+
+    std::vector<std::string> names;
+    for (const auto& src : sol.projects[0].sources) {
+        names.push_back(std::filesystem::path(src.path).filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    CHECK(names == std::vector<std::string>{"a.cpp", "b.cc", "v1.cpp"});
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
+
+TEST_CASE("Parser finds existing sources for per-file settings in large projects", "[buildscript_parser]") {
+    std::string input = "[solution]\nname = Big\nconfigurations = Debug\nplatforms = x64\n\n"
+                        "[project:Big]\ntype = lib\n";
+    for (int i = 0; i < 2000; ++i) {
+        input += "sources = src/file" + std::to_string(i) + ".cpp\n";
+    }
+    for (int i = 0; i < 2000; i += 100) {
+        input += "src/file" + std::to_string(i) + ".cpp:defines = FILE_" + std::to_string(i) + "\n";
+    }
+    input += "[file:src/file1999.cpp]\ndefines = LAST\n";
+
+    BuildscriptParser parser;
+    Solution sol = parser.parse_string(input);
+    REQUIRE(sol.projects.size() == 1);
+    const auto& sources = sol.projects[0].sources;
+    REQUIRE(sources.size() == 2000);
+
+    CHECK(sources[100].path.find("file100.cpp") != std::string::npos);
+    CHECK(contains(sources[100].settings.preprocessor_defines.at(ALL_CONFIGS), "FILE_100"));
+    CHECK(contains(sources[1999].settings.preprocessor_defines.at(ALL_CONFIGS), "LAST"));
+    CHECK(sources[1].settings.preprocessor_defines.empty());
+}
+
+TEST_CASE("Parser keeps the current project across includes that add projects", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_include_projects";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir, ec);
+
+    // Enough projects in the include to reallocate the solution's project list
+    std::ofstream libs(temp_dir / "libs.buildscript");
+    for (int i = 0; i < 40; ++i) {
+        libs << "[project:Lib" << i << "]\ntype = lib\nsources = lib" << i << ".cpp\n";
+    }
+    libs.close();
+
+    std::ofstream(temp_dir / "root.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = before.cpp
+include = libs.buildscript
+sources = after.cpp
+)";
+
+    BuildscriptParser parser;
+    auto sol = parser.parse((temp_dir / "root.buildscript").string());
+    const Project* app = find_project(sol, "App");
+    REQUIRE(app != nullptr);
+    REQUIRE(app->sources.size() == 2);
+    CHECK(app->sources[1].path.find("after.cpp") != std::string::npos);
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
+
+TEST_CASE("Parser applies an include shared by several projects to each", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_shared_include";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir / "common", ec);
+
+    std::ofstream(temp_dir / "common" / "warnings.buildscript") << R"(
+defines = SHARED_WARNINGS
+sources = {
+    shared.cpp
+}
+)";
+    std::ofstream(temp_dir / "root.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:A]
+type = lib
+include = common/warnings.buildscript
+
+[project:B]
+type = lib
+include = common/warnings.buildscript
+include = common/missing.buildscript
+include = common/missing.buildscript
+)";
+
+    BuildscriptParser parser;
+    auto sol = parser.parse((temp_dir / "root.buildscript").string());
+
+    for (const char* name : {"A", "B"}) {
+        const Project* project = find_project(sol, name);
+        REQUIRE(project != nullptr);
+        REQUIRE(project->sources.size() == 1);
+        CHECK(project->sources[0].path.find("shared.cpp") != std::string::npos);
+        auto it = project->configurations.find("Debug|x64");
+        REQUIRE(it != project->configurations.end());
+        CHECK(contains(it->second.cl_compile.preprocessor_definitions, "SHARED_WARNINGS"));
+    }
+
+    // Each include file is an input once, however often it is included
+    size_t shared_inputs = 0;
+    size_t missing_inputs = 0;
+    for (const auto& input : sol.inputs) {
+        if (input.path.find("warnings.buildscript") != std::string::npos) ++shared_inputs;
+        if (input.path.find("missing.buildscript") != std::string::npos) ++missing_inputs;
+    }
+    CHECK(shared_inputs == 1);
+    CHECK(missing_inputs == 1);
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
+
+TEST_CASE("Parser merges includes parsed in parallel in include order", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_parallel_includes";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir, ec);
+
+    std::ofstream root(temp_dir / "root.buildscript");
+    root << "[solution]\nname = Test\nconfigurations = Debug\nplatforms = x64\n\n";
+    for (int i = 0; i < 12; ++i) {
+        const std::string name = "P" + std::to_string(i);
+        std::ofstream script(temp_dir / (name + ".buildscript"));
+        script << "[project:" << name << "]\ntype = lib\nsources = " << name << ".cpp\n"
+               << "defines = " << name << "_DEF, FOO_${Foo_FOUND}\n";
+        // Includes after these read what they set, so they must see it
+        if (i == 3) script << "find_package(Foo)\n";
+        if (i == 6) script << "[config:Profile|x64]\noptimization = MaxSpeed\n";
+        root << "include = " << name << ".buildscript\n";
+        if (i == 8) root << "\n# comment between includes\n";
+    }
+    root.close();
+
+    auto parse_with_jobs = [&](int jobs) {
+        BuildscriptParser parser;
+        parser.set_jobs(jobs);
+        return parser.parse((temp_dir / "root.buildscript").string());
+    };
+    Solution sequential = parse_with_jobs(1);
+    Solution parallel = parse_with_jobs(4);
+
+    REQUIRE(parallel.projects.size() == 12);
+    REQUIRE(sequential.projects.size() == 12);
+    CHECK(parallel.configurations == sequential.configurations);
+    CHECK(parallel.platforms == sequential.platforms);
+    for (size_t i = 0; i < 12; ++i) {
+        const Project& a = sequential.projects[i];
+        const Project& b = parallel.projects[i];
+        CHECK(b.name == a.name);
+        CHECK(b.uuid == a.uuid);
+        REQUIRE(b.sources.size() == a.sources.size());
+        CHECK(b.sources[0].path == a.sources[0].path);
+        for (const auto& [key, config] : a.configurations) {
+            auto it = b.configurations.find(key);
+            REQUIRE(it != b.configurations.end());
+            CHECK(it->second.cl_compile.preprocessor_definitions == config.cl_compile.preprocessor_definitions);
+        }
+        CHECK(b.configurations.size() == a.configurations.size());
+    }
+
+    // P3 sets Foo_FOUND after reading it: the includes before it see it
+    // undefined, the ones after it see FALSE
+    auto has_define = [&](size_t project, const std::string& define) {
+        for (const auto& [key, config] : parallel.projects[project].configurations) {
+            if (contains(config.cl_compile.preprocessor_definitions, define)) return true;
+        }
+        return false;
+    };
+    CHECK(has_define(2, "FOO_"));
+    CHECK(has_define(4, "FOO_FALSE"));
+    CHECK(parallel.projects[7].configurations.count("Profile|x64") == 1);
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
+
+TEST_CASE("Parser shares include files and project toolsets with parallel includes", "[buildscript_parser]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "sighmake_test_parallel_shared";
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir, ec);
+    std::filesystem::create_directories(temp_dir, ec);
+
+    std::ofstream(temp_dir / "common.buildscript") << "defines = COMMON\n";
+    std::ofstream root(temp_dir / "root.buildscript");
+    root << "[solution]\nname = Test\nconfigurations = Debug\nplatforms = x64\n\n";
+    for (int i = 0; i < 8; ++i) {
+        const std::string name = "P" + std::to_string(i);
+        std::ofstream script(temp_dir / (name + ".buildscript"));
+        script << "[project:" << name << "]\ntype = lib\nsources = " << name << ".cpp\n"
+               << "include = common.buildscript\n";
+        if (i == 1) script << "toolset = v142\n";
+        if (i == 4) script << "toolset = v143\n";
+        root << "include = " << name << ".buildscript\n";
+    }
+    root.close();
+
+    auto parse_with_jobs = [&](int jobs) {
+        BuildscriptParser parser;
+        parser.set_jobs(jobs);
+        return parser.parse((temp_dir / "root.buildscript").string());
+    };
+    Solution sequential = parse_with_jobs(1);
+
+    reset_timings();
+    enable_timings();
+    Solution parallel = parse_with_jobs(4);
+    std::ostringstream summary;
+    write_timing_summary(summary);
+    enable_timings(false);
+    reset_timings();
+
+    // The first project's toolset is the solution's, as when parsed in order
+    CHECK(sequential.target_toolset == "v142");
+    CHECK(parallel.target_toolset == "v142");
+    REQUIRE(parallel.projects.size() == 8);
+    CHECK(parallel.projects[4].project_level_defaults.platform_toolset == "v143");
+
+    // A toolset changes nothing later includes depend on, and the shared
+    // fragment is read once for all workers
+    const std::string text = summary.str();
+    CHECK(text.find("includes parsed again") == std::string::npos);
+    size_t hits = text.find("include cache hits");
+    REQUIRE(hits != std::string::npos);
+    std::istringstream fields(text.substr(hits + std::string("include cache hits").size()));
+    int count = 0;
+    fields >> count;
+    CHECK(count == 7);
+
+    size_t common_inputs = 0;
+    for (const auto& input : parallel.inputs) {
+        if (input.path.find("common.buildscript") != std::string::npos) ++common_inputs;
+    }
+    CHECK(common_inputs == 1);
+
+    std::filesystem::remove_all(temp_dir, ec);
+}
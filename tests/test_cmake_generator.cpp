@@ -116,6 +116,43 @@ sources = main.cpp
     CHECK(result.root_content.find("add_subdirectory(App)") != std::string::npos);
 }
 
+TEST_CASE("CMakeGenerator sets the compiler launcher", "[cmake_generator]") {
+    auto result = generate_cmake(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = x64
+compiler_launcher = ccache
+
+[project:App]
+type = exe
+sources = main.cpp
+compiler_launcher = distcc -j4
+)");
+    CHECK(result.root_content.find("if(NOT DEFINED CMAKE_CXX_COMPILER_LAUNCHER)") != std::string::npos);
+    CHECK(result.root_content.find("set(CMAKE_CXX_COMPILER_LAUNCHER \"ccache\")") != std::string::npos);
+    CHECK(result.project_content.find("CXX_COMPILER_LAUNCHER \"distcc;-j4\"") != std::string::npos);
+}
+
+TEST_CASE("CMakeGenerator emits unity build properties", "[cmake_generator]") {
+    auto result = generate_cmake(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = x64
+
+[project:App]
+type = exe
+sources = main.cpp, util.cpp
+unity_build = true
+unity_batch_size = 16
+util.cpp:defines = UTIL
+)");
+    CHECK(result.project_content.find("UNITY_BUILD ON") != std::string::npos);
+    CHECK(result.project_content.find("UNITY_BUILD_BATCH_SIZE 16") != std::string::npos);
+    CHECK(result.project_content.find("SKIP_UNITY_BUILD_INCLUSION ON") != std::string::npos);
+}
+
 // ============================================================================
 // Target types
 // ============================================================================
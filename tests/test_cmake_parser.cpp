@@ -3,6 +3,7 @@
 #include "parsers/cmake_parser.hpp"
 
 using namespace vcxproj;
+namespace fs = std::filesystem;
 
 // Helper to find a project by name
 static const Project* find_project(const Solution& sol, const std::string& name) {
@@ -418,6 +419,65 @@ create_exe(MyApp)
     CHECK(find_project(sol, "MyApp") != nullptr);
 }
 
+TEST_CASE("CMake function() variables stay in the function's scope", "[cmake_parser]") {
+    CMakeParser parser;
+    auto sol = parser.parse_string(R"(
+project(Test)
+set(NAME Outer)
+set(ITEM Kept)
+function(make_lib name)
+    set(NAME ${name})
+    set(FROM_FUNCTION ON)
+    foreach(ITEM a b)
+    endforeach()
+    add_library(${NAME}_${ITEM} STATIC src.cpp)
+endfunction()
+make_lib(Inner)
+if(NOT DEFINED FROM_FUNCTION)
+    add_library(${NAME}_${ITEM} STATIC src.cpp)
+endif()
+)");
+    CHECK(find_project(sol, "Inner_Kept") != nullptr);
+    CHECK(find_project(sol, "Outer_Kept") != nullptr);
+}
+
+TEST_CASE("CMake add_subdirectory() scope reads the parent's and returns PARENT_SCOPE", "[cmake_parser]") {
+    fs::path root = fs::temp_directory_path() / "sighmake_test_cmake_scopes";
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    fs::create_directories(root / "sub");
+    std::ofstream(root / "sub" / "CMakeLists.txt") << R"(
+set(LOCAL_ONLY ON)
+set(PREFIX Sub)
+set(RESULT ${PREFIX}_done PARENT_SCOPE)
+define_lib(${PREFIX}_${BASE})
+function(sub_helper)
+endfunction()
+)";
+
+    CMakeParser parser;
+    auto sol = parser.parse_string(R"(
+project(Test)
+set(BASE Lib)
+set(PREFIX Top)
+function(define_lib name)
+    add_library(${name} STATIC src.cpp)
+endfunction()
+add_subdirectory(sub)
+define_lib(${PREFIX}_${RESULT})
+if(NOT DEFINED LOCAL_ONLY)
+    add_library(NoLeak STATIC src.cpp)
+endif()
+sub_helper()
+)", root.string());
+    fs::remove_all(root, ec);
+
+    CHECK(find_project(sol, "Sub_Lib") != nullptr);
+    CHECK(find_project(sol, "Top_Sub_done") != nullptr);
+    CHECK(find_project(sol, "NoLeak") != nullptr);
+    CHECK(sol.projects.size() == 3);
+}
+
 // ============================================================================
 // list operations
 // ============================================================================
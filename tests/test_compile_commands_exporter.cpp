@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/buildscript_parser.hpp"
+#include "generators/compile_commands_exporter.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Helper to read file content
+static std::string read_file(const fs::path& path) {
+    std::ifstream f(path);
+    return std::string((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+}
+
+// RAII temp dir for compile_commands.json tests
+struct CompileCommandsResult {
+    fs::path temp_dir;
+    std::string content;
+    bool success = false;
+
+    ~CompileCommandsResult() {
+        std::error_code ec;
+        fs::remove_all(temp_dir, ec);
+    }
+};
+
+static CompileCommandsResult export_commands(const std::string& buildscript,
+                                             std::vector<std::string> source_files,
+                                             const std::string& config = "") {
+    CompileCommandsResult result;
+    result.temp_dir = fs::temp_directory_path() / "sighmake_test_compile_commands";
+    std::error_code ec;
+    fs::remove_all(result.temp_dir, ec);
+    fs::create_directories(result.temp_dir);
+
+    // Create dummy source files so source paths resolve.
+    for (const auto& source : source_files) {
+        fs::path source_path = result.temp_dir / source;
+        fs::create_directories(source_path.parent_path());
+        std::ofstream(source_path) << "int main() { return 0; }";
+    }
+
+    BuildscriptParser parser;
+    Solution solution = parser.parse_string(buildscript, result.temp_dir.string());
+
+    result.success = export_compile_commands(solution, result.temp_dir.string(), config);
+    fs::path json_path = result.temp_dir / "compile_commands.json";
+    if (fs::exists(json_path)) {
+        result.content = read_file(json_path);
+    }
+    return result;
+}
+
+// ============================================================================
+// compile_commands.json tests
+// ============================================================================
+
+TEST_CASE("CompileCommands writes one entry per translation unit", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug, Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp, util.c
+defines = APP_DEFINE
+std = 17
+)", {"main.cpp", "util.c"});
+    REQUIRE(result.success);
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.front() == '[');
+    CHECK(result.content.find("\"directory\": ") != std::string::npos);
+    CHECK(result.content.find("main.cpp\",") != std::string::npos);
+    CHECK(result.content.find("util.c\",") != std::string::npos);
+    CHECK(result.content.find("-std=c++17") != std::string::npos);
+    CHECK(result.content.find("-DAPP_DEFINE") != std::string::npos);
+    // Debug is the default configuration
+    CHECK(result.content.find("-O0") != std::string::npos);
+}
+
+TEST_CASE("CompileCommands honors the selected configuration", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug, Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+)", {"main.cpp"}, "Release");
+    REQUIRE(result.success);
+    CHECK(result.content.find("Release/obj/App") != std::string::npos);
+    CHECK(result.content.find("Debug/obj/App") == std::string::npos);
+}
+
+TEST_CASE("CompileCommands rejects unknown configurations", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+)", {"main.cpp"}, "Profile");
+    CHECK_FALSE(result.success);
+}
+
+TEST_CASE("CompileCommands includes per-file overrides and PCH", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp, fast.cpp
+pch = Use
+pch_header = pch.h
+fast.cpp:defines = FAST_PATH
+fast.cpp:optimization = MaxSpeed
+)", {"main.cpp", "fast.cpp", "pch.h"});
+    REQUIRE(result.success);
+    CHECK(result.content.find("-DFAST_PATH") != std::string::npos);
+    CHECK(result.content.find("-O3") != std::string::npos);
+    // Indexers get the real header rather than the .gch stem used by the build
+    CHECK(result.content.find("-include \\\"") != std::string::npos);
+    CHECK(result.content.find("pch.h\\\" -c") != std::string::npos);
+}
+
+TEST_CASE("CompileCommands lists the sources batched into unity TUs", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Linux
+
+[project:App]
+type = exe
+sources = a.cpp, b.cpp, c.cpp
+defines = UNITY_DEFINE
+unity_build = true
+)", {"a.cpp", "b.cpp", "c.cpp"});
+    REQUIRE(result.success);
+    // One entry per real source, with the unity TU's flags and object
+    CHECK(result.content.find("a.cpp\",") != std::string::npos);
+    CHECK(result.content.find("b.cpp\",") != std::string::npos);
+    CHECK(result.content.find("c.cpp\",") != std::string::npos);
+    CHECK(result.content.find("unity_0_cxx.cpp\",") == std::string::npos);
+    CHECK(result.content.find("-DUNITY_DEFINE") != std::string::npos);
+    CHECK(result.content.find("/obj/App/unity/unity_0_cxx.o\"\n") != std::string::npos);
+    // Exporting plans the unity TUs but does not write them
+    CHECK_FALSE(fs::exists(result.temp_dir / "build" / "unity"));
+}
+
+TEST_CASE("CompileCommands falls back to Windows configurations", "[compile_commands]") {
+    auto result = export_commands(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = main.cpp
+)", {"main.cpp"});
+    REQUIRE(result.success);
+    CHECK(result.content.find("main.cpp\",") != std::string::npos);
+}
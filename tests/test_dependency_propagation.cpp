@@ -553,3 +553,89 @@ target_link_libraries(PUBLIC EngineCore)
     CHECK_FALSE(contains_substring(eit->second.link.additional_library_directories, "/opt/homebrew/lib"));
     CHECK_FALSE(contains(eit->second.cl_compile.preprocessor_definitions, "USE_SDL2"));
 }
+
+// ============================================================================
+// Shared and cyclic dependencies
+// ============================================================================
+
+// Which of wanted occur in list (as substrings of its resolved paths), in list order
+static std::vector<std::string> filter(const std::vector<std::string>& list,
+                                       const std::vector<std::string>& wanted) {
+    std::vector<std::string> result;
+    for (const auto& value : list) {
+        for (const auto& name : wanted) {
+            if (value.find(name) != std::string::npos) result.push_back(name);
+        }
+    }
+    return result;
+}
+
+TEST_CASE("Shared transitive dependency is propagated once, in walk order", "[dependency_propagation]") {
+    BuildscriptParser parser;
+    auto sol = parser.parse_string(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Win32
+
+[project:Platform]
+type = lib
+public_includes = platform_inc
+
+[project:Core]
+type = lib
+public_includes = core_inc
+target_link_libraries(PUBLIC Platform)
+
+[project:Render]
+type = lib
+public_includes = render_inc
+target_link_libraries(PUBLIC Platform)
+
+[project:Game]
+type = exe
+target_link_libraries(PUBLIC Core Render)
+)");
+    auto* game = find_project(sol, "Game");
+    REQUIRE(game != nullptr);
+    const auto& includes = game->configurations.at("Debug|Win32").cl_compile.additional_include_directories;
+
+    // Later references are walked first, each to the bottom of its chain
+    CHECK(filter(includes, {"platform_inc", "core_inc", "render_inc"}) ==
+          std::vector<std::string>{"render_inc", "platform_inc", "core_inc"});
+}
+
+TEST_CASE("Dependency cycles propagate to every project on the cycle", "[dependency_propagation]") {
+    BuildscriptParser parser;
+    auto sol = parser.parse_string(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Win32
+
+[project:A]
+type = lib
+public_includes = a_inc
+target_link_libraries(PUBLIC B)
+
+[project:B]
+type = lib
+public_includes = b_inc
+target_link_libraries(PUBLIC A)
+
+[project:App]
+type = exe
+target_link_libraries(PUBLIC A)
+)");
+    auto* a = find_project(sol, "A");
+    auto* b = find_project(sol, "B");
+    auto* app = find_project(sol, "App");
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    REQUIRE(app != nullptr);
+
+    const auto& app_includes = app->configurations.at("Debug|Win32").cl_compile.additional_include_directories;
+    CHECK(filter(app_includes, {"a_inc", "b_inc"}) == std::vector<std::string>{"a_inc", "b_inc"});
+    CHECK(contains_substring(a->configurations.at("Debug|Win32").cl_compile.additional_include_directories, "b_inc"));
+    CHECK(contains_substring(b->configurations.at("Debug|Win32").cl_compile.additional_include_directories, "a_inc"));
+}
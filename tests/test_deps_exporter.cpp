@@ -193,3 +193,129 @@ TEST_CASE("DepsExporter HTML escapes special characters", "[deps_exporter]") {
     CHECK(result.html_content.find("&lt;") != std::string::npos);
     CHECK(result.html_content.find("&gt;") != std::string::npos);
 }
+
+// ============================================================================
+// Critical-path analysis
+// ============================================================================
+
+static Project make_project(const std::string& name, std::vector<std::string> deps, size_t sources = 1) {
+    Project proj;
+    proj.name = name;
+    proj.configurations["Debug|Win32"].config_type = "StaticLibrary";
+    for (const auto& dep : deps) {
+        proj.project_references.push_back({dep, DependencyVisibility::PUBLIC});
+    }
+    for (size_t i = 0; i < sources; ++i) {
+        SourceFile src;
+        src.path = name + "/file" + std::to_string(i) + ".cpp";
+        proj.sources.push_back(src);
+    }
+    SourceFile header;
+    header.path = name + "/header.h";
+    header.type = FileType::ClInclude;
+    proj.sources.push_back(header);
+    return proj;
+}
+
+// Base <- Core <- Render <- App, plus Util and Audio hanging off Base
+static Solution make_layered_solution() {
+    Solution sol;
+    sol.name = "Layers";
+    sol.projects.push_back(make_project("App", {"Render", "Audio", "Util"}, 1));
+    sol.projects.push_back(make_project("Render", {"Core"}, 2));
+    sol.projects.push_back(make_project("Audio", {"Base"}, 20));
+    sol.projects.push_back(make_project("Util", {"Base"}, 1));
+    sol.projects.push_back(make_project("Core", {"Base"}, 3));
+    sol.projects.push_back(make_project("Base", {}, 4));
+    return sol;
+}
+
+static std::vector<std::string> chain_names(const DependencyAnalysis& analysis) {
+    std::vector<std::string> names;
+    for (size_t index : analysis.critical_path) names.push_back(analysis.projects[index].name);
+    return names;
+}
+
+TEST_CASE("Dependency analysis finds levels and the longest chain", "[deps_exporter]") {
+    auto analysis = analyze_dependencies(make_layered_solution());
+
+    CHECK(analysis.weight_unit == "projects");
+    CHECK(analysis.level_widths == std::vector<size_t>{1, 3, 1, 1});
+    CHECK(chain_names(analysis) == std::vector<std::string>{"Base", "Core", "Render", "App"});
+    CHECK(analysis.total_weight == 6.0);
+    CHECK(analysis.critical_weight == 4.0);
+    CHECK(analysis.parallelism() == Catch::Approx(1.5));
+
+    REQUIRE(!analysis.fan_in.empty());
+    const auto& base = analysis.projects[analysis.fan_in.front()];
+    CHECK(base.name == "Base");
+    CHECK(base.dependents == 3);
+    CHECK(base.transitive_dependents == 5);
+    CHECK(base.critical);
+}
+
+TEST_CASE("Dependency analysis weighs projects by compiled sources", "[deps_exporter]") {
+    DependencyReportOptions options;
+    options.weight = DependencyWeight::Sources;
+    auto analysis = analyze_dependencies(make_layered_solution(), options);
+
+    CHECK(analysis.weight_unit == "sources");
+    CHECK(chain_names(analysis) == std::vector<std::string>{"Base", "Audio", "App"});
+    CHECK(analysis.critical_weight == 25.0);
+    CHECK(analysis.total_weight == 31.0);
+}
+
+TEST_CASE("Dependency analysis weighs projects by traced build times", "[deps_exporter]") {
+    fs::path trace = fs::temp_directory_path() / "sighmake_test_deps_trace.json";
+    {
+        std::ofstream out(trace);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << "  {\"name\": \"Base.Debug\", \"cat\": \"make\", \"ph\": \"X\", \"ts\": 0, \"dur\": 1000000}\n";
+        out << "  {\"name\": \"Util.Debug\", \"cat\": \"make\", \"ph\": \"X\", \"ts\": 0, \"dur\": 9000000}\n";
+        out << "  {\"name\": \"App.Debug\", \"cat\": \"make\", \"ph\": \"X\", \"ts\": 0, \"dur\": 500000}\n";
+        out << "  {\"name\": \"app.cpp\", \"cat\": \"compile\", \"ph\": \"X\", \"ts\": 0, \"dur\": 99000000}\n";
+        out << "]}\n";
+    }
+
+    DependencyReportOptions options;
+    options.weight = DependencyWeight::BuildTime;
+    options.trace_file = trace.string();
+    auto analysis = analyze_dependencies(make_layered_solution(), options);
+    fs::remove(trace);
+
+    CHECK(analysis.weight_unit == "seconds");
+    CHECK(chain_names(analysis) == std::vector<std::string>{"Base", "Util", "App"});
+    CHECK(analysis.critical_weight == Catch::Approx(10.5));
+}
+
+TEST_CASE("Dependency analysis survives cycles and skips package projects", "[deps_exporter]") {
+    Solution sol;
+    sol.name = "Cycle";
+    sol.projects.push_back(make_project("A", {"B", "ZLIB"}));
+    sol.projects.push_back(make_project("B", {"A"}));
+    Project package = make_project("ZLIB", {});
+    package.is_package_project = true;
+    sol.projects.push_back(package);
+
+    auto analysis = analyze_dependencies(sol);
+    REQUIRE(analysis.projects.size() == 2);
+    CHECK(analysis.projects[0].dependencies == 1);
+    CHECK(analysis.level_widths == std::vector<size_t>{1, 1});
+    CHECK(analysis.critical_path.size() == 2);
+}
+
+TEST_CASE("DepsExporter writes the critical path as HTML and JSON", "[deps_exporter]") {
+    Solution sol = make_layered_solution();
+    auto result = export_deps(sol);
+    REQUIRE(result.success);
+    CHECK(result.html_content.find("Critical Path") != std::string::npos);
+    CHECK(result.html_content.find("Highest fan-in") != std::string::npos);
+
+    REQUIRE(export_dependencies_json(sol, result.temp_dir.string()));
+    const std::string json = read_file(result.temp_dir / "Layers_dependencies.json");
+    CHECK(json.find("\"level_widths\": [1, 3, 1, 1]") != std::string::npos);
+    CHECK(json.find("\"critical_path\": [\"Base\", \"Core\", \"Render\", \"App\"]") != std::string::npos);
+    CHECK(json.find("{\"name\": \"Base\", \"type\": \"Static Library\", \"level\": 0, \"weight\": 1, \"finish\": 1, "
+                    "\"dependents\": 3, \"transitive_dependents\": 5, \"critical\": true") != std::string::npos);
+    CHECK(json.find("{\"name\": \"Core\", \"visibility\": \"PUBLIC\"}") != std::string::npos);
+}
@@ -23,6 +23,12 @@ TEST_CASE("GeneratorFactory creates makefile generator", "[generator_factory]")
     CHECK(gen->name() == "makefile");
 }
 
+TEST_CASE("GeneratorFactory creates ninja generator", "[generator_factory]") {
+    auto gen = GeneratorFactory::instance().create("ninja");
+    REQUIRE(gen != nullptr);
+    CHECK(gen->name() == "ninja");
+}
+
 TEST_CASE("GeneratorFactory creates buildscript generator", "[generator_factory]") {
     auto gen = GeneratorFactory::instance().create("buildscript");
     REQUIRE(gen != nullptr);
@@ -0,0 +1,287 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/glob.hpp"
+
+#include <algorithm>
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// RAII temp tree for glob tests
+struct GlobDir {
+    fs::path path;
+
+    GlobDir() {
+        path = fs::temp_directory_path() / "sighmake_test_glob";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path);
+    }
+
+    ~GlobDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    void touch(const std::string& rel) {
+        fs::path file = path / rel;
+        fs::create_directories(file.parent_path());
+        std::ofstream(file) << "x\n";
+    }
+};
+
+// Sorted generic-form results, so assertions don't depend on listing order
+static std::vector<std::string> glob_sorted(const std::string& pattern, const fs::path& base) {
+    std::vector<std::string> result;
+    for (const auto& path : glob_files(pattern, base.string())) {
+        result.push_back(fs::path(path).generic_string());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// ============================================================================
+// GlobPattern
+// ============================================================================
+
+TEST_CASE("GlobPattern matches stars and question marks", "[glob]") {
+    CHECK(GlobPattern("*.cpp").matches("main.cpp"));
+    CHECK(GlobPattern("*.cpp").matches(".cpp"));
+    CHECK_FALSE(GlobPattern("*.cpp").matches("main.cpp.bak"));
+    CHECK(GlobPattern("*_test*.cpp").matches("parser_test_utils.cpp"));
+    CHECK(GlobPattern("a*b*c").matches("aXbYbZc"));
+    CHECK_FALSE(GlobPattern("a*b*c").matches("aXbYbZ"));
+    CHECK(GlobPattern("file?.h").matches("file1.h"));
+    CHECK_FALSE(GlobPattern("file?.h").matches("file.h"));
+    CHECK(GlobPattern("*").matches("anything"));
+}
+
+TEST_CASE("GlobPattern is case-insensitive by default", "[glob]") {
+    CHECK(GlobPattern("*.CPP").matches("main.cpp"));
+    CHECK(GlobPattern("Main.cpp").matches("MAIN.CPP"));
+    CHECK_FALSE(GlobPattern("*.CPP", true).matches("main.cpp"));
+    CHECK(GlobPattern("*.cpp", true).matches("main.cpp"));
+}
+
+TEST_CASE("GlobPattern matches character classes", "[glob]") {
+    CHECK(GlobPattern("[abc].cpp").matches("b.cpp"));
+    CHECK_FALSE(GlobPattern("[abc].cpp").matches("d.cpp"));
+    CHECK(GlobPattern("v[0-9].h").matches("v7.h"));
+    CHECK_FALSE(GlobPattern("v[0-9].h").matches("vx.h"));
+    CHECK(GlobPattern("[!_]*.cpp").matches("main.cpp"));
+    CHECK_FALSE(GlobPattern("[!_]*.cpp").matches("_private.cpp"));
+    CHECK_FALSE(GlobPattern("[^_]*.cpp").matches("_private.cpp"));
+    CHECK(GlobPattern("[A-Z]*.h").matches("config.h"));
+    CHECK_FALSE(GlobPattern("[A-Z]*.h", true).matches("config.h"));
+
+    // ']' first in a class is a member; an unterminated '[' is literal
+    CHECK(GlobPattern("[]x]").matches("]"));
+    CHECK(GlobPattern("a[b").matches("a[b"));
+}
+
+TEST_CASE("GlobPattern matches brace sets", "[glob]") {
+    GlobPattern pattern("*.{cpp,cc,cxx}");
+    CHECK(pattern.matches("a.cpp"));
+    CHECK(pattern.matches("a.cc"));
+    CHECK(pattern.matches("a.cxx"));
+    CHECK_FALSE(pattern.matches("a.c"));
+
+    CHECK(GlobPattern("{foo,bar{1,2}}.h").matches("bar2.h"));
+    CHECK_FALSE(GlobPattern("{foo,bar{1,2}}.h").matches("bar3.h"));
+}
+
+TEST_CASE("GlobPattern reports literal patterns", "[glob]") {
+    CHECK(GlobPattern("main.cpp").is_literal());
+    CHECK(GlobPattern("{x}").is_literal());
+    CHECK_FALSE(GlobPattern("*.cpp").is_literal());
+    CHECK_FALSE(GlobPattern("{a,b}.cpp").is_literal());
+}
+
+TEST_CASE("expand_braces expands nested sets in order", "[glob]") {
+    CHECK(expand_braces("a.{h,cpp}") == std::vector<std::string>{"a.h", "a.cpp"});
+    CHECK(expand_braces("{a,b}{1,2}") == std::vector<std::string>{"a1", "a2", "b1", "b2"});
+    CHECK(expand_braces("x{y") == std::vector<std::string>{"x{y"});
+    CHECK(expand_braces("plain") == std::vector<std::string>{"plain"});
+}
+
+TEST_CASE("has_glob_chars detects glob syntax", "[glob]") {
+    CHECK(has_glob_chars("src/*.cpp"));
+    CHECK(has_glob_chars("file?.h"));
+    CHECK(has_glob_chars("v[0-9].h"));
+    CHECK(has_glob_chars("*.{h,cpp}"));
+    CHECK_FALSE(has_glob_chars("src/main.cpp"));
+}
+
+// ============================================================================
+// glob_files
+// ============================================================================
+
+TEST_CASE("glob_files expands a single directory", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+    dir.touch("src/b.CPP");
+    dir.touch("src/c.h");
+    dir.touch("src/sub/d.cpp");
+
+    CHECK(glob_sorted("src/*.cpp", dir.path) == std::vector<std::string>{"src/a.cpp", "src/b.CPP"});
+    CHECK(glob_sorted("src/*.{h,cpp}", dir.path) ==
+          std::vector<std::string>{"src/a.cpp", "src/b.CPP", "src/c.h"});
+    CHECK(glob_sorted("missing/*.cpp", dir.path).empty());
+}
+
+TEST_CASE("glob_files matches ** as zero or more directories", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+    dir.touch("src/x/b.cpp");
+    dir.touch("src/x/y/c.cpp");
+    dir.touch("src/x/y/c.h");
+    dir.touch("other/d.cpp");
+
+    CHECK(glob_sorted("src/**/*.cpp", dir.path) ==
+          std::vector<std::string>{"src/a.cpp", "src/x/b.cpp", "src/x/y/c.cpp"});
+    CHECK(glob_sorted("**/*.h", dir.path) == std::vector<std::string>{"src/x/y/c.h"});
+    CHECK(glob_sorted("src/**", dir.path).size() == 4);
+}
+
+TEST_CASE("glob_files honours components after **", "[glob]") {
+    GlobDir dir;
+    dir.touch("mods/a/include/a.h");
+    dir.touch("mods/a/src/a.cpp");
+    dir.touch("mods/b/deep/include/b.h");
+    dir.touch("mods/b/deep/src/b.h");
+
+    CHECK(glob_sorted("mods/**/include/*.h", dir.path) ==
+          std::vector<std::string>{"mods/a/include/a.h", "mods/b/deep/include/b.h"});
+    CHECK(glob_sorted("mods/*/src/*", dir.path) == std::vector<std::string>{"mods/a/src/a.cpp"});
+}
+
+TEST_CASE("glob_files keeps recursive_directory_iterator order", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+    dir.touch("src/sub/b.cpp");
+    dir.touch("src/sub/deeper/c.cpp");
+    dir.touch("src/z.cpp");
+
+    std::vector<std::string> expected;
+    for (const auto& entry : fs::recursive_directory_iterator(dir.path / "src")) {
+        if (entry.is_regular_file()) {
+            expected.push_back(fs::relative(entry.path(), dir.path).generic_string());
+        }
+    }
+
+    std::vector<std::string> actual;
+    for (const auto& path : glob_files("src/**/*.cpp", dir.path.string())) {
+        actual.push_back(fs::path(path).generic_string());
+    }
+    CHECK(actual == expected);
+}
+
+TEST_CASE("glob_files only lists directories that can match", "[glob]") {
+    GlobDir dir;
+    dir.touch("a/keep/x.cpp");
+    dir.touch("a/skip/x.cpp");
+    dir.touch("b/keep/y.cpp");
+    dir.touch("b/keep/nested/z.cpp");
+
+    std::vector<std::string> listed;
+    GlobOptions options;
+    options.on_directory = [&](const fs::path& path) {
+        listed.push_back(fs::relative(path, dir.path).generic_string());
+    };
+
+    auto result = glob_files("*/keep/*.cpp", dir.path.string(), options);
+    CHECK(result.size() == 2);
+
+    // The top level and both keep/ directories are listed; "skip" and
+    // "nested" are never opened
+    std::sort(listed.begin(), listed.end());
+    CHECK(listed == std::vector<std::string>{".", "a/keep", "b/keep"});
+}
+
+TEST_CASE("glob_files reports missing directories it needed", "[glob]") {
+    GlobDir dir;
+    std::vector<fs::path> listed;
+    GlobOptions options;
+    options.on_directory = [&](const fs::path& path) { listed.push_back(path); };
+
+    CHECK(glob_files("gen/*.cpp", dir.path.string(), options).empty());
+    REQUIRE(listed.size() == 1);
+    CHECK(listed[0] == dir.path / "gen");
+}
+
+TEST_CASE("glob_files returns absolute paths for absolute patterns", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+
+    auto result = glob_files((dir.path / "src" / "*.cpp").string(), "/unrelated");
+    REQUIRE(result.size() == 1);
+    CHECK(fs::path(result[0]) == dir.path / "src" / "a.cpp");
+}
+
+TEST_CASE("glob_files does not report a file twice", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+
+    CHECK(glob_files("src/{*.cpp,a.*}", dir.path.string()).size() == 1);
+    CHECK(glob_files("{src,src}/*.cpp", dir.path.string()).size() == 1);
+}
+
+// ============================================================================
+// DirectoryCache and parallel expansion
+// ============================================================================
+
+TEST_CASE("DirectoryCache reads each directory once", "[glob]") {
+    GlobDir dir;
+    dir.touch("src/a.cpp");
+    dir.touch("src/a.h");
+    dir.touch("src/sub/b.cpp");
+
+    DirectoryCache cache;
+    std::vector<std::string> listed;
+    GlobOptions options;
+    options.cache = &cache;
+    options.on_directory = [&](const fs::path& path) {
+        listed.push_back(fs::relative(path, dir.path).generic_string());
+    };
+
+    CHECK(glob_files("src/**/*.cpp", dir.path.string(), options).size() == 2);
+
+    // A file created after the first walk is not seen: listings are per run
+    dir.touch("src/late.h");
+    CHECK(glob_files("src/**/*.h", dir.path.string(), options).size() == 1);
+
+    cache.clear();
+    CHECK(glob_files("src/**/*.h", dir.path.string(), options).size() == 2);
+    CHECK(listed.size() == 6);
+}
+
+TEST_CASE("DirectoryCache reports missing directories", "[glob]") {
+    GlobDir dir;
+    DirectoryCache cache;
+    auto listing = cache.list(dir.path / "missing");
+    CHECK_FALSE(listing->exists);
+    CHECK(listing->entries.empty());
+    CHECK(cache.list(dir.path)->exists);
+}
+
+TEST_CASE("glob_files gives the same results with parallel reads", "[glob]") {
+    GlobDir dir;
+    for (int m = 0; m < 6; ++m) {
+        for (int d = 0; d < 4; ++d) {
+            for (int f = 0; f < 5; ++f) {
+                dir.touch("src/m" + std::to_string(m) + "/d" + std::to_string(d) + "/f" +
+                          std::to_string(f) + (f % 2 ? ".cpp" : ".h"));
+            }
+        }
+    }
+
+    auto sequential = glob_files("src/**/*.cpp", dir.path.string());
+
+    GlobOptions options;
+    options.jobs = 4;
+    CHECK(glob_files("src/**/*.cpp", dir.path.string(), options) == sequential);
+    CHECK(sequential.size() == 6 * 4 * 2);
+
+    options.jobs = 0;
+    CHECK(glob_files("src/*/d1/**", dir.path.string(), options).size() == 6 * 5);
+}
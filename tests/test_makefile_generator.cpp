@@ -33,7 +33,8 @@ struct MakefileResult {
 };
 
 static MakefileResult generate_makefile(const std::string& buildscript,
-                                        std::vector<std::string> source_files = {"main.cpp"}) {
+                                        std::vector<std::string> source_files = {"main.cpp"},
+                                        bool flat = false) {
     MakefileResult result;
     result.temp_dir = fs::temp_directory_path() / "sighmake_test_makefile";
     std::error_code ec;
@@ -51,6 +52,7 @@ static MakefileResult generate_makefile(const std::string& buildscript,
     result.solution = parser.parse_string(buildscript, result.temp_dir.string());
 
     MakefileGenerator generator;
+    generator.set_flat(flat);
     generator.generate(result.solution, result.temp_dir.string());
 
     // Read the project-specific Makefile (e.g., App.Release), not the master Makefile
@@ -1161,3 +1163,379 @@ target_link_libraries(
     // The dependency archive lives in the ABI-scoped output directory
     CHECK(mk.find("android/$(ANDROID_ABI)/Core.a") != std::string::npos);
 }
+
+TEST_CASE("MakefileGenerator applies per-file compiler settings", "[makefile_generator]") {
+    auto result = generate_makefile(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp, fast.cpp
+fast.cpp:defines = FAST_PATH
+fast.cpp:optimization = MaxSpeed
+)", {"main.cpp", "fast.cpp"});
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("$(CXX) $(CXXFLAGS) -O3 -DFAST_PATH -MMD") != std::string::npos);
+    // Other files keep the target flags only
+    CHECK(result.content.find("$(CXX) $(CXXFLAGS) -MMD") != std::string::npos);
+}
+
+TEST_CASE("MakefileGenerator batches sources into unity translation units", "[makefile_generator]") {
+    auto result = generate_makefile(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = pch.cpp, a.cpp, b.cpp, c.cpp, d.cpp, own.cpp, raw.cpp, util.c, gone.cpp
+unity_build = true
+unity_batch_size = 2
+pch = Use
+pch_header = pch.h
+pch.cpp:pch = Create
+own.cpp:defines = OWN
+raw.cpp:pch = NotUsing
+gone.cpp:exclude = true
+)", {"pch.h", "pch.cpp", "a.cpp", "b.cpp", "c.cpp", "d.cpp", "own.cpp", "raw.cpp", "util.c", "gone.cpp"});
+    REQUIRE(!result.content.empty());
+
+    // Four PCH sources in two batches; the lone C source compiles as itself
+    const fs::path unity_dir = result.temp_dir / "build" / "unity" / "App.Release";
+    CHECK(read_file(unity_dir / "unity_0_cxx.cpp").find("#include \"../../../a.cpp\"\n#include \"../../../b.cpp\"\n") !=
+          std::string::npos);
+    CHECK(read_file(unity_dir / "unity_1_cxx.cpp").find("#include \"../../../d.cpp\"") != std::string::npos);
+    CHECK_FALSE(fs::exists(unity_dir / "unity_2_cxx.cpp"));
+    CHECK_FALSE(fs::exists(unity_dir / "unity_2_c.c"));
+
+    const std::string& content = result.content;
+    CHECK(content.find("Release/obj/App/unity/unity_0_cxx.o: unity/App.Release/unity_0_cxx.cpp $(PCH_OUTPUT)") !=
+          std::string::npos);
+    CHECK(content.find("unity_0_cxx.cpp $(PCH_OUTPUT)\n\t@mkdir -p $(dir $@)\n"
+                       "\t$(SIGHMAKE_COMPILER_LAUNCHER) $(CXX) $(CXXFLAGS) -include ") != std::string::npos);
+
+    // Per-file settings, NotUsing and lone sources keep their own objects
+    CHECK(content.find(": ../own.cpp") != std::string::npos);
+    CHECK(content.find(": ../raw.cpp\n") != std::string::npos);
+    CHECK(content.find(": ../util.c") != std::string::npos);
+    CHECK(content.find(": ../a.cpp") == std::string::npos);
+    CHECK(content.find("gone") == std::string::npos);
+}
+
+TEST_CASE("MakefileGenerator deletes unity translation units it no longer plans", "[makefile_generator]") {
+    const std::string buildscript = R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = a.cpp, b.cpp, c.cpp, d.cpp
+unity_build = true
+)";
+    auto result = generate_makefile(buildscript + "unity_batch_size = 2\n", {"a.cpp", "b.cpp", "c.cpp", "d.cpp"});
+    const fs::path unity_dir = result.temp_dir / "build" / "unity" / "App.Release";
+    REQUIRE(fs::exists(unity_dir / "unity_1_cxx.cpp"));
+    std::ofstream(unity_dir / "notes.txt") << "kept\n";
+
+    auto regenerate = [&](const std::string& script) {
+        BuildscriptParser parser;
+        Solution solution = parser.parse_string(script, result.temp_dir.string());
+        MakefileGenerator generator;
+        generator.generate(solution, result.temp_dir.string());
+    };
+
+    // One batch of four: the second TU is gone
+    regenerate(buildscript + "unity_batch_size = 4\n");
+    CHECK(fs::exists(unity_dir / "unity_0_cxx.cpp"));
+    CHECK_FALSE(fs::exists(unity_dir / "unity_1_cxx.cpp"));
+
+    // No unity build: only files the generator did not write remain
+    std::string plain = buildscript;
+    plain.replace(plain.find("unity_build = true"), 18, "unity_build = false");
+    regenerate(plain);
+    CHECK_FALSE(fs::exists(unity_dir / "unity_0_cxx.cpp"));
+    CHECK(fs::exists(unity_dir / "notes.txt"));
+}
+
+TEST_CASE("MakefileGenerator prefixes compile recipes with the compiler launcher", "[makefile_generator]") {
+    const std::string buildscript = R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+compiler_launcher = ccache
+
+[project:App]
+type = exe
+sources = main.cpp, util.c
+target_link_libraries(Tool)
+
+[project:Tool]
+type = lib
+sources = tool.cpp
+compiler_launcher = none
+)";
+    auto result = generate_makefile(buildscript, {"main.cpp", "util.c", "tool.cpp"});
+    const std::string& app = result.files["App.Release"];
+    CHECK(app.find("\nSIGHMAKE_COMPILER_LAUNCHER = ccache\n") != std::string::npos);
+    CHECK(app.find("\t$(SIGHMAKE_COMPILER_LAUNCHER) $(CXX) $(CXXFLAGS) -MMD") != std::string::npos);
+    CHECK(app.find("\t$(SIGHMAKE_COMPILER_LAUNCHER) $(CC) $(CFLAGS) -MMD") != std::string::npos);
+    // Links run the compiler driver directly
+    CHECK(app.find("\t$(CXX) $(LDFLAGS) -o $@") != std::string::npos);
+
+    // An opted-out project still honours a launcher given on the make command
+    // line, but not one from the environment
+    const std::string& tool = result.files["Tool.Release"];
+    CHECK(tool.find("\nSIGHMAKE_COMPILER_LAUNCHER =\n") != std::string::npos);
+    CHECK(tool.find("\t$(SIGHMAKE_COMPILER_LAUNCHER) $(CXX) $(CXXFLAGS) -MMD") != std::string::npos);
+
+    auto flat = generate_makefile(buildscript, {"main.cpp", "util.c", "tool.cpp"}, true);
+    CHECK(flat.master_content.find("\nSIGHMAKE_COMPILER_LAUNCHER =\n") != std::string::npos);
+    CHECK(flat.master_content.find("App.Release_COMPILER_LAUNCHER = $(or $(SIGHMAKE_COMPILER_LAUNCHER),ccache)") !=
+          std::string::npos);
+    CHECK(flat.master_content.find("\t$(App.Release_COMPILER_LAUNCHER) $(CXX) $(App.Release_CXXFLAGS)") !=
+          std::string::npos);
+    CHECK(flat.master_content.find("\t$(SIGHMAKE_COMPILER_LAUNCHER) $(CXX) $(Tool.Release_CXXFLAGS)") != std::string::npos);
+}
+
+TEST_CASE("MakefileGenerator parallel generation matches serial output", "[makefile_generator]") {
+    const std::string buildscript = R"(
+[solution]
+name = Test
+configurations = Debug, Release
+platforms = Linux
+
+[project:Core]
+type = lib
+sources = core.cpp
+
+[project:Util]
+type = dll
+sources = util.cpp
+
+[project:App]
+type = exe
+sources = main.cpp
+target_link_libraries(Core, Util)
+)";
+    fs::path temp_dir = fs::temp_directory_path() / "sighmake_test_makefile_jobs";
+    std::error_code ec;
+    fs::remove_all(temp_dir, ec);
+    fs::create_directories(temp_dir);
+    for (const char* source : {"core.cpp", "util.cpp", "main.cpp"}) {
+        std::ofstream(temp_dir / source) << "int f() { return 0; }";
+    }
+
+    BuildscriptParser parser;
+    Solution solution = parser.parse_string(buildscript, temp_dir.string());
+
+    std::map<std::string, std::string> outputs[2];
+    const int job_counts[2] = {1, 4};
+    for (int run = 0; run < 2; ++run) {
+        fs::path out_dir = temp_dir / ("out" + std::to_string(run));
+        MakefileGenerator generator;
+        generator.set_jobs(job_counts[run]);
+        REQUIRE(generator.generate(solution, out_dir.string()));
+        for (auto& entry : fs::directory_iterator(out_dir / "build")) {
+            outputs[run][entry.path().filename().string()] = read_file(entry.path());
+        }
+    }
+
+    CHECK(outputs[0].size() == 7);  // 3 projects x 2 configs + master Makefile
+    CHECK(outputs[0] == outputs[1]);
+    fs::remove_all(temp_dir, ec);
+}
+
+// ============================================================================
+// Flat (non-recursive) Makefile
+// ============================================================================
+
+TEST_CASE("MakefileGenerator flat mode writes a single Makefile", "[makefile_generator]") {
+    auto result = generate_makefile(R"(
+[solution]
+name = Test
+configurations = Debug, Release
+platforms = Linux
+
+[project:Core]
+type = lib
+sources = core.cpp
+
+[project:App]
+type = exe
+sources = main.cpp
+target_link_libraries(Core)
+)", {"main.cpp", "core.cpp"}, true);
+    REQUIRE(!result.master_content.empty());
+    CHECK(result.files.size() == 1);
+    CHECK(result.master_content.find("$(MAKE)") == std::string::npos);
+
+    // Every target lives in the one Makefile with prefixed variables
+    CHECK(result.master_content.find("Core.Debug_CXXFLAGS = ") != std::string::npos);
+    CHECK(result.master_content.find("App.Release_OBJS =") != std::string::npos);
+    CHECK(result.master_content.find("Debug: Core.Debug App.Debug") != std::string::npos);
+    CHECK(result.master_content.find("-include $(App.Debug_OBJS:.o=.d)") != std::string::npos);
+}
+
+TEST_CASE("MakefileGenerator flat mode orders links after referenced projects", "[makefile_generator]") {
+    auto result = generate_makefile(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:Core]
+type = lib
+sources = core.cpp
+
+[project:App]
+type = exe
+sources = main.cpp
+target_link_libraries(Core)
+)", {"main.cpp", "core.cpp"}, true);
+    REQUIRE(!result.master_content.empty());
+    // Archives are real prerequisites of the link; compiles are not ordered
+    CHECK(result.master_content.find(
+        "$(App.Release_TARGET): $(App.Release_OBJS) $(App.Release_PROJECT_DEPS) | Core.Release")
+        != std::string::npos);
+    CHECK(result.master_content.find("$(App.Release_OBJS): |") == std::string::npos);
+}
+
+TEST_CASE("MakefileGenerator flat mode keeps pre-build events per target", "[makefile_generator]") {
+    auto result = generate_makefile(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+prebuild = echo pre
+)", {"main.cpp"}, true);
+    REQUIRE(!result.master_content.empty());
+    CHECK(result.master_content.find("App.Release.prebuild:\n\techo pre") != std::string::npos);
+    CHECK(result.master_content.find("$(App.Release_OBJS): | App.Release.prebuild") != std::string::npos);
+}
+
+// ============================================================================
+// Write-if-changed regeneration
+// ============================================================================
+
+TEST_CASE("MakefileGenerator regeneration only rewrites changed makefiles", "[makefile_generator]") {
+    const std::string buildscript = R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:Core]
+type = lib
+sources = core.cpp
+
+[project:App]
+type = exe
+sources = main.cpp
+target_link_libraries(Core)
+)";
+    fs::path temp_dir = fs::temp_directory_path() / "sighmake_test_makefile_unchanged";
+    std::error_code ec;
+    fs::remove_all(temp_dir, ec);
+    fs::create_directories(temp_dir);
+    for (const char* source : {"core.cpp", "main.cpp"}) {
+        std::ofstream(temp_dir / source) << "int f() { return 0; }";
+    }
+
+    BuildscriptParser parser;
+    Solution solution = parser.parse_string(buildscript, temp_dir.string());
+    {
+        MakefileGenerator generator;
+        REQUIRE(generator.generate(solution, temp_dir.string()));
+    }
+
+    // Backdate every output so a rewrite is visible regardless of clock resolution
+    const auto old_time = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    const fs::path build_dir = temp_dir / "build";
+    for (const char* name : {"Makefile", "Core.Release", "App.Release"}) {
+        fs::last_write_time(build_dir / name, old_time);
+    }
+
+    // Only App's flags change
+    for (auto& project : solution.projects) {
+        if (project.name == "App") {
+            project.configurations["Release|Linux"].cl_compile.preprocessor_definitions.push_back("APP_ONLY");
+        }
+    }
+    {
+        MakefileGenerator generator;
+        REQUIRE(generator.generate(solution, temp_dir.string()));
+    }
+
+    CHECK(fs::last_write_time(build_dir / "Makefile") == old_time);
+    CHECK(fs::last_write_time(build_dir / "Core.Release") == old_time);
+    CHECK(fs::last_write_time(build_dir / "App.Release") != old_time);
+    CHECK(read_file(build_dir / "App.Release").find("-DAPP_ONLY") != std::string::npos);
+    fs::remove_all(temp_dir, ec);
+}
+
+// ============================================================================
+// Self-regeneration rule
+// ============================================================================
+
+TEST_CASE("MakefileGenerator emits a regeneration rule for recorded inputs", "[makefile_generator]") {
+    fs::path temp_dir = fs::temp_directory_path() / "sighmake_test_makefile_regen";
+    std::error_code ec;
+    fs::remove_all(temp_dir, ec);
+    fs::create_directories(temp_dir / "src");
+    std::ofstream(temp_dir / "src" / "main.cpp") << "int main() { return 0; }";
+    std::ofstream(temp_dir / "app.buildscript") << R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = src/*.cpp
+)";
+
+    BuildscriptParser parser;
+    Solution solution = parser.parse((temp_dir / "app.buildscript").string());
+
+    SECTION("recursive and flat Makefiles re-run the command") {
+        for (bool flat : {false, true}) {
+            MakefileGenerator generator;
+            generator.set_flat(flat);
+            generator.set_regenerate_command({"/opt/bin/sighmake", "app.buildscript", "-D", "X=$Y"},
+                                             temp_dir.string());
+            REQUIRE(generator.generate(solution, temp_dir.string()));
+
+            std::string content = read_file(temp_dir / "build" / "Makefile");
+            CHECK(content.find("SIGHMAKE_INPUTS :=") != std::string::npos);
+            CHECK(content.find("app.buildscript \\\n") != std::string::npos);
+            CHECK(content.find("/src\n") != std::string::npos);
+            CHECK(content.find("Makefile: .sighmake.stamp ;") != std::string::npos);
+            CHECK(content.find(".sighmake.stamp: $(SIGHMAKE_INPUTS)") != std::string::npos);
+            CHECK(content.find("'/opt/bin/sighmake' 'app.buildscript' '-D' 'X=$$Y'") != std::string::npos);
+            CHECK(fs::exists(temp_dir / "build" / MakefileGenerator::REGENERATE_STAMP));
+
+            // The default goal stays the build, not the regeneration rule
+            CHECK(content.find("all:") < content.find("Makefile: .sighmake.stamp"));
+        }
+    }
+
+    SECTION("no rule without a command") {
+        MakefileGenerator generator;
+        REQUIRE(generator.generate(solution, temp_dir.string()));
+        std::string content = read_file(temp_dir / "build" / "Makefile");
+        CHECK(content.find("SIGHMAKE_INPUTS") == std::string::npos);
+    }
+
+    fs::remove_all(temp_dir, ec);
+}
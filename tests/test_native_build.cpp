@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/native_build.hpp"
+#include "common/work_stealing_pool.hpp"
+
+#include <atomic>
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// RAII temp build directory
+struct NativeBuildDir {
+    fs::path path;
+
+    explicit NativeBuildDir(const std::string& name) {
+        path = fs::temp_directory_path() / name;
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path);
+    }
+    ~NativeBuildDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    void write(const std::string& file, const std::string& content) const {
+        std::ofstream out(path / file, std::ios::binary);
+        out << content;
+    }
+
+    std::string read(const std::string& file) const {
+        std::ifstream in(path / file);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    // Moves every file an hour into the past, so a file written afterwards
+    // is newer than all outputs regardless of timestamp granularity
+    void backdate_all() const {
+        const auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+        for (const auto& entry : fs::recursive_directory_iterator(path)) {
+            if (entry.is_regular_file()) fs::last_write_time(entry.path(), past);
+        }
+    }
+};
+
+struct NativeRun {
+    int exit_code = 0;
+    std::string output;
+};
+
+static NativeRun build(const NativeBuildDir& dir, std::vector<std::string> targets = {}, int jobs = 2) {
+    std::ostringstream out;
+    std::ostringstream err;
+    NativeBuildOptions options;
+    options.jobs = jobs;
+    options.out = &out;
+    options.err = &err;
+    NativeRun run;
+    run.exit_code = run_native_build(dir.path.string(), targets, options);
+    run.output = out.str() + err.str();
+    return run;
+}
+
+static size_t count_of(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE("Ninja manifest parses rules, builds and variables", "[native_build]") {
+    auto manifest = NinjaManifest::parse(
+        "# comment\n"
+        "tool = cc\n"
+        "flags = -O2 $\n"
+        "    -g\n"
+        "rule compile\n"
+        "  command = $tool $flags $extra -c $in -o $out\n"
+        "  description = CC $out\n"
+        "build obj/a$ b.o: compile src/a.c | gen.h || dir\n"
+        "  extra = -DX\n"
+        "build all: phony obj/a$ b.o\n"
+        "default all\n");
+
+    REQUIRE(manifest.edges().size() == 2);
+    const auto& edge = manifest.edges()[0];
+    CHECK(edge.outputs == std::vector<std::string>{"obj/a b.o"});
+    CHECK(edge.inputs == std::vector<std::string>{"src/a.c", "gen.h", "dir"});
+    CHECK(edge.implicit_begin == 1);
+    CHECK(edge.order_only_begin == 2);
+    CHECK(manifest.evaluate(edge, "command") == "cc -O2 -g -DX -c src/a.c -o 'obj/a b.o'");
+    CHECK(manifest.evaluate(edge, "description") == "CC 'obj/a b.o'");
+    CHECK(manifest.producer("obj/a b.o") == 0);
+    CHECK(manifest.producer("src/a.c") == NinjaManifest::npos);
+    CHECK(manifest.edges()[1].rule == "phony");
+    CHECK(manifest.defaults() == std::vector<std::string>{"all"});
+}
+
+TEST_CASE("Ninja manifest rejects what the executor cannot run", "[native_build]") {
+    CHECK_THROWS_WITH(NinjaManifest::parse("include other.ninja\n"), Catch::Matchers::ContainsSubstring(":1:"));
+    CHECK_THROWS(NinjaManifest::parse("build a: missing b\n"));
+    CHECK_THROWS(NinjaManifest::parse("rule r\n  command = x\nbuild a: r\nbuild a: r\n"));
+}
+
+TEST_CASE("Depfiles list the first rule's inputs", "[native_build]") {
+    NativeBuildDir dir("sighmake_test_depfile");
+    dir.write("a.o.d",
+              "obj/a.o: src/a.cpp include/my\\ header.h \\\n"
+              "  /usr/include/stdio.h\n"
+              "include/my\\ header.h:\n"
+              "/usr/include/stdio.h:\n");
+
+    CHECK(read_depfile((dir.path / "a.o.d").string()) ==
+          std::vector<std::string>{"src/a.cpp", "include/my header.h", "/usr/include/stdio.h"});
+    CHECK(read_depfile((dir.path / "missing.d").string()).empty());
+}
+
+#ifndef _WIN32
+// cat stands in for the compiler; the depfile names the "header" it read
+static const char* kCatManifest =
+    "rule cat\n"
+    "  command = cat $in header.txt > $out && printf '%s: %s header.txt\\n' $out $in > $out.d\n"
+    "  depfile = $out.d\n"
+    "  description = CAT $out\n"
+    "rule join\n"
+    "  command = cat $in > $out\n"
+    "  description = JOIN $out\n"
+    "build out/a.txt: cat a.src\n"
+    "build out/b.txt: cat b.src\n"
+    "build out/all.txt: join out/a.txt out/b.txt\n"
+    "build all: phony out/all.txt\n"
+    "default all\n";
+
+TEST_CASE("Native executor builds and then has nothing to do", "[native_build]") {
+    NativeBuildDir dir("sighmake_test_native_build");
+    dir.write("build.ninja", kCatManifest);
+    dir.write("a.src", "a\n");
+    dir.write("b.src", "b\n");
+    dir.write("header.txt", "h\n");
+
+    auto first = build(dir);
+    REQUIRE(first.exit_code == 0);
+    CHECK(dir.read("out/all.txt") == "a\nh\nb\nh\n");
+    CHECK(count_of(first.output, "CAT ") == 2);
+    CHECK(count_of(first.output, "JOIN out/all.txt") == 1);
+
+    auto second = build(dir);
+    CHECK(second.exit_code == 0);
+    CHECK(second.output.find("no work to do") != std::string::npos);
+
+    // A header recorded in the depfile rebuilds both objects and the join
+    dir.backdate_all();
+    dir.write("header.txt", "h\n");
+    auto third = build(dir);
+    CHECK(count_of(third.output, "CAT ") == 2);
+    CHECK(count_of(third.output, "JOIN ") == 1);
+
+    // Only the changed source and what depends on it
+    dir.backdate_all();
+    dir.write("b.src", "b2\n");
+    auto fourth = build(dir);
+    CHECK(fourth.output.find("CAT out/b.txt") != std::string::npos);
+    CHECK(fourth.output.find("CAT out/a.txt") == std::string::npos);
+    CHECK(dir.read("out/all.txt") == "a\nh\nb2\nh\n");
+}
+
+TEST_CASE("Native executor rebuilds when a command changes", "[native_build]") {
+    NativeBuildDir dir("sighmake_test_native_command");
+    dir.write("build.ninja", "rule gen\n  command = echo $msg > $out\nbuild out.txt: gen\n  msg = one\n");
+    REQUIRE(build(dir).exit_code == 0);
+    CHECK(dir.read("out.txt") == "one\n");
+
+    dir.write("build.ninja", "rule gen\n  command = echo $msg > $out\nbuild out.txt: gen\n  msg = two\n");
+    auto run = build(dir, {"out.txt"});
+    CHECK(run.exit_code == 0);
+    CHECK(dir.read("out.txt") == "two\n");
+}
+
+TEST_CASE("Native executor stops after a failing command", "[native_build]") {
+    NativeBuildDir dir("sighmake_test_native_failure");
+    dir.write("build.ninja",
+              "rule run\n  command = $cmd\n"
+              "build bad: run\n  cmd = echo broken && exit 3\n"
+              "build after: run bad\n  cmd = touch after\n");
+
+    auto run = build(dir, {"after"}, 4);
+    CHECK(run.exit_code == 1);
+    CHECK(run.output.find("FAILED: bad") != std::string::npos);
+    CHECK(run.output.find("broken") != std::string::npos);
+    CHECK_FALSE(fs::exists(dir.path / "after"));
+}
+
+TEST_CASE("Native executor reports unknown targets and missing inputs", "[native_build]") {
+    NativeBuildDir dir("sighmake_test_native_missing");
+    dir.write("build.ninja", "rule copy\n  command = cp $in $out\nbuild out: copy in\n");
+
+    CHECK(build(dir, {"nothing"}).exit_code == 1);
+    auto run = build(dir, {"out"});
+    CHECK(run.exit_code == 1);
+    CHECK(run.output.find("'in' is missing") != std::string::npos);
+}
+#endif
+
+TEST_CASE("Work-stealing pool runs tasks submitted by tasks", "[native_build]") {
+    WorkStealingPool pool(4);
+    std::atomic<int> count{0};
+    std::function<void(int)> spawn = [&](int depth) {
+        count.fetch_add(1);
+        if (depth < 6) {
+            pool.submit([&, depth] { spawn(depth + 1); });
+            pool.submit([&, depth] { spawn(depth + 1); });
+        }
+    };
+    pool.submit([&] { spawn(0); });
+    pool.wait();
+    CHECK(count.load() == 127);
+
+    // The pool is reusable after wait(), and rethrows a task's exception
+    pool.submit([] { throw std::runtime_error("task failed"); });
+    CHECK_THROWS_WITH(pool.wait(), "task failed");
+}
@@ -0,0 +1,236 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "parsers/buildscript_parser.hpp"
+#include "generators/ninja_generator.hpp"
+#include "common/build_cache.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Helper to read file content
+static std::string read_file(const fs::path& path) {
+    std::ifstream f(path);
+    return std::string((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+}
+
+// Helper to generate build.ninja and return its content
+struct NinjaResult {
+    fs::path temp_dir;
+    std::string content;
+    Solution solution;
+
+    ~NinjaResult() {
+        std::error_code ec;
+        fs::remove_all(temp_dir, ec);
+    }
+};
+
+static NinjaResult generate_ninja(const std::string& buildscript,
+                                  std::vector<std::string> source_files = {"main.cpp"}) {
+    NinjaResult result;
+    result.temp_dir = fs::temp_directory_path() / "sighmake_test_ninja";
+    std::error_code ec;
+    fs::remove_all(result.temp_dir, ec);
+    fs::create_directories(result.temp_dir);
+
+    // Create dummy source files so source paths resolve.
+    for (const auto& source : source_files) {
+        fs::path source_path = result.temp_dir / source;
+        fs::create_directories(source_path.parent_path());
+        std::ofstream(source_path) << "int main() { return 0; }";
+    }
+
+    BuildscriptParser parser;
+    result.solution = parser.parse_string(buildscript, result.temp_dir.string());
+
+    NinjaGenerator generator;
+    generator.generate(result.solution, result.temp_dir.string());
+
+    auto ninja_path = result.temp_dir / "build" / NinjaGenerator::NINJA_FILENAME;
+    if (fs::exists(ninja_path)) {
+        result.content = read_file(ninja_path);
+    }
+
+    return result;
+}
+
+// ============================================================================
+// Basic build.ninja generation
+// ============================================================================
+
+TEST_CASE("NinjaGenerator name and description", "[ninja_generator]") {
+    NinjaGenerator gen;
+    CHECK(gen.name() == "ninja");
+    CHECK(!gen.description().empty());
+}
+
+TEST_CASE("NinjaGenerator writes a single build.ninja with rules", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Debug, Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+std = 17
+)");
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("rule cxx\n") != std::string::npos);
+    CHECK(result.content.find("deps = gcc") != std::string::npos);
+    CHECK(result.content.find("rule link\n") != std::string::npos);
+    CHECK(result.content.find("-std=c++17") != std::string::npos);
+    CHECK(result.content.find("build App.Debug: phony") != std::string::npos);
+    CHECK(result.content.find("build App.Release: phony") != std::string::npos);
+    CHECK(result.content.find("build Release: phony App.Release") != std::string::npos);
+    CHECK(result.content.find("build all: phony Debug") != std::string::npos);
+    CHECK(result.content.find("default all") != std::string::npos);
+
+    // No per-project makefiles are produced
+    CHECK(!fs::exists(result.temp_dir / "build" / "Makefile"));
+}
+
+TEST_CASE("NinjaGenerator writes build cache for --build", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+)");
+    auto cache = BuildCache::read(result.temp_dir.string());
+    REQUIRE(cache.has_value());
+    CHECK(cache->generator == "ninja");
+    CHECK(cache->build_dir == "build");
+}
+
+TEST_CASE("NinjaGenerator uses the same flags as the makefile generator", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+defines = MY_FLAG
+optimization[Release|Linux] = MaxSpeed
+)");
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("cxxflags_App_Release = ") != std::string::npos);
+    CHECK(result.content.find("-DMY_FLAG") != std::string::npos);
+    CHECK(result.content.find("-O3") != std::string::npos);
+    CHECK(result.content.find("cxxflags = $cxxflags_App_Release") != std::string::npos);
+}
+
+TEST_CASE("NinjaGenerator prefixes compile edges with the compiler launcher", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+compiler_launcher = ccache
+
+[project:App]
+type = exe
+sources = main.cpp
+
+[project:Tool]
+type = exe
+sources = tool.cpp
+compiler_launcher = none
+)", {"main.cpp", "tool.cpp"});
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("command = $launcher$cxx ") != std::string::npos);
+    CHECK(result.content.find("launcher_App_Release = ccache$ \n") != std::string::npos);
+    CHECK(result.content.find("launcher = $launcher_App_Release") != std::string::npos);
+    CHECK(result.content.find("launcher_Tool_Release") == std::string::npos);
+}
+
+TEST_CASE("NinjaGenerator links against dependent static libraries", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:Core]
+type = lib
+sources = core.cpp
+
+[project:App]
+type = exe
+sources = main.cpp
+target_link_libraries(Core)
+)", {"main.cpp", "core.cpp"});
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find(": archive ") != std::string::npos);
+    CHECK(result.content.find("restat = 1") != std::string::npos);
+
+    // The App link edge has Core's archive as an implicit input and waits for Core
+    auto link_pos = result.content.find(": link ");
+    REQUIRE(link_pos != std::string::npos);
+    auto line_end = result.content.find('\n', link_pos);
+    std::string link_line = result.content.substr(link_pos, line_end - link_pos);
+    CHECK(link_line.find("Core.a") != std::string::npos);
+    CHECK(link_line.find("|| Core.Release") != std::string::npos);
+}
+
+TEST_CASE("NinjaGenerator escapes paths and dollar signs", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = my file.cpp
+postbuild = echo $HOME
+)", {"my file.cpp"});
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("my$ file.cpp") != std::string::npos);
+    CHECK(result.content.find("echo $$HOME") != std::string::npos);
+}
+
+TEST_CASE("NinjaGenerator joins multi-line build events into one command", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Release
+platforms = Linux
+
+[project:App]
+type = exe
+sources = main.cpp
+postbuild = """
+echo one
+echo two
+"""
+)");
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("echo one && echo two") != std::string::npos);
+    CHECK(result.content.find("\necho two") == std::string::npos);
+}
+
+TEST_CASE("NinjaGenerator skips Windows-only solutions", "[ninja_generator]") {
+    auto result = generate_ninja(R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = main.cpp
+)");
+    REQUIRE(!result.content.empty());
+    CHECK(result.content.find("build all: phony\n") != std::string::npos);
+    CHECK(result.content.find("rule cxx") == std::string::npos);
+}
@@ -0,0 +1,170 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/object_cache.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// RAII temp directory holding a tiny C project and its cache
+struct ObjectCacheDir {
+    fs::path path;
+
+    explicit ObjectCacheDir(const std::string& name) {
+        path = fs::temp_directory_path() / name;
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path / "obj");
+    }
+    ~ObjectCacheDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    void write(const std::string& file, const std::string& content) const {
+        std::ofstream out(path / file, std::ios::binary);
+        out << content;
+    }
+
+    std::string read(const std::string& file) const {
+        std::ifstream in(path / file, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+};
+
+TEST_CASE("Cacheable compiles are plain -c commands", "[object_cache]") {
+    auto compile = parse_cacheable_compile("g++ -std=c++17 -I'inc dir' -DNAME=\\\"x\\\" -MMD -MP -c -o obj/a.o src/a.cpp");
+    REQUIRE(compile);
+    CHECK(compile->source == "src/a.cpp");
+    CHECK(compile->output == "obj/a.o");
+    CHECK(compile->depfile == "obj/a.d");
+    CHECK(compile->words[2] == "-Iinc dir");
+    CHECK(compile->words[3] == "-DNAME=\"x\"");
+
+    auto ninja = parse_cacheable_compile("clang -O2 -MMD -MF obj/b.o.d -c -o obj/b.o b.c");
+    REQUIRE(ninja);
+    CHECK(ninja->depfile == "obj/b.o.d");
+    CHECK(parse_cacheable_compile("gcc -c -o a.o a.c")->depfile.empty());
+
+    CHECK_FALSE(parse_cacheable_compile("g++ -o app a.o b.o"));                           // Link
+    CHECK_FALSE(parse_cacheable_compile("g++ -x c++-header -c -o pch.h.gch pch.h"));       // PCH
+    CHECK_FALSE(parse_cacheable_compile("mkdir -p obj && g++ -c -o obj/a.o a.cpp"));      // Shell syntax
+    CHECK_FALSE(parse_cacheable_compile("g++ -c -o a.o a.cpp > log.txt"));
+    CHECK_FALSE(parse_cacheable_compile("g++ -c -o a.o -DV=$(VERSION) a.cpp"));
+    CHECK_FALSE(parse_cacheable_compile("g++ --coverage -c -o a.o a.cpp"));
+    CHECK_FALSE(parse_cacheable_compile("g++ -c a.cpp b.cpp"));
+    CHECK_FALSE(parse_cacheable_compile("nasm -f elf64 -c -o a.o a.asm"));
+}
+
+TEST_CASE("Cache sizes accept K, M, G and T suffixes", "[object_cache]") {
+    CHECK(ObjectCache::parse_size("4096") == 4096u);
+    CHECK(ObjectCache::parse_size("64K") == 64u << 10);
+    CHECK(ObjectCache::parse_size("500M") == 500ull << 20);
+    CHECK(ObjectCache::parse_size("5GB") == 5ull << 30);
+    CHECK(ObjectCache::parse_size("1t") == 1ull << 40);
+    CHECK_FALSE(ObjectCache::parse_size(""));
+    CHECK_FALSE(ObjectCache::parse_size("G"));
+    CHECK_FALSE(ObjectCache::parse_size("5X"));
+}
+
+#ifndef _WIN32
+TEST_CASE("Object cache serves unchanged sources and misses changed ones", "[object_cache]") {
+    ObjectCacheDir dir("sighmake_test_object_cache");
+    dir.write("a.h", "#define VALUE 1\n");
+    dir.write("a.c", "#include \"a.h\"\nint value(void) { return VALUE; }\n");
+    ObjectCache cache((dir.path / "cache").string());
+
+    auto compile = parse_cacheable_compile("cc -O0 -MMD -MP -c -o obj/a.o a.c");
+    REQUIRE(compile);
+    std::string output;
+    REQUIRE(cache.compile(*compile, dir.path.string(), output) == 0);
+    const std::string object = dir.read("obj/a.o");
+    REQUIRE_FALSE(object.empty());
+    CHECK(cache.stats().misses == 1);
+    CHECK(cache.stats().bytes > 0);
+
+    // Same source and flags, different object name: a hit with its own depfile
+    fs::remove(dir.path / "obj/a.o");
+    auto renamed = parse_cacheable_compile("cc -O0 -MMD -MP -c -o obj/renamed.o a.c");
+    REQUIRE(cache.compile(*renamed, dir.path.string(), output) == 0);
+    CHECK(cache.stats().hits == 1);
+    CHECK(dir.read("obj/renamed.o") == object);
+    CHECK(dir.read("obj/renamed.d").rfind("obj/renamed.o: a.c a.h", 0) == 0);
+
+    // A header change reaches the key through the preprocessed source
+    dir.write("a.h", "#define VALUE 2\n");
+    REQUIRE(cache.compile(*compile, dir.path.string(), output) == 0);
+    CHECK(cache.stats().misses == 2);
+
+    // So do the flags
+    auto optimized = parse_cacheable_compile("cc -O2 -MMD -MP -c -o obj/a.o a.c");
+    REQUIRE(cache.compile(*optimized, dir.path.string(), output) == 0);
+    CHECK(cache.stats().misses == 3);
+    CHECK(cache.stats().hits == 1);
+}
+
+TEST_CASE("Object cache replays warnings and does not store failures", "[object_cache]") {
+    ObjectCacheDir dir("sighmake_test_object_cache_output");
+    dir.write("warn.c", "#warning cached warning\nint x;\n");
+    dir.write("bad.c", "int x = ;\n");
+    ObjectCache cache((dir.path / "cache").string());
+
+    auto warn = parse_cacheable_compile("cc -c -o obj/warn.o warn.c");
+    std::string first;
+    REQUIRE(cache.compile(*warn, dir.path.string(), first) == 0);
+    std::string second;
+    REQUIRE(cache.compile(*warn, dir.path.string(), second) == 0);
+    CHECK(cache.stats().hits == 1);
+    CHECK_THAT(second, Catch::Matchers::ContainsSubstring("cached warning"));
+
+    auto bad = parse_cacheable_compile("cc -c -o obj/bad.o bad.c");
+    std::string error;
+    CHECK(cache.compile(*bad, dir.path.string(), error) != 0);
+    CHECK(cache.compile(*bad, dir.path.string(), error) != 0);
+    CHECK(cache.stats().hits == 1);
+    CHECK(cache.stats().misses == 3);
+}
+
+TEST_CASE("Object cache evicts least recently used entries", "[object_cache]") {
+    ObjectCacheDir dir("sighmake_test_object_cache_evict");
+    for (int i = 0; i < 4; ++i) {
+        dir.write("s" + std::to_string(i) + ".c", "int f" + std::to_string(i) + "(void) { return " +
+                                                    std::to_string(i) + "; }\n");
+    }
+    ObjectCache probe((dir.path / "probe").string());
+    std::string output;
+    REQUIRE(probe.compile(*parse_cacheable_compile("cc -c -o obj/p.o s0.c"), dir.path.string(), output) == 0);
+    const uint64_t entry_size = probe.stats().bytes;
+
+    // Room for a little over two entries
+    ObjectCache cache((dir.path / "cache").string(), entry_size * 5 / 2);
+    auto command = [](int i) {
+        return *parse_cacheable_compile("cc -c -o obj/s" + std::to_string(i) + ".o s" + std::to_string(i) + ".c");
+    };
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(cache.compile(command(i), dir.path.string(), output) == 0);
+        // Age every entry so each one is clearly older than the next
+        for (const auto& entry : fs::recursive_directory_iterator(dir.path / "cache")) {
+            if (entry.path().extension() == ".o") {
+                fs::last_write_time(entry.path(), fs::last_write_time(entry.path()) - std::chrono::seconds(10));
+            }
+        }
+    }
+
+    const ObjectCacheStats stats = cache.stats();
+    CHECK(stats.evictions >= 2);
+    CHECK(stats.bytes <= entry_size * 5 / 2);
+
+    // The newest entry survived, the oldest did not
+    const uint64_t hits = stats.hits;
+    REQUIRE(cache.compile(command(3), dir.path.string(), output) == 0);
+    CHECK(cache.stats().hits == hits + 1);
+    REQUIRE(cache.compile(command(0), dir.path.string(), output) == 0);
+    CHECK(cache.stats().hits == hits + 1);
+}
+
+TEST_CASE("Recipe commands fall back to the shell without a cache", "[object_cache]") {
+    ::unsetenv(CACHE_DIR_ENV);
+    CHECK(run_recipe_command("exit 3") == 3);
+    CHECK(run_recipe_command("true") == 0);
+}
+#endif
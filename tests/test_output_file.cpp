@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/output_file.hpp"
+
+#include <chrono>
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Helper to read file content
+static std::string read_file(const fs::path& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(f)),
+                        std::istreambuf_iterator<char>());
+}
+
+// RAII temp dir for output file tests
+struct OutputDir {
+    fs::path path;
+
+    OutputDir() {
+        path = fs::temp_directory_path() / "sighmake_test_output_file";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path);
+    }
+
+    ~OutputDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+// ============================================================================
+// write_file_if_changed
+// ============================================================================
+
+TEST_CASE("write_file_if_changed creates missing files", "[output_file]") {
+    OutputDir dir;
+    fs::path file = dir.path / "out.txt";
+
+    CHECK(write_file_if_changed(file, "hello\n") == WriteResult::Written);
+    CHECK(read_file(file) == "hello\n");
+}
+
+TEST_CASE("write_file_if_changed leaves identical files untouched", "[output_file]") {
+    OutputDir dir;
+    fs::path file = dir.path / "out.txt";
+    REQUIRE(write_file_if_changed(file, "same\n") == WriteResult::Written);
+
+    const auto old_time = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    fs::last_write_time(file, old_time);
+
+    CHECK(write_file_if_changed(file, "same\n") == WriteResult::Unchanged);
+    CHECK(fs::last_write_time(file) == old_time);
+}
+
+TEST_CASE("write_file_if_changed rewrites files whose content differs", "[output_file]") {
+    OutputDir dir;
+    fs::path file = dir.path / "out.txt";
+    REQUIRE(write_file_if_changed(file, "before\n") == WriteResult::Written);
+
+    // Same length, different bytes
+    CHECK(write_file_if_changed(file, "after!\n") == WriteResult::Written);
+    CHECK(read_file(file) == "after!\n");
+
+    // Existing file is a prefix of the new content, and vice versa
+    CHECK(write_file_if_changed(file, "after!\nmore\n") == WriteResult::Written);
+    CHECK(write_file_if_changed(file, "after!\n") == WriteResult::Written);
+    CHECK(read_file(file) == "after!\n");
+}
+
+TEST_CASE("write_file_if_changed compares binary content exactly", "[output_file]") {
+    OutputDir dir;
+    fs::path file = dir.path / "out.xml";
+    const std::string content = "\xEF\xBB\xBF<a>\r\n</a>\r\n";
+
+    CHECK(write_file_if_changed(file, content, true) == WriteResult::Written);
+    CHECK(read_file(file) == content);
+    CHECK(write_file_if_changed(file, content, true) == WriteResult::Unchanged);
+}
+
+TEST_CASE("write_file_if_changed reports unwritable paths", "[output_file]") {
+    OutputDir dir;
+    CHECK(write_file_if_changed(dir.path / "missing" / "out.txt", "x") == WriteResult::Failed);
+}
+
+TEST_CASE("output_stats counts written and unchanged files", "[output_file]") {
+    OutputDir dir;
+    reset_output_stats();
+
+    write_file_if_changed(dir.path / "a.txt", "a");
+    write_file_if_changed(dir.path / "b.txt", "b");
+    write_file_if_changed(dir.path / "a.txt", "a");
+
+    auto stats = output_stats();
+    CHECK(stats.written == 2);
+    CHECK(stats.unchanged == 1);
+
+    reset_output_stats();
+    stats = output_stats();
+    CHECK(stats.written == 0);
+    CHECK(stats.unchanged == 0);
+}
+
+// ============================================================================
+// OutputFile
+// ============================================================================
+
+TEST_CASE("OutputFile writes nothing until commit", "[output_file]") {
+    OutputDir dir;
+    fs::path file = dir.path / "Makefile";
+
+    OutputFile out(file);
+    out << "all:\n";
+    CHECK_FALSE(fs::exists(file));
+
+    REQUIRE(out.commit());
+    CHECK(out.result() == WriteResult::Written);
+    CHECK(read_file(file) == "all:\n");
+
+    OutputFile again(file);
+    again << "all:\n";
+    REQUIRE(again.commit());
+    CHECK(again.result() == WriteResult::Unchanged);
+}
+
+TEST_CASE("OutputFile commit fails for unwritable paths", "[output_file]") {
+    OutputDir dir;
+    OutputFile out(dir.path / "missing" / "Makefile");
+    out << "all:\n";
+    CHECK_FALSE(out.commit());
+    CHECK(out.result() == WriteResult::Failed);
+}
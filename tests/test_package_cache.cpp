@@ -0,0 +1,286 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/package_cache.hpp"
+#include "parsers/buildscript_parser.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// RAII temp dir for package cache tests
+struct PackageCacheDir {
+    fs::path path;
+
+    PackageCacheDir() {
+        path = fs::temp_directory_path() / "sighmake_test_package_cache";
+        std::error_code ec;
+        fs::remove_all(path, ec);
+        fs::create_directories(path / "sdk" / "include");
+    }
+
+    ~PackageCacheDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+// Finder in the style of the real ones: an environment variable, then a
+// header under a fixed path
+static PackageFindResult find_fake_sdk(PackageProbe& probe, const fs::path& sdk, int& probes) {
+    ++probes;
+    PackageFindResult result;
+    probe.env("SIGHMAKE_TEST_FAKE_SDK");
+    if (probe.exists(sdk / "include" / "fake.h")) {
+        result.found = true;
+        result.include_dirs = (sdk / "include").string();
+        result.libraries = "fake";
+        result.version = "1.2";
+    } else {
+        result.error_message = "fake.h not found";
+    }
+    return result;
+}
+
+TEST_CASE("PackageProbe notices changed variables and paths", "[package_cache]") {
+    PackageCacheDir dir;
+    const fs::path header = dir.path / "sdk" / "include" / "fake.h";
+
+    PackageProbe probe;
+    CHECK_FALSE(probe.exists(header));
+    probe.env("SIGHMAKE_TEST_FAKE_SDK");
+    probe.exists(header);  // Recorded once
+    REQUIRE(probe.inputs.size() == 2);
+    CHECK(probe.unchanged());
+
+    std::ofstream(header) << "// fake\n";
+    CHECK_FALSE(probe.unchanged());
+}
+
+TEST_CASE("PackageCache probes a package once per run", "[package_cache]") {
+    PackageCacheDir dir;
+    const fs::path sdk = dir.path / "sdk";
+    int probes = 0;
+
+    PackageCache cache;
+    auto finder = [&](PackageProbe& probe) { return find_fake_sdk(probe, sdk, probes); };
+    CHECK_FALSE(cache.find("fake", finder).found);
+    CHECK_FALSE(cache.find("fake", finder).found);
+    CHECK(probes == 1);
+
+    // Within a run the result stands even if the disk changes
+    std::ofstream(sdk / "include" / "fake.h") << "// fake\n";
+    CHECK_FALSE(cache.find("fake", finder).found);
+    CHECK(probes == 1);
+
+    // The next run checks the probe's inputs and probes again
+    cache.begin_run();
+    CHECK(cache.find("fake", finder).found);
+    CHECK(probes == 2);
+}
+
+TEST_CASE("PackageCache computes a run value once per run", "[package_cache]") {
+    PackageCache cache;
+    int computed = 0;
+    auto compute = [&] { return "dirs" + std::to_string(++computed); };
+
+    CHECK(cache.run_value("search path", compute) == "dirs1");
+    CHECK(cache.run_value("search path", compute) == "dirs1");
+    CHECK(computed == 1);
+
+    cache.begin_run();
+    CHECK(cache.run_value("search path", compute) == "dirs2");
+}
+
+TEST_CASE("PackageCache probes different packages concurrently", "[package_cache]") {
+    PackageCache cache;
+    std::atomic<bool> slow_started{false};
+    std::atomic<bool> fast_done{false};
+    bool fast_done_during_slow = false;
+
+    // The slow probe waits (bounded) for the fast one, which can only finish
+    // if it is not queued behind the slow probe
+    std::thread slow([&] {
+        cache.find("slow", [&](PackageProbe&) {
+            slow_started = true;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!fast_done && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            fast_done_during_slow = fast_done;
+            return PackageFindResult{};
+        });
+    });
+    while (!slow_started) {
+        std::this_thread::yield();
+    }
+    cache.find("fast", [](PackageProbe&) { return PackageFindResult{}; });
+    fast_done = true;
+    slow.join();
+
+    CHECK(fast_done_during_slow);
+}
+
+TEST_CASE("PackageCache reuses stored results across runs while inputs are unchanged", "[package_cache]") {
+    PackageCacheDir dir;
+    const fs::path sdk = dir.path / "sdk";
+    const std::string cache_dir = dir.path.string();
+    std::ofstream(sdk / "include" / "fake.h") << "// fake\n";
+    int probes = 0;
+    auto finder = [&](PackageProbe& probe) { return find_fake_sdk(probe, sdk, probes); };
+
+    {
+        PackageCache cache;
+        cache.load(cache_dir);
+        CHECK(cache.find("fake", finder).found);
+        REQUIRE(cache.save(cache_dir));
+    }
+    REQUIRE(fs::exists(dir.path / PackageCache::CACHE_FILENAME));
+    CHECK(probes == 1);
+
+    {
+        PackageCache cache;
+        cache.load(cache_dir);
+        auto result = cache.find("fake", finder);
+        CHECK(probes == 1);
+        CHECK(result.found);
+        CHECK(result.include_dirs == (sdk / "include").string());
+        CHECK(result.libraries == "fake");
+        CHECK(result.version == "1.2");
+    }
+
+    // Removing the header invalidates the stored result
+    fs::remove(sdk / "include" / "fake.h");
+    {
+        PackageCache cache;
+        cache.load(cache_dir);
+        CHECK_FALSE(cache.find("fake", finder).found);
+        CHECK(probes == 2);
+        REQUIRE(cache.save(cache_dir));
+    }
+    {
+        PackageCache cache;
+        cache.load(cache_dir);
+        auto result = cache.find("fake", finder);
+        CHECK_FALSE(result.found);
+        CHECK(result.error_message == "fake.h not found");
+        CHECK(probes == 2);
+    }
+}
+
+TEST_CASE("PackageCache drops stored results a run did not use", "[package_cache]") {
+    PackageCacheDir dir;
+    const std::string cache_dir = dir.path.string();
+    auto finder = [](PackageProbe& probe) {
+        probe.env("SIGHMAKE_TEST_FAKE_SDK");
+        return PackageFindResult{};
+    };
+
+    {
+        PackageCache cache;
+        cache.find("old", finder);
+        cache.find("kept", finder);
+        REQUIRE(cache.save(cache_dir));
+    }
+    {
+        PackageCache cache;
+        cache.load(cache_dir);
+        cache.find("kept", finder);
+        REQUIRE(cache.save(cache_dir));
+    }
+
+    std::ifstream in(dir.path / PackageCache::CACHE_FILENAME);
+    std::stringstream content;
+    content << in.rdbuf();
+    CHECK(content.str().find("package=kept\n") != std::string::npos);
+    CHECK(content.str().find("package=old\n") == std::string::npos);
+}
+
+TEST_CASE("Parser stores find_package() results next to the build cache", "[package_cache]") {
+    PackageCacheDir dir;
+    std::ofstream(dir.path / "app.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = main.cpp
+find_package(OpenGL)
+)";
+
+    BuildscriptParser parser;
+    parser.set_package_cache_dir(dir.path.string());
+    Solution first = parser.parse((dir.path / "app.buildscript").string());
+
+    std::ifstream in(dir.path / PackageCache::CACHE_FILENAME);
+    REQUIRE(in.is_open());
+    std::stringstream content;
+    content << in.rdbuf();
+    CHECK(content.str().find("package=opengl\n") != std::string::npos);
+
+    BuildscriptParser again;
+    again.set_package_cache_dir(dir.path.string());
+    Solution second = again.parse((dir.path / "app.buildscript").string());
+    CHECK(second.found_packages.size() == first.found_packages.size());
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+TEST_CASE("Parser notices an upgraded .pc file a package requires", "[package_cache]") {
+    if (std::system("pkg-config --version > /dev/null 2>&1") != 0) {
+        SKIP("pkg-config is not installed");
+    }
+    PackageCacheDir dir;
+    const fs::path pc_dir = dir.path / "pkgconfig";
+    fs::create_directories(pc_dir);
+    std::ofstream(pc_dir / "sdl2.pc") << "Name: sdl2\nDescription: fake\nVersion: 2.0\n"
+                                         "Requires.private: fakedep\nCflags: -I/opt/sdl2\nLibs: -lSDL2\n";
+    auto write_dependency = [&](const std::string& include) {
+        std::ofstream(pc_dir / "fakedep.pc") << "Name: fakedep\nDescription: fake\nVersion: 1.0\n"
+                                                "Cflags: -I" << include << "\n";
+    };
+    write_dependency("/opt/dep-1");
+
+    // Only the fake .pc files are visible
+    const char* old_path = std::getenv("PKG_CONFIG_PATH");
+    const char* old_libdir = std::getenv("PKG_CONFIG_LIBDIR");
+    const std::string saved_path = old_path ? old_path : "";
+    const std::string saved_libdir = old_libdir ? old_libdir : "";
+    ::setenv("PKG_CONFIG_LIBDIR", pc_dir.string().c_str(), 1);
+    ::unsetenv("PKG_CONFIG_PATH");
+
+    std::ofstream(dir.path / "app.buildscript") << R"(
+[solution]
+name = Test
+configurations = Debug
+platforms = x64
+
+[project:App]
+type = exe
+sources = main.cpp
+find_package(SDL2)
+)";
+    auto include_dirs = [&] {
+        BuildscriptParser parser;
+        parser.set_package_cache_dir(dir.path.string());
+        Solution solution = parser.parse((dir.path / "app.buildscript").string());
+        auto it = solution.found_packages.find("SDL2");
+        return it == solution.found_packages.end() ? std::string() : it->second.include_dirs;
+    };
+
+    CHECK(include_dirs().find("/opt/dep-1") != std::string::npos);
+
+    // Upgrade the dependency in place, with a visibly newer modification time
+    write_dependency("/opt/dep-2");
+    fs::last_write_time(pc_dir / "fakedep.pc",
+                        fs::last_write_time(pc_dir / "fakedep.pc") + std::chrono::seconds(5));
+    CHECK(include_dirs().find("/opt/dep-2") != std::string::npos);
+
+    if (old_path) ::setenv("PKG_CONFIG_PATH", saved_path.c_str(), 1);
+    if (old_libdir) ::setenv("PKG_CONFIG_LIBDIR", saved_libdir.c_str(), 1);
+    else ::unsetenv("PKG_CONFIG_LIBDIR");
+}
+#endif
@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/project_graph.hpp"
+
+using namespace vcxproj;
+
+// Solution with one project per name; deps[i] lists project i's references
+static Solution make_solution(const std::vector<std::string>& names,
+                              const std::vector<std::vector<std::string>>& deps) {
+    Solution solution;
+    for (size_t i = 0; i < names.size(); ++i) {
+        Project project;
+        project.name = names[i];
+        if (i < deps.size()) {
+            for (const auto& dep : deps[i]) {
+                project.project_references.push_back(ProjectDependency(dep));
+            }
+        }
+        solution.projects.push_back(std::move(project));
+    }
+    return solution;
+}
+
+static std::vector<std::string> order_names(const Solution& solution, const ProjectGraph& graph) {
+    std::vector<std::string> names;
+    for (size_t index : graph.topological_order()) {
+        names.push_back(solution.projects[index].name);
+    }
+    return names;
+}
+
+TEST_CASE("ProjectGraph indexes projects by name", "[project_graph]") {
+    auto solution = make_solution({"App", "Core", "Util"}, {});
+    ProjectGraph graph(solution);
+
+    CHECK(graph.size() == 3);
+    CHECK(graph.find("App") == 0);
+    CHECK(graph.find("Util") == 2);
+    CHECK(graph.find("Missing") == ProjectGraph::npos);
+}
+
+TEST_CASE("ProjectGraph resolves references to edges", "[project_graph]") {
+    auto solution = make_solution({"App", "Core", "Util"},
+                                  {{"ws2_32", "Util", "Core"}, {"Util"}, {}});
+    ProjectGraph graph(solution);
+
+    // The unresolved "ws2_32" gets no edge; references keep their positions
+    const auto& app = graph.dependencies(0);
+    REQUIRE(app.size() == 2);
+    CHECK(app[0].project == 2);
+    CHECK(app[0].reference == 1);
+    CHECK(app[1].project == 1);
+    CHECK(app[1].reference == 2);
+
+    CHECK(graph.dependents(2) == std::vector<size_t>{0, 1});
+    CHECK(graph.dependents(1) == std::vector<size_t>{0});
+    CHECK(graph.dependents(0).empty());
+}
+
+TEST_CASE("ProjectGraph lists a repeated dependent once", "[project_graph]") {
+    auto solution = make_solution({"App", "Core"}, {{"Core", "Core"}});
+    ProjectGraph graph(solution);
+
+    CHECK(graph.dependencies(0).size() == 2);
+    CHECK(graph.dependents(1) == std::vector<size_t>{0});
+}
+
+TEST_CASE("ProjectGraph orders dependencies first", "[project_graph]") {
+    auto solution = make_solution({"App", "Gfx", "Core", "Tool"},
+                                  {{"Gfx", "Core"}, {"Core"}, {}, {"Core"}});
+    ProjectGraph graph(solution);
+
+    CHECK(order_names(solution, graph) == std::vector<std::string>{"Core", "Gfx", "App", "Tool"});
+}
+
+TEST_CASE("ProjectGraph breaks cycles where they close", "[project_graph]") {
+    auto solution = make_solution({"A", "B", "C"}, {{"B"}, {"C"}, {"A"}});
+    ProjectGraph graph(solution);
+
+    CHECK(order_names(solution, graph) == std::vector<std::string>{"C", "B", "A"});
+}
+
+TEST_CASE("ProjectGraph handles deep dependency chains", "[project_graph]") {
+    // Each project depends on the next; a recursive walk would go 20000 deep
+    const size_t count = 20000;
+    Solution solution;
+    for (size_t i = 0; i < count; ++i) {
+        Project project;
+        project.name = "p" + std::to_string(i);
+        if (i + 1 < count) {
+            project.project_references.push_back(ProjectDependency("p" + std::to_string(i + 1)));
+        }
+        solution.projects.push_back(std::move(project));
+    }
+
+    ProjectGraph graph(solution);
+    const auto& order = graph.topological_order();
+    REQUIRE(order.size() == count);
+    CHECK(order.front() == count - 1);
+    CHECK(order.back() == 0);
+}
+
+TEST_CASE("Solution::graph is rebuilt when projects change", "[project_graph]") {
+    auto solution = make_solution({"App"}, {{"Core"}});
+    CHECK(solution.graph().dependencies(0).empty());
+
+    // Adding a project rebuilds the graph on the next call
+    Project core;
+    core.name = "Core";
+    solution.projects.push_back(core);
+    REQUIRE(solution.graph().dependencies(0).size() == 1);
+    CHECK(solution.graph().dependencies(0)[0].project == 1);
+
+    // Editing references needs an explicit invalidation
+    solution.projects[0].project_references.clear();
+    solution.invalidate_graph();
+    CHECK(solution.graph().dependencies(0).empty());
+
+    // Copies share the graph built for the original
+    Solution copy = solution;
+    CHECK(&copy.graph() == &solution.graph());
+}
@@ -274,3 +274,27 @@ TEST_CASE("ProjectDependency constructor with name and visibility", "[project_ty
     CHECK(dep.name == "MyLib");
     CHECK(dep.visibility == DependencyVisibility::PRIVATE);
 }
+
+// ============================================================================
+// Stable UUID tests
+// ============================================================================
+
+TEST_CASE("make_stable_uuid is deterministic", "[project_types]") {
+    CHECK(make_stable_uuid("project|App") == make_stable_uuid("project|App"));
+    CHECK(make_stable_uuid("project|App") != make_stable_uuid("project|Core"));
+    CHECK(make_stable_uuid("project|App") != make_stable_uuid("solution|App"));
+}
+
+TEST_CASE("make_stable_uuid has the GUID format", "[project_types]") {
+    std::string uuid = make_stable_uuid("solution|Test");
+    REQUIRE(uuid.size() == 36);
+    CHECK(uuid[8] == '-');
+    CHECK(uuid[13] == '-');
+    CHECK(uuid[18] == '-');
+    CHECK(uuid[23] == '-');
+    CHECK(uuid[14] == '8');  // Version 8 (name-based, custom hash)
+    CHECK(std::string("89AB").find(uuid[19]) != std::string::npos);  // RFC 4122 variant
+    for (char c : uuid) {
+        CHECK((c == '-' || std::isdigit(static_cast<unsigned char>(c)) || (c >= 'A' && c <= 'F')));
+    }
+}
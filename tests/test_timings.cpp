@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "catch_amalgamated.hpp"
+#include "common/timings.hpp"
+#include "common/parallel.hpp"
+
+using namespace vcxproj;
+namespace fs = std::filesystem;
+
+// Turns collection on for one test and leaves it off and empty afterwards,
+// so other tests never record anything
+struct TimingsOn {
+    TimingsOn() {
+        reset_timings();
+        enable_timings();
+    }
+    ~TimingsOn() {
+        enable_timings(false);
+        reset_timings();
+    }
+};
+
+static std::string summary() {
+    std::ostringstream out;
+    write_timing_summary(out);
+    return out.str();
+}
+
+TEST_CASE("Timings record nothing while disabled", "[timings]") {
+    reset_timings();
+    CHECK_FALSE(timings_enabled());
+    {
+        TimingScope timing("disabled phase");
+        add_timing_counter("disabled counter");
+    }
+    const std::string text = summary();
+    CHECK(text.find("disabled phase") == std::string::npos);
+    CHECK(text.find("disabled counter") == std::string::npos);
+}
+
+TEST_CASE("Timings summarize phases and counters", "[timings]") {
+    TimingsOn on;
+    for (int i = 0; i < 3; ++i) {
+        TimingScope timing("repeated phase");
+        add_timing_counter("widgets", 2);
+    }
+    {
+        TimingScope timing("single phase");
+    }
+
+    const std::string text = summary();
+    std::istringstream lines(text);
+    std::string line;
+    bool found_repeated = false;
+    while (std::getline(lines, line)) {
+        if (line.find("repeated phase") != std::string::npos) {
+            std::istringstream fields(line.substr(line.find("phase") + 5));
+            int calls = 0;
+            fields >> calls;
+            CHECK(calls == 3);
+            found_repeated = true;
+        }
+        if (line.find("widgets") != std::string::npos) {
+            CHECK(line.find(" 6") != std::string::npos);
+        }
+    }
+    CHECK(found_repeated);
+
+    // Phases are listed in the order they first started
+    CHECK(text.find("repeated phase") < text.find("single phase"));
+}
+
+TEST_CASE("Timings collect spans from worker threads", "[timings]") {
+    TimingsOn on;
+    parallel_for(16, 4, [](size_t) {
+        TimingScope timing("worker phase");
+        add_timing_counter("items");
+    });
+
+    const std::string text = summary();
+    CHECK(text.find("worker phase") != std::string::npos);
+    CHECK(text.find("16") != std::string::npos);
+}
+
+TEST_CASE("Timing trace is Chrome trace_event JSON", "[timings]") {
+    TimingsOn on;
+    {
+        TimingScope timing("traced \"phase\"");
+        add_timing_counter("traced counter", 5);
+    }
+
+    fs::path path = fs::temp_directory_path() / "sighmake_test_timings.json";
+    REQUIRE(write_timing_trace(path.string()));
+
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    fs::remove(path);
+
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\": \"traced \\\"phase\\\"\"") != std::string::npos);
+    CHECK(json.find("\"ph\": \"X\"") != std::string::npos);
+    CHECK(json.find("\"traced counter\": 5") != std::string::npos);
+}